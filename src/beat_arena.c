@@ -0,0 +1,163 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+
+#include "beat_arena.h"
+
+// --------------------------------------------------------------------------------
+
+void* Engine_MemAlloc(int nSize);
+void Engine_MemFree(void* pData);
+
+
+// --------------------------------------------------------------------------------
+static int BeatArenaAlignSize(int nSize)
+{
+	return (nSize + BEAT_ARENA_ALIGN - 1) & ~(BEAT_ARENA_ALIGN - 1);
+}
+
+
+// --------------------------------------------------------------------------------
+static uint8_t* BeatArenaBlockData(BeatArenaBlock* pBlock)
+{
+	return (uint8_t*)pBlock + BeatArenaAlignSize(sizeof(BeatArenaBlock));
+}
+
+
+// --------------------------------------------------------------------------------
+static BeatArenaBlock* BeatArenaAddBlock(BeatArena* pArena, int nSize)
+{
+	if (nSize < BEAT_ARENA_BLOCK_SIZE)
+		nSize = BEAT_ARENA_BLOCK_SIZE;
+
+	BeatArenaBlock* pBlock = Engine_MemAlloc(BeatArenaAlignSize(sizeof(BeatArenaBlock)) + nSize);
+	if (pBlock == NULL)
+		return NULL;
+
+	pBlock->pNext = NULL;
+	pBlock->nSize = nSize;
+	pBlock->nUsed = 0;
+
+	// blocks are kept in allocation order so a reset walks them front to back again
+	if (pArena->pBlocks == NULL)
+	{
+		pArena->pBlocks = pBlock;
+	}
+	else
+	{
+		BeatArenaBlock* pLast = pArena->pBlocks;
+		while (pLast->pNext)
+			pLast = pLast->pNext;
+
+		pLast->pNext = pBlock;
+	}
+
+	pArena->stats.nBlockCount++;
+	pArena->stats.nReservedBytes += nSize;
+
+	return pBlock;
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatArenaInit(BeatArena* pArena)
+{
+	memset(pArena, 0, sizeof(BeatArena));
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatArenaRelease(BeatArena* pArena)
+{
+	BeatArenaBlock* pBlock = pArena->pBlocks;
+	while (pBlock)
+	{
+		BeatArenaBlock* pNext = pBlock->pNext;
+		Engine_MemFree(pBlock);
+		pBlock = pNext;
+	}
+
+	BeatArenaInit(pArena);
+
+}
+
+
+// --------------------------------------------------------------------------------
+void* BeatArenaAlloc(BeatArena* pArena, int nSize)
+{
+	nSize = BeatArenaAlignSize(nSize);
+
+	// first block from the current one on with room left, after a reset these are the old blocks
+	BeatArenaBlock* pBlock = pArena->pCurrent ? pArena->pCurrent : pArena->pBlocks;
+	while (pBlock && pBlock->nSize - pBlock->nUsed < nSize)
+		pBlock = pBlock->pNext;
+
+	if (pBlock == NULL)
+		pBlock = BeatArenaAddBlock(pArena, nSize);
+
+	if (pBlock == NULL)
+		return NULL;
+
+	pArena->pCurrent = pBlock;
+
+	void* pData = BeatArenaBlockData(pBlock) + pBlock->nUsed;
+	pBlock->nUsed += nSize;
+
+	memset(pData, 0, nSize);
+
+	pArena->stats.nAllocCount++;
+	pArena->stats.nUsedBytes += nSize;
+	if (pArena->stats.nUsedBytes > pArena->stats.nPeakUsedBytes)
+		pArena->stats.nPeakUsedBytes = pArena->stats.nUsedBytes;
+
+	return pData;
+}
+
+
+// --------------------------------------------------------------------------------
+char* BeatArenaStrDup(BeatArena* pArena, const char* str)
+{
+	int len = strlen(str);
+	char* s = BeatArenaAlloc(pArena, len + 1);
+	if (s)
+		memcpy(s, str, len + 1);
+
+	return s;
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatArenaReset(BeatArena* pArena)
+{
+	for (BeatArenaBlock* pBlock = pArena->pBlocks; pBlock; pBlock = pBlock->pNext)
+		pBlock->nUsed = 0;
+
+	pArena->pCurrent = pArena->pBlocks;
+
+	pArena->stats.nUsedBytes = 0;
+	pArena->stats.nResetCount++;
+
+}
+
+
+// --------------------------------------------------------------------------------
+const BeatArenaStats* BeatArenaGetStats(BeatArena* pArena)
+{
+	return &pArena->stats;
+}
@@ -0,0 +1,93 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+
+#ifndef BEATARENA_H
+#define BEATARENA_H
+
+#pragma once
+
+#include <stdio.h>
+
+#include "pd_api.h"
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	// a whole beat (tracks, scale, names) fits in one block, bigger requests get a block of their own
+	BEAT_ARENA_BLOCK_SIZE = 8 * 1024,
+	BEAT_ARENA_ALIGN = 8
+
+} BEAT_ARENA_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+typedef struct BeatArenaBlock
+{
+	struct BeatArenaBlock* pNext;
+
+	int nSize;
+	int nUsed;
+
+} BeatArenaBlock;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int nAllocCount;
+	int nResetCount;
+
+	int nUsedBytes;
+	int nPeakUsedBytes;
+
+	int nBlockCount;
+	int nReservedBytes;
+
+} BeatArenaStats;
+
+
+// --------------------------------------------------------------------------------
+// Bump allocator for everything a loaded beat owns. Nothing is freed on its own,
+// BeatArenaReset() drops it all at once and keeps the blocks for the next beat,
+// so loading beat after beat does not touch the heap once the blocks exist.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	BeatArenaBlock* pBlocks;
+	BeatArenaBlock* pCurrent;
+
+	BeatArenaStats stats;
+
+} BeatArena;
+
+
+// --------------------------------------------------------------------------------
+void BeatArenaInit(BeatArena* pArena);
+void BeatArenaRelease(BeatArena* pArena);
+
+void* BeatArenaAlloc(BeatArena* pArena, int nSize);
+char* BeatArenaStrDup(BeatArena* pArena, const char* str);
+
+void BeatArenaReset(BeatArena* pArena);
+
+const BeatArenaStats* BeatArenaGetStats(BeatArena* pArena);
+
+
+#endif
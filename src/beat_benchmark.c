@@ -0,0 +1,538 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <stdio.h>
+
+#include "beat_benchmark.h"
+#include "beat_machine.h"
+
+
+// --------------------------------------------------------------------------------
+static PlaydateAPI* pd = NULL;
+
+
+// --------------------------------------------------------------------------------
+typedef int (*BenchLoadFunc)(BeatMachine* pBeatMachine, const char* szName);
+
+
+// --------------------------------------------------------------------------------
+static int BenchFileExists(const char* szName)
+{
+	char szPath[256];
+	memset(szPath, 0, 256);
+	strcpy(szPath, "beats/");
+	strcat(szPath, szName);
+
+	FileStat stat;
+	return pd->file->stat(szPath, &stat) == 0;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BenchLoad(const char* szLabel, const char* szName, BenchLoadFunc loadFunc)
+{
+	if (!BenchFileExists(szName))
+	{
+		pd->system->logToConsole("bench %s: beats/%s not found, skipped", szLabel, szName);
+		return;
+	}
+
+	BeatMachineMemStats* pMemStats = BeatMachineGetMemStats();
+
+	float fTotalTime = 0.0f;
+	int nPeakBytes = 0;
+
+	for (int i = 0; i < BENCH_REPEAT_COUNT; i++)
+	{
+		BeatMachine* pBeatMachine = BeatMachineCreate(pd);
+
+		int nBaseBytes = pMemStats->nLiveBytes;
+		pMemStats->nPeakBytes = nBaseBytes;
+
+		pd->system->resetElapsedTime();
+		loadFunc(pBeatMachine, szName);
+		fTotalTime += pd->system->getElapsedTime();
+
+		if (pMemStats->nPeakBytes - nBaseBytes > nPeakBytes)
+			nPeakBytes = pMemStats->nPeakBytes - nBaseBytes;
+
+		BeatMachineDestroy(pBeatMachine);
+	}
+
+	pd->system->logToConsole("bench %s %s: %.3f ms per load, peak heap %d bytes", szLabel, szName, fTotalTime * 1000.0f / BENCH_REPEAT_COUNT, nPeakBytes);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BenchBeatFormats(const char* szBeat)
+{
+	char szJson[64];
+	char szCompiled[64];
+
+	snprintf(szJson, 64, "%s.bmf", szBeat);
+	snprintf(szCompiled, 64, "%s.bmb", szBeat);
+
+	// peak heap only counts the player's own allocations, the buffers of pd->json are not visible from here
+	BenchLoad("json", szJson, BeatMachineLoadBeat);
+	BenchLoad("compiled", szCompiled, BeatMachineLoadCompiledBeat);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BenchSampleCache(const char* szFirst, const char* szSecond)
+{
+	if (!BenchFileExists(szFirst) || !BenchFileExists(szSecond))
+		return;
+
+	BeatMachine* pBeatMachine = BeatMachineCreate(pd);
+
+	// the second load is a beat switch, every sample it shares with the first one is a hit
+	pd->system->resetElapsedTime();
+	BeatMachineLoadBeat(pBeatMachine, szFirst);
+	float fFirstTime = pd->system->getElapsedTime();
+	SampleCacheLogStats(pBeatMachine->pSampleCache);
+
+	pd->system->resetElapsedTime();
+	BeatMachineLoadBeat(pBeatMachine, szSecond);
+	float fSecondTime = pd->system->getElapsedTime();
+	SampleCacheLogStats(pBeatMachine->pSampleCache);
+
+	pd->system->logToConsole("bench sample cache: %s %.3f ms, then %s %.3f ms", szFirst, fFirstTime * 1000.0f, szSecond, fSecondTime * 1000.0f);
+
+	BeatMachineDestroy(pBeatMachine);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BenchNoteSort(const char* szName)
+{
+	if (!BenchFileExists(szName))
+		return;
+
+	float fCommitTime[2] = { 0.0f, 0.0f };
+
+	for (int bSortNotes = 0; bSortNotes < 2; bSortNotes++)
+	{
+		for (int i = 0; i < BENCH_REPEAT_COUNT; i++)
+		{
+			BeatMachine* pBeatMachine = BeatMachineCreate(pd);
+			pBeatMachine->bSortNotes = bSortNotes;
+
+			BeatMachineLoadBeat(pBeatMachine, szName);
+
+			const BeatLoadStats* pStats = BeatMachineGetLoadStats(pBeatMachine);
+			fCommitTime[bSortNotes] += pStats->fCommitTime;
+
+			if (bSortNotes && i == 0)
+			{
+				pd->system->logToConsole("bench notes %s: %d notes, %d events, %d tracks sorted, read %.3f decode %.3f sort %.3f tracks %.3f commit %.3f ms", szName, pStats->nNoteCount, pStats->nEventCount, pStats->nUnsortedTracks,
+					pStats->fReadTime * 1000.0f, pStats->fDecodeTime * 1000.0f, pStats->fSortTime * 1000.0f, pStats->fTrackTime * 1000.0f, pStats->fCommitTime * 1000.0f);
+			}
+
+			BeatMachineDestroy(pBeatMachine);
+		}
+	}
+
+	pd->system->logToConsole("bench notes %s: commit %.3f ms in file order, %.3f ms sorted", szName, fCommitTime[0] * 1000.0f / BENCH_REPEAT_COUNT, fCommitTime[1] * 1000.0f / BENCH_REPEAT_COUNT);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BenchTransition(const char* szFirst, const char* szSecond, const char* szLabel)
+{
+	if (!BenchFileExists(szFirst) || !BenchFileExists(szSecond))
+		return;
+
+	BeatMachine* pBeatMachine = BeatMachineCreate(pd);
+
+	BeatMachineLoadBeat(pBeatMachine, szFirst);
+	BeatMachinePlayTheBeat(pBeatMachine, 0);
+
+	// the next beat loads a slice per frame while the first one plays
+	int nPhase = BeatMachineBeginLoad(pBeatMachine, szSecond) == 0 ? BM_LOAD_READING : BM_LOAD_FAILED;
+	while (nPhase != BM_LOAD_READY && nPhase != BM_LOAD_FAILED)
+		nPhase = BeatMachineStepLoad(pBeatMachine, BENCH_FRAME_BUDGET);
+
+	// jump to a beat before the label so the bench doesn't wait through the whole beat
+	int nLabelStep = szLabel ? BeatMachineFindLabel(pBeatMachine, szLabel) : -1;
+	if (nLabelStep >= BM_STEPS_PER_BEAT)
+		pd->sound->sequence->setCurrentStep(pBeatMachine->pSequence, nLabelStep - BM_STEPS_PER_BEAT, 0, 0);
+
+	if (nPhase == BM_LOAD_FAILED || BeatMachineQueueTransition(pBeatMachine, szLabel, BM_STEPS_PER_BAR, 0) != 0)
+	{
+		pd->system->logToConsole("bench transition %s -> %s: could not be queued", szFirst, szSecond);
+		BeatMachineDestroy(pBeatMachine);
+		return;
+	}
+
+	int nStartStep = pBeatMachine->transition.nStartStep;
+	int nStepsToStart = pBeatMachine->transition.nStepsToStart;
+	int nStartAllocs = -1;
+	int nLateSteps = -1;
+
+	BeatMachineMemStats* pMemStats = BeatMachineGetMemStats();
+
+	pd->system->resetElapsedTime();
+
+	while (pBeatMachine->transition.nState != BM_TRANSITION_NONE && pd->system->getElapsedTime() < BENCH_TRANSITION_TIMEOUT)
+	{
+		int nState = pBeatMachine->transition.nState;
+		int nAllocCount = pMemStats->nAllocCount;
+
+		BeatMachineUpdateTransition(pBeatMachine);
+
+		if (nState == BM_TRANSITION_ARMED && pBeatMachine->transition.nState == BM_TRANSITION_FADING)
+		{
+			nStartAllocs = pMemStats->nAllocCount - nAllocCount;
+			nLateSteps = pd->sound->sequence->getCurrentStep(pBeatMachine->pSequence, NULL);
+		}
+	}
+
+	int bDone = pBeatMachine->transition.nState == BM_TRANSITION_NONE && pBeatMachine->pLoad == NULL;
+
+	pd->system->logToConsole("bench transition %s -> %s: start step %d (%d steps ahead), new beat %d steps in, %d allocations on the start frame, %s", szFirst, szSecond,
+		nStartStep, nStepsToStart, nLateSteps, nStartAllocs, (bDone && nStartAllocs == 0) ? "ok" : "FAILED");
+
+	BeatMachineDestroy(pBeatMachine);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BenchSeek(const char* szName, const char* szLabel)
+{
+	if (!BenchFileExists(szName))
+		return;
+
+	BeatMachine* pBeatMachine = BeatMachineCreate(pd);
+	BeatMachineLoadBeat(pBeatMachine, szName);
+	BeatMachinePlayTheBeat(pBeatMachine, 0);
+
+	// every frame the seek can be called on lands somewhere else in the bar, a few of them show the spread
+	int nSeeks = 0;
+	int nFailed = 0;
+	pd->system->resetElapsedTime();
+
+	while (nSeeks < BENCH_SEEK_COUNT && pd->system->getElapsedTime() < BENCH_TRANSITION_TIMEOUT)
+	{
+		if (BeatMachineSeekToLabel(pBeatMachine, szLabel) != 0)
+		{
+			nFailed++;
+			break;
+		}
+
+		while (pBeatMachine->seek.bPending && pd->system->getElapsedTime() < BENCH_TRANSITION_TIMEOUT)
+			BeatMachineUpdateSeek(pBeatMachine);
+
+		nSeeks++;
+	}
+
+	const BeatSeek* pSeek = &pBeatMachine->seek;
+
+	pd->system->logToConsole("bench seek %s to %s: %d seeks, last %.1f ms after the call, longest %.1f ms, %d late, %s", szName, szLabel, pSeek->nSeekCount,
+		pSeek->nLastLatency * 1000.0f / BM_SAMPLE_RATE, pSeek->nMaxLatency * 1000.0f / BM_SAMPLE_RATE, pSeek->nLateCount,
+		(nFailed == 0 && pSeek->nSeekCount == nSeeks) ? "ok" : "FAILED");
+
+	BeatMachineDestroy(pBeatMachine);
+}
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int nSteps;
+	int nBars;
+	int nLastStep;
+	int nSkipped;				// steps that didn't follow the one before
+
+} BenchEventCount;
+
+
+// --------------------------------------------------------------------------------
+static void BenchOnEvent(const BeatEvent* pEvent, void* pUserdata)
+{
+	BenchEventCount* pCount = pUserdata;
+
+	if (pEvent->nType == BM_EVENT_BAR)
+	{
+		pCount->nBars++;
+		return;
+	}
+
+	if (pCount->nLastStep >= 0 && pEvent->nStep != pCount->nLastStep + 1)
+		pCount->nSkipped++;
+
+	pCount->nLastStep = pEvent->nStep;
+	pCount->nSteps++;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BenchEvents(const char* szName)
+{
+	if (!BenchFileExists(szName))
+		return;
+
+	BeatMachine* pBeatMachine = BeatMachineCreate(pd);
+	BeatMachineLoadBeat(pBeatMachine, szName);
+
+	BenchEventCount count;
+	memset(&count, 0, sizeof(BenchEventCount));
+	count.nLastStep = -1;
+
+	BeatMachineSubscribe(pBeatMachine, BM_EVENT_STEP | BM_EVENT_BAR, BenchOnEvent, &count);
+	BeatMachinePlayTheBeat(pBeatMachine, 0);
+
+	// two bars at 120 BPM, handed out as often as the loop comes round
+	pd->system->resetElapsedTime();
+
+	while (pd->system->getElapsedTime() < BENCH_EVENT_SECONDS)
+		BeatMachineDispatchEvents(pBeatMachine);
+
+	BeatMachineDispatchEvents(pBeatMachine);
+
+	pd->system->logToConsole("bench events %s: %d steps, %d bars in %d s, %d out of order, %u dropped, %s", szName, count.nSteps, count.nBars, BENCH_EVENT_SECONDS,
+		count.nSkipped, pBeatMachine->events.nDropped, (count.nSteps > 0 && count.nSkipped == 0 && pBeatMachine->events.nDropped == 0) ? "ok" : "FAILED");
+
+	BeatMachineDestroy(pBeatMachine);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BenchTrigger(const char* szName, const char* szSample)
+{
+	if (!BenchFileExists(szName))
+		return;
+
+	BeatMachine* pBeatMachine = BeatMachineCreate(pd);
+	BeatMachineLoadBeat(pBeatMachine, szName);
+	BeatMachinePlayTheBeat(pBeatMachine, 0);
+
+	BeatMachineMemStats* pMemStats = BeatMachineGetMemStats();
+	int nAllocCount = pMemStats->nAllocCount;
+
+	// every grid size a few times, the voices get stolen on the way
+	int nFailed = 0;
+	int nTriggers = 0;
+	pd->system->resetElapsedTime();
+
+	for (int i = 0; i < BENCH_LOAD_LOOP_COUNT; i++, nTriggers++)
+	{
+		int nQuantum = (i % 3 == 0) ? BM_QUANTUM_STEP : ((i % 3 == 1) ? BM_QUANTUM_BEAT : BM_QUANTUM_BAR);
+		if (BeatMachineTriggerQuantized(pBeatMachine, szSample, nQuantum, 0.5f) != 0)
+			nFailed++;
+	}
+
+	float fTime = pd->system->getElapsedTime();
+	int nAllocs = pMemStats->nAllocCount - nAllocCount;
+
+	pd->system->logToConsole("bench trigger %s %s: %d triggers in %.3f ms, %d stolen, %d allocations, %s", szName, szSample, nTriggers, fTime * 1000.0f,
+		pBeatMachine->triggers.nStolenCount, nAllocs, (nFailed == 0 && nAllocs == 0) ? "ok" : "FAILED");
+
+	BeatMachineDestroy(pBeatMachine);
+}
+
+
+// --------------------------------------------------------------------------------
+static uint32_t BenchNoteChecksum(BeatMachine* pBeatMachine, int* pEventCount)
+{
+	uint32_t nChecksum = 0;
+	int nEventCount = 0;
+
+	for (int t = 0; t < BM_MAX_TRACK; t++)
+	{
+		BeatMachineTrack* pTrack = pBeatMachine->pTracks[t];
+		if (pTrack == NULL || pTrack->pTrack == NULL)
+			continue;
+
+		uint32_t nStep = 0;
+		uint32_t nLen = 0;
+		MIDINote note = 0;
+		float fVelocity = 0.0f;
+
+		// order free, the events of a step may come back in any order after a rewrite
+		for (int i = 0; pd->sound->track->getNoteAtIndex(pTrack->pTrack, i, &nStep, &nLen, &note, &fVelocity); i++)
+		{
+			uint32_t nEvent = ((uint32_t)(t + 1) << 24) ^ (nStep << 8) ^ ((uint32_t)note << 1) ^ (nLen << 20);
+			nChecksum += nEvent * 2654435761u;
+			nEventCount++;
+		}
+	}
+
+	*pEventCount = nEventCount;
+
+	return nChecksum;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BenchOccupancy(const char* szName)
+{
+	if (!BenchFileExists(szName))
+		return;
+
+	BeatMachine* pBeatMachine = BeatMachineCreate(pd);
+	BeatMachineLoadBeat(pBeatMachine, szName);
+
+	static uint16_t nWalked[BM_MAX_STEP_COUNT];
+	memset(nWalked, 0, sizeof(nWalked));
+
+	// what it takes without the index, every note of every track through the API
+	pd->system->resetElapsedTime();
+
+	for (int t = 0; t < BM_MAX_TRACK; t++)
+	{
+		BeatMachineTrack* pTrack = pBeatMachine->pTracks[t];
+		if (pTrack == NULL || pTrack->pTrack == NULL)
+			continue;
+
+		uint32_t nStep = 0;
+		uint32_t nLen = 0;
+		MIDINote note = 0;
+		float fVelocity = 0.0f;
+
+		for (int i = 0; pd->sound->track->getNoteAtIndex(pTrack->pTrack, i, &nStep, &nLen, &note, &fVelocity); i++)
+		{
+			if (nStep < BM_MAX_STEP_COUNT)
+				nWalked[nStep] |= 1 << t;
+		}
+	}
+
+	float fWalkTime = pd->system->getElapsedTime();
+
+	int nLength = pBeatMachine->nBeatLength;
+	int nMismatches = 0;
+	int nQueries = 0;
+
+	pd->system->resetElapsedTime();
+
+	for (int n = 0; n < nLength; n++, nQueries++)
+	{
+		if (BeatMachineGetTracksAtStep(pBeatMachine, n) != nWalked[n])
+			nMismatches++;
+	}
+
+	float fStepTime = pd->system->getElapsedTime();
+
+	// a bar and a half from every step, checked against the walked steps
+	pd->system->resetElapsedTime();
+
+	for (int n = 0; n < nLength; n++)
+	{
+		int nEnd = n + BM_STEPS_PER_BAR + BM_STEPS_PER_BAR / 2;
+		int nTracks = BeatMachineGetTracksInRange(pBeatMachine, n, nEnd);
+
+		int nExpected = 0;
+		for (int k = n; k < nEnd && k < BM_MAX_STEP_COUNT; k++)
+			nExpected |= nWalked[k];
+
+		if (nTracks != nExpected)
+			nMismatches++;
+	}
+
+	float fRangeTime = pd->system->getElapsedTime();
+
+	int nNotes = 0;
+	for (int t = 0; t < BM_MAX_TRACK; t++)
+		nNotes += BeatMachineGetTrackNotes(pBeatMachine, t, NULL);
+
+	if (nNotes != pBeatMachine->loadStats.nNoteCount)
+		nMismatches++;
+
+	pd->system->logToConsole("bench occupancy %s: %d steps, %d notes, walking the tracks %.3f ms, %.3f us per step query, %.3f us per range (incl. check), %d bytes, %s", szName,
+		nLength, nNotes, fWalkTime * 1000.0f, fStepTime * 1000000.0f / (nQueries ? nQueries : 1), fRangeTime * 1000000.0f / (nLength ? nLength : 1),
+		(int)sizeof(BeatOccupancy), nMismatches == 0 ? "ok" : "MISMATCH");
+
+	BeatMachineDestroy(pBeatMachine);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BenchScaleChange(const char* szName)
+{
+	if (!BenchFileExists(szName))
+		return;
+
+	BeatMachine* pBeatMachine = BeatMachineCreate(pd);
+	BeatMachineLoadBeat(pBeatMachine, szName);
+	BeatMachinePlayTheBeat(pBeatMachine, 0);
+
+	ScaleManager* pScaleManager = pBeatMachine->pScaleManager;
+	int nScale = pScaleManager->nCurrentScale;
+	int nRoot = pScaleManager->nNoteIndex;
+
+	int nEventCount = 0;
+	uint32_t nChecksum = BenchNoteChecksum(pBeatMachine, &nEventCount);
+
+	// every scale on a few roots while the beat plays, then back to where it was
+	int nChanges = 0;
+	pd->system->resetElapsedTime();
+
+	for (int s = 0; s < SCALE_COUNT; s++)
+	{
+		for (int r = 0; r < NOTE_COUNT; r += 5, nChanges++)
+			BeatMachineSetScale(pBeatMachine, s, r);
+	}
+
+	BeatMachineSetScale(pBeatMachine, nScale, nRoot);
+	float fScaleTime = pd->system->getElapsedTime();
+
+	int nScaleEvents = 0;
+	int bScaleSame = BenchNoteChecksum(pBeatMachine, &nScaleEvents) == nChecksum && nScaleEvents == nEventCount;
+
+	pd->system->resetElapsedTime();
+	BeatMachineTranspose(pBeatMachine, 7);
+	BeatMachineTranspose(pBeatMachine, -7);
+	float fTransposeTime = pd->system->getElapsedTime();
+
+	int nTransposeEvents = 0;
+	int bTransposeSame = BenchNoteChecksum(pBeatMachine, &nTransposeEvents) == nChecksum && nTransposeEvents == nEventCount;
+
+	pd->system->logToConsole("bench scale change %s: %d events, %.3f ms per scale change, %.3f ms per transpose, %s", szName, nEventCount,
+		fScaleTime * 1000.0f / (nChanges + 1), fTransposeTime * 1000.0f / 2, (bScaleSame && bTransposeSame) ? "round trip ok" : "FAILED");
+
+	BeatMachineDestroy(pBeatMachine);
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatBenchmarkRun(PlaydateAPI* playdateApi)
+{
+	pd = playdateApi;
+
+	BenchBeatFormats("demo");
+	BenchBeatFormats("stress");
+
+	BenchSampleCache("demo.bmf", "stress.bmf");
+
+	BenchNoteSort("demo.bmf");
+	BenchNoteSort("stress.bmf");
+
+	BenchTransition("demo.bmf", "stress.bmf", NULL);
+	BenchTransition("stress.bmb", "demo.bmb", NULL);
+	BenchTransition("demo.bmb", "demo.bmf", "drop");
+
+	BenchSeek("demo.bmf", "drop");
+	BenchSeek("demo.bmb", "intro");
+	BenchEvents("demo.bmf");
+	BenchTrigger("demo.bmf", "cowbell");
+	BenchOccupancy("demo.bmf");
+	BenchOccupancy("demo.bmb");
+
+	BenchScaleChange("demo.bmf");
+	BenchScaleChange("stress.bmf");
+}
@@ -0,0 +1,47 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef BEATBENCHMARK_H
+#define BEATBENCHMARK_H
+
+#pragma once
+
+#include "pd_api.h"
+
+
+// --------------------------------------------------------------------------------
+// Build with -DBM_BENCHMARK=1 (UDEFS in the Makefile) to run these at start up,
+// results go to the console. Run "make stress" in tools/ first for the stress beat.
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BENCH_REPEAT_COUNT = 5,
+	BENCH_LOAD_LOOP_COUNT = 100,
+	BENCH_FRAME_BUDGET = 2000,			// micro seconds of loading per simulated frame
+	BENCH_TRANSITION_TIMEOUT = 10,		// seconds
+	BENCH_SEEK_COUNT = 3,				// a seek waits up to a bar, 2 s at 120 BPM
+	BENCH_EVENT_SECONDS = 4
+
+} BENCH_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+void BeatBenchmarkRun(PlaydateAPI* playdateApi);
+
+
+#endif
@@ -0,0 +1,322 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "beat_bus.h"
+
+// --------------------------------------------------------------------------------
+
+void* Engine_MemAlloc(int nSize);
+void Engine_MemFree(void* pData);
+
+
+// --------------------------------------------------------------------------------
+// the tap only gets its effect, the send is its userdata and that takes the API
+static PlaydateAPI* pBusApi = NULL;
+
+
+// --------------------------------------------------------------------------------
+static int16_t BeatBusSaturate(int32_t nValue)
+{
+	return nValue > 32767 ? 32767 : (nValue < -32768 ? -32768 : (int16_t)nValue);
+}
+
+
+// --------------------------------------------------------------------------------
+// Hands out what the taps sent since the last call. Anything past nFrameCount
+// moves up for the next one.
+// --------------------------------------------------------------------------------
+static int BeatBusRender(void* pContext, int16_t* pOutLeft, int16_t* pOutRight, int nFrameCount)
+{
+	BeatBus* pBus = pContext;
+
+	if (pBus->nFilled == 0)
+		return 0;
+
+	int nFrames = nFrameCount < pBus->nFilled ? nFrameCount : pBus->nFilled;
+
+	// Q8.24 to 16 bit
+	for (int i = 0; i < nFrames; i++)
+	{
+		pOutLeft[i] = BeatBusSaturate(pBus->nLeft[i] >> 9);
+		pOutRight[i] = BeatBusSaturate(pBus->nRight[i] >> 9);
+	}
+
+	for (int i = nFrames; i < nFrameCount; i++)
+	{
+		pOutLeft[i] = 0;
+		pOutRight[i] = 0;
+	}
+
+	int nLeftOver = pBus->nFilled - nFrames;
+
+	memmove(pBus->nLeft, pBus->nLeft + nFrames, nLeftOver * sizeof(int32_t));
+	memmove(pBus->nRight, pBus->nRight + nFrames, nLeftOver * sizeof(int32_t));
+	memset(pBus->nLeft + nLeftOver, 0, nFrames * sizeof(int32_t));
+	memset(pBus->nRight + nLeftOver, 0, nFrames * sizeof(int32_t));
+
+	pBus->nFilled = nLeftOver;
+
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+// The last effect on a sending track's channel. It adds the channel to the buses
+// and returns 0, it didn't change what the channel plays.
+// --------------------------------------------------------------------------------
+static int32_t BeatBusTap(SoundEffect* pEffect, int32_t* pLeft, int32_t* pRight, int nFrameCount, int bBufferActive)
+{
+	BeatBusSend* pSend = pBusApi->sound->effect->getUserdata(pEffect);
+
+	if (!bBufferActive || pSend == NULL)
+		return 0;
+
+	if (nFrameCount > BM_BUS_MAX_FRAMES)
+		nFrameCount = BM_BUS_MAX_FRAMES;
+
+	if (pRight == NULL)
+		pRight = pLeft;
+
+	for (int b = 0; b < BM_BUS_COUNT; b++)
+	{
+		BeatBus* pBus = pSend->pBuses[b];
+		int32_t nGain = pSend->nGains[b];
+
+		if (pBus == NULL || nGain == 0)
+			continue;
+
+		for (int i = 0; i < nFrameCount; i++)
+		{
+			pBus->nLeft[i] += (int32_t)(((int64_t)pLeft[i] * nGain) >> BM_BUS_GAIN_SHIFT);
+			pBus->nRight[i] += (int32_t)(((int64_t)pRight[i] * nGain) >> BM_BUS_GAIN_SHIFT);
+		}
+
+		if (nFrameCount > pBus->nFilled)
+			pBus->nFilled = nFrameCount;
+	}
+
+	return 0;
+}
+
+
+// --------------------------------------------------------------------------------
+BeatBus* BeatBusCreate(PlaydateAPI* playdateApi, int nKind)
+{
+	PlaydateAPI* pd = playdateApi;
+
+	BeatBus* pBus = Engine_MemAlloc(sizeof(BeatBus));
+	memset(pBus, 0, sizeof(BeatBus));
+
+	pBus->pd = pd;
+	pBus->nKind = nKind;
+
+	pBus->pChannel = pd->sound->channel->newChannel();
+	pBus->pSource = pd->sound->channel->addCallbackSource(pBus->pChannel, BeatBusRender, pBus, 1);
+
+	// a bus returns only what its effect makes of the sends
+	if (nKind == BM_BUS_DELAY)
+	{
+		pBus->pEffect = pd->sound->effect->delayline->newDelayLine(BM_BUS_MAX_DELAY_FRAMES, 1);
+		pd->sound->effect->delayline->setLength(pBus->pEffect, BM_BUS_MAX_DELAY_FRAMES / 4);
+	}
+	else
+	{
+		pBus->pEffect = pd->sound->effect->twopolefilter->newFilter();
+		pd->sound->effect->twopolefilter->setType(pBus->pEffect, kFilterTypeLowPass);
+		pd->sound->effect->twopolefilter->setFrequency(pBus->pEffect, 1000.0f);
+	}
+
+	pd->sound->effect->setMix(pBus->pEffect, 1.0f);
+	pd->sound->channel->addEffect(pBus->pChannel, pBus->pEffect);
+
+	return pBus;
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatBusDestroy(BeatBus* pBus)
+{
+	if (pBus == NULL)
+		return;
+
+	PlaydateAPI* pd = pBus->pd;
+
+	pd->sound->channel->removeEffect(pBus->pChannel, pBus->pEffect);
+
+	if (pBus->nKind == BM_BUS_DELAY)
+		pd->sound->effect->delayline->freeDelayLine(pBus->pEffect);
+	else
+		pd->sound->effect->twopolefilter->freeFilter(pBus->pEffect);
+
+	// a callback source belongs to whoever added it
+	pd->sound->channel->removeSource(pBus->pChannel, pBus->pSource);
+	pd->system->realloc(pBus->pSource, 0);
+
+	pd->sound->channel->freeChannel(pBus->pChannel);
+
+	Engine_MemFree(pBus);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// The line was made at its longest, a new length only moves the read position.
+// --------------------------------------------------------------------------------
+void BeatBusSetDelayLength(BeatBus* pBus, int nFrames)
+{
+	PlaydateAPI* pd = pBus->pd;
+
+	if (pBus->nKind != BM_BUS_DELAY)
+		return;
+
+	if (nFrames < 1)
+		nFrames = 1;
+	else if (nFrames > BM_BUS_MAX_DELAY_FRAMES)
+		nFrames = BM_BUS_MAX_DELAY_FRAMES;
+
+	pd->sound->effect->delayline->setLength(pBus->pEffect, nFrames);
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatBusSetDelay(BeatBus* pBus, int nFrames, float fFeedback)
+{
+	if (pBus->nKind != BM_BUS_DELAY)
+		return;
+
+	BeatBusSetDelayLength(pBus, nFrames);
+	pBus->pd->sound->effect->delayline->setFeedback(pBus->pEffect, fFeedback);
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatBusSetFilter(BeatBus* pBus, int nType, int nFrequency, float fResonance)
+{
+	PlaydateAPI* pd = pBus->pd;
+
+	if (pBus->nKind != BM_BUS_FILTER)
+		return;
+
+	pd->sound->effect->twopolefilter->setType(pBus->pEffect, (TwoPoleFilterType)nType);
+	pd->sound->effect->twopolefilter->setFrequency(pBus->pEffect, nFrequency);
+	pd->sound->effect->twopolefilter->setResonance(pBus->pEffect, fResonance);
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatBusSetReturn(BeatBus* pBus, float fLevel)
+{
+	pBus->pd->sound->channel->setVolume(pBus->pChannel, fLevel);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatBusSendUpdateGains(BeatBusSend* pSend)
+{
+	for (int b = 0; b < BM_BUS_COUNT; b++)
+		pSend->nGains[b] = (int32_t)(pSend->fLevels[b] * pSend->fGain * (1 << BM_BUS_GAIN_SHIFT));
+}
+
+
+// --------------------------------------------------------------------------------
+// The tap is made the first time the track sends anything and kept after that,
+// a level of 0 only stops it adding to that bus.
+// --------------------------------------------------------------------------------
+void BeatBusSendSetLevel(PlaydateAPI* pd, BeatBusSend* pSend, BeatBus* pBus, int nKind, float fLevel)
+{
+	if (nKind < 0 || nKind >= BM_BUS_COUNT)
+		return;
+
+	pBusApi = pd;
+
+	if (pSend->pTap == NULL)
+		pSend->pTap = pd->sound->effect->newEffect(BeatBusTap, pSend);
+
+	pSend->pBuses[nKind] = pBus;
+	pSend->fLevels[nKind] = fLevel;
+	BeatBusSendUpdateGains(pSend);
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatBusSendSetGain(BeatBusSend* pSend, float fGain)
+{
+	pSend->fGain = fGain;
+	BeatBusSendUpdateGains(pSend);
+}
+
+
+// --------------------------------------------------------------------------------
+// Puts the tap at the end of pChannel, after the effects that are on it now.
+// --------------------------------------------------------------------------------
+void BeatBusSendAttach(PlaydateAPI* pd, BeatBusSend* pSend, SoundChannel* pChannel)
+{
+	if (pSend->pTap == NULL)
+		return;
+
+	BeatBusSendDetach(pd, pSend);
+
+	pd->sound->channel->addEffect(pChannel, pSend->pTap);
+	pSend->pChannel = pChannel;
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatBusSendDetach(PlaydateAPI* pd, BeatBusSend* pSend)
+{
+	if (pSend->pChannel == NULL)
+		return;
+
+	pd->sound->channel->removeEffect(pSend->pChannel, pSend->pTap);
+	pSend->pChannel = NULL;
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatBusSendFree(PlaydateAPI* pd, BeatBusSend* pSend)
+{
+	if (pSend->pTap == NULL)
+		return;
+
+	BeatBusSendDetach(pd, pSend);
+	pd->sound->effect->freeEffect(pSend->pTap);
+
+	memset(pSend, 0, sizeof(BeatBusSend));
+
+}
+
+
+// --------------------------------------------------------------------------------
+int BeatBusSendIsActive(const BeatBusSend* pSend)
+{
+	for (int b = 0; b < BM_BUS_COUNT; b++)
+	{
+		if (pSend->pBuses[b] && pSend->fLevels[b] > 0.0f)
+			return 1;
+	}
+
+	return 0;
+}
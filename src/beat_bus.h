@@ -0,0 +1,105 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef BEATBUS_H
+#define BEATBUS_H
+
+#pragma once
+
+#include <stdio.h>
+
+#include "pd_api.h"
+
+
+// --------------------------------------------------------------------------------
+// Shared send effects. A bus is a channel of its own with one effect on it, fed
+// by a callback source from what the tracks send it. A track sends through a tap,
+// an effect at the end of its channel that adds its output at the send level to
+// the buses and leaves the channel as it is. However many tracks send, there is
+// one delay line and one filter.
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BM_BUS_DELAY = 0,
+	BM_BUS_FILTER,
+	BM_BUS_COUNT,
+
+	BM_BUS_MAX_FRAMES = 1024,			// the most an audio callback asks for at once
+	BM_BUS_MAX_DELAY_FRAMES = 44100,	// the delay line is made this long once, a quarter at 60 BPM
+	BM_BUS_GAIN_SHIFT = 16				// send gains are 16.16 fixed point
+
+} BEAT_BUS_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+// The taps add into nLeft/nRight (Q8.24, the format of effect buffers) and the
+// source hands nFilled frames of it out and clears them. The bus channel is made
+// after the track channels so it plays after them, if it doesn't the sends come
+// out one audio block late.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	PlaydateAPI* pd;
+	int nKind;
+
+	SoundChannel* pChannel;
+	SoundSource* pSource;
+	SoundEffect* pEffect;			// a DelayLine or a TwoPoleFilter
+
+	int nFilled;
+	int32_t nLeft[BM_BUS_MAX_FRAMES];
+	int32_t nRight[BM_BUS_MAX_FRAMES];
+
+} BeatBus;
+
+
+// --------------------------------------------------------------------------------
+// What a track sends. The levels are set from the main thread, the tap reads them
+// on the audio thread. fGain follows the track's volume, the sends are post fader.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	SoundEffect* pTap;
+	SoundChannel* pChannel;			// the tap is on it, NULL while it is on none
+
+	BeatBus* pBuses[BM_BUS_COUNT];
+	float fLevels[BM_BUS_COUNT];
+	float fGain;
+	int32_t nGains[BM_BUS_COUNT];	// level times gain, 16.16
+
+} BeatBusSend;
+
+
+// --------------------------------------------------------------------------------
+BeatBus* BeatBusCreate(PlaydateAPI* playdateApi, int nKind);
+void BeatBusDestroy(BeatBus* pBus);
+
+void BeatBusSetDelayLength(BeatBus* pBus, int nFrames);
+void BeatBusSetDelay(BeatBus* pBus, int nFrames, float fFeedback);
+void BeatBusSetFilter(BeatBus* pBus, int nType, int nFrequency, float fResonance);
+void BeatBusSetReturn(BeatBus* pBus, float fLevel);
+
+void BeatBusSendSetLevel(PlaydateAPI* pd, BeatBusSend* pSend, BeatBus* pBus, int nKind, float fLevel);
+void BeatBusSendSetGain(BeatBusSend* pSend, float fGain);
+void BeatBusSendAttach(PlaydateAPI* pd, BeatBusSend* pSend, SoundChannel* pChannel);
+void BeatBusSendDetach(PlaydateAPI* pd, BeatBusSend* pSend);
+void BeatBusSendFree(PlaydateAPI* pd, BeatBusSend* pSend);
+int BeatBusSendIsActive(const BeatBusSend* pSend);
+
+
+#endif
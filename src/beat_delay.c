@@ -0,0 +1,247 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "beat_delay.h"
+
+// --------------------------------------------------------------------------------
+
+void* Engine_MemAlloc(int nSize);
+void Engine_MemFree(void* pData);
+
+
+// --------------------------------------------------------------------------------
+// the effect only gets itself, the line is its userdata and that takes the API
+static PlaydateAPI* pDelayApi = NULL;
+
+
+// --------------------------------------------------------------------------------
+static int16_t BeatDelaySaturate(int32_t nValue)
+{
+	return nValue > 32767 ? 32767 : (nValue < -32768 ? -32768 : (int16_t)nValue);
+}
+
+
+// --------------------------------------------------------------------------------
+// The same echo as the freeze renders: what comes back is fed in again at the
+// feedback level and mixed with the input. The buffers are Q8.24, the line keeps
+// the top 16 bits. A mono line gets the same left and right, so it works out the
+// left side and copies it.
+// --------------------------------------------------------------------------------
+static int32_t BeatDelayProcess(SoundEffect* pEffect, int32_t* pLeft, int32_t* pRight, int nFrameCount, int bBufferActive)
+{
+	BeatDelayLine* pLine = pDelayApi->sound->effect->getUserdata(pEffect);
+
+	// nothing coming in and nothing left in the line
+	if (!pLine->bInUse || (!bBufferActive && pLine->nQuietFrames >= pLine->nLength))
+		return 0;
+
+	int nStride = pLine->nChannels;
+	int nChannels = pRight ? nStride : 1;
+	int nLength = pLine->nLength;
+	int nPosition = pLine->nPosition;
+
+	for (int i = 0; i < nFrameCount; i++)
+	{
+		int16_t* pTap = &pLine->pFrames[nPosition * nStride];
+		int bQuiet = 1;
+
+		for (int c = 0; c < nChannels; c++)
+		{
+			int32_t* pBuffer = c ? pRight : pLeft;
+
+			int32_t x = bBufferActive ? pBuffer[i] : 0;
+			int32_t y = (int32_t)pTap[c] << 9;
+
+			int16_t nWritten = BeatDelaySaturate((x + (int32_t)(((int64_t)y * pLine->nFeedback) >> BM_DELAY_GAIN_SHIFT)) >> 9);
+			pTap[c] = nWritten;
+			bQuiet &= nWritten == 0;
+
+			pBuffer[i] = (int32_t)(((int64_t)x * pLine->nDry + (int64_t)y * pLine->nWet) >> BM_DELAY_GAIN_SHIFT);
+		}
+
+		if (pRight && nChannels == 1)
+			pRight[i] = pLeft[i];
+
+		pLine->nQuietFrames = bQuiet ? pLine->nQuietFrames + 1 : 0;
+
+		if (++nPosition >= nLength)
+			nPosition = 0;
+	}
+
+	pLine->nPosition = nPosition;
+
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+// The lines have no frames until they are first acquired.
+// --------------------------------------------------------------------------------
+BeatDelayPool* BeatDelayPoolCreate(PlaydateAPI* playdateApi, int nLines)
+{
+	PlaydateAPI* pd = playdateApi;
+
+	if (nLines > BM_DELAY_MAX_LINES)
+		nLines = BM_DELAY_MAX_LINES;
+
+	BeatDelayPool* pPool = Engine_MemAlloc(sizeof(BeatDelayPool));
+	memset(pPool, 0, sizeof(BeatDelayPool));
+
+	pDelayApi = pd;
+
+	pPool->pd = pd;
+	pPool->nLineCount = nLines;
+
+	for (int i = 0; i < nLines; i++)
+	{
+		BeatDelayLine* pLine = &pPool->lines[i];
+		pLine->pEffect = pd->sound->effect->newEffect(BeatDelayProcess, pLine);
+	}
+
+	return pPool;
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatDelayPoolDestroy(BeatDelayPool* pPool)
+{
+	if (pPool == NULL)
+		return;
+
+	for (int i = 0; i < pPool->nLineCount; i++)
+	{
+		pPool->pd->sound->effect->freeEffect(pPool->lines[i].pEffect);
+		Engine_MemFree(pPool->lines[i].pFrames);
+	}
+
+	Engine_MemFree(pPool);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// A free line of nChannels that holds at least nMaxFrames, silent and one frame
+// long until it gets a length. The smallest free line that is long enough, else
+// the longest free one grows, the only time the pool allocates. NULL when all of
+// them are taken.
+// --------------------------------------------------------------------------------
+BeatDelayLine* BeatDelayPoolAcquire(BeatDelayPool* pPool, int nMaxFrames, int nChannels)
+{
+	int nSamples = nMaxFrames * nChannels;
+
+	BeatDelayLine* pFit = NULL;
+	BeatDelayLine* pLongest = NULL;
+
+	for (int i = 0; i < pPool->nLineCount; i++)
+	{
+		BeatDelayLine* pLine = &pPool->lines[i];
+		if (pLine->bInUse)
+			continue;
+
+		if (pLine->nCapacity >= nSamples && (pFit == NULL || pLine->nCapacity < pFit->nCapacity))
+			pFit = pLine;
+
+		if (pLongest == NULL || pLine->nCapacity > pLongest->nCapacity)
+			pLongest = pLine;
+	}
+
+	if (pFit == NULL && pLongest == NULL)
+	{
+		pPool->nDenied++;
+		return NULL;
+	}
+
+	if (pFit == NULL)
+	{
+		pFit = pLongest;
+
+		Engine_MemFree(pFit->pFrames);
+		pFit->pFrames = Engine_MemAlloc(nSamples * sizeof(int16_t));
+
+		pPool->nBytes += (nSamples - pFit->nCapacity) * (int)sizeof(int16_t);
+		pFit->nCapacity = nSamples;
+	}
+
+	memset(pFit->pFrames, 0, pFit->nCapacity * sizeof(int16_t));
+
+	pFit->nChannels = nChannels;
+	pFit->nLength = 1;
+	pFit->nPosition = 0;
+	pFit->nQuietFrames = 0;
+	pFit->nFeedback = 0;
+	pFit->nWet = 0;
+	pFit->nDry = 1 << BM_DELAY_GAIN_SHIFT;
+	pFit->bInUse = 1;
+
+	return pFit;
+}
+
+
+// --------------------------------------------------------------------------------
+// A line that is not one of the pool's is left alone.
+// --------------------------------------------------------------------------------
+void BeatDelayPoolRelease(BeatDelayPool* pPool, BeatDelayLine* pLine)
+{
+	if (pPool == NULL || pLine < pPool->lines || pLine >= pPool->lines + pPool->nLineCount)
+		return;
+
+	pLine->bInUse = 0;
+
+}
+
+
+// --------------------------------------------------------------------------------
+int BeatDelayMaxFrames(const BeatDelayLine* pLine)
+{
+	return pLine->nCapacity / pLine->nChannels;
+}
+
+
+// --------------------------------------------------------------------------------
+// Clamped to the line. Frames a longer line takes back in are cleared, they
+// still hold echoes from before.
+// --------------------------------------------------------------------------------
+void BeatDelaySetLength(BeatDelayLine* pLine, int nFrames)
+{
+	int nMaxFrames = BeatDelayMaxFrames(pLine);
+
+	if (nFrames < 1)
+		nFrames = 1;
+	else if (nFrames > nMaxFrames)
+		nFrames = nMaxFrames;
+
+	if (nFrames > pLine->nLength)
+		memset(pLine->pFrames + pLine->nLength * pLine->nChannels, 0, (nFrames - pLine->nLength) * pLine->nChannels * sizeof(int16_t));
+
+	if (pLine->nPosition >= nFrames)
+		pLine->nPosition = 0;
+
+	pLine->nLength = nFrames;
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatDelaySetLevels(BeatDelayLine* pLine, float fFeedback, float fMix)
+{
+	pLine->nFeedback = (int32_t)(fFeedback * (1 << BM_DELAY_GAIN_SHIFT));
+	pLine->nWet = (int32_t)(fMix * (1 << BM_DELAY_GAIN_SHIFT));
+	pLine->nDry = (int32_t)((1.0f - fMix) * (1 << BM_DELAY_GAIN_SHIFT));
+}
@@ -0,0 +1,101 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef BEATDELAY_H
+#define BEATDELAY_H
+
+#pragma once
+
+#include <stdio.h>
+
+#include "pd_api.h"
+
+
+// --------------------------------------------------------------------------------
+// Delay times are steps of the beat, four to a beat. A line is made long enough
+// for its track's time at the slowest tempo, so a new tempo only moves where the
+// line reads back.
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BM_DELAY_SIXTEENTH = 1,
+	BM_DELAY_EIGHTH = 2,
+	BM_DELAY_DOTTED_EIGHTH = 3,
+	BM_DELAY_QUARTER = 4,
+
+	BM_DELAY_MAX_STEPS = BM_DELAY_QUARTER,
+	BM_DELAY_MIN_BPM = 60,				// slower than this the echoes come early
+	BM_DELAY_DEFAULT_LINES = 4,
+	BM_DELAY_MAX_LINES = 32,
+	BM_DELAY_GAIN_SHIFT = 16			// feedback and mix are 16.16 fixed point
+
+} BEAT_DELAY_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+// One echo on a track's channel, a custom effect reading and writing its frames.
+// They are 16 bit, stereo or mono for a channel that only gets mono sources, which
+// echoes the left side into both. nQuietFrames counts the silence written in a
+// row, once the whole line is silent it stops until there is input.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	SoundEffect* pEffect;
+	int16_t* pFrames;
+	int nCapacity;					// samples in pFrames, kept when the line is released
+	int nChannels;
+	int bInUse;
+
+	int nLength;
+	int nPosition;
+	int nQuietFrames;
+
+	int32_t nFeedback;
+	int32_t nWet;
+	int32_t nDry;
+
+} BeatDelayLine;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	PlaydateAPI* pd;
+
+	int nLineCount;
+	int nBytes;						// the frames of all lines, they grow but never shrink
+
+	BeatDelayLine lines[BM_DELAY_MAX_LINES];
+	int nDenied;					// tracks that asked for a line when none was left
+
+} BeatDelayPool;
+
+
+// --------------------------------------------------------------------------------
+BeatDelayPool* BeatDelayPoolCreate(PlaydateAPI* playdateApi, int nLines);
+void BeatDelayPoolDestroy(BeatDelayPool* pPool);
+
+BeatDelayLine* BeatDelayPoolAcquire(BeatDelayPool* pPool, int nMaxFrames, int nChannels);
+void BeatDelayPoolRelease(BeatDelayPool* pPool, BeatDelayLine* pLine);
+
+int BeatDelayMaxFrames(const BeatDelayLine* pLine);
+void BeatDelaySetLength(BeatDelayLine* pLine, int nFrames);
+void BeatDelaySetLevels(BeatDelayLine* pLine, float fFeedback, float fMix);
+
+
+#endif
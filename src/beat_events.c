@@ -0,0 +1,145 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "beat_events.h"
+
+
+// --------------------------------------------------------------------------------
+void BeatEventBusReset(BeatEventBus* pBus)
+{
+	memset(pBus, 0, sizeof(BeatEventBus));
+}
+
+
+// --------------------------------------------------------------------------------
+// Returns the id to unsubscribe with, -1 when every slot is taken.
+// --------------------------------------------------------------------------------
+int BeatEventBusSubscribe(BeatEventBus* pBus, int nMask, BeatEventCallback* pfnCallback, void* pUserdata)
+{
+	if (pfnCallback == NULL || (nMask & BM_EVENT_ALL) == 0)
+		return -1;
+
+	for (int i = 0; i < BM_EVENT_MAX_SUBSCRIBERS; i++)
+	{
+		BeatEventSubscriber* pSubscriber = &pBus->subscribers[i];
+		if (pSubscriber->pfnCallback)
+			continue;
+
+		pSubscriber->nMask = nMask & BM_EVENT_ALL;
+		pSubscriber->pfnCallback = pfnCallback;
+		pSubscriber->pUserdata = pUserdata;
+
+		pBus->nSubscriberMask |= pSubscriber->nMask;
+
+		return i;
+	}
+
+	return -1;
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatEventBusUnsubscribe(BeatEventBus* pBus, int nId)
+{
+	if (nId < 0 || nId >= BM_EVENT_MAX_SUBSCRIBERS)
+		return;
+
+	memset(&pBus->subscribers[nId], 0, sizeof(BeatEventSubscriber));
+
+	pBus->nSubscriberMask = 0;
+	for (int i = 0; i < BM_EVENT_MAX_SUBSCRIBERS; i++)
+		pBus->nSubscriberMask |= pBus->subscribers[i].nMask;
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Audio side. A full ring drops the step rather than wait for the main loop.
+// --------------------------------------------------------------------------------
+int BeatEventBusPush(BeatEventBus* pBus, int nTypes, int nStep, uint32_t nTime, int nLabel)
+{
+	uint32_t nWrite = pBus->nWrite;
+
+	if (nWrite - pBus->nRead >= BM_EVENT_RING_SIZE)
+	{
+		pBus->nDropped++;
+		return 0;
+	}
+
+	BeatEventEntry* pEntry = &pBus->ring[nWrite & (BM_EVENT_RING_SIZE - 1)];
+	pEntry->nTime = nTime;
+	pEntry->nStep = (int16_t)nStep;
+	pEntry->nTypes = (uint8_t)nTypes;
+	pEntry->nLabel = (int8_t)nLabel;
+
+	pBus->nWrite = nWrite + 1;
+
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+// Main loop side, returns 0 when the ring is empty.
+// --------------------------------------------------------------------------------
+int BeatEventBusPop(BeatEventBus* pBus, int* pTypes, int* pStep, uint32_t* pTime, int* pLabel)
+{
+	uint32_t nRead = pBus->nRead;
+
+	if (nRead == pBus->nWrite)
+		return 0;
+
+	BeatEventEntry* pEntry = &pBus->ring[nRead & (BM_EVENT_RING_SIZE - 1)];
+	*pTime = pEntry->nTime;
+	*pStep = pEntry->nStep;
+	*pTypes = pEntry->nTypes;
+	*pLabel = pEntry->nLabel;
+
+	pBus->nRead = nRead + 1;
+
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+// Calls the subscribers once per type of the step, from the step up to the loop.
+// --------------------------------------------------------------------------------
+void BeatEventBusDispatch(BeatEventBus* pBus, int nTypes, int nStep, uint32_t nTime, const char* szLabel)
+{
+	BeatEvent event;
+	event.nStep = nStep;
+	event.nTime = nTime;
+	event.szLabel = szLabel;
+
+	for (int nType = BM_EVENT_STEP; nType <= BM_EVENT_LOOP; nType <<= 1)
+	{
+		if ((nTypes & nType) == 0)
+			continue;
+
+		event.nType = nType;
+
+		for (int i = 0; i < BM_EVENT_MAX_SUBSCRIBERS; i++)
+		{
+			BeatEventSubscriber* pSubscriber = &pBus->subscribers[i];
+			if (pSubscriber->pfnCallback && (pSubscriber->nMask & nType))
+				pSubscriber->pfnCallback(&event, pSubscriber->pUserdata);
+		}
+	}
+
+}
@@ -0,0 +1,118 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+
+#ifndef BEATEVENTS_H
+#define BEATEVENTS_H
+
+#pragma once
+
+#include <stdio.h>
+
+#include "pd_api.h"
+
+
+// --------------------------------------------------------------------------------
+// Events of the playing beat. The audio side puts one entry per step into a ring,
+// the main loop takes them out once per frame and calls whoever subscribed.
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BM_EVENT_STEP = 1 << 0,
+	BM_EVENT_BEAT = 1 << 1,
+	BM_EVENT_BAR = 1 << 2,
+	BM_EVENT_LABEL = 1 << 3,
+	BM_EVENT_LOOP = 1 << 4,			// the sequence wrapped from the end of its loop region to the start
+	BM_EVENT_ALL = (1 << 5) - 1,
+
+	BM_EVENT_RING_SIZE = 64,		// a power of two, a second of steps at 480 BPM
+	BM_EVENT_MAX_SUBSCRIBERS = 8,
+	BM_EVENT_NO_LABEL = -1
+
+} BEAT_EVENT_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+// What a subscriber is called with, one call per event type of a step.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int nType;						// one BM_EVENT_ bit
+	int nStep;
+
+	uint32_t nTime;					// pd->sound->getCurrentTime() the step started on
+	const char* szLabel;			// label on the step, NULL when there is none
+
+} BeatEvent;
+
+
+// --------------------------------------------------------------------------------
+typedef void BeatEventCallback(const BeatEvent* pEvent, void* pUserdata);
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int nMask;
+	BeatEventCallback* pfnCallback;
+	void* pUserdata;
+
+} BeatEventSubscriber;
+
+
+// --------------------------------------------------------------------------------
+// Single producer, single consumer. The audio callback only writes nWrite and the
+// entries, the main loop only writes nRead. Both run on the one core, so volatile
+// is all it takes to keep an entry written before it is published.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	volatile uint32_t nTime;
+	volatile int16_t nStep;
+	volatile uint8_t nTypes;
+	volatile int8_t nLabel;
+
+} BeatEventEntry;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	BeatEventEntry ring[BM_EVENT_RING_SIZE];
+	volatile uint32_t nWrite;
+	volatile uint32_t nRead;
+	volatile uint32_t nDropped;		// steps that found the ring full
+
+	BeatEventSubscriber subscribers[BM_EVENT_MAX_SUBSCRIBERS];
+	int nSubscriberMask;			// all event types someone wants
+
+} BeatEventBus;
+
+
+// --------------------------------------------------------------------------------
+void BeatEventBusReset(BeatEventBus* pBus);
+
+int BeatEventBusSubscribe(BeatEventBus* pBus, int nMask, BeatEventCallback* pfnCallback, void* pUserdata);
+void BeatEventBusUnsubscribe(BeatEventBus* pBus, int nId);
+
+int BeatEventBusPush(BeatEventBus* pBus, int nTypes, int nStep, uint32_t nTime, int nLabel);
+int BeatEventBusPop(BeatEventBus* pBus, int* pTypes, int* pStep, uint32_t* pTime, int* pLabel);
+void BeatEventBusDispatch(BeatEventBus* pBus, int nTypes, int nStep, uint32_t nTime, const char* szLabel);
+
+
+#endif
@@ -0,0 +1,144 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef BEATFORMAT_H
+#define BEATFORMAT_H
+
+#pragma once
+
+// Compiled beat file (.bmb) layout. This header is shared by the player and
+// the host-side compiler in tools/, so it must not depend on pd_api.h.
+//
+//	BMBHeader
+//	BMBTrack	[nTrackCount]
+//	BMBLabel	[nLabelCount]
+//	BMBNote		[nNoteCount]	notes of each track are stored together, sorted by step
+//
+// Everything after the header is nDataSize bytes, so a loader needs exactly
+// two reads. All values are little endian, same as the device and the PC.
+
+#include <stdint.h>
+
+
+// --------------------------------------------------------------------------------
+#define BMB_MAGIC			0x31424D42		// "BMB1"
+#define BMB_VERSION			2
+
+#define BMB_NAME_SIZE		16
+#define BMB_SAMPLE_SIZE		48
+#define BMB_SCALE_SIZE		24
+#define BMB_BASE_NOTE_SIZE	4
+#define BMB_HARMONIC_COUNT	16
+
+
+// --------------------------------------------------------------------------------
+// nSoundSource uses the same order as BM_TYPE_* / szSoundSrcType in beat_machine.c
+typedef struct
+{
+	uint32_t nMagic;
+	uint16_t nVersion;
+	uint16_t nFileVersion;			// "ver" of the source .bmf
+
+	uint16_t nBPM;
+	uint16_t nBeatLength;
+
+	uint8_t nTrackCount;
+	uint8_t nLabelCount;
+	uint8_t bLoopOn;
+	uint8_t nReserved;
+
+	uint16_t nLoopStart;
+	uint16_t nLoopEnd;
+
+	uint32_t nNoteCount;
+	uint32_t nDataSize;
+
+	char szScale[BMB_SCALE_SIZE];
+	char szBaseNote[BMB_BASE_NOTE_SIZE];
+
+} BMBHeader;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	uint8_t nId;
+	uint8_t nSoundSource;
+	uint8_t nColour;
+	uint8_t bMuted;
+
+	uint8_t bIsChordTrack;
+	uint8_t bHasEnvelope;
+	uint8_t bFilterEnabled;
+	uint8_t bDelayEnabled;
+
+	uint8_t bBitCrusherEnabled;
+	uint8_t nFilterType;
+	uint16_t nFilterFreq;
+
+	char szTrackName[BMB_NAME_SIZE];
+	char szSampleName[BMB_SAMPLE_SIZE];
+
+	// the "harmonics" of a wavetable track, 255 is 1.0, all 0 when it has none
+	uint8_t nHarmonics[BMB_HARMONIC_COUNT];
+
+	float fVolume;
+	float fPanning;
+
+	float fAttack;
+	float fDecay;
+	float fSustain;
+	float fRelease;
+
+	float fFilterResn;
+	float fFilterMix;
+
+	float fDelayFeedback;
+	float fDelayMix;
+
+	float fBitcrusherAmount;
+	float fBitcrusherMix;
+
+	uint32_t nFirstNote;
+	uint32_t nNoteCount;
+
+} BMBTrack;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	uint16_t nStep;
+	uint16_t nReserved;				// keeps the note array 4 byte aligned
+	char szText[BMB_NAME_SIZE];
+
+} BMBLabel;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	uint16_t nStep;
+	uint8_t nPitch;
+	uint8_t nLen;
+	float fVelocity;
+
+} BMBNote;
+
+
+#endif
@@ -0,0 +1,527 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <string.h>
+#include <math.h>
+
+#include "beat_freeze.h"
+
+
+// --------------------------------------------------------------------------------
+void* Engine_MemAlloc(int nSize);
+void Engine_MemFree(void* pData);
+
+
+// --------------------------------------------------------------------------------
+#define BM_FREEZE_TWO_PI	6.28318531f
+
+
+// --------------------------------------------------------------------------------
+// Frames the sample of a note needs: the note, its release and, with a delay on
+// the track, the echoes until they are down by 60 dB.
+// --------------------------------------------------------------------------------
+static int BeatFreezeKeyFrames(const BeatFreezeVoice* pVoice, int nLen, float fFramesPerStep, float* pVoiceSeconds)
+{
+	int nHold = (int)(nLen * fFramesPerStep + 0.5f);
+	int nRelease = (int)(pVoice->fRelease * BM_FREEZE_SAMPLE_RATE);
+
+	*pVoiceSeconds = (float)(nHold + nRelease) / BM_FREEZE_SAMPLE_RATE;
+
+	int nTail = 0;
+	if (pVoice->bDelay && pVoice->nDelayFrames > 0)
+	{
+		int nRepeats = 1;
+		if (pVoice->fDelayFeedback >= 1.0f)
+			nRepeats = BM_FREEZE_MAX_TAIL;
+		else if (pVoice->fDelayFeedback > 0.0f)
+			nRepeats = (int)ceilf(logf(0.001f) / logf(pVoice->fDelayFeedback));
+
+		nTail = (nRepeats > BM_FREEZE_MAX_TAIL / pVoice->nDelayFrames) ? BM_FREEZE_MAX_TAIL : nRepeats * pVoice->nDelayFrames;
+	}
+
+	int nFrames = nHold + nRelease + nTail;
+
+	return nFrames > 0 ? nFrames : 1;
+}
+
+
+// --------------------------------------------------------------------------------
+// Walks the events of the track and gives every one its key. pNotes and pNoteKeys
+// may be NULL when only the cost is wanted.
+// --------------------------------------------------------------------------------
+static int BeatFreezeCollect(PlaydateAPI* pd, SequenceTrack* pTrack, const BeatFreezeVoice* pVoice, float fFramesPerStep, BeatFreezeKey* pKeys, BMBNote* pNotes, uint8_t* pNoteKeys, BeatFreezeCost* pCost)
+{
+	memset(pCost, 0, sizeof(BeatFreezeCost));
+
+	switch (pVoice->nWaveform)
+	{
+	case kWaveformSine:
+	case kWaveformSquare:
+	case kWaveformSawtooth:
+	case kWaveformTriangle:
+	case kWaveformNoise:
+		break;
+
+	default:
+		return BM_FREEZE_UNSUPPORTED;
+	}
+
+	pCost->nLiveEffects = (pVoice->bFilter ? 1 : 0) + (pVoice->bCrusher ? 1 : 0) + (pVoice->bDelay ? 1 : 0);
+
+	uint32_t nStep;
+	uint32_t nLen;
+	MIDINote fNote;
+	float fVelocity;
+
+	for (int i = 0; pd->sound->track->getNoteAtIndex(pTrack, i, &nStep, &nLen, &fNote, &fVelocity); i++)
+	{
+		uint8_t nPitch = (uint8_t)(fNote + 0.5f);
+		uint8_t nNoteLen = (uint8_t)(nLen > 255 ? 255 : nLen);
+
+		int nKey = 0;
+		while (nKey < pCost->nKeyCount && (pKeys[nKey].nPitch != nPitch || pKeys[nKey].nLen != nNoteLen || pKeys[nKey].fVelocity != fVelocity))
+			nKey++;
+
+		float fSeconds = 0.0f;
+		int nFrames = BeatFreezeKeyFrames(pVoice, nNoteLen, fFramesPerStep, &fSeconds);
+
+		if (nKey == pCost->nKeyCount)
+		{
+			if (nKey == BM_FREEZE_MAX_KEYS)
+				return BM_FREEZE_TOO_MANY_KEYS;
+
+			BeatFreezeKey* pKey = &pKeys[nKey];
+			pKey->nPitch = nPitch;
+			pKey->nLen = nNoteLen;
+			pKey->fVelocity = fVelocity;
+			pKey->nFrames = nFrames;
+			pKey->nEventLen = (int)ceilf(nFrames / fFramesPerStep);
+
+			pCost->nKeyCount++;
+			pCost->nSampleBytes += nFrames * (int)sizeof(int16_t);
+
+			if (pCost->nSampleBytes > BM_FREEZE_MAX_BYTES)
+				return BM_FREEZE_TOO_BIG;
+		}
+
+		if (pNotes)
+		{
+			pNotes[i].nStep = (uint16_t)nStep;
+			pNotes[i].nPitch = nPitch;
+			pNotes[i].nLen = nNoteLen;
+			pNotes[i].fVelocity = fVelocity;
+			pNoteKeys[i] = (uint8_t)nKey;
+		}
+
+		pCost->fVoiceSeconds += fSeconds;
+		pCost->nNoteCount++;
+	}
+
+	return BM_FREEZE_OK;
+}
+
+
+// --------------------------------------------------------------------------------
+int BeatFreezeMeasure(PlaydateAPI* pd, SequenceTrack* pTrack, const BeatFreezeVoice* pVoice, float fFramesPerStep, BeatFreezeCost* pCost)
+{
+	BeatFreezeKey keys[BM_FREEZE_MAX_KEYS];
+
+	return BeatFreezeCollect(pd, pTrack, pVoice, fFramesPerStep, keys, NULL, NULL, pCost);
+}
+
+
+// --------------------------------------------------------------------------------
+// RBJ cookbook biquads, resonance 0 - 1 taken as a Q of 0.7 - 10. The shelves and
+// the peak filter have no gain set on a track, they let everything through.
+// --------------------------------------------------------------------------------
+static void BeatFreezeSetupFilter(const BeatFreezeVoice* pVoice, BeatFreezeFilter* pFilter)
+{
+	float fFrequency = pVoice->fFilterFrequency;
+	if (fFrequency < 10.0f)
+		fFrequency = 10.0f;
+	if (fFrequency > BM_FREEZE_SAMPLE_RATE * 0.45f)
+		fFrequency = BM_FREEZE_SAMPLE_RATE * 0.45f;
+
+	float fQ = 0.707f + pVoice->fFilterResonance * 9.3f;
+	float w = BM_FREEZE_TWO_PI * fFrequency / BM_FREEZE_SAMPLE_RATE;
+	float fAlpha = sinf(w) / (2.0f * fQ);
+	float fCos = cosf(w);
+
+	float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a0 = 1.0f, a1 = 0.0f, a2 = 0.0f;
+
+	switch (pVoice->nFilterType)
+	{
+	case kFilterTypeLowPass:
+		b0 = (1.0f - fCos) / 2.0f;	b1 = 1.0f - fCos;	b2 = b0;
+		a0 = 1.0f + fAlpha;	a1 = -2.0f * fCos;	a2 = 1.0f - fAlpha;
+		break;
+
+	case kFilterTypeHighPass:
+		b0 = (1.0f + fCos) / 2.0f;	b1 = -(1.0f + fCos);	b2 = b0;
+		a0 = 1.0f + fAlpha;	a1 = -2.0f * fCos;	a2 = 1.0f - fAlpha;
+		break;
+
+	case kFilterTypeBandPass:
+		b0 = fAlpha;	b1 = 0.0f;	b2 = -fAlpha;
+		a0 = 1.0f + fAlpha;	a1 = -2.0f * fCos;	a2 = 1.0f - fAlpha;
+		break;
+
+	case kFilterTypeNotch:
+		b0 = 1.0f;	b1 = -2.0f * fCos;	b2 = 1.0f;
+		a0 = 1.0f + fAlpha;	a1 = -2.0f * fCos;	a2 = 1.0f - fAlpha;
+		break;
+	}
+
+	pFilter->b0 = b0 / a0;
+	pFilter->b1 = b1 / a0;
+	pFilter->b2 = b2 / a0;
+	pFilter->a1 = a1 / a0;
+	pFilter->a2 = a2 / a0;
+
+}
+
+
+// --------------------------------------------------------------------------------
+// One note through the same oscillator, linear ADSR and effects the live track
+// has, into 16 bit mono. pDelay is scratch for the delay line.
+// --------------------------------------------------------------------------------
+static void BeatFreezeRenderKey(const BeatFreezeVoice* pVoice, const BeatFreezeFilter* pFilter, float* pDelay, const BeatFreezeKey* pKey, float fFramesPerStep, uint32_t nSeed, int16_t* pOut)
+{
+	const float fRate = (float)BM_FREEZE_SAMPLE_RATE;
+
+	float fPhase = 0.0f;
+	float fPhaseStep = 440.0f * powf(2.0f, (pKey->nPitch - 69.0f) / 12.0f) / fRate;
+	uint32_t nNoise = nSeed;
+
+	float fAttackRate = pVoice->fAttack > 0.0f ? 1.0f / (pVoice->fAttack * fRate) : 1.0f;
+	float fDecayRate = pVoice->fDecay > 0.0f ? (1.0f - pVoice->fSustain) / (pVoice->fDecay * fRate) : 1.0f;
+	float fReleaseRate = 0.0f;
+
+	int nHold = (int)(pKey->nLen * fFramesPerStep + 0.5f);
+	int nStage = 0;					// attack, decay, sustain, release, done
+	float fLevel = 0.0f;
+
+	float x1 = 0.0f, x2 = 0.0f, y1 = 0.0f, y2 = 0.0f;
+	float fCrushSteps = powf(2.0f, 16.0f * (1.0f - pVoice->fCrusherAmount));
+
+	int nDelayPos = 0;
+	if (pVoice->bDelay)
+		memset(pDelay, 0, pVoice->nDelayFrames * sizeof(float));
+
+	for (int i = 0; i < pKey->nFrames; i++)
+	{
+		if (i == nHold && nStage < 3)
+		{
+			fReleaseRate = pVoice->fRelease > 0.0f ? fLevel / (pVoice->fRelease * fRate) : fLevel;
+			nStage = 3;
+		}
+
+		switch (nStage)
+		{
+		case 0:
+			fLevel += fAttackRate;
+			if (fLevel >= 1.0f)
+			{
+				fLevel = 1.0f;
+				nStage = 1;
+			}
+			break;
+
+		case 1:
+			fLevel -= fDecayRate;
+			if (fLevel <= pVoice->fSustain)
+			{
+				fLevel = pVoice->fSustain;
+				nStage = 2;
+			}
+			break;
+
+		case 3:
+			fLevel -= fReleaseRate;
+			if (fLevel <= 0.0f)
+			{
+				fLevel = 0.0f;
+				nStage = 4;
+			}
+			break;
+		}
+
+		float x = 0.0f;
+
+		if (nStage != 4)
+		{
+			float p = fPhase;
+			float fValue;
+
+			switch (pVoice->nWaveform)
+			{
+			case kWaveformSquare:	fValue = p < 0.5f ? 1.0f : -1.0f;						break;
+			case kWaveformTriangle:	fValue = p < 0.5f ? 4.0f * p - 1.0f : 3.0f - 4.0f * p;	break;
+			case kWaveformSawtooth:	fValue = 2.0f * p - 1.0f;								break;
+
+			case kWaveformNoise:
+				nNoise ^= nNoise << 13;
+				nNoise ^= nNoise >> 17;
+				nNoise ^= nNoise << 5;
+				fValue = (int32_t)nNoise / 2147483648.0f;
+				break;
+
+			default:
+				fValue = sinf(BM_FREEZE_TWO_PI * p);
+				break;
+			}
+
+			fPhase += fPhaseStep;
+			if (fPhase >= 1.0f)
+				fPhase -= 1.0f;
+
+			x = fValue * fLevel * pKey->fVelocity;
+		}
+
+		if (pVoice->bFilter)
+		{
+			float y = pFilter->b0 * x + pFilter->b1 * x1 + pFilter->b2 * x2 - pFilter->a1 * y1 - pFilter->a2 * y2;
+			x2 = x1;
+			x1 = x;
+			y2 = y1;
+			y1 = y;
+
+			x = x * (1.0f - pVoice->fFilterMix) + y * pVoice->fFilterMix;
+		}
+
+		if (pVoice->bCrusher)
+		{
+			float y = floorf(x * fCrushSteps) / fCrushSteps;
+			x = x * (1.0f - pVoice->fCrusherMix) + y * pVoice->fCrusherMix;
+		}
+
+		if (pVoice->bDelay)
+		{
+			float y = pDelay[nDelayPos];
+			pDelay[nDelayPos] = x + y * pVoice->fDelayFeedback;
+			if (++nDelayPos == pVoice->nDelayFrames)
+				nDelayPos = 0;
+
+			x = x * (1.0f - pVoice->fDelayMix) + y * pVoice->fDelayMix;
+		}
+
+		int nValue = (int)(x * 32767.0f);
+		pOut[i] = (int16_t)(nValue > 32767 ? 32767 : (nValue < -32768 ? -32768 : nValue));
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatFreezeFree(BeatFreeze* pFreeze)
+{
+	if (pFreeze == NULL)
+		return;
+
+	PlaydateAPI* pd = pFreeze->pd;
+
+	if (pFreeze->pChannel)
+	{
+		pd->sound->channel->removeSource(pFreeze->pChannel, (SoundSource*)pFreeze->pInstrument);
+		pd->sound->channel->freeChannel(pFreeze->pChannel);
+	}
+
+	for (int i = 0; i < pFreeze->cost.nKeyCount; i++)
+	{
+		if (pFreeze->pVoices[i])
+			pd->sound->synth->freeSynth(pFreeze->pVoices[i]);
+
+		if (pFreeze->pSamples[i])
+			pd->sound->sample->freeSample(pFreeze->pSamples[i]);
+
+		if (pFreeze->pSampleData[i])
+			Engine_MemFree(pFreeze->pSampleData[i]);
+	}
+
+	if (pFreeze->pInstrument)
+		pd->sound->instrument->freeInstrument(pFreeze->pInstrument);
+
+	if (pFreeze->pNotes)
+		Engine_MemFree(pFreeze->pNotes);
+
+	if (pFreeze->pNoteKeys)
+		Engine_MemFree(pFreeze->pNoteKeys);
+
+	Engine_MemFree(pFreeze);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Collects the keys of the track without rendering any, BeatFreezeRenderKeys()
+// does that a few at a time. Returns NULL with the reason in *pError when the track
+// can't be frozen, or with BM_FREEZE_OK when it has no notes.
+// --------------------------------------------------------------------------------
+BeatFreeze* BeatFreezeBegin(PlaydateAPI* pd, SequenceTrack* pTrack, const BeatFreezeVoice* pVoice, float fFramesPerStep, int* pError)
+{
+	BeatFreeze* pFreeze = Engine_MemAlloc(sizeof(BeatFreeze));
+	memset(pFreeze, 0, sizeof(BeatFreeze));
+	pFreeze->pd = pd;
+
+	// once to size the note list, once to fill it
+	int nError = BeatFreezeCollect(pd, pTrack, pVoice, fFramesPerStep, pFreeze->keys, NULL, NULL, &pFreeze->cost);
+	*pError = nError;
+
+	if (nError != BM_FREEZE_OK || pFreeze->cost.nNoteCount == 0)
+	{
+		Engine_MemFree(pFreeze);
+		return NULL;
+	}
+
+	int nNoteCount = pFreeze->cost.nNoteCount;
+	pFreeze->pNotes = Engine_MemAlloc(nNoteCount * sizeof(BMBNote));
+	pFreeze->pNoteKeys = Engine_MemAlloc(nNoteCount);
+
+	BeatFreezeCollect(pd, pTrack, pVoice, fFramesPerStep, pFreeze->keys, pFreeze->pNotes, pFreeze->pNoteKeys, &pFreeze->cost);
+
+	pFreeze->voice = *pVoice;
+	pFreeze->fFramesPerStep = fFramesPerStep;
+	BeatFreezeSetupFilter(pVoice, &pFreeze->filter);
+
+	return pFreeze;
+}
+
+
+// --------------------------------------------------------------------------------
+// Renders up to nKeys more keys, returns how many are left.
+// --------------------------------------------------------------------------------
+int BeatFreezeRenderKeys(BeatFreeze* pFreeze, int nKeys)
+{
+	PlaydateAPI* pd = pFreeze->pd;
+	BeatFreezeVoice* pVoice = &pFreeze->voice;
+
+	float fStart = pd->system->getElapsedTime();
+
+	float* pDelay = NULL;
+	if (pVoice->bDelay && pVoice->nDelayFrames > 0)
+		pDelay = Engine_MemAlloc(pVoice->nDelayFrames * sizeof(float));
+
+	BeatFreezeVoice voice = *pVoice;
+	voice.bDelay = pDelay != NULL;
+
+	for (; nKeys > 0 && pFreeze->nKeysRendered < pFreeze->cost.nKeyCount; nKeys--)
+	{
+		int k = pFreeze->nKeysRendered++;
+		BeatFreezeKey* pKey = &pFreeze->keys[k];
+
+		pFreeze->pSampleData[k] = Engine_MemAlloc(pKey->nFrames * (int)sizeof(int16_t));
+
+		BeatFreezeRenderKey(&voice, &pFreeze->filter, pDelay, pKey, pFreeze->fFramesPerStep, 0x9E3779B9u + k, pFreeze->pSampleData[k]);
+	}
+
+	if (pDelay)
+		Engine_MemFree(pDelay);
+
+	pFreeze->cost.fRenderTime += pd->system->getElapsedTime() - fStart;
+
+	return pFreeze->cost.nKeyCount - pFreeze->nKeysRendered;
+}
+
+
+// --------------------------------------------------------------------------------
+// Moves the events of the track onto an instrument playing the rendered keys.
+// --------------------------------------------------------------------------------
+void BeatFreezeApply(BeatFreeze* pFreeze, SequenceTrack* pTrack)
+{
+	PlaydateAPI* pd = pFreeze->pd;
+
+	BeatFreezeRenderKeys(pFreeze, BM_FREEZE_MAX_KEYS);
+
+	pFreeze->pInstrument = pd->sound->instrument->newInstrument();
+
+	for (int k = 0; k < pFreeze->cost.nKeyCount; k++)
+	{
+		int nBytes = pFreeze->keys[k].nFrames * (int)sizeof(int16_t);
+		pFreeze->pSamples[k] = pd->sound->sample->newSampleFromData((uint8_t*)pFreeze->pSampleData[k], kSound16bitMono, BM_FREEZE_SAMPLE_RATE, nBytes, 0);
+
+		// the envelope is in the sample, the voice just plays it through
+		PDSynth* pSynth = pd->sound->synth->newSynth();
+		pd->sound->synth->setSample(pSynth, pFreeze->pSamples[k], 0, 0);
+		pd->sound->synth->setAttackTime(pSynth, 0.0f);
+		pd->sound->synth->setDecayTime(pSynth, 0.0f);
+		pd->sound->synth->setSustainLevel(pSynth, 1.0f);
+		pd->sound->synth->setReleaseTime(pSynth, 0.0f);
+
+		pd->sound->instrument->addVoice(pFreeze->pInstrument, pSynth, k, k, BM_FREEZE_SAMPLE_NOTE - k);
+		pFreeze->pVoices[k] = pSynth;
+	}
+
+	pFreeze->pChannel = pd->sound->channel->newChannel();
+	pd->sound->channel->addSource(pFreeze->pChannel, (SoundSource*)pFreeze->pInstrument);
+
+	int nNoteCount = pFreeze->cost.nNoteCount;
+
+	// all old events go before any new one is added, a key may have the pitch of another note
+	for (int i = 0; i < nNoteCount; i++)
+		pd->sound->track->removeNoteEvent(pTrack, pFreeze->pNotes[i].nStep, pFreeze->pNotes[i].nPitch);
+
+	for (int i = 0; i < nNoteCount; i++)
+	{
+		const BeatFreezeKey* pKey = &pFreeze->keys[pFreeze->pNoteKeys[i]];
+		pd->sound->track->addNoteEvent(pTrack, pFreeze->pNotes[i].nStep, pKey->nEventLen, pFreeze->pNoteKeys[i], 1.0f);
+	}
+
+	pd->sound->track->setInstrument(pTrack, pFreeze->pInstrument);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Renders the notes of the track and moves its events onto the frozen instrument.
+// Returns NULL with the reason in *pError when the track can't be frozen, the
+// track is not touched then.
+// --------------------------------------------------------------------------------
+BeatFreeze* BeatFreezeTrack(PlaydateAPI* pd, SequenceTrack* pTrack, const BeatFreezeVoice* pVoice, float fFramesPerStep, int* pError)
+{
+	BeatFreeze* pFreeze = BeatFreezeBegin(pd, pTrack, pVoice, fFramesPerStep, pError);
+
+	if (pFreeze)
+		BeatFreezeApply(pFreeze, pTrack);
+
+	return pFreeze;
+}
+
+
+// --------------------------------------------------------------------------------
+// Puts the live events and instrument back and frees the frozen ones.
+// --------------------------------------------------------------------------------
+void BeatFreezeThaw(BeatFreeze* pFreeze, SequenceTrack* pTrack, PDSynthInstrument* pLiveInstrument)
+{
+	PlaydateAPI* pd = pFreeze->pd;
+
+	int nNoteCount = pFreeze->cost.nNoteCount;
+
+	for (int i = 0; i < nNoteCount; i++)
+		pd->sound->track->removeNoteEvent(pTrack, pFreeze->pNotes[i].nStep, pFreeze->pNoteKeys[i]);
+
+	for (int i = 0; i < nNoteCount; i++)
+	{
+		const BMBNote* pNote = &pFreeze->pNotes[i];
+		pd->sound->track->addNoteEvent(pTrack, pNote->nStep, pNote->nLen, pNote->nPitch, pNote->fVelocity);
+	}
+
+	pd->sound->track->setInstrument(pTrack, pLiveInstrument);
+
+	BeatFreezeFree(pFreeze);
+
+}
@@ -0,0 +1,167 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef BEATFREEZE_H
+#define BEATFREEZE_H
+
+#pragma once
+
+#include <stdio.h>
+
+#include "pd_api.h"
+
+#include "beat_format.h"
+
+
+// --------------------------------------------------------------------------------
+// A frozen synth track plays its notes as samples. Every distinct pitch, length
+// and velocity of the track is rendered once, envelope and effects included, and
+// gets a MIDI note of its own: the track's events are rewritten onto those notes
+// and an instrument with one sampler voice per note plays them back. The original
+// events are kept, so thawing puts the live synth back as it was.
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BM_FREEZE_MAX_KEYS = 128,			// one MIDI note each
+	BM_FREEZE_MAX_BYTES = 1024 * 1024,	// sample data one track may take
+	BM_FREEZE_SAMPLE_RATE = 44100,
+	BM_FREEZE_MAX_TAIL = 44100,			// frames the delay may ring on after the release
+	BM_FREEZE_SAMPLE_NOTE = 60,			// a sample plays at its own pitch on middle C
+
+	BM_FREEZE_OK = 0,
+	BM_FREEZE_UNSUPPORTED = -1,			// no oscillator, or a pocket operator voice there is no model of
+	BM_FREEZE_TOO_MANY_KEYS = -2,
+	BM_FREEZE_TOO_BIG = -3
+
+} BEAT_FREEZE_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+// The sound of the track as the renderer needs it, effects in the order they run.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	SoundWaveform nWaveform;
+
+	float fAttack;
+	float fDecay;
+	float fSustain;
+	float fRelease;
+
+	int bFilter;
+	int nFilterType;
+	float fFilterFrequency;
+	float fFilterResonance;
+	float fFilterMix;
+
+	int bCrusher;
+	float fCrusherAmount;
+	float fCrusherMix;
+
+	int bDelay;
+	int nDelayFrames;
+	float fDelayFeedback;
+	float fDelayMix;
+
+} BeatFreezeVoice;
+
+
+// --------------------------------------------------------------------------------
+// What freezing a track costs against what it saves. fVoiceSeconds of oscillator,
+// envelope and per voice work a pass of the beat become sample playback, and the
+// nLiveEffects on the track's channel stop running. nSampleBytes is what it costs.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int nNoteCount;
+	int nKeyCount;
+	int nSampleBytes;
+
+	float fVoiceSeconds;
+	int nLiveEffects;
+
+	float fRenderTime;			// seconds the freeze took, 0 for an estimate
+
+} BeatFreezeCost;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	float b0;
+	float b1;
+	float b2;
+	float a1;
+	float a2;
+
+} BeatFreezeFilter;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	uint8_t nPitch;
+	uint8_t nLen;
+	float fVelocity;
+
+	int nFrames;
+	int nEventLen;				// steps the frozen event is held for, the whole sample
+
+} BeatFreezeKey;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	PlaydateAPI* pd;
+
+	SoundChannel* pChannel;		// no effects on it, they are in the samples
+	PDSynthInstrument* pInstrument;
+
+	BeatFreezeVoice voice;
+	BeatFreezeFilter filter;
+	float fFramesPerStep;
+
+	BeatFreezeKey keys[BM_FREEZE_MAX_KEYS];
+	int nKeysRendered;
+	PDSynth* pVoices[BM_FREEZE_MAX_KEYS];
+	AudioSample* pSamples[BM_FREEZE_MAX_KEYS];
+	int16_t* pSampleData[BM_FREEZE_MAX_KEYS];
+
+	// the events of the live track, step order
+	BMBNote* pNotes;
+	uint8_t* pNoteKeys;
+
+	BeatFreezeCost cost;
+
+} BeatFreeze;
+
+
+// --------------------------------------------------------------------------------
+int BeatFreezeMeasure(PlaydateAPI* pd, SequenceTrack* pTrack, const BeatFreezeVoice* pVoice, float fFramesPerStep, BeatFreezeCost* pCost);
+
+BeatFreeze* BeatFreezeBegin(PlaydateAPI* pd, SequenceTrack* pTrack, const BeatFreezeVoice* pVoice, float fFramesPerStep, int* pError);
+int BeatFreezeRenderKeys(BeatFreeze* pFreeze, int nKeys);
+void BeatFreezeApply(BeatFreeze* pFreeze, SequenceTrack* pTrack);
+
+BeatFreeze* BeatFreezeTrack(PlaydateAPI* pd, SequenceTrack* pTrack, const BeatFreezeVoice* pVoice, float fFramesPerStep, int* pError);
+void BeatFreezeThaw(BeatFreeze* pFreeze, SequenceTrack* pTrack, PDSynthInstrument* pLiveInstrument);
+void BeatFreezeFree(BeatFreeze* pFreeze);
+
+
+#endif
@@ -0,0 +1,33 @@
+// Written by tools/bmkeys from the key list in beat_keys.h, "make keys" in tools.
+
+#ifndef BEAT_KEY_SLOTS_H
+#define BEAT_KEY_SLOTS_H
+
+#pragma once
+
+_Static_assert(BEAT_KEY_COUNT == 43, "the key list changed, run make keys in tools");
+
+#define BEAT_KEY_SEED	77u
+
+// BeatKeyHash() of every key with BEAT_KEY_SEED: the key in its slot, BEAT_KEY_NONE elsewhere
+static const uint8_t nKeySlots[BEAT_KEY_SLOT_COUNT] =
+{
+	 0, 36,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0, 27,  0,  0,  0, 41,  0,  4,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 19,  0,  0,  0,  0,  0,
+	 0,  0, 15,  0,  0, 25,  0, 26,  0,  0,  0, 14,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0, 22,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0, 35,  0,  0,  0,  9,  0,  0,  0,  0,  0,  0,
+	23,  0,  5,  0,  0, 42,  0,  0, 18, 30,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0, 13,  0,  0,  0, 16,  0,  0, 21, 37,  0,
+	 0, 17,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0, 33,  0, 38,  0,  0,  0,  0,  0,  0,  0,  0,
+	 8,  0, 29,  0,  0,  0,  0, 20,  0,  0,  0,  0, 39,  0,  0,  0,
+	 0,  0, 40,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 11,  0,  0,
+	 2,  0, 34,  0,  3,  0,  0,  0,  0,  0,  0,  0,  0,  0,  6,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 32,  0,  0,  0,  0,
+	 0,  0,  0,  0, 28,  0,  0,  0,  0,  0,  0,  7,  0,  0,  1,  0,
+	 0,  0,  0,  0,  0,  0, 10,  0, 24,  0,  0, 31,  0, 12,  0,  0,
+};
+
+#endif
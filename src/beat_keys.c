@@ -0,0 +1,60 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+
+#include "beat_keys.h"
+#include "beat_key_slots.h"
+
+
+// --------------------------------------------------------------------------------
+#define BEAT_KEY_STRING(id, name)	name,
+
+static const char* szKeyNames[BEAT_KEY_COUNT] =
+{
+	"",
+	BEAT_KEY_LIST(BEAT_KEY_STRING)
+};
+
+#undef BEAT_KEY_STRING
+
+
+// --------------------------------------------------------------------------------
+int BeatKeyLookup(const char* szKey)
+{
+	int nLength = strlen(szKey);
+	if (nLength == 0)
+		return BEAT_KEY_NONE;
+
+	int nKey = nKeySlots[BeatKeyHash(szKey, nLength, BEAT_KEY_SEED)];
+
+	// one compare to reject keys that are not in the list but share a slot
+	if (nKey != BEAT_KEY_NONE && strcmp(szKeyNames[nKey], szKey) == 0)
+		return nKey;
+
+	return BEAT_KEY_NONE;
+}
+
+
+// --------------------------------------------------------------------------------
+const char* BeatKeyName(int nKey)
+{
+	if (nKey < 0 || nKey >= BEAT_KEY_COUNT)
+		return "";
+
+	return szKeyNames[nKey];
+}
@@ -0,0 +1,125 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+
+#ifndef BEATKEYS_H
+#define BEATKEYS_H
+
+#pragma once
+
+#include <stdio.h>
+
+#include "pd_api.h"
+
+
+// --------------------------------------------------------------------------------
+// Every key the .bmf decoder knows about. The enum and the name table are built
+// from this one list, the hash seed and slots in beat_key_slots.h are written from
+// it by tools/bmkeys, so a new key goes in here and then "make keys" in tools.
+// --------------------------------------------------------------------------------
+#define BEAT_KEY_LIST(X)			\
+	X(BEAT,		"beat")				\
+	X(TRACKS,	"tracks")			\
+	X(ENV,		"env")				\
+	X(LOOP,		"loop")				\
+	X(FILTER,	"filter")			\
+	X(LPF,		"lpf")				\
+	X(DELAY,	"delay")			\
+	X(BITCRUSH,	"bitcrush")			\
+	X(NOTES,	"notes")			\
+	X(LABELS,	"labels")			\
+	X(SCALE,	"scale")			\
+	X(OPTIONS,	"options")			\
+	X(ID,		"id")				\
+	X(NAME,		"name")				\
+	X(VOL,		"vol")				\
+	X(PAN,		"pan")				\
+	X(COLOR,	"color")			\
+	X(SAMPLE,	"sample")			\
+	X(TYPE,		"type")				\
+	X(MUTE,		"mute")				\
+	X(CHORD,	"chord")			\
+	X(STEP,		"step")				\
+	X(PITCH,	"pitch")			\
+	X(LEN,		"len")				\
+	X(VEL,		"vel")				\
+	X(VER,		"ver")				\
+	X(BPM,		"BPM")				\
+	X(A,		"a")				\
+	X(D,		"d")				\
+	X(S,		"s")				\
+	X(R,		"r")				\
+	X(BASE,		"base")				\
+	X(FREQ,		"freq")				\
+	X(RESN,		"resn")				\
+	X(MIX,		"mix")				\
+	X(FEEDBACK,	"feedback")			\
+	X(AMOUNT,	"amount")			\
+	X(ON,		"on")				\
+	X(START,	"start")			\
+	X(END,		"end")				\
+	X(TXT,		"txt")				\
+	X(HARMONICS,	"harmonics")
+
+
+// --------------------------------------------------------------------------------
+#define BEAT_KEY_ENUM(id, name)		BEAT_KEY_##id,
+
+typedef enum
+{
+	BEAT_KEY_NONE,
+	BEAT_KEY_LIST(BEAT_KEY_ENUM)
+	BEAT_KEY_COUNT
+
+} BEAT_KEYS;
+
+#undef BEAT_KEY_ENUM
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	// 8 bit slots keep the table at 256 bytes with plenty of room for a collision free seed
+	BEAT_KEY_HASH_BITS = 8,
+	BEAT_KEY_SLOT_COUNT = 1 << BEAT_KEY_HASH_BITS
+
+} BEAT_KEY_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+// Length plus first, middle and last character tell every key apart for the right
+// seed. Inline here so tools/bmkeys searches for it with this same function.
+// --------------------------------------------------------------------------------
+static inline uint32_t BeatKeyHash(const char* szKey, int nLength, uint32_t nSeed)
+{
+	uint32_t h = nSeed;
+	h = (h ^ (uint32_t)nLength) * 16777619u;
+	h = (h ^ (uint8_t)szKey[0]) * 16777619u;
+	h = (h ^ (uint8_t)szKey[nLength / 2]) * 16777619u;
+	h = (h ^ (uint8_t)szKey[nLength - 1]) * 16777619u;
+
+	return h >> (32 - BEAT_KEY_HASH_BITS);
+}
+
+
+// --------------------------------------------------------------------------------
+int BeatKeyLookup(const char* szKey);
+const char* BeatKeyName(int nKey);
+
+
+#endif
@@ -0,0 +1,662 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+
+#include <string.h>
+
+#include "beat_library.h"
+#include "beat_keys.h"
+
+// --------------------------------------------------------------------------------
+
+void* Engine_MemAlloc(int nSize);
+void Engine_MemFree(void* pData);
+
+
+// --------------------------------------------------------------------------------
+#define BEAT_LIBRARY_DIR		"beats/"
+#define BEAT_LIBRARY_INDEX		"beatlib.idx"
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	LIBRARY_STATE_ROOT,
+	LIBRARY_STATE_HEADER,
+	LIBRARY_STATE_SCALE,
+	LIBRARY_STATE_LABELS,
+	LIBRARY_STATE_TRACKS,
+	LIBRARY_STATE_NOTES,
+
+	LIBRARY_MAX_STATE = 8,
+	LIBRARY_READ_CHUNK = 1024
+
+} LIBRARY_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	PlaydateAPI* pd;
+	SDFile* file;
+
+	BeatLibraryEntry* pEntry;
+
+	int nStep;
+	int nLen;
+	BMBLabel label;
+
+	int nStateCount;
+	int nStates[LIBRARY_MAX_STATE];
+
+} LibraryDecode;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	BeatLibrary* pLibrary;
+
+	BeatLibraryEntry* pOldEntries;
+	int nOldCount;
+
+	int bChanged;
+
+} LibraryScan;
+
+
+// --------------------------------------------------------------------------------
+static uint32_t BeatLibraryPackTime(const FileStat* pStat)
+{
+	// not a real timestamp, only compared for equality
+	return ((uint32_t)(pStat->m_year - 2000) & 63) << 26 | (pStat->m_month & 15) << 22 | (pStat->m_day & 31) << 17 |
+		(pStat->m_hour & 31) << 12 | (pStat->m_minute & 63) << 6 | (pStat->m_second & 63);
+}
+
+
+// --------------------------------------------------------------------------------
+static int BeatLibraryHasExtension(const char* szName, const char* szExtension)
+{
+	int nLength = (int)strlen(szName);
+	int nExtLength = (int)strlen(szExtension);
+
+	return nLength > nExtLength && strcmp(szName + nLength - nExtLength, szExtension) == 0;
+}
+
+
+// --------------------------------------------------------------------------------
+static BeatLibraryEntry* BeatLibraryAddEntry(BeatLibrary* pLibrary)
+{
+	if (pLibrary->nEntryCount == pLibrary->nEntryCapacity)
+	{
+		int nCapacity = pLibrary->nEntryCapacity ? pLibrary->nEntryCapacity * 2 : 16;
+
+		BeatLibraryEntry* pEntries = Engine_MemAlloc(nCapacity * sizeof(BeatLibraryEntry));
+		if (pEntries == NULL)
+			return NULL;
+
+		if (pLibrary->pEntries)
+		{
+			memcpy(pEntries, pLibrary->pEntries, pLibrary->nEntryCount * sizeof(BeatLibraryEntry));
+			Engine_MemFree(pLibrary->pEntries);
+		}
+
+		pLibrary->pEntries = pEntries;
+		pLibrary->nEntryCapacity = nCapacity;
+	}
+
+	BeatLibraryEntry* pEntry = &pLibrary->pEntries[pLibrary->nEntryCount++];
+	memset(pEntry, 0, sizeof(BeatLibraryEntry));
+
+	return pEntry;
+}
+
+
+// --------------------------------------------------------------------------------
+// .bmf decoding. Only the beat table, scale, labels and the step/len of each note
+// are wanted, shouldDecodeTableValueForKey() turns everything else down so the
+// decoder skips over it without calling back or building values.
+// --------------------------------------------------------------------------------
+static void libraryDecodeError(json_decoder* decoder, const char* error, int linenum)
+{
+	LibraryDecode* pDecode = decoder->userdata;
+
+	pDecode->pd->system->logToConsole("library: %s line %i: %s", pDecode->pEntry->szName, linenum, error);
+}
+
+
+// --------------------------------------------------------------------------------
+static void libraryWillDecodeSublist(json_decoder* decoder, const char* name, json_value_type type)
+{
+	LibraryDecode* pDecode = decoder->userdata;
+
+	int nState = -1;
+
+	switch (BeatKeyLookup(name))
+	{
+	case BEAT_KEY_BEAT:		nState = LIBRARY_STATE_HEADER;	break;
+	case BEAT_KEY_SCALE:	nState = LIBRARY_STATE_SCALE;	break;
+	case BEAT_KEY_LABELS:	nState = LIBRARY_STATE_LABELS;	break;
+	case BEAT_KEY_TRACKS:	nState = LIBRARY_STATE_TRACKS;	break;
+	case BEAT_KEY_NOTES:	nState = LIBRARY_STATE_NOTES;	break;
+	}
+
+	if (nState != -1 && pDecode->nStateCount < LIBRARY_MAX_STATE)
+		pDecode->nStates[pDecode->nStateCount++] = nState;
+
+}
+
+
+// --------------------------------------------------------------------------------
+static int libraryShouldDecodeTableValueForKey(json_decoder* decoder, const char* key)
+{
+	LibraryDecode* pDecode = decoder->userdata;
+
+	int nState = pDecode->nStateCount > 0 ? pDecode->nStates[pDecode->nStateCount - 1] : LIBRARY_STATE_ROOT;
+
+	switch (nState)
+	{
+	case LIBRARY_STATE_ROOT:
+		return BeatKeyLookup(key) == BEAT_KEY_BEAT;
+
+	case LIBRARY_STATE_HEADER:
+		switch (BeatKeyLookup(key))
+		{
+		case BEAT_KEY_VER:
+		case BEAT_KEY_BPM:
+		case BEAT_KEY_SCALE:
+		case BEAT_KEY_LABELS:
+		case BEAT_KEY_TRACKS:
+			return 1;
+		}
+		return 0;
+
+	case LIBRARY_STATE_TRACKS:
+		// a track only counts for its notes, no name, sample or effects
+		return BeatKeyLookup(key) == BEAT_KEY_NOTES;
+
+	case LIBRARY_STATE_NOTES:
+	{
+		int nKey = BeatKeyLookup(key);
+		return nKey == BEAT_KEY_STEP || nKey == BEAT_KEY_LEN;
+	}
+	}
+
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+static void libraryDidDecodeTableValue(json_decoder* decoder, const char* key, json_value value)
+{
+	LibraryDecode* pDecode = decoder->userdata;
+	BeatLibraryEntry* pEntry = pDecode->pEntry;
+
+	if (pDecode->nStateCount == 0)
+		return;
+
+	switch (pDecode->nStates[pDecode->nStateCount - 1])
+	{
+	case LIBRARY_STATE_HEADER:
+		switch (BeatKeyLookup(key))
+		{
+		case BEAT_KEY_VER:		pEntry->nFileVersion = json_intValue(value);	break;
+		case BEAT_KEY_BPM:		pEntry->nBPM = json_intValue(value);			break;
+		}
+		break;
+
+	case LIBRARY_STATE_SCALE:
+		switch (BeatKeyLookup(key))
+		{
+		case BEAT_KEY_TYPE:		strncpy(pEntry->szScale, json_stringValue(value), BMB_SCALE_SIZE - 1);			break;
+		case BEAT_KEY_BASE:		strncpy(pEntry->szBaseNote, json_stringValue(value), BMB_BASE_NOTE_SIZE - 1);	break;
+		}
+		break;
+
+	case LIBRARY_STATE_LABELS:
+		switch (BeatKeyLookup(key))
+		{
+		case BEAT_KEY_STEP:		pDecode->label.nStep = json_intValue(value);							break;
+		case BEAT_KEY_TXT:		strncpy(pDecode->label.szText, json_stringValue(value), BMB_NAME_SIZE - 1);	break;
+		}
+		break;
+
+	case LIBRARY_STATE_NOTES:
+		switch (BeatKeyLookup(key))
+		{
+		case BEAT_KEY_STEP:		pDecode->nStep = json_intValue(value);			break;
+		case BEAT_KEY_LEN:		pDecode->nLen = json_intValue(value);			break;
+		}
+		break;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static int libraryShouldDecodeArrayValueAtIndex(json_decoder* decoder, int pos)
+{
+	LibraryDecode* pDecode = decoder->userdata;
+
+	pDecode->nStep = 0;
+	pDecode->nLen = 0;
+	memset(&pDecode->label, 0, sizeof(BMBLabel));
+
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+static void libraryDidDecodeArrayValue(json_decoder* decoder, int pos, json_value value)
+{
+	LibraryDecode* pDecode = decoder->userdata;
+	BeatLibraryEntry* pEntry = pDecode->pEntry;
+
+	if (pDecode->nStateCount == 0)
+		return;
+
+	switch (pDecode->nStates[pDecode->nStateCount - 1])
+	{
+	case LIBRARY_STATE_LABELS:
+		if (pEntry->nLabelCount < BEAT_LIBRARY_MAX_LABELS)
+			pEntry->labels[pEntry->nLabelCount++] = pDecode->label;
+		break;
+
+	case LIBRARY_STATE_TRACKS:
+		pEntry->nTrackCount++;
+		break;
+
+	case LIBRARY_STATE_NOTES:
+	{
+		int nLength = pDecode->nStep + pDecode->nLen;
+		if (nLength > pEntry->nBeatLength)
+			pEntry->nBeatLength = nLength;
+		break;
+	}
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void* libraryDidDecodeSublist(json_decoder* decoder, const char* name, json_value_type type)
+{
+	LibraryDecode* pDecode = decoder->userdata;
+
+	switch (BeatKeyLookup(name))
+	{
+	case BEAT_KEY_BEAT:
+	case BEAT_KEY_SCALE:
+	case BEAT_KEY_LABELS:
+	case BEAT_KEY_TRACKS:
+	case BEAT_KEY_NOTES:
+		if (pDecode->nStateCount > 0)
+			pDecode->nStateCount--;
+		break;
+	}
+
+	return NULL;
+}
+
+
+// --------------------------------------------------------------------------------
+static int libraryRead(void* userdata, uint8_t* buf, int bufsize)
+{
+	LibraryDecode* pDecode = userdata;
+
+	return pDecode->pd->file->read(pDecode->file, buf, bufsize);
+}
+
+
+// --------------------------------------------------------------------------------
+static int BeatLibraryReadSource(BeatLibrary* pLibrary, BeatLibraryEntry* pEntry, const char* szPath)
+{
+	PlaydateAPI* pd = pLibrary->pd;
+
+	LibraryDecode decode;
+	memset(&decode, 0, sizeof(LibraryDecode));
+
+	decode.pd = pd;
+	decode.pEntry = pEntry;
+
+	// the file is streamed through the decoder, nothing the size of the beat is allocated
+	decode.file = pd->file->open(szPath, kFileRead | kFileReadData);
+	if (decode.file == NULL)
+		return 0;
+
+	json_decoder decoder =
+	{
+		.decodeError = libraryDecodeError,
+		.willDecodeSublist = libraryWillDecodeSublist,
+		.shouldDecodeTableValueForKey = libraryShouldDecodeTableValueForKey,
+		.didDecodeTableValue = libraryDidDecodeTableValue,
+		.shouldDecodeArrayValueAtIndex = libraryShouldDecodeArrayValueAtIndex,
+		.didDecodeArrayValue = libraryDidDecodeArrayValue,
+		.didDecodeSublist = libraryDidDecodeSublist,
+		.userdata = &decode
+	};
+
+	json_reader reader = { .read = libraryRead, .userdata = &decode };
+
+	int nResult = pd->json->decode(&decoder, reader, NULL);
+
+	pd->file->close(decode.file);
+
+	if (pEntry->szScale[0] == '\0')
+	{
+		strcpy(pEntry->szScale, "Major");
+		strcpy(pEntry->szBaseNote, "C");
+	}
+
+	return nResult;
+}
+
+
+// --------------------------------------------------------------------------------
+static int BeatLibraryReadCompiled(BeatLibrary* pLibrary, BeatLibraryEntry* pEntry, const char* szPath)
+{
+	PlaydateAPI* pd = pLibrary->pd;
+
+	SDFile* file = pd->file->open(szPath, kFileRead | kFileReadData);
+	if (file == NULL)
+		return 0;
+
+	// the header has everything but the labels, which sit right after the tracks
+	BMBHeader header;
+	int bResult = 0;
+
+	if (pd->file->read(file, &header, sizeof(BMBHeader)) == sizeof(BMBHeader) && header.nMagic == BMB_MAGIC && header.nVersion == BMB_VERSION)
+	{
+		pEntry->nFileVersion = header.nFileVersion;
+		pEntry->nBPM = header.nBPM;
+		pEntry->nBeatLength = header.nBeatLength;
+		pEntry->nTrackCount = header.nTrackCount;
+
+		memcpy(pEntry->szScale, header.szScale, BMB_SCALE_SIZE);
+		memcpy(pEntry->szBaseNote, header.szBaseNote, BMB_BASE_NOTE_SIZE);
+		pEntry->szScale[BMB_SCALE_SIZE - 1] = '\0';
+		pEntry->szBaseNote[BMB_BASE_NOTE_SIZE - 1] = '\0';
+
+		int nLabelCount = header.nLabelCount;
+		if (nLabelCount > BEAT_LIBRARY_MAX_LABELS)
+			nLabelCount = BEAT_LIBRARY_MAX_LABELS;
+
+		bResult = 1;
+
+		if (nLabelCount > 0)
+		{
+			int nLabelBytes = nLabelCount * sizeof(BMBLabel);
+
+			if (pd->file->seek(file, header.nTrackCount * sizeof(BMBTrack), SEEK_CUR) == 0 &&
+				pd->file->read(file, pEntry->labels, nLabelBytes) == nLabelBytes)
+			{
+				pEntry->nLabelCount = nLabelCount;
+			}
+			else
+			{
+				bResult = 0;
+			}
+		}
+	}
+
+	pd->file->close(file);
+
+	return bResult;
+}
+
+
+// --------------------------------------------------------------------------------
+static const BeatLibraryEntry* BeatLibraryFindIndexed(LibraryScan* pScan, const char* szName, const FileStat* pStat)
+{
+	uint32_t nFileTime = BeatLibraryPackTime(pStat);
+
+	for (int i = 0; i < pScan->nOldCount; i++)
+	{
+		const BeatLibraryEntry* pEntry = &pScan->pOldEntries[i];
+
+		if (strcmp(pEntry->szName, szName) == 0)
+		{
+			if (pEntry->nFileSize == (uint32_t)pStat->size && pEntry->nFileTime == nFileTime)
+				return pEntry;
+
+			return NULL;
+		}
+	}
+
+	return NULL;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatLibraryScanFile(const char* szName, void* userdata)
+{
+	LibraryScan* pScan = userdata;
+	BeatLibrary* pLibrary = pScan->pLibrary;
+	PlaydateAPI* pd = pLibrary->pd;
+
+	int bCompiled = BeatLibraryHasExtension(szName, ".bmb");
+	if (!bCompiled && !BeatLibraryHasExtension(szName, ".bmf"))
+		return;
+
+	if (strlen(szName) >= BEAT_LIBRARY_NAME_SIZE)
+		return;
+
+	char szPath[BEAT_LIBRARY_NAME_SIZE + 8];
+	strcpy(szPath, BEAT_LIBRARY_DIR);
+	strcat(szPath, szName);
+
+	FileStat stat;
+	if (pd->file->stat(szPath, &stat) != 0 || stat.isdir)
+		return;
+
+	const BeatLibraryEntry* pIndexed = BeatLibraryFindIndexed(pScan, szName, &stat);
+
+	BeatLibraryEntry* pEntry = BeatLibraryAddEntry(pLibrary);
+	if (pEntry == NULL)
+		return;
+
+	if (pIndexed)
+	{
+		*pEntry = *pIndexed;
+		pLibrary->stats.nFromIndex++;
+		return;
+	}
+
+	strcpy(pEntry->szName, szName);
+	pEntry->nFileSize = stat.size;
+	pEntry->nFileTime = BeatLibraryPackTime(&stat);
+
+	int bResult = bCompiled ? BeatLibraryReadCompiled(pLibrary, pEntry, szPath) : BeatLibraryReadSource(pLibrary, pEntry, szPath);
+	if (!bResult)
+	{
+		// keep the entry so a broken file is not opened again on every start
+		pLibrary->stats.nFailed++;
+	}
+
+	pLibrary->stats.nScanned++;
+	pScan->bChanged = 1;
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatLibraryReadIndex(BeatLibrary* pLibrary)
+{
+	PlaydateAPI* pd = pLibrary->pd;
+
+	SDFile* file = pd->file->open(BEAT_LIBRARY_INDEX, kFileReadData);
+	if (file == NULL)
+		return;
+
+	BeatLibraryIndexHeader header;
+
+	if (pd->file->read(file, &header, sizeof(BeatLibraryIndexHeader)) == sizeof(BeatLibraryIndexHeader) &&
+		header.nMagic == BEAT_LIBRARY_MAGIC && header.nVersion == BEAT_LIBRARY_VERSION && header.nEntrySize == sizeof(BeatLibraryEntry))
+	{
+		for (uint32_t i = 0; i < header.nEntryCount; i++)
+		{
+			BeatLibraryEntry* pEntry = BeatLibraryAddEntry(pLibrary);
+			if (pEntry == NULL)
+				break;
+
+			if (pd->file->read(file, pEntry, sizeof(BeatLibraryEntry)) != sizeof(BeatLibraryEntry))
+			{
+				pLibrary->nEntryCount--;
+				break;
+			}
+
+			pEntry->szName[BEAT_LIBRARY_NAME_SIZE - 1] = '\0';
+		}
+	}
+
+	pd->file->close(file);
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatLibraryWriteIndex(BeatLibrary* pLibrary)
+{
+	PlaydateAPI* pd = pLibrary->pd;
+
+	SDFile* file = pd->file->open(BEAT_LIBRARY_INDEX, kFileWrite);
+	if (file == NULL)
+	{
+		pd->system->logToConsole("library: can't write %s: %s", BEAT_LIBRARY_INDEX, pd->file->geterr());
+		return;
+	}
+
+	BeatLibraryIndexHeader header;
+	header.nMagic = BEAT_LIBRARY_MAGIC;
+	header.nVersion = BEAT_LIBRARY_VERSION;
+	header.nEntrySize = sizeof(BeatLibraryEntry);
+	header.nEntryCount = pLibrary->nEntryCount;
+
+	pd->file->write(file, &header, sizeof(BeatLibraryIndexHeader));
+	pd->file->write(file, pLibrary->pEntries, pLibrary->nEntryCount * sizeof(BeatLibraryEntry));
+
+	pd->file->close(file);
+
+}
+
+
+// --------------------------------------------------------------------------------
+BeatLibrary* BeatLibraryCreate(PlaydateAPI* playdateApi)
+{
+	BeatLibrary* pLibrary = Engine_MemAlloc(sizeof(BeatLibrary));
+	if (pLibrary == NULL)
+		return NULL;
+
+	memset(pLibrary, 0, sizeof(BeatLibrary));
+	pLibrary->pd = playdateApi;
+
+	// whatever the last run found, BeatLibraryScan() checks it against beats/
+	BeatLibraryReadIndex(pLibrary);
+
+	return pLibrary;
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatLibraryDestroy(BeatLibrary* pLibrary)
+{
+	if (pLibrary == NULL)
+		return;
+
+	Engine_MemFree(pLibrary->pEntries);
+	Engine_MemFree(pLibrary);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Lists beats/ and fills the library. A file whose size and time match its index
+// entry is not opened, new or changed files are decoded and the index is written
+// again. Returns the number of beats.
+// --------------------------------------------------------------------------------
+int BeatLibraryScan(BeatLibrary* pLibrary)
+{
+	if (pLibrary == NULL)
+		return 0;
+
+	PlaydateAPI* pd = pLibrary->pd;
+
+	LibraryScan scan;
+	scan.pLibrary = pLibrary;
+	scan.pOldEntries = pLibrary->pEntries;
+	scan.nOldCount = pLibrary->nEntryCount;
+	scan.bChanged = 0;
+
+	pLibrary->pEntries = NULL;
+	pLibrary->nEntryCount = 0;
+	pLibrary->nEntryCapacity = 0;
+	memset(&pLibrary->stats, 0, sizeof(BeatLibraryStats));
+
+	pd->file->listfiles(BEAT_LIBRARY_DIR, BeatLibraryScanFile, &scan, 0);
+
+	// a beat that was deleted also changes the index
+	if (pLibrary->stats.nFromIndex != scan.nOldCount)
+		scan.bChanged = 1;
+
+	Engine_MemFree(scan.pOldEntries);
+
+	if (scan.bChanged)
+		BeatLibraryWriteIndex(pLibrary);
+
+	return pLibrary->nEntryCount;
+}
+
+
+// --------------------------------------------------------------------------------
+int BeatLibraryGetCount(BeatLibrary* pLibrary)
+{
+	return pLibrary ? pLibrary->nEntryCount : 0;
+}
+
+
+// --------------------------------------------------------------------------------
+const BeatLibraryEntry* BeatLibraryGetEntry(BeatLibrary* pLibrary, int nIndex)
+{
+	if (pLibrary == NULL || nIndex < 0 || nIndex >= pLibrary->nEntryCount)
+		return NULL;
+
+	return &pLibrary->pEntries[nIndex];
+}
+
+
+// --------------------------------------------------------------------------------
+const BeatLibraryEntry* BeatLibraryFind(BeatLibrary* pLibrary, const char* szName)
+{
+	if (pLibrary == NULL || szName == NULL)
+		return NULL;
+
+	for (int i = 0; i < pLibrary->nEntryCount; i++)
+	{
+		if (strcmp(pLibrary->pEntries[i].szName, szName) == 0)
+			return &pLibrary->pEntries[i];
+	}
+
+	return NULL;
+}
+
+
+// --------------------------------------------------------------------------------
+const BeatLibraryStats* BeatLibraryGetStats(BeatLibrary* pLibrary)
+{
+	return pLibrary ? &pLibrary->stats : NULL;
+}
@@ -0,0 +1,118 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+
+#ifndef BEATLIBRARY_H
+#define BEATLIBRARY_H
+
+#pragma once
+
+#include <stdio.h>
+
+#include "pd_api.h"
+
+#include "beat_format.h"
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BEAT_LIBRARY_NAME_SIZE = 48,
+	BEAT_LIBRARY_MAX_LABELS = 8,
+
+	BEAT_LIBRARY_MAGIC = 0x494C4D42,		// "BMLI"
+	BEAT_LIBRARY_VERSION = 1
+
+} BEAT_LIBRARY_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+// What a menu needs to show a beat. Entries are written to the index as they are,
+// so only fixed size fields go in here.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	char szName[BEAT_LIBRARY_NAME_SIZE];	// file name in beats/, .bmf or .bmb
+
+	uint32_t nFileSize;
+	uint32_t nFileTime;						// FileStat time packed by BeatLibraryPackTime
+
+	uint16_t nFileVersion;
+	uint16_t nBPM;
+	uint16_t nBeatLength;					// in steps
+
+	uint8_t nTrackCount;
+	uint8_t nLabelCount;
+
+	char szScale[BMB_SCALE_SIZE];
+	char szBaseNote[BMB_BASE_NOTE_SIZE];
+
+	BMBLabel labels[BEAT_LIBRARY_MAX_LABELS];
+
+} BeatLibraryEntry;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	uint32_t nMagic;
+	uint16_t nVersion;
+	uint16_t nEntrySize;
+	uint32_t nEntryCount;
+
+} BeatLibraryIndexHeader;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int nFromIndex;				// beats listed without opening them
+	int nScanned;				// beats that were new or had changed
+	int nFailed;
+
+} BeatLibraryStats;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	PlaydateAPI* pd;
+
+	BeatLibraryEntry* pEntries;
+	int nEntryCount;
+	int nEntryCapacity;
+
+	BeatLibraryStats stats;
+
+} BeatLibrary;
+
+
+// --------------------------------------------------------------------------------
+BeatLibrary* BeatLibraryCreate(PlaydateAPI* playdateApi);
+void BeatLibraryDestroy(BeatLibrary* pLibrary);
+
+int BeatLibraryScan(BeatLibrary* pLibrary);
+
+int BeatLibraryGetCount(BeatLibrary* pLibrary);
+const BeatLibraryEntry* BeatLibraryGetEntry(BeatLibrary* pLibrary, int nIndex);
+const BeatLibraryEntry* BeatLibraryFind(BeatLibrary* pLibrary, const char* szName);
+
+const BeatLibraryStats* BeatLibraryGetStats(BeatLibrary* pLibrary);
+
+
+#endif
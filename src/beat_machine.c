@@ -17,14 +17,22 @@ PERFORMANCE OF THIS SOFTWARE.
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
 
 #include "beat_machine.h"
+#include "beat_keys.h"
+#include "beat_scanner.h"
 
 
 // --------------------------------------------------------------------------------
-static PlaydateAPI* pd = NULL;
-static BeatMachine* pBeatMachine = NULL;
-static DecodeData decodeData;
+#define BM_MEM_HEADER_SIZE	8
+
+
+// --------------------------------------------------------------------------------
+// there is one heap per game, so the allocator and its counters are shared by all instances
+static void* (*pfnRealloc)(void* ptr, size_t size) = NULL;
+static BeatMachineMemStats memStats;
 
 
 // --------------------------------------------------------------------------------
@@ -43,10 +51,39 @@ static char* szSoundSrcType[] =
 };
 
 
+// --------------------------------------------------------------------------------
+// the platform waveform of each synth sound source, the sampler has none and the
+// wavetable is a generator of its own (beat_wavetable.c)
+static const SoundWaveform waveforms[BM_TYPE_WAVETABLE] =
+{
+	0,
+	kWaveformSine,
+	kWaveformSquare,
+	kWaveformSawtooth,
+	kWaveformTriangle,
+	kWaveformNoise,
+	kWaveformPOPhase,
+	kWaveformPODigital,
+	kWaveformPOVosim
+};
+
+
 // --------------------------------------------------------------------------------
 void* Engine_MemAlloc(int nSize)
 {
-	return pd->system->realloc(NULL, nSize);
+	// every block carries its size so that the heap usage can be tracked
+	int* pBlock = pfnRealloc(NULL, nSize + BM_MEM_HEADER_SIZE);
+	if (pBlock == NULL)
+		return NULL;
+
+	*pBlock = nSize;
+
+	memStats.nAllocCount++;
+	memStats.nLiveBytes += nSize;
+	if (memStats.nLiveBytes > memStats.nPeakBytes)
+		memStats.nPeakBytes = memStats.nLiveBytes;
+
+	return (char*)pBlock + BM_MEM_HEADER_SIZE;
 
 }
 
@@ -54,839 +91,3883 @@ void* Engine_MemAlloc(int nSize)
 // --------------------------------------------------------------------------------
 void Engine_MemFree(void* pData)
 {
-	pd->system->realloc(pData, 0);
+	if (pData == NULL)
+		return;
+
+	int* pBlock = (int*)((char*)pData - BM_MEM_HEADER_SIZE);
+
+	memStats.nFreeCount++;
+	memStats.nLiveBytes -= *pBlock;
+
+	pfnRealloc(pBlock, 0);
 
 }
 
 
 // --------------------------------------------------------------------------------
-char* Engine_StrDup(const char* str)
+BeatMachineMemStats* BeatMachineGetMemStats()
 {
-	int len = strlen(str);
-	char* s = Engine_MemAlloc(len + 1);
-	memcpy(s, str, len);
-	s[len] = '\0';
-	return s;
+	return &memStats;
 }
 
 
 // --------------------------------------------------------------------------------
-char** BeatMachineGetSoundSrcStrings()
+SampleCache* BeatMachineGetSampleCache(BeatMachine* pBeatMachine)
 {
-	return szSoundSrcType;
+	if (pBeatMachine)
+		return pBeatMachine->pSampleCache;
+
+	return NULL;
 }
 
 
 // --------------------------------------------------------------------------------
-BeatMachine* BeatMachineCreate(PlaydateAPI* playdateApi)
+const BeatArenaStats* BeatMachineGetArenaStats(BeatMachine* pBeatMachine)
 {
-	pd = playdateApi;
-
-	const int nVersion = 1;
-
-	int nMemSize = sizeof(BeatMachine);
-	pBeatMachine = Engine_MemAlloc(nMemSize);
+	if (pBeatMachine)
+		return BeatArenaGetStats(pBeatMachine->pArena);
 
-	pBeatMachine->pScaleManager = ScaleManagerCreate();
+	return NULL;
+}
 
-	pBeatMachine->pSequence = pd->sound->sequence->newSequence();
 
-	pBeatMachine->nVersion = nVersion;
+// --------------------------------------------------------------------------------
+const BeatLoadStats* BeatMachineGetLoadStats(BeatMachine* pBeatMachine)
+{
+	if (pBeatMachine)
+		return &pBeatMachine->loadStats;
 
-	pBeatMachine->szBeatName = NULL;
-	pBeatMachine->szProducer = NULL;
+	return NULL;
+}
 
-	pBeatMachine->nBeatLength = 0;
 
-	decodeData.nStateCount = 0;
+// --------------------------------------------------------------------------------
+char** BeatMachineGetSoundSrcStrings()
+{
+	return szSoundSrcType;
+}
 
 
-	nMemSize = sizeof(BeatMachineTrack);
+// --------------------------------------------------------------------------------
+static void BeatMachineAllocTracks(BeatArena* pArena, BeatMachineTrack** pTracks)
+{
+	int nMemSize = sizeof(BeatMachineTrack);
 	for (int i = 0; i < BM_MAX_TRACK; ++i)
 	{
-		pBeatMachine->pTracks[i] = Engine_MemAlloc(nMemSize);
-
-		memset(pBeatMachine->pTracks[i], 0, nMemSize);
+		pTracks[i] = BeatArenaAlloc(pArena, nMemSize);
 
 	}
 
-	BeatMachineSetBPM(120);
-
-	return pBeatMachine;
 }
 
 
 // --------------------------------------------------------------------------------
-void BeatMachineDestroy()
+// A sample of a beat that goes away is taken off the trigger voices, unless the
+// playing beat has it too.
+// --------------------------------------------------------------------------------
+static void BeatMachineTriggerForgetSample(BeatMachine* pBeatMachine, AudioSample* pSample)
 {
-	if (pd->sound->sequence->isPlaying(pBeatMachine->pSequence))
-		pd->sound->sequence->stop(pBeatMachine->pSequence);
-
-	for (int nTrack = 0; nTrack < BM_MAX_TRACK; nTrack++)
-	{
-		if (pBeatMachine->pTracks[nTrack]->pTrack)
-		{
-			if (pBeatMachine->pTracks[nTrack]->pSampleName)
-				Engine_MemFree(pBeatMachine->pTracks[nTrack]->pSampleName);
+	PlaydateAPI* pd = pBeatMachine->pd;
 
-			if (pBeatMachine->pTracks[nTrack]->filter)
-				pd->sound->effect->twopolefilter->freeFilter(pBeatMachine->pTracks[nTrack]->filter);
+	BeatTriggerPool* pPool = &pBeatMachine->triggers;
 
-			if (pBeatMachine->pTracks[nTrack]->delay)
-				pd->sound->effect->delayline->freeDelayLine(pBeatMachine->pTracks[nTrack]->delay);
+	if (pSample == NULL)
+		return;
 
-			if (pBeatMachine->pTracks[nTrack]->bitCrusher)
-				pd->sound->effect->bitcrusher->freeBitCrusher(pBeatMachine->pTracks[nTrack]->bitCrusher);
+	for (int i = 0; i < BM_MAX_TRACK; i++)
+	{
+		if (pBeatMachine->pTracks[i] && pBeatMachine->pTracks[i]->pSample == pSample && pBeatMachine->pTracks[i]->pTrack)
+			return;
+	}
 
-			pd->sound->synth->freeSynth(pBeatMachine->pTracks[nTrack]->pSynth);
-			pd->sound->instrument->freeInstrument(pBeatMachine->pTracks[nTrack]->pInstrument);
-			pd->sound->channel->freeChannel(pBeatMachine->pTracks[nTrack]->pChannel);
+	for (int v = 0; v < BM_TRIGGER_VOICES; v++)
+	{
+		if (pPool->pVoiceSamples[v] != pSample)
+			continue;
 
-			pd->sound->track->freeTrack(pBeatMachine->pTracks[nTrack]->pTrack);
-		}
+		pd->sound->synth->stop(pPool->pVoices[v]);
+		pPool->pVoiceSamples[v] = NULL;
+		pPool->nVoiceEnds[v] = 0;
 	}
 
-	Engine_MemFree(pBeatMachine->pScaleManager);
-	Engine_MemFree(pBeatMachine);
-
 }
 
 
 // --------------------------------------------------------------------------------
-void BeatMachineSetBPM(int nBPM)
+static int BeatMachineTrackHasEffects(const BeatMachineTrack* pTrack)
 {
-	float fBPM = (float)nBPM;
-
-	float stepsPerBeat = 4.0f;
-	float beatsPerSecond = fBPM / 60.f;
-	float stepsPerSecond = stepsPerBeat * beatsPerSecond;
-
-	if (pBeatMachine && pBeatMachine->pSequence)
-	{
-		pd->sound->sequence->setTempo(pBeatMachine->pSequence, stepsPerSecond);
-		pBeatMachine->nBPM = nBPM;
-	}
-
-
+	return pTrack->bFilterEnabled || pTrack->bDelayEnabled || pTrack->bBitCrusherEnabled;
 }
 
 
 // --------------------------------------------------------------------------------
-void BeatMachineSetADSR(int nTrack, float a, float d, float s, float r)
+static void BeatMachineTrackUnchainEffects(PlaydateAPI* pd, BeatMachineTrack* pTrack)
 {
-	if (pBeatMachine && pBeatMachine->pTracks[nTrack])
-	{
-		pBeatMachine->pTracks[nTrack]->fAttack = a;
-		pd->sound->synth->setAttackTime(pBeatMachine->pTracks[nTrack]->pSynth, a);
+	BeatBusSendDetach(pd, &pTrack->send);
 
-		pBeatMachine->pTracks[nTrack]->fDecay = d;
-		pd->sound->synth->setDecayTime(pBeatMachine->pTracks[nTrack]->pSynth, d);
+	if (pTrack->pChannel == NULL)
+		return;
 
-		pBeatMachine->pTracks[nTrack]->fSustain = s;
-		pd->sound->synth->setSustainLevel(pBeatMachine->pTracks[nTrack]->pSynth, s);
+	if (pTrack->filter)
+		pd->sound->channel->removeEffect(pTrack->pChannel, pTrack->filter);
 
-		pBeatMachine->pTracks[nTrack]->fRelease = r;
-		pd->sound->synth->setReleaseTime(pBeatMachine->pTracks[nTrack]->pSynth, r);
-	}
+	if (pTrack->bitCrusher)
+		pd->sound->channel->removeEffect(pTrack->pChannel, pTrack->bitCrusher);
+
+	if (pTrack->delay)
+		pd->sound->channel->removeEffect(pTrack->pChannel, pTrack->delay->pEffect);
 
 }
 
 
 // --------------------------------------------------------------------------------
-void BeatMachineSetSample(int nTrack, const char* szPath, const char* szSampleName)
+// A channel runs its effects in the order they were added, so they all go on again
+// as filter, bit crusher, delay, the order a freeze renders them in. The send tap
+// goes last so the buses get the track the way it is heard. A frozen track has the
+// effects in its samples and sends from the frozen channel.
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackChainEffects(PlaydateAPI* pd, BeatMachineTrack* pTrack)
 {
-	char szFullPath[256];
-	memset(szFullPath, 0, 256);
+	BeatMachineTrackUnchainEffects(pd, pTrack);
 
-	strcpy(szFullPath, szPath);
-	strcat(szFullPath, szSampleName);
+	if (pTrack->pChannel == NULL)
+		return;
 
-	if (pBeatMachine && pBeatMachine->pTracks[nTrack])
-	{
-		AudioSample* pSample = pd->sound->sample->load(szFullPath);
-		pd->sound->synth->setSample(pBeatMachine->pTracks[nTrack]->pSynth, pSample, 0, 0);
-		pd->sound->sample->freeSample(pSample);
+	if (pTrack->filter)
+		pd->sound->channel->addEffect(pTrack->pChannel, pTrack->filter);
 
-		if (pBeatMachine->pTracks[nTrack]->pSampleName)
-			Engine_MemFree(pBeatMachine->pTracks[nTrack]->pSampleName);
+	if (pTrack->bitCrusher)
+		pd->sound->channel->addEffect(pTrack->pChannel, pTrack->bitCrusher);
 
-		pBeatMachine->pTracks[nTrack]->pSampleName = Engine_StrDup(szSampleName);
-	}
+	if (pTrack->delay)
+		pd->sound->channel->addEffect(pTrack->pChannel, pTrack->delay->pEffect);
+
+	BeatBusSendAttach(pd, &pTrack->send, pTrack->pFrozen ? pTrack->pFrozen->pChannel : pTrack->pChannel);
 
 }
 
 
 // --------------------------------------------------------------------------------
-void BeatMachineCreateSynth(int nTrack, int nWaveFormIndex)
+static void BeatMachineFreeTracks(BeatMachine* pBeatMachine, BeatMachineTrack** pTracks)
 {
-	SoundWaveform waveforms[] =
-	{
-		0,
-		kWaveformSine,
-		kWaveformSquare,
-		kWaveformSawtooth,
-		kWaveformTriangle,
-		kWaveformNoise,
-		kWaveformPOPhase,
-		kWaveformPODigital,
-		kWaveformPOVosim
-	};
+	PlaydateAPI* pd = pBeatMachine->pd;
 
-	if (pBeatMachine && pBeatMachine->pTracks[nTrack])
+	for (int nTrack = 0; nTrack < BM_MAX_TRACK; nTrack++)
 	{
-		int bCreateNew = FALSE;
+		if (pTracks[nTrack] == NULL)
+			continue;
 
-		if (pBeatMachine->pTracks[nTrack]->pChannel == NULL)
+		if (pTracks[nTrack]->pTrack)
 		{
-			bCreateNew = TRUE;
-			pBeatMachine->pTracks[nTrack]->pChannel = pd->sound->channel->newChannel();
-		}
+			// the mixer lets go of the sample data before the cache might free it
+			if (pTracks[nTrack]->pMixerInput)
+				BeatMixerDetach(pBeatMachine->pMixer, pTracks[nTrack]->pMixerInput);
 
-		if (pBeatMachine->pTracks[nTrack]->pInstrument == NULL)
-			pBeatMachine->pTracks[nTrack]->pInstrument = pd->sound->instrument->newInstrument();
+			BeatMachineTriggerForgetSample(pBeatMachine, pTracks[nTrack]->pSample);
+			SampleCacheRelease(pBeatMachine->pSampleCache, pTracks[nTrack]->pSample);
 
-		if (pBeatMachine->pTracks[nTrack]->pSynth == NULL)
-			pBeatMachine->pTracks[nTrack]->pSynth = pd->sound->synth->newSynth();
+			// nothing may be left on a channel when it or the effect goes
+			BeatMachineTrackUnchainEffects(pd, pTracks[nTrack]);
+			BeatBusSendFree(pd, &pTracks[nTrack]->send);
 
-		pd->sound->synth->setWaveform(pBeatMachine->pTracks[nTrack]->pSynth, waveforms[nWaveFormIndex]);
+			// the track goes with it, so the live events don't need to be put back
+			if (pTracks[nTrack]->pFrozen)
+				BeatFreezeFree(pTracks[nTrack]->pFrozen);
 
-		pd->sound->synth->setAttackTime(pBeatMachine->pTracks[nTrack]->pSynth, 0);
-		pd->sound->synth->setDecayTime(pBeatMachine->pTracks[nTrack]->pSynth, .2f);
-		pd->sound->synth->setSustainLevel(pBeatMachine->pTracks[nTrack]->pSynth, .3f);
-		pd->sound->synth->setReleaseTime(pBeatMachine->pTracks[nTrack]->pSynth, .5f);
-		pBeatMachine->pTracks[nTrack]->fAttack = 0.0f;
-		pBeatMachine->pTracks[nTrack]->fDecay = .2f;
-		pBeatMachine->pTracks[nTrack]->fSustain = .3f;
-		pBeatMachine->pTracks[nTrack]->fRelease = .5f;
+			if (pTracks[nTrack]->filter)
+				pd->sound->effect->twopolefilter->freeFilter(pTracks[nTrack]->filter);
 
-		if (bCreateNew)
-		{
-			pd->sound->instrument->addVoice(pBeatMachine->pTracks[nTrack]->pInstrument, pBeatMachine->pTracks[nTrack]->pSynth, 24, 127, 0);
+			// the line goes back to the pool, its memory stays there
+			BeatDelayPoolRelease(pBeatMachine->pDelayPool, pTracks[nTrack]->delay);
+
+			if (pTracks[nTrack]->bitCrusher)
+				pd->sound->effect->bitcrusher->freeBitCrusher(pTracks[nTrack]->bitCrusher);
+
+			pd->sound->synth->freeSynth(pTracks[nTrack]->pSynth);
+
+			for (int v = 0; v < BM_CHORD_VOICE_COUNT; v++)
+			{
+				if (pTracks[nTrack]->pChordVoices[v])
+					pd->sound->synth->freeSynth(pTracks[nTrack]->pChordVoices[v]);
+			}
 
-			pd->sound->channel->addSource(pBeatMachine->pTracks[nTrack]->pChannel, (SoundSource*)pBeatMachine->pTracks[nTrack]->pInstrument);
+			pd->sound->instrument->freeInstrument(pTracks[nTrack]->pInstrument);
+			pd->sound->channel->freeChannel(pTracks[nTrack]->pChannel);
 
-			pBeatMachine->pTracks[nTrack]->pTrack = pd->sound->sequence->addTrack(pBeatMachine->pSequence);
-			pd->sound->track->setInstrument(pBeatMachine->pTracks[nTrack]->pTrack, pBeatMachine->pTracks[nTrack]->pInstrument);
+			pd->sound->track->freeTrack(pTracks[nTrack]->pTrack);
 		}
 
-		pBeatMachine->pTracks[nTrack]->nSoundSource = nWaveFormIndex;
+		// the track itself belongs to the arena of its beat
+		pTracks[nTrack] = NULL;
 	}
+
 }
 
 
 // --------------------------------------------------------------------------------
-void BeatMachineCreateSampler(int nTrack)
+// Takes the channels of the playing beat out of the mix while its prerendered
+// buffer plays, or puts them back. The sequence keeps running as the clock.
+// --------------------------------------------------------------------------------
+static void BeatMachineSetChannelsLive(BeatMachine* pBeatMachine, int bLive)
 {
-	if (pBeatMachine && pBeatMachine->pTracks[nTrack])
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	// notes the sequence started while the channels were out would come back mid-note
+	if (bLive)
+		pd->sound->sequence->allNotesOff(pBeatMachine->pSequence);
+
+	for (int i = 0; i < BM_MAX_TRACK; i++)
 	{
-		int bCreateNew = FALSE;
+		BeatMachineTrack* pTrack = pBeatMachine->pTracks[i];
+		if (pTrack == NULL || pTrack->pChannel == NULL)
+			continue;
+
+		if (bLive)
+			pd->sound->addChannel(pTrack->pChannel);
+		else
+			pd->sound->removeChannel(pTrack->pChannel);
+
+		if (pTrack->pFrozen && bLive)
+			pd->sound->addChannel(pTrack->pFrozen->pChannel);
+		else if (pTrack->pFrozen)
+			pd->sound->removeChannel(pTrack->pFrozen->pChannel);
+	}
 
-		if (pBeatMachine->pTracks[nTrack]->pChannel == NULL)
-		{
-			bCreateNew = TRUE;
-			pBeatMachine->pTracks[nTrack]->pChannel = pd->sound->channel->newChannel();
-		}
+	if (pBeatMachine->pMixer && bLive)
+		pd->sound->addChannel(pBeatMachine->pMixer->pChannel);
+	else if (pBeatMachine->pMixer)
+		pd->sound->removeChannel(pBeatMachine->pMixer->pChannel);
+
+}
 
-		if (pBeatMachine->pTracks[nTrack]->pInstrument == NULL)
-			pBeatMachine->pTracks[nTrack]->pInstrument = pd->sound->instrument->newInstrument();
 
-		if (pBeatMachine->pTracks[nTrack]->pSynth == NULL)
-			pBeatMachine->pTracks[nTrack]->pSynth = pd->sound->synth->newSynth();
+// --------------------------------------------------------------------------------
+// Back to the live tracks, nReason says why for the game to read.
+// --------------------------------------------------------------------------------
+static void BeatMachinePrerenderDrop(BeatMachine* pBeatMachine, int nReason)
+{
+	if (pBeatMachine == NULL || pBeatMachine->prerender.nState == BM_PRERENDER_IDLE)
+		return;
 
-		if (bCreateNew)
-		{
-			pd->sound->instrument->addVoice(pBeatMachine->pTracks[nTrack]->pInstrument, pBeatMachine->pTracks[nTrack]->pSynth, 24, 127, 0);
+	if (pBeatMachine->prerender.nState == BM_PRERENDER_PLAYING)
+		BeatMachineSetChannelsLive(pBeatMachine, TRUE);
 
-			pd->sound->channel->addSource(pBeatMachine->pTracks[nTrack]->pChannel, (SoundSource*)pBeatMachine->pTracks[nTrack]->pInstrument);
+	BeatPrerenderFree(&pBeatMachine->prerender);
+	pBeatMachine->prerender.nError = nReason;
 
-			pBeatMachine->pTracks[nTrack]->pTrack = pd->sound->sequence->addTrack(pBeatMachine->pSequence);
-			pd->sound->track->setInstrument(pBeatMachine->pTracks[nTrack]->pTrack, pBeatMachine->pTracks[nTrack]->pInstrument);
-		}
+}
 
-		pBeatMachine->pTracks[nTrack]->nSoundSource = BM_TYPE_SAMPLE;
 
-	}
+// --------------------------------------------------------------------------------
+// The slot of track nTrack in the playing beat, NULL when nTrack is out of range.
+// Only the calls that build a track's voice, a synth, sampler or wavetable, take a
+// slot, everything else wants BeatMachineGetTrack().
+// --------------------------------------------------------------------------------
+static BeatMachineTrack* BeatMachineGetTrackSlot(BeatMachine* pBeatMachine, int nTrack)
+{
+	if (pBeatMachine == NULL || nTrack < 0 || nTrack >= BM_MAX_TRACK)
+		return NULL;
 
+	return pBeatMachine->pTracks[nTrack];
 }
 
 
 // --------------------------------------------------------------------------------
-void BeatMachineSetChordTrack(int nTrack, int bFlag)
+// Track nTrack of the playing beat once it has a synth or sampler and its sequence
+// track, NULL before that or when nTrack is out of range.
+// --------------------------------------------------------------------------------
+static BeatMachineTrack* BeatMachineGetTrack(BeatMachine* pBeatMachine, int nTrack)
 {
-	if (bFlag)
-	{
-		pBeatMachine->pTracks[nTrack]->bIsChordTrack = bFlag;
-		for (int v = 0; v < 2; v++)
-		{
-			// make it polyphony for chord track
-			pd->sound->instrument->addVoice(pBeatMachine->pTracks[nTrack]->pInstrument, pd->sound->synth->copy(pBeatMachine->pTracks[nTrack]->pSynth), 24, 127, 0);
-		}
-	}
+	BeatMachineTrack* pTrack = BeatMachineGetTrackSlot(pBeatMachine, nTrack);
 
+	if (pTrack == NULL || pTrack->pTrack == NULL)
+		return NULL;
+
+	return pTrack;
 }
 
 
 // --------------------------------------------------------------------------------
-void BeatMachineCreateSynthByName(int nTrack, const char* szWaveFormName)
+BeatMachine* BeatMachineCreate(PlaydateAPI* playdateApi)
 {
-	for (int i = 0; i < BM_MAX_SOUND_TYPE; i++)
-	{
-		if (strcmp(szSoundSrcType[i], szWaveFormName) == 0)
-		{
-			BeatMachineCreateSynth(nTrack, i);
-			break;
-		}
-	}
+	return BeatMachineCreateWithCache(playdateApi, NULL);
 }
 
 
 // --------------------------------------------------------------------------------
-void BeatMachineEnableFilter(int nTrack, int nType, int nFreq, float resonant, float mix)
+BeatMachine* BeatMachineCreateWithCache(PlaydateAPI* playdateApi, SampleCache* pSharedCache)
 {
-	if (pBeatMachine && pBeatMachine->pTracks[nTrack])
-	{
-		pBeatMachine->pTracks[nTrack]->bFilterEnabled = TRUE;
-		pBeatMachine->pTracks[nTrack]->filter = pd->sound->effect->twopolefilter->newFilter();
+	PlaydateAPI* pd = playdateApi;
+
+	pfnRealloc = pd->system->realloc;
+
+	const int nVersion = 1;
+
+	int nMemSize = sizeof(BeatMachine);
+	BeatMachine* pBeatMachine = Engine_MemAlloc(nMemSize);
+
+	pBeatMachine->pd = pd;
 
-		pBeatMachine->pTracks[nTrack]->nFilterType = nType;
-		pd->sound->effect->twopolefilter->setType(pBeatMachine->pTracks[nTrack]->filter, (TwoPoleFilterType)nType);
+	BeatArenaInit(&pBeatMachine->arenas[0]);
+	BeatArenaInit(&pBeatMachine->arenas[1]);
+	pBeatMachine->pArena = &pBeatMachine->arenas[0];
+	pBeatMachine->pSpareArena = &pBeatMachine->arenas[1];
 
-		pBeatMachine->pTracks[nTrack]->nFilterFreq = nFreq;
-		pd->sound->effect->twopolefilter->setFrequency(pBeatMachine->pTracks[nTrack]->filter, nFreq);
+	pBeatMachine->pScaleManager = BeatArenaAlloc(pBeatMachine->pArena, sizeof(ScaleManager));
+	ScaleManagerInit(pBeatMachine->pScaleManager);
 
-		pBeatMachine->pTracks[nTrack]->fFilterResn = resonant;
-		pd->sound->effect->twopolefilter->setResonance(pBeatMachine->pTracks[nTrack]->filter, resonant);
+	// instances that play side by side can share one cache so they share samples too
+	pBeatMachine->bOwnsSampleCache = (pSharedCache == NULL);
+	pBeatMachine->pSampleCache = pSharedCache ? pSharedCache : SampleCacheCreate(pd, SAMPLE_CACHE_DEFAULT_BUDGET);
 
-		pBeatMachine->pTracks[nTrack]->fFilterMix = mix;
-		pd->sound->effect->setMix(pBeatMachine->pTracks[nTrack]->filter, mix);
+	pBeatMachine->pSequence = pd->sound->sequence->newSequence();
+
+	pBeatMachine->nVersion = nVersion;
+
+	pBeatMachine->szBeatName = NULL;
+	pBeatMachine->szProducer = NULL;
+
+	pBeatMachine->nBeatLength = 0;
+
+	pBeatMachine->pLoad = NULL;
+
+	pBeatMachine->bSortNotes = TRUE;
+	pBeatMachine->bUseScanner = FALSE;
+	memset(&pBeatMachine->loadStats, 0, sizeof(BeatLoadStats));
+
+	pBeatMachine->nFreezeMask = 0;
+
+	pBeatMachine->bUseMixer = FALSE;
+	pBeatMachine->nMixerVoices = BM_MIXER_DEFAULT_VOICES;
+	pBeatMachine->pMixer = NULL;
+
+	for (int b = 0; b < BM_BUS_COUNT; b++)
+		pBeatMachine->pBuses[b] = NULL;
+
+	pBeatMachine->nBusDelaySteps = BM_DELAY_QUARTER;
+
+	pBeatMachine->nDelayLines = BM_DELAY_DEFAULT_LINES;
+	pBeatMachine->pDelayPool = NULL;
+
+	pBeatMachine->nLabelCount = 0;
+	pBeatMachine->bLoopOn = FALSE;
+	pBeatMachine->nLoopStart = 0;
+	pBeatMachine->nLoopLast = 0;
+	memset(&pBeatMachine->transition, 0, sizeof(BeatTransition));
+	memset(&pBeatMachine->seek, 0, sizeof(BeatSeek));
+	memset(&pBeatMachine->prerender, 0, sizeof(BeatPrerender));
+
+	BeatEventBusReset(&pBeatMachine->events);
+	pBeatMachine->pEventChannel = NULL;
+	pBeatMachine->pEventSource = NULL;
+	pBeatMachine->nEventStep = -1;
+
+	// the trigger voices are made up front, a trigger must not allocate
+	BeatTriggerPool* pPool = &pBeatMachine->triggers;
+	memset(pPool, 0, sizeof(BeatTriggerPool));
+
+	pPool->pChannel = pd->sound->channel->newChannel();
+	for (int v = 0; v < BM_TRIGGER_VOICES; v++)
+	{
+		pPool->pVoices[v] = pd->sound->synth->newSynth();
+		pd->sound->channel->addSource(pPool->pChannel, (SoundSource*)pPool->pVoices[v]);
 	}
 
+	BeatMachineAllocTracks(pBeatMachine->pArena, pBeatMachine->pTracks);
+	pBeatMachine->pOccupancy = BeatArenaAlloc(pBeatMachine->pArena, sizeof(BeatOccupancy));
+
+	BeatMachineSetBPM(pBeatMachine, 120);
+
+	return pBeatMachine;
 }
 
 
 // --------------------------------------------------------------------------------
-void BeatMachineEnableDelay(int nTrack, float feedback, float mix)
+void BeatMachineDestroy(BeatMachine* pBeatMachine)
 {
-	if (pBeatMachine && pBeatMachine->pTracks[nTrack])
-	{
-		pBeatMachine->pTracks[nTrack]->bDelayEnabled = TRUE;
-		pBeatMachine->pTracks[nTrack]->delay = pd->sound->effect->delayline->newDelayLine(128, 2);
-		pd->sound->effect->delayline->setFeedback(pBeatMachine->pTracks[nTrack]->delay, 0.5f);
-		pd->sound->effect->setMix(pBeatMachine->pTracks[nTrack]->delay, 0.5f);
+	PlaydateAPI* pd = pBeatMachine->pd;
 
-		pBeatMachine->pTracks[nTrack]->fDelayFeedback = feedback;
-		pd->sound->effect->delayline->setFeedback(pBeatMachine->pTracks[nTrack]->delay, feedback);
+	BeatMachineCancelLoad(pBeatMachine);
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_OK);
 
-		pBeatMachine->pTracks[nTrack]->fDelayMix = mix;
-		pd->sound->effect->setMix(pBeatMachine->pTracks[nTrack]->delay, mix);
+	if (pd->sound->sequence->isPlaying(pBeatMachine->pSequence))
+		pd->sound->sequence->stop(pBeatMachine->pSequence);
+
+	// the event source reads the sequence, it goes first
+	if (pBeatMachine->pEventSource)
+	{
+		pd->sound->channel->removeSource(pBeatMachine->pEventChannel, pBeatMachine->pEventSource);
+		pd->system->realloc(pBeatMachine->pEventSource, 0);
+		pd->sound->channel->freeChannel(pBeatMachine->pEventChannel);
 	}
+
+	BeatMachineFreeTracks(pBeatMachine, pBeatMachine->pTracks);
+
+	for (int v = 0; v < BM_TRIGGER_VOICES; v++)
+		pd->sound->synth->freeSynth(pBeatMachine->triggers.pVoices[v]);
+
+	pd->sound->channel->freeChannel(pBeatMachine->triggers.pChannel);
+
+	if (pBeatMachine->pMixer)
+		BeatMixerDestroy(pBeatMachine->pMixer);
+
+	// after the tracks, their taps write into the buses
+	for (int b = 0; b < BM_BUS_COUNT; b++)
+		BeatBusDestroy(pBeatMachine->pBuses[b]);
+
+	BeatDelayPoolDestroy(pBeatMachine->pDelayPool);
+
+	pd->sound->sequence->freeSequence(pBeatMachine->pSequence);
+
+	// tracks, scale manager and names all go with the arenas
+	BeatArenaRelease(&pBeatMachine->arenas[0]);
+	BeatArenaRelease(&pBeatMachine->arenas[1]);
+
+	if (pBeatMachine->bOwnsSampleCache)
+		SampleCacheDestroy(pBeatMachine->pSampleCache);
+
+	Engine_MemFree(pBeatMachine);
+
 }
 
 
 // --------------------------------------------------------------------------------
-void BeatMachineEnableBitCrusher(int nTrack, float amount, float mix)
+static float BeatMachineStepsPerSecond(int nBPM)
 {
-	if (pBeatMachine && pBeatMachine->pTracks[nTrack])
-	{
-		pBeatMachine->pTracks[nTrack]->bBitCrusherEnabled = TRUE;
-		pBeatMachine->pTracks[nTrack]->bitCrusher = pd->sound->effect->bitcrusher->newBitCrusher();
-		pd->sound->effect->bitcrusher->setAmount(pBeatMachine->pTracks[nTrack]->bitCrusher, 0.5f);
-		pd->sound->effect->setMix(pBeatMachine->pTracks[nTrack]->bitCrusher, 0.5f);
-
-		pBeatMachine->pTracks[nTrack]->fBitcrusherAmount = amount;
-		pd->sound->effect->bitcrusher->setAmount(pBeatMachine->pTracks[nTrack]->bitCrusher, amount);
+	float fBPM = (float)nBPM;
 
-		pBeatMachine->pTracks[nTrack]->fBitcrusherMix= mix;
-		pd->sound->effect->setMix(pBeatMachine->pTracks[nTrack]->bitCrusher, mix);
-	}
+	float stepsPerBeat = 4.0f;
+	float beatsPerSecond = fBPM / 60.f;
+	float stepsPerSecond = stepsPerBeat * beatsPerSecond;
 
+	return stepsPerSecond;
 }
 
 
 // --------------------------------------------------------------------------------
-void BeatMachineSetVolume(int nTrack, float fVolume)
+static float BeatMachineFramesPerStep(int nBPM)
 {
+	return BM_SAMPLE_RATE / BeatMachineStepsPerSecond(nBPM);
+}
 
-	pBeatMachine->pTracks[nTrack]->fVolume= fVolume;
 
-	pd->sound->channel->setVolume(pBeatMachine->pTracks[nTrack]->pChannel, fVolume);
+// --------------------------------------------------------------------------------
+// A delay of nSteps at nBPM in frames, no longer than a pooled line can be.
+// --------------------------------------------------------------------------------
+static int BeatMachineDelayFrames(int nSteps, int nBPM)
+{
+	int nMaxFrames = (int)(BM_DELAY_MAX_STEPS * BeatMachineFramesPerStep(BM_DELAY_MIN_BPM) + 0.5f);
+
+	if (nBPM < BM_DELAY_MIN_BPM)
+		return nMaxFrames;
 
+	int nFrames = (int)(nSteps * BeatMachineFramesPerStep(nBPM) + 0.5f);
 
+	return nFrames < nMaxFrames ? nFrames : nMaxFrames;
 }
 
 
 // --------------------------------------------------------------------------------
-void BeatMachineSetPanning(int nTrack, float fValue)
+// Made with the first delay, nDelayLines lines for the playing beat and as many
+// for the one loading or fading next to it. The lines get their frames when a
+// track first needs them.
+// --------------------------------------------------------------------------------
+static BeatDelayPool* BeatMachineGetDelayPool(BeatMachine* pBeatMachine)
 {
-	pBeatMachine->pTracks[nTrack]->fPanning = fValue;
-	pd->sound->channel->setPan(pBeatMachine->pTracks[nTrack]->pChannel, fValue);
+	if (pBeatMachine->pDelayPool == NULL)
+		pBeatMachine->pDelayPool = BeatDelayPoolCreate(pBeatMachine->pd, pBeatMachine->nDelayLines * 2);
 
+	return pBeatMachine->pDelayPool;
 }
 
 
 // --------------------------------------------------------------------------------
-void BeatMachineMuteTrack(int nTrack, int bFlag)
+static int BeatMachineCountDelayLines(BeatMachineTrack** pTracks)
 {
-	pBeatMachine->pTracks[nTrack]->bMuted = bFlag;
-	pd->sound->track->setMuted(pBeatMachine->pTracks[nTrack]->pTrack, bFlag);
+	int nCount = 0;
+
+	for (int nTrack = 0; nTrack < BM_MAX_TRACK; nTrack++)
+	{
+		if (pTracks[nTrack] && pTracks[nTrack]->delay)
+			nCount++;
+	}
+
+	return nCount;
 }
 
 
 // --------------------------------------------------------------------------------
-void decodeError(json_decoder* decoder, const char* error, int linenum)
+// What reaches the track's effects: a synth is mono, a sampler is as its sample.
+// --------------------------------------------------------------------------------
+static int BeatMachineTrackChannelCount(PlaydateAPI* pd, BeatMachineTrack* pTrack)
 {
-	pd->system->logToConsole("decode error line %i: %s", linenum, error);
+	if (pTrack->nSoundSource != BM_TYPE_SAMPLE || pTrack->pSample == NULL)
+		return 1;
+
+	uint8_t* pData = NULL;
+	SoundFormat format = kSound16bitMono;
+	uint32_t nSampleRate = 0;
+	uint32_t nByteLength = 0;
+	pd->sound->sample->getData(pTrack->pSample, &pData, &format, &nSampleRate, &nByteLength);
+
+	return (format == kSound16bitStereo || format == kSound8bitStereo) ? 2 : 1;
 }
 
 
 // --------------------------------------------------------------------------------
-const char* typeToName(json_value_type type)
+// Gives the track a line long enough for its time at BM_DELAY_MIN_BPM with as many
+// channels as it plays, so tempo changes never need another one. A line that
+// already fits is kept, else it goes back to the pool for one that does. A track
+// without a line stays dry once pTracks holds nDelayLines of them, so the other
+// beat always finds its own. The effects come off the channel while the line
+// changes, the caller chains them again.
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackFitDelay(BeatMachine* pBeatMachine, BeatMachineTrack** pTracks, BeatMachineTrack* pTrack)
 {
-	switch (type)
+	PlaydateAPI* pd = pBeatMachine->pd;
+	BeatDelayPool* pPool = BeatMachineGetDelayPool(pBeatMachine);
+
+	int nMaxFrames = BeatMachineDelayFrames(pTrack->nDelaySteps, BM_DELAY_MIN_BPM);
+	int nChannels = BeatMachineTrackChannelCount(pd, pTrack);
+
+	BeatDelayLine* pLine = pTrack->delay;
+	if (pLine && pLine->nChannels == nChannels && BeatDelayMaxFrames(pLine) >= nMaxFrames)
+		return;
+
+	if (pLine == NULL && BeatMachineCountDelayLines(pTracks) >= pBeatMachine->nDelayLines)
 	{
-	case kJSONNull: return "null";
-	case kJSONTrue: return "true";
-	case kJSONFalse: return "false";
-	case kJSONInteger: return "integer";
-	case kJSONFloat: return "float";
-	case kJSONString: return "string";
-	case kJSONArray: return "array";
-	case kJSONTable: return "table";
-	default: return "???";
+		pPool->nDenied++;
+		return;
 	}
+
+	BeatMachineTrackUnchainEffects(pd, pTrack);
+
+	// released first, so the line can grow into what the track asks for
+	BeatDelayPoolRelease(pPool, pLine);
+	pTrack->delay = BeatDelayPoolAcquire(pPool, nMaxFrames, nChannels);
+
 }
 
 
 // --------------------------------------------------------------------------------
-void willDecodeSublist(json_decoder* decoder, const char* name, json_value_type type)
+// Sets the line of a track with a delay to its time at nBPM and its levels.
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackUpdateDelay(BeatMachine* pBeatMachine, BeatMachineTrack** pTracks, BeatMachineTrack* pTrack, int nBPM)
 {
+	BeatMachineTrackFitDelay(pBeatMachine, pTracks, pTrack);
 
-	if (strcmp(name, "beat") == 0)
-	{
-		decodeData.nLoadStates[decodeData.nStateCount++] = LOAD_STATE_HEADER;
-	}
-	else if (strcmp(name, "tracks") == 0)
-	{
-		decodeData.nLoadStates[decodeData.nStateCount++] = LOAD_STATE_TRACK_INFO;
-	}
-	else if (strcmp(name, "env") == 0)
-	{
-		decodeData.nLoadStates[decodeData.nStateCount++] = LOAD_STATE_ENVOLOPE;
-	}
-	else if (strcmp(name, "loop") == 0)
-	{
-		decodeData.nLoadStates[decodeData.nStateCount++] = LOAD_STATE_LOOP;
-	}
-	else if (strcmp(name, "filter") == 0)
-	{
-		decodeData.nLoadStates[decodeData.nStateCount++] = LOAD_STATE_FILTER;
-	}
-	else if (strcmp(name, "delay") == 0)
-	{
-		decodeData.nLoadStates[decodeData.nStateCount++] = LOAD_STATE_DELAY;
-	}
-	else if (strcmp(name, "bitcrush") == 0)
-	{
-		decodeData.nLoadStates[decodeData.nStateCount++] = LOAD_STATE_BITCRUSHER;
-	}
-	else if (strcmp(name, "notes") == 0)
-	{
-		decodeData.nLoadStates[decodeData.nStateCount++] = LOAD_STATE_NOTES;
-	}
-	else if (strcmp(name, "labels") == 0)
-	{
-		decodeData.nLoadStates[decodeData.nStateCount++] = LOAD_STATE_LABELS;
-	}
-	else if (strcmp(name, "scale") == 0)
-	{
-		decodeData.nLoadStates[decodeData.nStateCount++] = LOAD_STATE_SCALE;
-		memset(decodeData.szBuffer, 0, 128);
-		memset(decodeData.szBufferSmall, 0, 32);
-	}
-	else if (strcmp(name, "options") == 0)
+	if (pTrack->delay)
 	{
-		decodeData.nLoadStates[decodeData.nStateCount++] = LOAD_STATE_OPTIONS;
+		BeatDelaySetLength(pTrack->delay, BeatMachineDelayFrames(pTrack->nDelaySteps, nBPM));
+		BeatDelaySetLevels(pTrack->delay, pTrack->fDelayFeedback, pTrack->fDelayMix);
 	}
-	
+
+	BeatMachineTrackChainEffects(pBeatMachine->pd, pTrack);
+
 }
 
 
 // --------------------------------------------------------------------------------
-int shouldDecodeTableValueForKey(json_decoder* decoder, const char* key)
+static void BeatMachineTrackSetADSR(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, float a, float d, float s, float r)
 {
-	
-	return 1;
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	pTrack->fAttack = a;
+	pd->sound->synth->setAttackTime(pTrack->pSynth, a);
+
+	pTrack->fDecay = d;
+	pd->sound->synth->setDecayTime(pTrack->pSynth, d);
+
+	pTrack->fSustain = s;
+	pd->sound->synth->setSustainLevel(pTrack->pSynth, s);
+
+	pTrack->fRelease = r;
+	pd->sound->synth->setReleaseTime(pTrack->pSynth, r);
+
+	if (pTrack->pMixerInput)
+		pTrack->pMixerInput->nReleaseFrames = (int)(r * BM_SAMPLE_RATE);
+
 }
 
 
 // --------------------------------------------------------------------------------
-void didDecodeTableValue(json_decoder* decoder, const char* key, json_value value)
+void BeatMachineSetADSR(BeatMachine* pBeatMachine, int nTrack, float a, float d, float s, float r)
 {
-	
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
 
-	if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_TRACK_INFO)
-	{
-		if (strcmp(key, "id") == 0)
-		{
-			decodeData.nTrack = json_intValue(value);
-		}
-		else if (strcmp(key, "name") == 0)
-		{
-			strcpy(pBeatMachine->pTracks[decodeData.nTrack]->szTrackName, json_stringValue(value));
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
 
-		}
-		else if (strcmp(key, "vol") == 0)
-		{
-			BeatMachineSetVolume(decodeData.nTrack, json_floatValue(value));
-		}
-		else if (strcmp(key, "pan") == 0)
-		{
-			BeatMachineSetPanning(decodeData.nTrack, json_floatValue(value));
-		}
-		else if (strcmp(key, "color") == 0)
-		{
-			
-		}
-		else if (strcmp(key, "sample") == 0)
-		{
-			BeatMachineSetSample(decodeData.nTrack, "samples/", json_stringValue(value));
-		}
-		else if (strcmp(key, "type") == 0)
-		{
-			char* szName = json_stringValue(value);
-			if (strcmp(szName, "sampler") == 0)
+	if (pTrack)
+		BeatMachineTrackSetADSR(pBeatMachine, pTrack, a, d, s, r);
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackSetSample(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, BeatArena* pArena, const char* szPath, const char* szSampleName)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	// acquire before releasing so a track keeping its sample never reloads it
+	AudioSample* pSample = SampleCacheAcquire(pBeatMachine->pSampleCache, szPath, szSampleName);
+	pd->sound->synth->setSample(pTrack->pSynth, pSample, 0, 0);
+
+	AudioSample* pOldSample = pTrack->pSample;
+	pTrack->pSample = pSample;
+
+	BeatMachineTriggerForgetSample(pBeatMachine, pOldSample);
+	SampleCacheRelease(pBeatMachine->pSampleCache, pOldSample);
+
+	// a replaced name stays in the arena until the beat is unloaded
+	pTrack->pSampleName = BeatArenaStrDup(pArena, szSampleName);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// A chord on the platform path needs a synth per note. An instrument can't drop a
+// voice again, so the copies stay until the track is freed.
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackAddChordVoices(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	if (!pTrack->bIsChordTrack)
+		return;
+
+	int nVoices = pTrack->nChordType == SCALE_CHORD_SEVENTH ? 3 : 2;
+
+	for (int v = 0; v < nVoices; v++)
+	{
+		if (pTrack->pChordVoices[v])
+			continue;
+
+		pTrack->pChordVoices[v] = pd->sound->synth->copy(pTrack->pSynth);
+		pd->sound->instrument->addVoice(pTrack->pInstrument, pTrack->pChordVoices[v], 24, 127, 0);
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackDetachMixer(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	if (pTrack->pMixerInput == NULL)
+		return;
+
+	BeatMixerDetach(pBeatMachine->pMixer, pTrack->pMixerInput);
+	pTrack->pMixerInput = NULL;
+
+	// back to the platform sampler, a chord now needs voices of its own
+	pd->sound->synth->setSample(pTrack->pSynth, pTrack->pSample, 0, 0);
+	BeatMachineTrackAddChordVoices(pBeatMachine, pTrack);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Moves a plain sampler track onto the beat mixer. Effects and sends need the
+// track's own channel, so those tracks stay where they are. A chord plays from the mixer's
+// voice pool, unless the track already got platform voices for it.
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackAttachMixer(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, BeatArena* pArena)
+{
+	if (!pBeatMachine->bUseMixer || pTrack->pMixerInput || pTrack->nSoundSource != BM_TYPE_SAMPLE || pTrack->pSample == NULL)
+		return;
+
+	if (pTrack->pChordVoices[0] || BeatMachineTrackHasEffects(pTrack) || BeatBusSendIsActive(&pTrack->send))
+		return;
+
+	if (pBeatMachine->pMixer == NULL)
+	{
+		pBeatMachine->pMixer = BeatMixerCreate(pBeatMachine->pd);
+		BeatMixerSetVoiceCount(pBeatMachine->pMixer, pBeatMachine->nMixerVoices);
+	}
+
+	// the input goes with the track, so it comes from the same arena
+	BeatMixerInput* pInput = BeatArenaAlloc(pArena, sizeof(BeatMixerInput));
+
+	if (BeatMixerAttach(pBeatMachine->pMixer, pInput, pTrack->pSynth, pTrack->pSample) == 0)
+	{
+		pInput->fVolume = pTrack->fVolume;
+		pInput->fPanning = pTrack->fPanning;
+		pInput->nReleaseFrames = (int)(pTrack->fRelease * BM_SAMPLE_RATE);
+
+		if (pTrack->nPolyphony > 0)
+			pInput->nMaxVoices = pTrack->nPolyphony;
+
+		pTrack->pMixerInput = pInput;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineSetSample(BeatMachine* pBeatMachine, int nTrack, const char* szPath, const char* szSampleName)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+
+	if (pTrack)
+	{
+		BeatMachineTrackDetachMixer(pBeatMachine, pTrack);
+		BeatMachineTrackSetSample(pBeatMachine, pTrack, pBeatMachine->pArena, szPath, szSampleName);
+		BeatMachineTrackAttachMixer(pBeatMachine, pTrack, pBeatMachine->pArena);
+
+		// a stereo sample can't echo through a mono line
+		if (pTrack->delay)
+			BeatMachineTrackUpdateDelay(pBeatMachine, pBeatMachine->pTracks, pTrack, pBeatMachine->nBPM);
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackCreateVoice(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, SoundSequence* pSequence)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	int bCreateNew = FALSE;
+
+	if (pTrack->pChannel == NULL)
+	{
+		bCreateNew = TRUE;
+		pTrack->pChannel = pd->sound->channel->newChannel();
+	}
+
+	if (pTrack->pInstrument == NULL)
+		pTrack->pInstrument = pd->sound->instrument->newInstrument();
+
+	if (pTrack->pSynth == NULL)
+		pTrack->pSynth = pd->sound->synth->newSynth();
+
+	if (bCreateNew)
+	{
+		pd->sound->instrument->addVoice(pTrack->pInstrument, pTrack->pSynth, 24, 127, 0);
+
+		pd->sound->channel->addSource(pTrack->pChannel, (SoundSource*)pTrack->pInstrument);
+
+		pTrack->pTrack = pd->sound->sequence->addTrack(pSequence);
+		pd->sound->track->setInstrument(pTrack->pTrack, pTrack->pInstrument);
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+// The synth and the chord copies it has play pTable, copies made later get it
+// from the synth.
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackSetWavetable(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, BeatWavetable* pTable)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	pTrack->pWavetable = pTable;
+	BeatWavetableAttach(pd, pTrack->pSynth, pTable);
+
+	for (int v = 0; v < BM_CHORD_VOICE_COUNT; v++)
+	{
+		if (pTrack->pChordVoices[v])
+			BeatWavetableAttach(pd, pTrack->pChordVoices[v], pTable);
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+// A wavetable track's table, from its "harmonics" or else from the single cycle
+// wave file its "sample" names. With neither it is a sine.
+// --------------------------------------------------------------------------------
+static BeatWavetable* BeatMachineLoadWavetable(BeatMachine* pBeatMachine, BeatArena* pArena, const BMBTrack* pInfo)
+{
+	float fLevels[BMB_HARMONIC_COUNT];
+	int nCount = 0;
+
+	for (int k = 0; k < BMB_HARMONIC_COUNT; k++)
+	{
+		fLevels[k] = pInfo->nHarmonics[k] / 255.0f;
+		if (pInfo->nHarmonics[k])
+			nCount = k + 1;
+	}
+
+	BeatWavetable* pTable = NULL;
+	if (nCount == 0 && pInfo->szSampleName[0])
+		pTable = BeatWavetableLoad(pBeatMachine->pd, pArena, "samples/", pInfo->szSampleName);
+
+	return pTable ? pTable : BeatWavetableCreate(pArena, fLevels, nCount);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackCreateSynth(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, SoundSequence* pSequence, int nWaveFormIndex)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	if (nWaveFormIndex < 0 || nWaveFormIndex > BM_TYPE_WAVETABLE)
+		return;
+
+	BeatMachineTrackCreateVoice(pBeatMachine, pTrack, pSequence);
+
+	// a wavetable track plays the table it had, a sine until it gets one
+	if (nWaveFormIndex == BM_TYPE_WAVETABLE && pTrack->pWavetable)
+		BeatMachineTrackSetWavetable(pBeatMachine, pTrack, pTrack->pWavetable);
+	else
+		pd->sound->synth->setWaveform(pTrack->pSynth, nWaveFormIndex == BM_TYPE_WAVETABLE ? kWaveformSine : waveforms[nWaveFormIndex]);
+
+	BeatMachineTrackSetADSR(pBeatMachine, pTrack, 0.0f, .2f, .3f, .5f);
+
+	pTrack->nSoundSource = nWaveFormIndex;
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineCreateSynth(BeatMachine* pBeatMachine, int nTrack, int nWaveFormIndex)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrackSlot(pBeatMachine, nTrack);
+
+	if (pTrack)
+		BeatMachineTrackCreateSynth(pBeatMachine, pTrack, pBeatMachine->pSequence, nWaveFormIndex);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackCreateSampler(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, SoundSequence* pSequence)
+{
+	BeatMachineTrackCreateVoice(pBeatMachine, pTrack, pSequence);
+
+	pTrack->nSoundSource = BM_TYPE_SAMPLE;
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineCreateSampler(BeatMachine* pBeatMachine, int nTrack)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrackSlot(pBeatMachine, nTrack);
+
+	if (pTrack)
+		BeatMachineTrackCreateSampler(pBeatMachine, pTrack, pBeatMachine->pSequence);
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackSetChord(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, int bFlag)
+{
+	if (bFlag && !pTrack->bIsChordTrack)
+	{
+		pTrack->bIsChordTrack = bFlag;
+
+		// the notes it has stay single notes, only the ones added from now on are roots
+		pTrack->bKeepNotes = FALSE;
+		pTrack->nRootCount = 0;
+
+		// a mixed track takes its chord notes from the voice pool, the copies would copy the generator
+		if (pTrack->pMixerInput == NULL)
+			BeatMachineTrackAddChordVoices(pBeatMachine, pTrack);
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineSetChordTrack(BeatMachine* pBeatMachine, int nTrack, int bFlag)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+
+	if (pTrack)
+		BeatMachineTrackSetChord(pBeatMachine, pTrack, bFlag);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Mixed tracks only, a platform track plays one note at a time or a chord.
+// --------------------------------------------------------------------------------
+void BeatMachineSetTrackPolyphony(BeatMachine* pBeatMachine, int nTrack, int nVoices)
+{
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+	if (pTrack == NULL)
+		return;
+	pTrack->nPolyphony = nVoices;
+
+	if (pTrack->pMixerInput)
+		pTrack->pMixerInput->nMaxVoices = nVoices > 0 ? nVoices : BM_MIXER_DEFAULT_POLYPHONY;
+
+}
+
+
+// --------------------------------------------------------------------------------
+int BeatMachineFindSoundSource(const char* szWaveFormName)
+{
+	for (int i = 0; i < BM_MAX_SOUND_TYPE; i++)
+	{
+		if (strcmp(szSoundSrcType[i], szWaveFormName) == 0)
+			return i;
+	}
+
+	return -1;
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineCreateSynthByName(BeatMachine* pBeatMachine, int nTrack, const char* szWaveFormName)
+{
+	int nIndex = BeatMachineFindSoundSource(szWaveFormName);
+
+	if (nIndex != -1)
+		BeatMachineCreateSynth(pBeatMachine, nTrack, nIndex);
+}
+
+
+// --------------------------------------------------------------------------------
+// Makes the track a wavetable track playing pLevels, the level of the fundamental
+// first. The table comes from the arena of the playing beat and stays until the
+// next one, so this is for setting a sound up and not for sweeping it.
+// --------------------------------------------------------------------------------
+void BeatMachineSetHarmonics(BeatMachine* pBeatMachine, int nTrack, const float* pLevels, int nCount)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrackSlot(pBeatMachine, nTrack);
+	if (pTrack == NULL)
+		return;
+
+	// the table takes the synth's generator, a mixed sampler can't keep it
+	BeatMachineTrackDetachMixer(pBeatMachine, pTrack);
+
+	if (pTrack->nSoundSource != BM_TYPE_WAVETABLE)
+		BeatMachineTrackCreateSynth(pBeatMachine, pTrack, pBeatMachine->pSequence, BM_TYPE_WAVETABLE);
+
+	BeatMachineTrackSetWavetable(pBeatMachine, pTrack, BeatWavetableCreate(pBeatMachine->pArena, pLevels, nCount));
+}
+
+
+// --------------------------------------------------------------------------------
+// The same with the harmonics of a single cycle wave file, szPath + szWaveName
+// the way BeatMachineSetSample() takes a sample. A file that can't be used leaves
+// the track as it was.
+// --------------------------------------------------------------------------------
+void BeatMachineSetWavetable(BeatMachine* pBeatMachine, int nTrack, const char* szPath, const char* szWaveName)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrackSlot(pBeatMachine, nTrack);
+	if (pTrack == NULL)
+		return;
+
+	BeatWavetable* pTable = BeatWavetableLoad(pBeatMachine->pd, pBeatMachine->pArena, szPath, szWaveName);
+	if (pTable == NULL)
+		return;
+
+	BeatMachineTrackDetachMixer(pBeatMachine, pTrack);
+
+	if (pTrack->nSoundSource != BM_TYPE_WAVETABLE)
+		BeatMachineTrackCreateSynth(pBeatMachine, pTrack, pBeatMachine->pSequence, BM_TYPE_WAVETABLE);
+
+	BeatMachineTrackSetWavetable(pBeatMachine, pTrack, pTable);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackEnableFilter(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, int nType, int nFreq, float resonant, float mix)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	pTrack->bFilterEnabled = TRUE;
+	if (pTrack->filter == NULL)
+		pTrack->filter = pd->sound->effect->twopolefilter->newFilter();
+
+	pTrack->nFilterType = nType;
+	pd->sound->effect->twopolefilter->setType(pTrack->filter, (TwoPoleFilterType)nType);
+
+	pTrack->nFilterFreq = nFreq;
+	pd->sound->effect->twopolefilter->setFrequency(pTrack->filter, nFreq);
+
+	pTrack->fFilterResn = resonant;
+	pd->sound->effect->twopolefilter->setResonance(pTrack->filter, resonant);
+
+	pTrack->fFilterMix = mix;
+	pd->sound->effect->setMix(pTrack->filter, mix);
+
+	BeatMachineTrackChainEffects(pd, pTrack);
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineEnableFilter(BeatMachine* pBeatMachine, int nTrack, int nType, int nFreq, float resonant, float mix)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+
+	if (pTrack)
+	{
+		BeatMachineTrackDetachMixer(pBeatMachine, pTrack);
+		BeatMachineTrackEnableFilter(pBeatMachine, pTrack, nType, nFreq, resonant, mix);
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+// The echo is nDelaySteps long at nBPM, an eighth unless the track was given a
+// time. pTracks is the beat the track is in.
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackEnableDelay(BeatMachine* pBeatMachine, BeatMachineTrack** pTracks, BeatMachineTrack* pTrack, float feedback, float mix, int nBPM)
+{
+	pTrack->bDelayEnabled = TRUE;
+
+	if (pTrack->nDelaySteps == 0)
+		pTrack->nDelaySteps = BM_DELAY_EIGHTH;
+
+	pTrack->fDelayFeedback = feedback;
+	pTrack->fDelayMix = mix;
+
+	BeatMachineTrackUpdateDelay(pBeatMachine, pTracks, pTrack, nBPM);
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineEnableDelay(BeatMachine* pBeatMachine, int nTrack, float feedback, float mix)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+
+	if (pTrack)
+	{
+		BeatMachineTrackDetachMixer(pBeatMachine, pTrack);
+		BeatMachineTrackEnableDelay(pBeatMachine, pBeatMachine->pTracks, pTrack, feedback, mix, pBeatMachine->nBPM);
+	}
+}
+
+
+// --------------------------------------------------------------------------------
+// nSteps is BM_DELAY_SIXTEENTH up to BM_DELAY_QUARTER, it follows the tempo from
+// then on. A frozen track keeps the echo it was frozen with until it is frozen
+// again.
+// --------------------------------------------------------------------------------
+void BeatMachineSetDelayTime(BeatMachine* pBeatMachine, int nTrack, int nSteps)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+	if (pTrack == NULL)
+		return;
+
+	pTrack->nDelaySteps = nSteps < 1 ? 1 : (nSteps > BM_DELAY_MAX_STEPS ? BM_DELAY_MAX_STEPS : nSteps);
+
+	if (pTrack->delay)
+		BeatMachineTrackUpdateDelay(pBeatMachine, pBeatMachine->pTracks, pTrack, pBeatMachine->nBPM);
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackEnableBitCrusher(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, float amount, float mix)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	pTrack->bBitCrusherEnabled = TRUE;
+	if (pTrack->bitCrusher == NULL)
+		pTrack->bitCrusher = pd->sound->effect->bitcrusher->newBitCrusher();
+	pd->sound->effect->bitcrusher->setAmount(pTrack->bitCrusher, 0.5f);
+	pd->sound->effect->setMix(pTrack->bitCrusher, 0.5f);
+
+	pTrack->fBitcrusherAmount = amount;
+	pd->sound->effect->bitcrusher->setAmount(pTrack->bitCrusher, amount);
+
+	pTrack->fBitcrusherMix = mix;
+	pd->sound->effect->setMix(pTrack->bitCrusher, mix);
+
+	BeatMachineTrackChainEffects(pd, pTrack);
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineEnableBitCrusher(BeatMachine* pBeatMachine, int nTrack, float amount, float mix)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+
+	if (pTrack)
+	{
+		BeatMachineTrackDetachMixer(pBeatMachine, pTrack);
+		BeatMachineTrackEnableBitCrusher(pBeatMachine, pTrack, amount, mix);
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+// The buses are made on first use and stay with the machine from beat to beat.
+// Made after the tracks of the playing beat, the bus plays after the channels
+// that feed it.
+// --------------------------------------------------------------------------------
+static BeatBus* BeatMachineGetBus(BeatMachine* pBeatMachine, int nBus)
+{
+	if (pBeatMachine->pBuses[nBus] == NULL)
+		pBeatMachine->pBuses[nBus] = BeatBusCreate(pBeatMachine->pd, nBus);
+
+	return pBeatMachine->pBuses[nBus];
+}
+
+
+// --------------------------------------------------------------------------------
+// nSteps is a BM_DELAY_* time like a track delay, it follows the tempo too.
+// fReturn is the level the echoes play at.
+// --------------------------------------------------------------------------------
+void BeatMachineSetDelayBus(BeatMachine* pBeatMachine, int nSteps, float fFeedback, float fReturn)
+{
+	if (pBeatMachine == NULL)
+		return;
+
+	BeatBus* pBus = BeatMachineGetBus(pBeatMachine, BM_BUS_DELAY);
+
+	pBeatMachine->nBusDelaySteps = nSteps < 1 ? 1 : (nSteps > BM_DELAY_MAX_STEPS ? BM_DELAY_MAX_STEPS : nSteps);
+
+	BeatBusSetDelay(pBus, BeatMachineDelayFrames(pBeatMachine->nBusDelaySteps, pBeatMachine->nBPM), fFeedback);
+	BeatBusSetReturn(pBus, fReturn);
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineSetFilterBus(BeatMachine* pBeatMachine, int nType, int nFreq, float fResonance, float fReturn)
+{
+	if (pBeatMachine == NULL)
+		return;
+
+	BeatBus* pBus = BeatMachineGetBus(pBeatMachine, BM_BUS_FILTER);
+
+	BeatBusSetFilter(pBus, nType, nFreq, fResonance);
+	BeatBusSetReturn(pBus, fReturn);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Sends a track of the playing beat to BM_BUS_DELAY or BM_BUS_FILTER at fLevel,
+// after its own effects and volume. 0 stops sending. A track on the beat mixer
+// moves to its own channel for it.
+// --------------------------------------------------------------------------------
+void BeatMachineSetSend(BeatMachine* pBeatMachine, int nTrack, int nBus, float fLevel)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+	if (pTrack == NULL || nBus < 0 || nBus >= BM_BUS_COUNT)
+		return;
+
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	BeatMachineTrackDetachMixer(pBeatMachine, pTrack);
+
+	BeatBusSendSetLevel(pd, &pTrack->send, BeatMachineGetBus(pBeatMachine, nBus), nBus, fLevel);
+	BeatBusSendSetGain(&pTrack->send, pTrack->fVolume);
+	BeatMachineTrackChainEffects(pd, pTrack);
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackSetVolume(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, float fVolume)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	pTrack->fVolume = fVolume;
+
+	pd->sound->channel->setVolume(pTrack->pChannel, fVolume);
+	BeatBusSendSetGain(&pTrack->send, fVolume);
+
+	if (pTrack->pMixerInput)
+		pTrack->pMixerInput->fVolume = fVolume;
+
+	if (pTrack->pFrozen)
+		pd->sound->channel->setVolume(pTrack->pFrozen->pChannel, fVolume);
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineSetVolume(BeatMachine* pBeatMachine, int nTrack, float fVolume)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+	if (pTrack == NULL)
+		return;
+
+	BeatMachineTrackSetVolume(pBeatMachine, pTrack, fVolume);
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackSetPanning(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, float fValue)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	pTrack->fPanning = fValue;
+	pd->sound->channel->setPan(pTrack->pChannel, fValue);
+
+	if (pTrack->pMixerInput)
+		pTrack->pMixerInput->fPanning = fValue;
+
+	if (pTrack->pFrozen)
+		pd->sound->channel->setPan(pTrack->pFrozen->pChannel, fValue);
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineSetPanning(BeatMachine* pBeatMachine, int nTrack, float fValue)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+	if (pTrack == NULL)
+		return;
+
+	BeatMachineTrackSetPanning(pBeatMachine, pTrack, fValue);
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackMute(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, int bFlag)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	pTrack->bMuted = bFlag;
+	pd->sound->track->setMuted(pTrack->pTrack, bFlag);
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineMuteTrack(BeatMachine* pBeatMachine, int nTrack, int bFlag)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+	if (pTrack == NULL)
+		return;
+
+	BeatMachineTrackMute(pBeatMachine, pTrack, bFlag);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackFreezeVoice(BeatMachineTrack* pTrack, BeatFreezeVoice* pVoice, int nBPM)
+{
+	memset(pVoice, 0, sizeof(BeatFreezeVoice));
+
+	// anything that is not a platform oscillator is turned down by the freeze
+	pVoice->nWaveform = (pTrack->nSoundSource > BM_TYPE_SAMPLE && pTrack->nSoundSource < BM_TYPE_WAVETABLE) ? waveforms[pTrack->nSoundSource] : (SoundWaveform)-1;
+
+	pVoice->fAttack = pTrack->fAttack;
+	pVoice->fDecay = pTrack->fDecay;
+	pVoice->fSustain = pTrack->fSustain;
+	pVoice->fRelease = pTrack->fRelease;
+
+	pVoice->bFilter = pTrack->bFilterEnabled;
+	pVoice->nFilterType = pTrack->nFilterType;
+	pVoice->fFilterFrequency = (float)pTrack->nFilterFreq;
+	pVoice->fFilterResonance = pTrack->fFilterResn;
+	pVoice->fFilterMix = pTrack->fFilterMix;
+
+	pVoice->bCrusher = pTrack->bBitCrusherEnabled;
+	pVoice->fCrusherAmount = pTrack->fBitcrusherAmount;
+	pVoice->fCrusherMix = pTrack->fBitcrusherMix;
+
+	// the echo the track plays, none when the pool had no line for it
+	pVoice->bDelay = pTrack->bDelayEnabled && pTrack->delay;
+	pVoice->nDelayFrames = BeatMachineDelayFrames(pTrack->nDelaySteps, nBPM);
+	pVoice->fDelayFeedback = pTrack->fDelayFeedback;
+	pVoice->fDelayMix = pTrack->fDelayMix;
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Renders the notes of a synth track at nBPM and plays them from samples from then
+// on. The frozen channel gets the track's volume, panning and sends.
+// --------------------------------------------------------------------------------
+static int BeatMachineTrackFreeze(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, int nBPM)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	if (pTrack->pFrozen)
+		return BM_FREEZE_OK;
+
+	if (pTrack->pTrack == NULL)
+		return BM_FREEZE_UNSUPPORTED;
+
+	BeatFreezeVoice voice;
+	BeatMachineTrackFreezeVoice(pTrack, &voice, nBPM);
+
+	int nError = BM_FREEZE_OK;
+	pTrack->pFrozen = BeatFreezeTrack(pd, pTrack->pTrack, &voice, BeatMachineFramesPerStep(nBPM), &nError);
+
+	if (pTrack->pFrozen)
+	{
+		pd->sound->channel->setVolume(pTrack->pFrozen->pChannel, pTrack->fVolume);
+		pd->sound->channel->setPan(pTrack->pFrozen->pChannel, pTrack->fPanning);
+		BeatBusSendAttach(pd, &pTrack->send, pTrack->pFrozen->pChannel);
+	}
+
+	return nError;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackThaw(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack)
+{
+	if (pTrack->pFrozen == NULL)
+		return;
+
+	// the tap comes off the frozen channel before it goes
+	BeatBusSendDetach(pBeatMachine->pd, &pTrack->send);
+
+	BeatFreezeThaw(pTrack->pFrozen, pTrack->pTrack, pTrack->pInstrument);
+	pTrack->pFrozen = NULL;
+
+	BeatBusSendAttach(pBeatMachine->pd, &pTrack->send, pTrack->pChannel);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Freezes a synth track of the playing beat. Returns BM_FREEZE_OK or why it can't
+// be done. A frozen track doesn't follow changes to its envelope or effects until
+// it is frozen again, the tempo, scale and key do refreeze it.
+// --------------------------------------------------------------------------------
+int BeatMachineFreezeTrack(BeatMachine* pBeatMachine, int nTrack)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+	if (pTrack == NULL)
+		return BM_FREEZE_UNSUPPORTED;
+
+	// a frozen track is rendered again, its sound may have changed since
+	BeatMachineTrackThaw(pBeatMachine, pTrack);
+
+	return BeatMachineTrackFreeze(pBeatMachine, pTrack, pBeatMachine->nBPM);
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineUnfreezeTrack(BeatMachine* pBeatMachine, int nTrack)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+
+	if (pTrack)
+		BeatMachineTrackThaw(pBeatMachine, pTrack);
+}
+
+
+// --------------------------------------------------------------------------------
+// What freezing the track costs and saves. A frozen track gives the real figures
+// with the time the render took, any other an estimate without rendering.
+// --------------------------------------------------------------------------------
+int BeatMachineGetFreezeCost(BeatMachine* pBeatMachine, int nTrack, BeatFreezeCost* pCost)
+{
+	memset(pCost, 0, sizeof(BeatFreezeCost));
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+	if (pTrack == NULL)
+		return BM_FREEZE_UNSUPPORTED;
+
+	if (pTrack->pFrozen)
+	{
+		*pCost = pTrack->pFrozen->cost;
+		return BM_FREEZE_OK;
+	}
+
+	BeatFreezeVoice voice;
+	BeatMachineTrackFreezeVoice(pTrack, &voice, pBeatMachine->nBPM);
+
+	return BeatFreezeMeasure(pBeatMachine->pd, pTrack->pTrack, &voice, BeatMachineFramesPerStep(pBeatMachine->nBPM), pCost);
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineSetBPM(BeatMachine* pBeatMachine, int nBPM)
+{
+	if (pBeatMachine && pBeatMachine->pSequence)
+	{
+		PlaydateAPI* pd = pBeatMachine->pd;
+
+		pd->sound->sequence->setTempo(pBeatMachine->pSequence, BeatMachineStepsPerSecond(nBPM));
+
+		if (nBPM != pBeatMachine->nBPM)
+			BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+		// the echoes move with the tempo inside the lines they have
+		for (int i = 0; i < BM_MAX_TRACK; i++)
+		{
+			BeatMachineTrack* pTrack = pBeatMachine->pTracks[i];
+			if (pTrack && pTrack->delay)
+				BeatDelaySetLength(pTrack->delay, BeatMachineDelayFrames(pTrack->nDelaySteps, nBPM));
+		}
+
+		if (pBeatMachine->pBuses[BM_BUS_DELAY])
+			BeatBusSetDelayLength(pBeatMachine->pBuses[BM_BUS_DELAY], BeatMachineDelayFrames(pBeatMachine->nBusDelaySteps, nBPM));
+
+		// frozen notes are as long as the old tempo made them
+		for (int i = 0; i < BM_MAX_TRACK && nBPM != pBeatMachine->nBPM; i++)
+		{
+			BeatMachineTrack* pTrack = pBeatMachine->pTracks[i];
+			if (pTrack && pTrack->pFrozen)
+			{
+				BeatMachineTrackThaw(pBeatMachine, pTrack);
+				BeatMachineTrackFreeze(pBeatMachine, pTrack, nBPM);
+			}
+		}
+
+		pBeatMachine->nBPM = nBPM;
+	}
+
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Notes mostly come in step order and go on the end, one for an earlier step is
+// moved in after the last root on or before its step.
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackKeepRoot(BeatMachineTrack* pTrack, BeatArena* pArena, int nStep, int nLen, int nPitch, float fVelocity)
+{
+	if (pTrack->nRootCount == pTrack->nRootCapacity)
+	{
+		// an arena block can't grow, the old array stays behind until the beat is unloaded
+		int nCapacity = pTrack->nRootCapacity ? pTrack->nRootCapacity * 2 : BM_ROOT_BLOCK;
+		BeatRootNote* pRoots = BeatArenaAlloc(pArena, nCapacity * sizeof(BeatRootNote));
+
+		if (pTrack->nRootCount)
+			memcpy(pRoots, pTrack->pRoots, pTrack->nRootCount * sizeof(BeatRootNote));
+
+		pTrack->pRoots = pRoots;
+		pTrack->nRootCapacity = nCapacity;
+	}
+
+	int nIndex = pTrack->nRootCount;
+	while (nIndex > 0 && pTrack->pRoots[nIndex - 1].nStep > nStep)
+		nIndex--;
+
+	if (nIndex < pTrack->nRootCount)
+		memmove(&pTrack->pRoots[nIndex + 1], &pTrack->pRoots[nIndex], (pTrack->nRootCount - nIndex) * sizeof(BeatRootNote));
+
+	pTrack->nRootCount++;
+
+	BeatRootNote* pRoot = &pTrack->pRoots[nIndex];
+	pRoot->nStep = (uint16_t)nStep;
+	pRoot->nLen = (uint8_t)nLen;
+	pRoot->nPitch = nPitch;
+	pRoot->fVelocity = fVelocity;
+
+}
+
+
+// --------------------------------------------------------------------------------
+static int BeatMachineTrackAddNote(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, ScaleManager* pScaleManager, BeatArena* pArena, int nStep, int nLen, int nPitch, float fVelocity)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	if (!pTrack->bIsChordTrack)
+	{
+		if (pTrack->bKeepNotes)
+			BeatMachineTrackKeepRoot(pTrack, pArena, nStep, nLen, nPitch, fVelocity);
+
+		pd->sound->track->addNoteEvent(pTrack->pTrack, nStep, nLen, nPitch, fVelocity);
+		return 1;
+	}
+
+	BeatMachineTrackKeepRoot(pTrack, pArena, nStep, nLen, nPitch, fVelocity);
+
+	int nPitches[SCALE_CHORD_MAX_NOTES];
+	int nCount = ScaleManagerGetChord(pScaleManager, nPitch, pTrack->nChordType, pTrack->nChordInversion, nPitches);
+
+	for (int i = 0; i < nCount; i++)
+		pd->sound->track->addNoteEvent(pTrack->pTrack, nStep, nLen, nPitches[i], fVelocity);
+
+	return nCount;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineMarkNote(BeatOccupancy* pOccupancy, int nTrack, int nStep)
+{
+	if (nStep < 0 || nStep >= BM_MAX_STEP_COUNT)
+		return;
+
+	uint16_t nBit = (uint16_t)(1 << nTrack);
+
+	pOccupancy->nStepTracks[nStep] |= nBit;
+	pOccupancy->nBarTracks[nStep / BM_STEPS_PER_BAR] |= nBit;
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineAddNote(BeatMachine* pBeatMachine, int nTrack, int nStep, int nLen, int nPitch, float fVelocity)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+	if (pTrack == NULL)
+		return;
+
+	// a frozen track gets the note live and is rendered again with it
+	int bFrozen = pTrack->pFrozen != NULL;
+	BeatMachineTrackThaw(pBeatMachine, pTrack);
+
+	BeatMachineTrackAddNote(pBeatMachine, pTrack, pBeatMachine->pScaleManager, pBeatMachine->pArena, nStep, nLen, nPitch, fVelocity);
+
+	if (bFrozen)
+		BeatMachineTrackFreeze(pBeatMachine, pTrack, pBeatMachine->nBPM);
+
+	// the note goes at the end of its track, the tracks after it move up by one
+	BeatOccupancy* pOccupancy = pBeatMachine->pOccupancy;
+	BeatMachineMarkNote(pOccupancy, nTrack, nStep);
+
+	for (int i = nTrack + 1; i <= BM_MAX_TRACK; i++)
+		pOccupancy->nNoteOffsets[i]++;
+
+	int nLength = nStep + nLen;
+	if (nLength > pBeatMachine->nBeatLength)
+		pBeatMachine->nBeatLength = nLength;
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Bit t of the result is set when track t starts a note on nStep.
+// --------------------------------------------------------------------------------
+int BeatMachineGetTracksAtStep(BeatMachine* pBeatMachine, int nStep)
+{
+	if (pBeatMachine == NULL || nStep < 0 || nStep >= BM_MAX_STEP_COUNT)
+		return 0;
+
+	return pBeatMachine->pOccupancy->nStepTracks[nStep];
+}
+
+
+// --------------------------------------------------------------------------------
+// The tracks that start a note anywhere from nFirstStep up to nEndStep, whole bars
+// in between are one lookup each.
+// --------------------------------------------------------------------------------
+int BeatMachineGetTracksInRange(BeatMachine* pBeatMachine, int nFirstStep, int nEndStep)
+{
+	if (pBeatMachine == NULL)
+		return 0;
+
+	if (nFirstStep < 0)
+		nFirstStep = 0;
+
+	if (nEndStep > BM_MAX_STEP_COUNT)
+		nEndStep = BM_MAX_STEP_COUNT;
+
+	const BeatOccupancy* pOccupancy = pBeatMachine->pOccupancy;
+	int nTracks = 0;
+	int nStep = nFirstStep;
+
+	while (nStep < nEndStep)
+	{
+		if (nStep % BM_STEPS_PER_BAR == 0 && nStep + BM_STEPS_PER_BAR <= nEndStep)
+		{
+			nTracks |= pOccupancy->nBarTracks[nStep / BM_STEPS_PER_BAR];
+			nStep += BM_STEPS_PER_BAR;
+		}
+		else
+		{
+			nTracks |= pOccupancy->nStepTracks[nStep];
+			nStep++;
+		}
+	}
+
+	return nTracks;
+}
+
+
+// --------------------------------------------------------------------------------
+// Returns how many notes the track has, *pFirstNote gets the number of its first
+// one in the beat.
+// --------------------------------------------------------------------------------
+int BeatMachineGetTrackNotes(BeatMachine* pBeatMachine, int nTrack, int* pFirstNote)
+{
+	if (pBeatMachine == NULL || nTrack < 0 || nTrack >= BM_MAX_TRACK)
+		return 0;
+
+	const BeatOccupancy* pOccupancy = pBeatMachine->pOccupancy;
+
+	if (pFirstNote)
+		*pFirstNote = pOccupancy->nNoteOffsets[nTrack];
+
+	return pOccupancy->nNoteOffsets[nTrack + 1] - pOccupancy->nNoteOffsets[nTrack];
+}
+
+
+// --------------------------------------------------------------------------------
+// The events a root is written as, the chord of a chord track or the note itself.
+// --------------------------------------------------------------------------------
+static int BeatMachineTrackRootTones(const BeatMachineTrack* pTrack, ScaleManager* pScaleManager, int nType, int nInversion, int nPitch, int* pTones)
+{
+	nPitch = nPitch < 0 ? 0 : (nPitch > 127 ? 127 : nPitch);
+
+	if (!pTrack->bIsChordTrack)
+	{
+		pTones[0] = nPitch;
+		return 1;
+	}
+
+	return ScaleManagerGetChord(pScaleManager, nPitch, nType, nInversion, pTones);
+}
+
+
+// --------------------------------------------------------------------------------
+// Moves the roots of a track from the old scale and voicing to the current ones
+// and by nTranspose. A step whose tones all stay is not touched, so most of the
+// track plays on undisturbed. Any other step has all its events taken off and
+// written again, two roots sharing a tone can't take each other's event.
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackRewriteRoots(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, ScaleManager* pOldScale, int nOldType, int nOldInversion, int nTranspose)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+	ScaleManager* pScaleManager = pBeatMachine->pScaleManager;
+	BeatRootNote* pRoots = pTrack->pRoots;
+
+	// the frozen events are on keys and not on pitches, the roots are written live
+	int bFrozen = pTrack->pFrozen != NULL;
+	BeatMachineTrackThaw(pBeatMachine, pTrack);
+
+	int nFirst = 0;
+	while (nFirst < pTrack->nRootCount)
+	{
+		int nStep = pRoots[nFirst].nStep;
+
+		int nEnd = nFirst + 1;
+		while (nEnd < pTrack->nRootCount && pRoots[nEnd].nStep == nStep)
+			nEnd++;
+
+		int bMoved = FALSE;
+		for (int r = nFirst; r < nEnd && !bMoved; r++)
+		{
+			int nOld[SCALE_CHORD_MAX_NOTES];
+			int nNew[SCALE_CHORD_MAX_NOTES];
+			int nOldCount = BeatMachineTrackRootTones(pTrack, pOldScale, nOldType, nOldInversion, pRoots[r].nPitch, nOld);
+			int nNewCount = BeatMachineTrackRootTones(pTrack, pScaleManager, pTrack->nChordType, pTrack->nChordInversion, pRoots[r].nPitch + nTranspose, nNew);
+
+			bMoved = nOldCount != nNewCount || memcmp(nOld, nNew, nOldCount * sizeof(int)) != 0;
+		}
+
+		if (bMoved)
+		{
+			for (int r = nFirst; r < nEnd; r++)
+			{
+				int nOld[SCALE_CHORD_MAX_NOTES];
+				int nOldCount = BeatMachineTrackRootTones(pTrack, pOldScale, nOldType, nOldInversion, pRoots[r].nPitch, nOld);
+
+				for (int o = 0; o < nOldCount; o++)
+					pd->sound->track->removeNoteEvent(pTrack->pTrack, nStep, nOld[o]);
+			}
+
+			for (int r = nFirst; r < nEnd; r++)
 			{
-				BeatMachineCreateSampler(decodeData.nTrack);
+				int nNew[SCALE_CHORD_MAX_NOTES];
+				int nNewCount = BeatMachineTrackRootTones(pTrack, pScaleManager, pTrack->nChordType, pTrack->nChordInversion, pRoots[r].nPitch + nTranspose, nNew);
+
+				for (int n = 0; n < nNewCount; n++)
+					pd->sound->track->addNoteEvent(pTrack->pTrack, nStep, pRoots[r].nLen, nNew[n], pRoots[r].fVelocity);
 			}
-			else
+		}
+
+		for (int r = nFirst; r < nEnd; r++)
+			pRoots[r].nPitch += nTranspose;
+
+		nFirst = nEnd;
+	}
+
+	if (bFrozen)
+		BeatMachineTrackFreeze(pBeatMachine, pTrack, pBeatMachine->nBPM);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Moves every note of a melodic track. The first time its notes are read out of
+// the events into the beat's arena, from then on the track keeps them like the
+// roots of a chord track and only writes the steps that move.
+// --------------------------------------------------------------------------------
+static void BeatMachineTrackTranspose(BeatMachine* pBeatMachine, BeatMachineTrack* pTrack, int nSemitones)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	// the frozen events are on keys, the notes are read from the live ones
+	int bFrozen = pTrack->pFrozen != NULL;
+	BeatMachineTrackThaw(pBeatMachine, pTrack);
+
+	if (!pTrack->bKeepNotes)
+	{
+		int nCount = 0;
+		while (pd->sound->track->getNoteAtIndex(pTrack->pTrack, nCount, NULL, NULL, NULL, NULL))
+			nCount++;
+
+		if (nCount > pTrack->nRootCapacity)
+		{
+			pTrack->pRoots = BeatArenaAlloc(pBeatMachine->pArena, nCount * sizeof(BeatRootNote));
+			pTrack->nRootCapacity = nCount;
+		}
+
+		pTrack->nRootCount = 0;
+
+		for (int i = 0; i < nCount; i++)
+		{
+			uint32_t nStep = 0;
+			uint32_t nLen = 0;
+			MIDINote note = 0;
+			float fVelocity = 0.0f;
+			pd->sound->track->getNoteAtIndex(pTrack->pTrack, i, &nStep, &nLen, &note, &fVelocity);
+
+			BeatMachineTrackKeepRoot(pTrack, pBeatMachine->pArena, nStep, nLen, (int)note, fVelocity);
+		}
+
+		pTrack->bKeepNotes = TRUE;
+	}
+
+	BeatMachineTrackRewriteRoots(pBeatMachine, pTrack, pBeatMachine->pScaleManager, pTrack->nChordType, pTrack->nChordInversion, nSemitones);
+
+	if (bFrozen)
+		BeatMachineTrackFreeze(pBeatMachine, pTrack, pBeatMachine->nBPM);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Re-voices the chords already in the track as well as the ones added later.
+// --------------------------------------------------------------------------------
+void BeatMachineSetChordVoicing(BeatMachine* pBeatMachine, int nTrack, int nChordType, int nInversion)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	BeatMachineTrack* pTrack = BeatMachineGetTrack(pBeatMachine, nTrack);
+	if (pTrack == NULL)
+		return;
+
+	int nOldType = pTrack->nChordType;
+	int nOldInversion = pTrack->nChordInversion;
+
+	pTrack->nChordType = nChordType == SCALE_CHORD_SEVENTH ? SCALE_CHORD_SEVENTH : SCALE_CHORD_TRIAD;
+	pTrack->nChordInversion = nInversion;
+
+	// a seventh needs one more platform voice
+	if (pTrack->pMixerInput == NULL)
+		BeatMachineTrackAddChordVoices(pBeatMachine, pTrack);
+
+	if (pTrack->bIsChordTrack)
+		BeatMachineTrackRewriteRoots(pBeatMachine, pTrack, pBeatMachine->pScaleManager, nOldType, nOldInversion, 0);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Changes the scale of the playing beat without reloading it. Chord tracks keep
+// their roots and get the chords of the new scale, nothing else changes.
+// --------------------------------------------------------------------------------
+void BeatMachineSetScale(BeatMachine* pBeatMachine, int nScale, int nRoot)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	if (pBeatMachine == NULL || nScale < 0 || nScale >= SCALE_COUNT || nRoot < 0 || nRoot >= NOTE_COUNT)
+		return;
+
+	ScaleManager oldScale = *pBeatMachine->pScaleManager;
+	SetupScale(pBeatMachine->pScaleManager, nScale, nRoot);
+
+	for (int i = 0; i < BM_MAX_TRACK; i++)
+	{
+		BeatMachineTrack* pTrack = pBeatMachine->pTracks[i];
+		if (pTrack && pTrack->pTrack && pTrack->bIsChordTrack)
+			BeatMachineTrackRewriteRoots(pBeatMachine, pTrack, &oldScale, pTrack->nChordType, pTrack->nChordInversion, 0);
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Moves the key of the playing beat. Synth and chord tracks are transposed, the
+// scale root moves with them, sampler tracks are drums and stay where they are.
+// --------------------------------------------------------------------------------
+void BeatMachineTranspose(BeatMachine* pBeatMachine, int nSemitones)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	if (pBeatMachine == NULL || nSemitones == 0)
+		return;
+
+	ScaleManager* pScaleManager = pBeatMachine->pScaleManager;
+	ScaleManager oldScale = *pScaleManager;
+
+	int nRoot = ((pScaleManager->nNoteIndex + nSemitones) % NOTE_COUNT + NOTE_COUNT) % NOTE_COUNT;
+	SetupScale(pScaleManager, pScaleManager->nCurrentScale, nRoot);
+
+	for (int i = 0; i < BM_MAX_TRACK; i++)
+	{
+		BeatMachineTrack* pTrack = pBeatMachine->pTracks[i];
+		if (pTrack == NULL || pTrack->pTrack == NULL)
+			continue;
+
+		if (pTrack->bIsChordTrack)
+			BeatMachineTrackRewriteRoots(pBeatMachine, pTrack, &oldScale, pTrack->nChordType, pTrack->nChordInversion, nSemitones);
+		else if (pTrack->nSoundSource != BM_TYPE_SAMPLE)
+			BeatMachineTrackTranspose(pBeatMachine, pTrack, nSemitones);
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+void decodeError(json_decoder* decoder, const char* error, int linenum)
+{
+	BeatLoadContext* pLoad = decoder->userdata;
+	PlaydateAPI* pd = pLoad->pd;
+
+	pd->system->logToConsole("decode error line %i: %s", linenum, error);
+}
+
+
+// --------------------------------------------------------------------------------
+// szSource cut to a field of nSize bytes, always terminated
+// --------------------------------------------------------------------------------
+static void BeatMachineCopyField(char* szDest, const char* szSource, int nSize)
+{
+	int nLength = (int)strlen(szSource);
+	if (nLength > nSize - 1)
+		nLength = nSize - 1;
+
+	memcpy(szDest, szSource, nLength);
+	szDest[nLength] = '\0';
+
+}
+
+
+// --------------------------------------------------------------------------------
+const char* typeToName(json_value_type type)
+{
+	switch (type)
+	{
+	case kJSONNull: return "null";
+	case kJSONTrue: return "true";
+	case kJSONFalse: return "false";
+	case kJSONInteger: return "integer";
+	case kJSONFloat: return "float";
+	case kJSONString: return "string";
+	case kJSONArray: return "array";
+	case kJSONTable: return "table";
+	default: return "???";
+	}
+}
+
+
+// --------------------------------------------------------------------------------
+// The decoder only stages the beat into the load context, tracks and notes are
+// built later by BeatMachineStepLoad() so that work can be spread over frames.
+// --------------------------------------------------------------------------------
+void willDecodeSublist(json_decoder* decoder, const char* name, json_value_type type)
+{
+	BeatLoadContext* pLoad = decoder->userdata;
+	DecodeData* pDecode = &pLoad->decodeData;
+
+	switch (BeatKeyLookup(name))
+	{
+	case BEAT_KEY_BEAT:
+		pDecode->nLoadStates[pDecode->nStateCount++] = LOAD_STATE_HEADER;
+		break;
+
+	case BEAT_KEY_TRACKS:
+		pDecode->nLoadStates[pDecode->nStateCount++] = LOAD_STATE_TRACK_INFO;
+		break;
+
+	case BEAT_KEY_ENV:
+		pDecode->nLoadStates[pDecode->nStateCount++] = LOAD_STATE_ENVOLOPE;
+		break;
+
+	case BEAT_KEY_LOOP:
+		pDecode->nLoadStates[pDecode->nStateCount++] = LOAD_STATE_LOOP;
+		break;
+
+	case BEAT_KEY_FILTER:
+	case BEAT_KEY_LPF:
+		pDecode->nLoadStates[pDecode->nStateCount++] = LOAD_STATE_FILTER;
+		break;
+
+	case BEAT_KEY_DELAY:
+		pDecode->nLoadStates[pDecode->nStateCount++] = LOAD_STATE_DELAY;
+		break;
+
+	case BEAT_KEY_BITCRUSH:
+		pDecode->nLoadStates[pDecode->nStateCount++] = LOAD_STATE_BITCRUSHER;
+		break;
+
+	case BEAT_KEY_NOTES:
+		pDecode->nLoadStates[pDecode->nStateCount++] = LOAD_STATE_NOTES;
+		pLoad->tracks[pDecode->nTrack].nFirstNote = pLoad->header.nNoteCount;
+		pLoad->tracks[pDecode->nTrack].nNoteCount = 0;
+		break;
+
+	case BEAT_KEY_LABELS:
+		pDecode->nLoadStates[pDecode->nStateCount++] = LOAD_STATE_LABELS;
+		break;
+
+	case BEAT_KEY_SCALE:
+		pDecode->nLoadStates[pDecode->nStateCount++] = LOAD_STATE_SCALE;
+		memset(pDecode->szBuffer, 0, 128);
+		memset(pDecode->szBufferSmall, 0, 32);
+		break;
+
+	case BEAT_KEY_OPTIONS:
+		pDecode->nLoadStates[pDecode->nStateCount++] = LOAD_STATE_OPTIONS;
+		break;
+
+	case BEAT_KEY_HARMONICS:
+		pDecode->nLoadStates[pDecode->nStateCount++] = LOAD_STATE_HARMONICS;
+		memset(pLoad->tracks[pDecode->nTrack].nHarmonics, 0, BMB_HARMONIC_COUNT);
+		pDecode->nValue = 0;
+		break;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+int shouldDecodeTableValueForKey(json_decoder* decoder, const char* key)
+{
+
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+void didDecodeTableValue(json_decoder* decoder, const char* key, json_value value)
+{
+	BeatLoadContext* pLoad = decoder->userdata;
+	DecodeData* pDecode = &pLoad->decodeData;
+
+	// one hash per key, then every state switches on the key id
+	int nKey = BeatKeyLookup(key);
+
+	if (pDecode->nLoadStates[pDecode->nStateCount - 1] == LOAD_STATE_TRACK_INFO)
+	{
+		BMBTrack* pInfo = &pLoad->tracks[pDecode->nTrack];
+
+		switch (nKey)
+		{
+		case BEAT_KEY_ID:
+		{
+			int nTrack = json_intValue(value);
+			if (nTrack < 0 || nTrack >= BM_MAX_TRACK)
+				nTrack = 0;
+
+			pDecode->nTrack = nTrack;
+
+			pLoad->bTrackUsed[nTrack] = TRUE;
+			pLoad->tracks[nTrack].nId = nTrack;
+			break;
+		}
+
+		case BEAT_KEY_NAME:
+			strncpy(pInfo->szTrackName, json_stringValue(value), BMB_NAME_SIZE - 1);
+			break;
+
+		case BEAT_KEY_VOL:
+			pInfo->fVolume = json_floatValue(value);
+			break;
+
+		case BEAT_KEY_PAN:
+			pInfo->fPanning = json_floatValue(value);
+			break;
+
+		case BEAT_KEY_COLOR:
+			pInfo->nColour = json_intValue(value);
+			break;
+
+		case BEAT_KEY_SAMPLE:
+			strncpy(pInfo->szSampleName, json_stringValue(value), BMB_SAMPLE_SIZE - 1);
+			break;
+
+		case BEAT_KEY_TYPE:
+		{
+			int nIndex = BeatMachineFindSoundSource(json_stringValue(value));
+			if (nIndex != -1)
+				pInfo->nSoundSource = nIndex;
+			break;
+		}
+
+		case BEAT_KEY_MUTE:
+			pInfo->bMuted = json_intValue(value);
+			break;
+
+		case BEAT_KEY_CHORD:
+			pInfo->bIsChordTrack = json_intValue(value);
+			break;
+		}
+
+	}
+	else if (pDecode->nLoadStates[pDecode->nStateCount - 1] == LOAD_STATE_NOTES)
+	{
+		switch (nKey)
+		{
+		case BEAT_KEY_STEP:		pDecode->nStep = json_intValue(value);				break;
+		case BEAT_KEY_PITCH:	pDecode->note.pitch = json_intValue(value);			break;
+		case BEAT_KEY_LEN:		pDecode->note.len = json_intValue(value);			break;
+		case BEAT_KEY_VEL:		pDecode->note.velocity = json_floatValue(value);	break;
+		}
+	}
+	else if (pDecode->nLoadStates[pDecode->nStateCount - 1] == LOAD_STATE_HEADER)
+	{
+		switch (nKey)
+		{
+		case BEAT_KEY_VER:		pLoad->header.nFileVersion = json_intValue(value);	break;
+		case BEAT_KEY_BPM:		pLoad->header.nBPM = json_intValue(value);			break;
+		}
+
+	}
+	else if (pDecode->nLoadStates[pDecode->nStateCount - 1] == LOAD_STATE_LOOP)
+	{
+		switch (nKey)
+		{
+		case BEAT_KEY_ON:		pLoad->header.bLoopOn = json_intValue(value);		break;
+		case BEAT_KEY_START:	pLoad->header.nLoopStart = json_intValue(value);	break;
+		case BEAT_KEY_END:		pLoad->header.nLoopEnd = json_intValue(value);		break;
+		}
+
+	}
+	else if (pDecode->nLoadStates[pDecode->nStateCount - 1] == LOAD_STATE_ENVOLOPE)
+	{
+		switch (nKey)
+		{
+		case BEAT_KEY_A:		pDecode->fValue1 = json_floatValue(value);			break;
+		case BEAT_KEY_D:		pDecode->fValue2 = json_floatValue(value);			break;
+		case BEAT_KEY_S:		pDecode->fValue3 = json_floatValue(value);			break;
+		case BEAT_KEY_R:		pDecode->fValue4 = json_floatValue(value);			break;
+		}
+
+	}
+	else if (pDecode->nLoadStates[pDecode->nStateCount - 1] == LOAD_STATE_LABELS)
+	{
+		switch (nKey)
+		{
+		case BEAT_KEY_STEP:		pDecode->nValue = json_intValue(value);							break;
+		case BEAT_KEY_TXT:		strncpy(pDecode->szBuffer, json_stringValue(value), 127);		break;
+		}
+	}
+	else if (pDecode->nLoadStates[pDecode->nStateCount - 1] == LOAD_STATE_SCALE)
+	{
+		switch (nKey)
+		{
+		case BEAT_KEY_TYPE:		strncpy(pDecode->szBuffer, json_stringValue(value), 127);		break;
+		case BEAT_KEY_BASE:		strncpy(pDecode->szBufferSmall, json_stringValue(value), 31);	break;
+		}
+	}
+	else if (pDecode->nLoadStates[pDecode->nStateCount - 1] == LOAD_STATE_FILTER)
+	{
+		switch (nKey)
+		{
+		case BEAT_KEY_FREQ:		pDecode->nValue = json_intValue(value);				break;
+		case BEAT_KEY_TYPE:		pDecode->nExtra = json_intValue(value);				break;
+		case BEAT_KEY_RESN:		pDecode->fValue1 = json_floatValue(value);			break;
+		case BEAT_KEY_MIX:		pDecode->fValue2 = json_floatValue(value);			break;
+		}
+
+	}
+	else if (pDecode->nLoadStates[pDecode->nStateCount - 1] == LOAD_STATE_DELAY)
+	{
+		switch (nKey)
+		{
+		case BEAT_KEY_FEEDBACK:	pDecode->fValue1 = json_floatValue(value);			break;
+		case BEAT_KEY_MIX:		pDecode->fValue2 = json_floatValue(value);			break;
+		}
+
+	}
+	else if (pDecode->nLoadStates[pDecode->nStateCount - 1] == LOAD_STATE_BITCRUSHER)
+	{
+		switch (nKey)
+		{
+		case BEAT_KEY_AMOUNT:	pDecode->fValue1 = json_floatValue(value);			break;
+		case BEAT_KEY_MIX:		pDecode->fValue2 = json_floatValue(value);			break;
+		}
+
+	}
+
+
+}
+
+
+// --------------------------------------------------------------------------------
+int shouldDecodeArrayValueAtIndex(json_decoder* decoder, int pos)
+{
+	BeatLoadContext* pLoad = decoder->userdata;
+	DecodeData* pDecode = &pLoad->decodeData;
+
+	if (pDecode->nLoadStates[pDecode->nStateCount - 1] == LOAD_STATE_NOTES)
+	{
+		pDecode->nArrayPos = pos;
+		pDecode->note.pitch = 0;
+		pDecode->note.len = 0;
+		pDecode->note.velocity = 0.0f;
+	}
+	else if (pDecode->nLoadStates[pDecode->nStateCount - 1] == LOAD_STATE_LABELS)
+	{
+		pDecode->nArrayPos = pos;
+		memset(pDecode->szBuffer, 0, 128);
+		pDecode->nValue = 0;
+	}
+
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+void didDecodeArrayValue(json_decoder* decoder, int pos, json_value value)
+{
+	BeatLoadContext* pLoad = decoder->userdata;
+	DecodeData* pDecode = &pLoad->decodeData;
+
+	if (pDecode->nLoadStates[pDecode->nStateCount - 1] == LOAD_STATE_NOTES)
+	{
+		if (pDecode->nArrayPos == pos && (int)pLoad->header.nNoteCount < pLoad->nNoteCapacity)
+		{
+			BMBNote* pNote = &pLoad->pNotes[pLoad->header.nNoteCount++];
+
+			pNote->nStep = pDecode->nStep;
+			pNote->nPitch = pDecode->note.pitch;
+			pNote->nLen = pDecode->note.len;
+			pNote->fVelocity = pDecode->note.velocity;
+
+			pLoad->tracks[pDecode->nTrack].nNoteCount++;
+
+			int nLength = pDecode->nStep + pDecode->note.len;
+			if (nLength > pLoad->header.nBeatLength)
+				pLoad->header.nBeatLength = nLength;
+		}
+	}
+	else if (pDecode->nLoadStates[pDecode->nStateCount - 1] == LOAD_STATE_LABELS)
+	{
+		if (pDecode->nArrayPos == pos && pLoad->header.nLabelCount < BM_MAX_LABEL)
+		{
+			BMBLabel* pLabel = &pLoad->labels[pLoad->header.nLabelCount++];
+
+			pLabel->nStep = pDecode->nValue;
+			BeatMachineCopyField(pLabel->szText, pDecode->szBuffer, BMB_NAME_SIZE);
+		}
+	}
+	else if (pDecode->nLoadStates[pDecode->nStateCount - 1] == LOAD_STATE_HARMONICS)
+	{
+		// one level per harmonic, from the fundamental up
+		if (pDecode->nValue < BMB_HARMONIC_COUNT)
+		{
+			float fLevel = json_floatValue(value);
+			fLevel = fLevel < 0.0f ? 0.0f : (fLevel > 1.0f ? 1.0f : fLevel);
+
+			pLoad->tracks[pDecode->nTrack].nHarmonics[pDecode->nValue++] = (uint8_t)(fLevel * 255.0f + 0.5f);
+		}
+	}
+
+
+}
+
+
+// --------------------------------------------------------------------------------
+void* didDecodeSublist(json_decoder* decoder, const char* name, json_value_type type)
+{
+	BeatLoadContext* pLoad = decoder->userdata;
+	DecodeData* pDecode = &pLoad->decodeData;
+
+	int nState = pDecode->nStateCount > 0 ? pDecode->nLoadStates[pDecode->nStateCount - 1] : -1;
+	BMBTrack* pInfo = &pLoad->tracks[pDecode->nTrack];
+
+	switch (BeatKeyLookup(name))
+	{
+	case BEAT_KEY_BEAT:
+		if (nState == LOAD_STATE_HEADER)
+			pDecode->nStateCount--;
+		break;
+
+	case BEAT_KEY_TRACKS:
+		if (nState == LOAD_STATE_TRACK_INFO)
+			pDecode->nStateCount--;
+		break;
+
+	case BEAT_KEY_ENV:
+		if (nState == LOAD_STATE_ENVOLOPE)
+		{
+			pDecode->nStateCount--;
+
+			pInfo->bHasEnvelope = TRUE;
+			pInfo->fAttack = pDecode->fValue1;
+			pInfo->fDecay = pDecode->fValue2;
+			pInfo->fSustain = pDecode->fValue3;
+			pInfo->fRelease = pDecode->fValue4;
+		}
+		break;
+
+	case BEAT_KEY_LOOP:
+		if (nState == LOAD_STATE_LOOP)
+			pDecode->nStateCount--;
+		break;
+
+	// older files call it lpf, bmfc takes both as well
+	case BEAT_KEY_FILTER:
+	case BEAT_KEY_LPF:
+		if (nState == LOAD_STATE_FILTER)
+		{
+			pDecode->nStateCount--;
+
+			pInfo->bFilterEnabled = TRUE;
+			pInfo->nFilterType = pDecode->nExtra;
+			pInfo->nFilterFreq = pDecode->nValue;
+			pInfo->fFilterResn = pDecode->fValue1;
+			pInfo->fFilterMix = pDecode->fValue2;
+		}
+		break;
+
+	case BEAT_KEY_DELAY:
+		if (nState == LOAD_STATE_DELAY)
+		{
+			pDecode->nStateCount--;
+
+			pInfo->bDelayEnabled = TRUE;
+			pInfo->fDelayFeedback = pDecode->fValue1;
+			pInfo->fDelayMix = pDecode->fValue2;
+		}
+		break;
+
+	case BEAT_KEY_BITCRUSH:
+		if (nState == LOAD_STATE_BITCRUSHER)
+		{
+			pDecode->nStateCount--;
+
+			pInfo->bBitCrusherEnabled = TRUE;
+			pInfo->fBitcrusherAmount = pDecode->fValue1;
+			pInfo->fBitcrusherMix = pDecode->fValue2;
+		}
+		break;
+
+	case BEAT_KEY_NOTES:
+		if (nState == LOAD_STATE_NOTES)
+			pDecode->nStateCount--;
+		break;
+
+	case BEAT_KEY_HARMONICS:
+		if (nState == LOAD_STATE_HARMONICS)
+			pDecode->nStateCount--;
+		break;
+
+	case BEAT_KEY_SCALE:
+		if (nState == LOAD_STATE_SCALE)
+		{
+			pDecode->nStateCount--;
+
+			BeatMachineCopyField(pLoad->header.szScale, pDecode->szBuffer, BMB_SCALE_SIZE);
+			BeatMachineCopyField(pLoad->header.szBaseNote, pDecode->szBufferSmall, BMB_BASE_NOTE_SIZE);
+		}
+		break;
+	}
+
+	return NULL;
+}
+
+
+// --------------------------------------------------------------------------------
+static float BeatMachineLoadTimer(BeatMachine* pBeatMachine)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	// the elapsed timer belongs to the game, so it is only read and never reset here
+	return pd->system->getElapsedTime();
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineFreeLoad(BeatMachine* pBeatMachine, BeatLoadContext* pLoad)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	if (pLoad->file)
+		pd->file->close(pLoad->file);
+
+	// the staging buffers only live as long as the load, so they stay on the heap
+	// compiled beats keep their notes inside the file data
+	if (!pLoad->bCompiled && pLoad->pNotes)
+		Engine_MemFree(pLoad->pNotes);
+
+	if (pLoad->pFileData)
+		Engine_MemFree(pLoad->pFileData);
+
+	// after a transition this is the beat that was faded out
+	if (pLoad->pSequence && pd->sound->sequence->isPlaying(pLoad->pSequence))
+		pd->sound->sequence->stop(pLoad->pSequence);
+
+	BeatMachineFreeTracks(pBeatMachine, pLoad->pTracks);
+
+	if (pLoad->pSequence)
+		pd->sound->sequence->freeSequence(pLoad->pSequence);
+
+	// whichever beat ended up in the load context, cancelled or replaced, goes in one reset
+	BeatArenaReset(pLoad->pArena);
+
+	Engine_MemFree(pLoad);
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineLoadFailed(BeatMachine* pBeatMachine, BeatLoadContext* pLoad, const char* szError)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	pd->system->logToConsole("load error: %s %s", pLoad->szName, szError);
+
+	pLoad->nPhase = BM_LOAD_FAILED;
+
+}
+
+
+// --------------------------------------------------------------------------------
+int BeatMachineBeginLoad(BeatMachine* pBeatMachine, const char* szName)
+{
+	if (pBeatMachine == NULL)
+		return -1;
+
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	BeatMachineCancelLoad(pBeatMachine);
+
+	BeatLoadContext* pLoad = Engine_MemAlloc(sizeof(BeatLoadContext));
+	memset(pLoad, 0, sizeof(BeatLoadContext));
+
+	pLoad->pd = pd;
+	pLoad->pArena = pBeatMachine->pSpareArena;
+	pLoad->bSortNotes = pBeatMachine->bSortNotes;
+	pLoad->bUseScanner = pBeatMachine->bUseScanner;
+	pLoad->nFreezeMask = pBeatMachine->nFreezeMask;
+
+	strncpy(pLoad->szName, szName, BM_TRACK_FILENAMEL_SIZE - 1);
+
+	int nNameLength = strlen(szName);
+	pLoad->bCompiled = nNameLength > 4 && strcmp(szName + nNameLength - 4, ".bmb") == 0;
+
+	pLoad->header.nBPM = 120;
+	strcpy(pLoad->header.szScale, "Major");
+	strcpy(pLoad->header.szBaseNote, "C");
+
+	pBeatMachine->pLoad = pLoad;
+
+	char szPath[256];
+	memset(szPath, 0, 256);
+	strcpy(szPath, "beats/");
+	strcat(szPath, szName);
+
+	FileStat stat;
+	if (pd->file->stat(szPath, &stat) != 0)
+	{
+		pd->system->logToConsole("filerror: %s", pd->file->geterr());
+		BeatMachineLoadFailed(pBeatMachine, pLoad, "not found");
+		return -1;
+	}
+
+	pLoad->file = pd->file->open(szPath, kFileRead | kFileReadData);
+
+	if (pLoad->file == NULL)
+	{
+		pd->system->logToConsole("filerror: %s", pd->file->geterr());
+		BeatMachineLoadFailed(pBeatMachine, pLoad, "cannot be opened");
+		return -1;
+	}
+
+	if (pLoad->bCompiled)
+	{
+		// the data size is known once the header has been read in the first step
+		pLoad->nFileSize = 0;
+	}
+	else
+	{
+		// text is zero terminated for decodeString
+		pLoad->nFileSize = stat.size;
+		pLoad->pFileData = Engine_MemAlloc(pLoad->nFileSize + 1);
+		pLoad->pFileData[pLoad->nFileSize] = '\0';
+	}
+
+	pLoad->pScaleManager = BeatArenaAlloc(pLoad->pArena, sizeof(ScaleManager));
+	ScaleManagerInit(pLoad->pScaleManager);
+
+	pLoad->szBeatName = BeatArenaStrDup(pLoad->pArena, szName);
+
+	pLoad->pSequence = pd->sound->sequence->newSequence();
+	BeatMachineAllocTracks(pLoad->pArena, pLoad->pTracks);
+	pLoad->pOccupancy = BeatArenaAlloc(pLoad->pArena, sizeof(BeatOccupancy));
+
+	pLoad->nPhase = BM_LOAD_READING;
+
+	return 0;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineLoadReadHeader(BeatMachine* pBeatMachine, BeatLoadContext* pLoad)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	BMBHeader* pHeader = &pLoad->header;
+
+	int nRead = pd->file->read(pLoad->file, pHeader, sizeof(BMBHeader));
+
+	if (nRead != sizeof(BMBHeader) || pHeader->nMagic != BMB_MAGIC || pHeader->nVersion != BMB_VERSION || pHeader->nTrackCount > BM_MAX_TRACK)
+	{
+		BeatMachineLoadFailed(pBeatMachine, pLoad, "is not a compiled beat");
+		return;
+	}
+
+	uint32_t nExpectedSize = pHeader->nTrackCount * sizeof(BMBTrack) + pHeader->nLabelCount * sizeof(BMBLabel) + pHeader->nNoteCount * sizeof(BMBNote);
+	if (pHeader->nDataSize != nExpectedSize)
+	{
+		BeatMachineLoadFailed(pBeatMachine, pLoad, "has a bad data size");
+		return;
+	}
+
+	pLoad->nFileSize = pHeader->nDataSize;
+	pLoad->pFileData = Engine_MemAlloc(pLoad->nFileSize);
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineLoadStageCompiled(BeatMachine* pBeatMachine, BeatLoadContext* pLoad)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	const BMBTrack* pTrackTable = (const BMBTrack*)pLoad->pFileData;
+	const BMBLabel* pLabels = (const BMBLabel*)(pTrackTable + pLoad->header.nTrackCount);
+
+	pLoad->pNotes = (BMBNote*)(pLabels + pLoad->header.nLabelCount);
+	pLoad->nNoteCapacity = pLoad->header.nNoteCount;
+
+	// the file data goes with the load, so labels are copied out of it
+	if (pLoad->header.nLabelCount > BM_MAX_LABEL)
+		pLoad->header.nLabelCount = BM_MAX_LABEL;
+
+	memcpy(pLoad->labels, pLabels, pLoad->header.nLabelCount * sizeof(BMBLabel));
+
+	for (int i = 0; i < pLoad->header.nLabelCount; i++)
+		pLoad->labels[i].szText[BMB_NAME_SIZE - 1] = '\0';
+
+	for (int t = 0; t < pLoad->header.nTrackCount; t++)
+	{
+		const BMBTrack* pInfo = &pTrackTable[t];
+
+		if (pInfo->nId >= BM_MAX_TRACK || pInfo->nSoundSource >= BM_MAX_SOUND_TYPE || pInfo->nFirstNote + pInfo->nNoteCount > pLoad->header.nNoteCount)
+		{
+			pd->system->logToConsole("load error: %s has a bad track %d", pLoad->szName, t);
+			continue;
+		}
+
+		pLoad->tracks[pInfo->nId] = *pInfo;
+		pLoad->bTrackUsed[pInfo->nId] = TRUE;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineLoadRead(BeatMachine* pBeatMachine, BeatLoadContext* pLoad)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	if (pLoad->bCompiled && pLoad->pFileData == NULL)
+	{
+		BeatMachineLoadReadHeader(pBeatMachine, pLoad);
+		return;
+	}
+
+	// a load without a budget reads the rest of the file in one go
+	int nSize = pLoad->nFileSize - pLoad->nBytesRead;
+	if (!pLoad->bNoBudget && nSize > BM_LOAD_READ_CHUNK)
+		nSize = BM_LOAD_READ_CHUNK;
+
+	uint8_t* pDest = pLoad->pFileData + pLoad->nBytesRead;
+
+	int nRead = pd->file->read(pLoad->file, pDest, nSize);
+	if (nRead != nSize)
+	{
+		BeatMachineLoadFailed(pBeatMachine, pLoad, "is truncated");
+		return;
+	}
+
+	if (!pLoad->bCompiled)
+	{
+		// every note is a table, so counting braces sizes the note buffer before decoding
+		for (int i = 0; i < nRead; i++)
+		{
+			if (pDest[i] == '{')
+				pLoad->nNoteCapacity++;
+		}
+	}
+
+	pLoad->nBytesRead += nRead;
+
+	if (pLoad->nBytesRead == pLoad->nFileSize)
+	{
+		pd->file->close(pLoad->file);
+		pLoad->file = NULL;
+
+		if (pLoad->bCompiled)
+		{
+			BeatMachineLoadStageCompiled(pBeatMachine, pLoad);
+			pLoad->nPhase = BM_LOAD_SORTING;
+		}
+		else
+		{
+			pLoad->nPhase = BM_LOAD_DECODING;
+		}
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineLoadDecode(BeatMachine* pBeatMachine, BeatLoadContext* pLoad)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	if (pLoad->pNotes == NULL)
+		pLoad->pNotes = Engine_MemAlloc(pLoad->nNoteCapacity * sizeof(BMBNote) + sizeof(BMBNote));
+
+	// pd->json can't stop part way, so only a load without a budget may go through it
+	if (!pLoad->bNoBudget)
+		pLoad->bUseScanner = TRUE;
+
+	if (pLoad->bUseScanner)
+	{
+		int nResult = BeatScannerStep(pLoad, (char*)pLoad->pFileData, pLoad->nFileSize, BM_LOAD_SCAN_BATCH);
+		if (nResult == BEAT_SCAN_MORE)
+			return;
+
+		if (nResult != BEAT_SCAN_DONE)
+			pd->system->logToConsole("decode error at byte %i: %s", nResult - 1, pLoad->szName);
+	}
+	else
+	{
+		json_decoder decoder =
+		{
+			.decodeError = decodeError,
+			.willDecodeSublist = willDecodeSublist,
+			.shouldDecodeTableValueForKey = shouldDecodeTableValueForKey,
+			.didDecodeTableValue = didDecodeTableValue,
+			.shouldDecodeArrayValueAtIndex = shouldDecodeArrayValueAtIndex,
+			.didDecodeArrayValue = didDecodeArrayValue,
+			.didDecodeSublist = didDecodeSublist,
+			.userdata = pLoad
+		};
+
+		json_value val;
+		pd->json->decodeString(&decoder, (const char*)pLoad->pFileData, &val);
+	}
+
+	Engine_MemFree(pLoad->pFileData);
+	pLoad->pFileData = NULL;
+
+	pLoad->nPhase = BM_LOAD_SORTING;
+
+}
+
+
+// --------------------------------------------------------------------------------
+static int BeatMachineCompareNotes(const void* a, const void* b)
+{
+	const BMBNote* pA = a;
+	const BMBNote* pB = b;
+
+	if (pA->nStep != pB->nStep)
+		return (int)pA->nStep - (int)pB->nStep;
+
+	return (int)pA->nPitch - (int)pB->nPitch;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineLoadSort(BeatMachine* pBeatMachine, BeatLoadContext* pLoad)
+{
+	// one track per unit, the compiler already sorts so a compiled beat only pays for the check
+	int nTrack = pLoad->nTrackCursor++;
+
+	if (pLoad->bSortNotes && pLoad->bTrackUsed[nTrack])
+	{
+		const BMBTrack* pInfo = &pLoad->tracks[nTrack];
+		BMBNote* pNotes = &pLoad->pNotes[pInfo->nFirstNote];
+
+		for (int i = 1; i < (int)pInfo->nNoteCount; i++)
+		{
+			if (pNotes[i].nStep < pNotes[i - 1].nStep)
 			{
-				BeatMachineCreateSynthByName(decodeData.nTrack, szName);
+				qsort(pNotes, pInfo->nNoteCount, sizeof(BMBNote), BeatMachineCompareNotes);
+				pLoad->stats.nUnsortedTracks++;
+				break;
 			}
 		}
-		else if (strcmp(key, "mute") == 0)
+	}
+
+	if (pLoad->nTrackCursor == BM_MAX_TRACK)
+	{
+		pLoad->nTrackCursor = 0;
+		pLoad->nPhase = BM_LOAD_TRACKS;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineLoadBuildTrack(BeatMachine* pBeatMachine, BeatLoadContext* pLoad)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	if (pLoad->nTrackCursor == 0)
+	{
+		pd->sound->sequence->setTempo(pLoad->pSequence, BeatMachineStepsPerSecond(pLoad->header.nBPM));
+		SetupScaleWithString(pLoad->pScaleManager, pLoad->header.szScale, pLoad->header.szBaseNote);
+	}
+
+	int nTrack = pLoad->nTrackCursor++;
+
+	if (pLoad->bTrackUsed[nTrack])
+	{
+		const BMBTrack* pInfo = &pLoad->tracks[nTrack];
+		BeatMachineTrack* pTrack = pLoad->pTracks[nTrack];
+
+		if (pInfo->nSoundSource == BM_TYPE_SAMPLE)
+		{
+			BeatMachineTrackCreateSampler(pBeatMachine, pTrack, pLoad->pSequence);
+
+			if (pInfo->szSampleName[0])
+				BeatMachineTrackSetSample(pBeatMachine, pTrack, pLoad->pArena, "samples/", pInfo->szSampleName);
+		}
+		else
 		{
-			BeatMachineMuteTrack(decodeData.nTrack, json_intValue(value));
+			// the table is built before the synth is set up, so it starts on it
+			if (pInfo->nSoundSource == BM_TYPE_WAVETABLE)
+				pTrack->pWavetable = BeatMachineLoadWavetable(pBeatMachine, pLoad->pArena, pInfo);
+
+			BeatMachineTrackCreateSynth(pBeatMachine, pTrack, pLoad->pSequence, pInfo->nSoundSource);
+
+			if (pInfo->bHasEnvelope)
+				BeatMachineTrackSetADSR(pBeatMachine, pTrack, pInfo->fAttack, pInfo->fDecay, pInfo->fSustain, pInfo->fRelease);
 		}
-		else if (strcmp(key, "chord") == 0)
+
+		memcpy(pTrack->szTrackName, pInfo->szTrackName, BMB_NAME_SIZE);
+		pTrack->szTrackName[BMB_NAME_SIZE - 1] = '\0';
+
+		BeatMachineTrackSetVolume(pBeatMachine, pTrack, pInfo->fVolume);
+		BeatMachineTrackSetPanning(pBeatMachine, pTrack, pInfo->fPanning);
+		BeatMachineTrackMute(pBeatMachine, pTrack, pInfo->bMuted);
+
+		if (pInfo->bFilterEnabled)
+			BeatMachineTrackEnableFilter(pBeatMachine, pTrack, pInfo->nFilterType, pInfo->nFilterFreq, pInfo->fFilterResn, pInfo->fFilterMix);
+
+		if (pInfo->bDelayEnabled)
+			BeatMachineTrackEnableDelay(pBeatMachine, pLoad->pTracks, pTrack, pInfo->fDelayFeedback, pInfo->fDelayMix, pLoad->header.nBPM);
+
+		if (pInfo->bBitCrusherEnabled)
+			BeatMachineTrackEnableBitCrusher(pBeatMachine, pTrack, pInfo->fBitcrusherAmount, pInfo->fBitcrusherMix);
+
+		// after the mixer, so a mixed chord track doesn't get platform voices
+		BeatMachineTrackAttachMixer(pBeatMachine, pTrack, pLoad->pArena);
+		BeatMachineTrackSetChord(pBeatMachine, pTrack, pInfo->bIsChordTrack);
+
+		// the roots are kept for scale changes, the note count is known so they get one array
+		if (pInfo->bIsChordTrack && pInfo->nNoteCount > 0)
 		{
-			BeatMachineSetChordTrack(decodeData.nTrack, json_intValue(value));
-			
+			pTrack->pRoots = BeatArenaAlloc(pLoad->pArena, pInfo->nNoteCount * sizeof(BeatRootNote));
+			pTrack->nRootCapacity = pInfo->nNoteCount;
 		}
-		
 	}
-	else if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_NOTES)
+
+	if (pLoad->nTrackCursor == BM_MAX_TRACK)
+	{
+		pLoad->nTrackCursor = 0;
+		pLoad->nNoteCursor = 0;
+		pLoad->nPhase = BM_LOAD_NOTES;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineLoadBuildNotes(BeatMachine* pBeatMachine, BeatLoadContext* pLoad)
+{
+	int nBatch = BM_LOAD_NOTE_BATCH;
+
+	while (nBatch > 0 && pLoad->nTrackCursor < BM_MAX_TRACK)
 	{
-		if (strcmp(key, "step") == 0)
+		int nTrack = pLoad->nTrackCursor;
+		const BMBTrack* pInfo = &pLoad->tracks[nTrack];
+
+		int nCount = pLoad->bTrackUsed[nTrack] ? (int)pInfo->nNoteCount - pLoad->nNoteCursor : 0;
+		if (nCount > nBatch)
+			nCount = nBatch;
+
+		// the run of a track is in step order, so the sequence appends every event
+		const BMBNote* pNote = &pLoad->pNotes[pInfo->nFirstNote + pLoad->nNoteCursor];
+		BeatMachineTrack* pTrack = pLoad->pTracks[nTrack];
+
+		for (int i = 0; i < nCount; i++, pNote++)
 		{
-			decodeData.nStep = json_intValue(value);
+			pLoad->stats.nEventCount += BeatMachineTrackAddNote(pBeatMachine, pTrack, pLoad->pScaleManager, pLoad->pArena, pNote->nStep, pNote->nLen, pNote->nPitch, pNote->fVelocity);
+			BeatMachineMarkNote(pLoad->pOccupancy, nTrack, pNote->nStep);
+
+			int nLength = pNote->nStep + pNote->nLen;
+			if (nLength > pLoad->nBeatLength)
+				pLoad->nBeatLength = nLength;
 		}
-		else if (strcmp(key, "pitch") == 0)
+
+		pLoad->nNoteCursor += nCount;
+		pLoad->nNotesAdded += nCount;
+		nBatch -= nCount;
+
+		if (!pLoad->bTrackUsed[nTrack] || pLoad->nNoteCursor >= (int)pInfo->nNoteCount)
 		{
-			int nPitch = json_intValue(value);
-			decodeData.note.pitch = nPitch;
+			pLoad->nTrackCursor++;
+			pLoad->nNoteCursor = 0;
 		}
-		else if (strcmp(key, "len") == 0)
+	}
+
+	if (pLoad->nTrackCursor == BM_MAX_TRACK)
+	{
+		int nOffset = 0;
+		for (int i = 0; i < BM_MAX_TRACK; i++)
 		{
-			decodeData.note.len = json_intValue(value);
+			pLoad->pOccupancy->nNoteOffsets[i] = (uint16_t)nOffset;
+			if (pLoad->bTrackUsed[i])
+				nOffset += pLoad->tracks[i].nNoteCount;
 		}
-		else if (strcmp(key, "vel") == 0)
+
+		pLoad->pOccupancy->nNoteOffsets[BM_MAX_TRACK] = (uint16_t)nOffset;
+
+		pLoad->stats.nNoteCount = pLoad->nNotesAdded;
+
+		pLoad->nTrackCursor = 0;
+		pLoad->nPhase = pLoad->nFreezeMask ? BM_LOAD_FREEZING : BM_LOAD_READY;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+// One track per step, a render can take a while.
+// --------------------------------------------------------------------------------
+static void BeatMachineLoadFreeze(BeatMachine* pBeatMachine, BeatLoadContext* pLoad)
+{
+	int nTrack = pLoad->nTrackCursor++;
+
+	if ((pLoad->nFreezeMask & (1 << nTrack)) && pLoad->bTrackUsed[nTrack])
+	{
+		int nError = BeatMachineTrackFreeze(pBeatMachine, pLoad->pTracks[nTrack], pLoad->header.nBPM);
+		if (nError != BM_FREEZE_OK)
+			pBeatMachine->pd->system->logToConsole("track %d of %s stays live, freeze error %d", nTrack, pLoad->szName, nError);
+	}
+
+	if (pLoad->nTrackCursor == BM_MAX_TRACK)
+		pLoad->nPhase = BM_LOAD_READY;
+
+}
+
+
+// --------------------------------------------------------------------------------
+int BeatMachineStepLoad(BeatMachine* pBeatMachine, int nBudgetMicros)
+{
+	if (pBeatMachine == NULL || pBeatMachine->pLoad == NULL)
+		return BM_LOAD_IDLE;
+
+	BeatLoadContext* pLoad = pBeatMachine->pLoad;
+	pLoad->bNoBudget = (nBudgetMicros == BM_LOAD_NO_BUDGET);
+
+	float fStart = BeatMachineLoadTimer(pBeatMachine);
+	float fBudget = nBudgetMicros / 1000000.0f;
+
+	float fLast = fStart;
+
+	// at least one unit of work per step so a load always finishes
+	for (;;)
+	{
+		float* pPhaseTime = NULL;
+
+		switch (pLoad->nPhase)
 		{
-			decodeData.note.velocity = json_floatValue(value);
+		case BM_LOAD_READING:	BeatMachineLoadRead(pBeatMachine, pLoad);		pPhaseTime = &pLoad->stats.fReadTime;	break;
+		case BM_LOAD_DECODING:	BeatMachineLoadDecode(pBeatMachine, pLoad);		pPhaseTime = &pLoad->stats.fDecodeTime;	break;
+		case BM_LOAD_SORTING:	BeatMachineLoadSort(pBeatMachine, pLoad);		pPhaseTime = &pLoad->stats.fSortTime;	break;
+		case BM_LOAD_TRACKS:	BeatMachineLoadBuildTrack(pBeatMachine, pLoad);	pPhaseTime = &pLoad->stats.fTrackTime;	break;
+		case BM_LOAD_NOTES:		BeatMachineLoadBuildNotes(pBeatMachine, pLoad);	pPhaseTime = &pLoad->stats.fCommitTime;	break;
+		case BM_LOAD_FREEZING:	BeatMachineLoadFreeze(pBeatMachine, pLoad);		pPhaseTime = &pLoad->stats.fFreezeTime;	break;
+		default:
+			return pLoad->nPhase;
 		}
+
+		float fNow = BeatMachineLoadTimer(pBeatMachine);
+		*pPhaseTime += fNow - fLast;
+		fLast = fNow;
+
+		if (nBudgetMicros != BM_LOAD_NO_BUDGET && fNow - fStart >= fBudget)
+			break;
+	}
+
+	return pLoad->nPhase;
+}
+
+
+// --------------------------------------------------------------------------------
+float BeatMachineGetLoadProgress(BeatMachine* pBeatMachine)
+{
+	if (pBeatMachine == NULL || pBeatMachine->pLoad == NULL)
+		return 0.0f;
+
+	BeatLoadContext* pLoad = pBeatMachine->pLoad;
+
+	// reading 0 - 0.3, decoding 0.3 - 0.35, sorting 0.35 - 0.4, tracks 0.4 - 0.7, notes 0.7 - 1
+	// or notes 0.7 - 0.9 and freezing 0.9 - 1 when tracks get frozen
+	float fNotesEnd = pLoad->nFreezeMask ? 0.9f : 1.0f;
+
+	switch (pLoad->nPhase)
+	{
+	case BM_LOAD_READING:
+		if (pLoad->nFileSize == 0)
+			return 0.0f;
+		return 0.3f * pLoad->nBytesRead / pLoad->nFileSize;
+
+	case BM_LOAD_DECODING:
+		if (pLoad->nFileSize == 0)
+			return 0.3f;
+		return 0.3f + 0.05f * pLoad->scanData.nOffset / pLoad->nFileSize;
+
+	case BM_LOAD_SORTING:
+		return 0.35f + 0.05f * pLoad->nTrackCursor / BM_MAX_TRACK;
+
+	case BM_LOAD_TRACKS:
+		return 0.4f + 0.3f * pLoad->nTrackCursor / BM_MAX_TRACK;
+
+	case BM_LOAD_NOTES:
+		if (pLoad->header.nNoteCount == 0)
+			return fNotesEnd;
+		return 0.7f + (fNotesEnd - 0.7f) * pLoad->nNotesAdded / pLoad->header.nNoteCount;
+
+	case BM_LOAD_FREEZING:
+		return fNotesEnd + (1.0f - fNotesEnd) * pLoad->nTrackCursor / BM_MAX_TRACK;
+
+	case BM_LOAD_READY:
+		return 1.0f;
+	}
+
+	return 0.0f;
+}
+
+
+// --------------------------------------------------------------------------------
+// Swaps the loaded beat in and the playing one into the load context. Only pointers
+// change hands, so this is safe on the frame a transition starts.
+// --------------------------------------------------------------------------------
+static void BeatMachineSwapLoad(BeatMachine* pBeatMachine, BeatLoadContext* pLoad)
+{
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	for (int i = 0; i < BM_MAX_TRACK; i++)
+	{
+		BeatMachineTrack* pTrack = pBeatMachine->pTracks[i];
+		pBeatMachine->pTracks[i] = pLoad->pTracks[i];
+		pLoad->pTracks[i] = pTrack;
+	}
+
+	SoundSequence* pSequence = pBeatMachine->pSequence;
+	pBeatMachine->pSequence = pLoad->pSequence;
+	pLoad->pSequence = pSequence;
+
+	BeatOccupancy* pOccupancy = pBeatMachine->pOccupancy;
+	pBeatMachine->pOccupancy = pLoad->pOccupancy;
+	pLoad->pOccupancy = pOccupancy;
+
+	ScaleManager* pScaleManager = pBeatMachine->pScaleManager;
+	pBeatMachine->pScaleManager = pLoad->pScaleManager;
+	pLoad->pScaleManager = pScaleManager;
+
+	char* szBeatName = pBeatMachine->szBeatName;
+	pBeatMachine->szBeatName = pLoad->szBeatName;
+	pLoad->szBeatName = szBeatName;
+
+	pBeatMachine->nBPM = pLoad->header.nBPM;
+	pBeatMachine->nBeatLength = pLoad->nBeatLength;
+	pBeatMachine->loadStats = pLoad->stats;
+	pBeatMachine->szProducer = NULL;
+
+	pBeatMachine->nLabelCount = pLoad->header.nLabelCount;
+	memcpy(pBeatMachine->labels, pLoad->labels, sizeof(pLoad->labels));
+
+	pBeatMachine->bLoopOn = pLoad->header.bLoopOn;
+	pBeatMachine->nLoopStart = pLoad->header.nLoopStart;
+	pBeatMachine->nLoopLast = pLoad->header.nLoopEnd;
+
+	// a seek into the old beat has nowhere to go
+	pBeatMachine->seek.bPending = FALSE;
+
+	BeatArena* pArena = pBeatMachine->pArena;
+	pBeatMachine->pArena = pLoad->pArena;
+	pBeatMachine->pSpareArena = pArena;
+	pLoad->pArena = pArena;
+
+	// what is left in the context is the old beat, it can't be committed again
+	pLoad->nPhase = BM_LOAD_IDLE;
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineSetTracksGain(BeatMachine* pBeatMachine, BeatMachineTrack** pTracks, float fGain)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	// the gain goes on top of the track volume and leaves fVolume as it is
+	for (int i = 0; i < BM_MAX_TRACK; i++)
+	{
+		if (pTracks[i] && pTracks[i]->pChannel)
+			pd->sound->channel->setVolume(pTracks[i]->pChannel, pTracks[i]->fVolume * fGain);
+
+		if (pTracks[i])
+			BeatBusSendSetGain(&pTracks[i]->send, pTracks[i]->fVolume * fGain);
+
+		if (pTracks[i] && pTracks[i]->pMixerInput)
+			pTracks[i]->pMixerInput->fGain = fGain;
+
+		if (pTracks[i] && pTracks[i]->pFrozen)
+			pd->sound->channel->setVolume(pTracks[i]->pFrozen->pChannel, pTracks[i]->fVolume * fGain);
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+int BeatMachineCommitLoad(BeatMachine* pBeatMachine)
+{
+	if (pBeatMachine == NULL || pBeatMachine->pLoad == NULL || pBeatMachine->pLoad->nPhase != BM_LOAD_READY)
+		return -1;
+
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	BeatLoadContext* pLoad = pBeatMachine->pLoad;
+
+	// committing a beat that waits for its transition cuts over right away
+	if (pBeatMachine->transition.nState == BM_TRANSITION_ARMED)
+	{
+		BeatMachineSetTracksGain(pBeatMachine, pLoad->pTracks, 1.0f);
+		pBeatMachine->transition.nState = BM_TRANSITION_NONE;
+	}
+
+	if (pd->sound->sequence->isPlaying(pBeatMachine->pSequence))
+		pd->sound->sequence->stop(pBeatMachine->pSequence);
+
+	// the old beat is freed together with the load context
+	BeatMachineSwapLoad(pBeatMachine, pLoad);
+
+	pBeatMachine->pLoad = NULL;
+	BeatMachineFreeLoad(pBeatMachine, pLoad);
+
+	return 0;
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineCancelLoad(BeatMachine* pBeatMachine)
+{
+	if (pBeatMachine == NULL || pBeatMachine->pLoad == NULL)
+		return;
+
+	// a fade that is cut short leaves the new beat at full volume
+	if (pBeatMachine->transition.nState == BM_TRANSITION_FADING)
+		BeatMachineSetTracksGain(pBeatMachine, pBeatMachine->pTracks, 1.0f);
+
+	pBeatMachine->transition.nState = BM_TRANSITION_NONE;
+
+	BeatLoadContext* pLoad = pBeatMachine->pLoad;
+	pBeatMachine->pLoad = NULL;
+
+	BeatMachineFreeLoad(pBeatMachine, pLoad);
+
+}
+
+
+// --------------------------------------------------------------------------------
+int BeatMachineFindLabel(BeatMachine* pBeatMachine, const char* szLabel)
+{
+	if (pBeatMachine == NULL || szLabel == NULL)
+		return -1;
+
+	for (int i = 0; i < pBeatMachine->nLabelCount; i++)
+	{
+		if (strcmp(pBeatMachine->labels[i].szText, szLabel) == 0)
+			return pBeatMachine->labels[i].nStep;
+	}
+
+	return -1;
+}
+
+
+// --------------------------------------------------------------------------------
+// Steps the sequence loops over, the end is the step after the region. Without a
+// usable loop region in the file the whole beat loops.
+// --------------------------------------------------------------------------------
+static void BeatMachineGetLoopRegion(int bLoopOn, int nLoopStart, int nLoopLast, int nBeatLength, int* pStart, int* pEnd)
+{
+	*pStart = 0;
+	*pEnd = nBeatLength;
+
+	if (bLoopOn && nLoopStart >= 0 && nLoopStart < nBeatLength && nLoopLast >= nLoopStart)
+	{
+		*pStart = nLoopStart;
+		*pEnd = nLoopLast < nBeatLength ? nLoopLast + 1 : nBeatLength;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Steps the playhead moves from nFrom to nTo, wrapping from the end of the loop
+// region to its start.
+// --------------------------------------------------------------------------------
+static int BeatMachineStepsBetween(int nFrom, int nTo, int nLoopStart, int nLoopEnd)
+{
+	if (nTo >= nFrom)
+		return nTo - nFrom;
+
+	return (nLoopEnd - nFrom) + (nTo - nLoopStart);
+}
+
+
+// --------------------------------------------------------------------------------
+// Arms a loaded beat (BeatMachineStepLoad() returned BM_LOAD_READY) to start on the
+// next bar of the playing beat, or on szLabel of it. With nFadeSteps the old beat
+// fades out over that many steps of the new one. BeatMachineUpdateTransition() has
+// to be called every frame until the transition is over.
+// --------------------------------------------------------------------------------
+int BeatMachineQueueTransition(BeatMachine* pBeatMachine, const char* szLabel, int nFadeSteps, int nLoops)
+{
+	if (pBeatMachine == NULL || pBeatMachine->pLoad == NULL || pBeatMachine->pLoad->nPhase != BM_LOAD_READY)
+		return -1;
+
+	// the old beat fades on its own channels
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_CHANGED);
+
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	BeatLoadContext* pLoad = pBeatMachine->pLoad;
+	BeatTransition* pTransition = &pBeatMachine->transition;
+
+	if (pTransition->nState != BM_TRANSITION_NONE)
+		return -1;
+
+	// the step counting below doesn't follow a jump of the playing beat
+	pBeatMachine->seek.bPending = FALSE;
+
+	int nLength = pBeatMachine->nBeatLength;
+
+	// nothing playing, nothing to wait for
+	if (!pd->sound->sequence->isPlaying(pBeatMachine->pSequence) || nLength <= 0)
+	{
+		BeatMachineCommitLoad(pBeatMachine);
+		BeatMachinePlayTheBeat(pBeatMachine, nLoops);
+		return 0;
+	}
+
+	// the playing beat wraps at the end of its loop region, not at the end of the beat
+	int nLoopStart;
+	int nLoopEnd;
+	BeatMachineGetLoopRegion(pBeatMachine->bLoopOn, pBeatMachine->nLoopStart, pBeatMachine->nLoopLast, nLength, &nLoopStart, &nLoopEnd);
+
+	int nStep = pd->sound->sequence->getCurrentStep(pBeatMachine->pSequence, NULL);
+	int nStartStep;
+
+	if (szLabel)
+	{
+		// a label outside the loop region is never played again
+		nStartStep = BeatMachineFindLabel(pBeatMachine, szLabel);
+		if (nStartStep < nLoopStart || nStartStep >= nLoopEnd)
+			return -1;
+	}
+	else
+	{
+		nStartStep = (nStep / BM_STEPS_PER_BAR + 1) * BM_STEPS_PER_BAR;
+		if (nStartStep >= nLoopEnd)
+			nStartStep = nLoopStart;
 	}
 
-	else if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_HEADER)
+	// a label on the current step is taken on its next pass
+	pTransition->nStepsToStart = BeatMachineStepsBetween(nStep, nStartStep, nLoopStart, nLoopEnd);
+	if (pTransition->nStepsToStart == 0)
+		pTransition->nStepsToStart = nLoopEnd - nLoopStart;
+
+	pTransition->nStartStep = nStartStep;
+	pTransition->nStepsPlayed = 0;
+	pTransition->nLastStep = nStep;
+	pTransition->nLoops = nLoops;
+
+	pTransition->nFadeLength = 0;
+	if (nFadeSteps > 0)
+		pTransition->nFadeLength = (uint32_t)(nFadeSteps * BM_SAMPLE_RATE / BeatMachineStepsPerSecond(pLoad->header.nBPM));
+
+	BeatMachineGetLoopRegion(pLoad->header.bLoopOn, pLoad->header.nLoopStart, pLoad->header.nLoopEnd, pLoad->nBeatLength, &nLoopStart, &nLoopEnd);
+
+	// everything but play() is done now, so the start step has nothing left to set up
+	pd->sound->sequence->setLoops(pLoad->pSequence, nLoopStart, nLoopEnd, nLoops);
+
+	if (pTransition->nFadeLength > 0)
+		BeatMachineSetTracksGain(pBeatMachine, pLoad->pTracks, 0.0f);
+
+	pTransition->nState = BM_TRANSITION_ARMED;
+
+	return 0;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachineStartTransition(BeatMachine* pBeatMachine)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	BeatLoadContext* pLoad = pBeatMachine->pLoad;
+	BeatTransition* pTransition = &pBeatMachine->transition;
+	SoundSequence* pSequence = pBeatMachine->pSequence;
+
+	// a late frame starts the new beat that many steps in, so it stays on the bar grid
+	int nLateSteps = 0;
+	if (pd->sound->sequence->isPlaying(pSequence) && pLoad->nBeatLength > 0)
+		nLateSteps = (pTransition->nStepsPlayed - pTransition->nStepsToStart) % pLoad->nBeatLength;
+
+	pd->sound->sequence->setCurrentStep(pLoad->pSequence, nLateSteps, 0, 0);
+	pd->sound->sequence->play(pLoad->pSequence, NULL, NULL);
+
+	if (pTransition->nFadeLength == 0)
+		pd->sound->sequence->stop(pSequence);
+
+	BeatMachineSwapLoad(pBeatMachine, pLoad);
+
+	pTransition->nFadeStart = pd->sound->getCurrentTime();
+	pTransition->nState = BM_TRANSITION_FADING;
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineUpdateTransition(BeatMachine* pBeatMachine)
+{
+	if (pBeatMachine == NULL || pBeatMachine->pLoad == NULL)
+		return;
+
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	BeatTransition* pTransition = &pBeatMachine->transition;
+
+	if (pTransition->nState == BM_TRANSITION_ARMED)
 	{
-		if (strcmp(key, "ver") == 0)
-		{
-			decodeData.nFileVersion = json_intValue(value);
-		}
-		else if (strcmp(key, "BPM") == 0)
+		SoundSequence* pSequence = pBeatMachine->pSequence;
+
+		// an old beat that ran out of loops hands over straight away
+		if (pd->sound->sequence->isPlaying(pSequence))
 		{
-			BeatMachineSetBPM(json_intValue(value));
+			int nLoopStart;
+			int nLoopEnd;
+			BeatMachineGetLoopRegion(pBeatMachine->bLoopOn, pBeatMachine->nLoopStart, pBeatMachine->nLoopLast, pBeatMachine->nBeatLength, &nLoopStart, &nLoopEnd);
+
+			int nStep = pd->sound->sequence->getCurrentStep(pSequence, NULL);
+
+			pTransition->nStepsPlayed += BeatMachineStepsBetween(pTransition->nLastStep, nStep, nLoopStart, nLoopEnd);
+			pTransition->nLastStep = nStep;
+
+			if (pTransition->nStepsPlayed < pTransition->nStepsToStart)
+				return;
 		}
 
+		// the old beat is freed on a later frame, not on the one the new beat starts
+		BeatMachineStartTransition(pBeatMachine);
 	}
-	else if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_ENVOLOPE)
+	else if (pTransition->nState == BM_TRANSITION_FADING)
 	{
-		if (strcmp(key, "a") == 0)
-		{
-			decodeData.fValue1 = json_floatValue(value);
-		}
-		else if (strcmp(key, "d") == 0)
-		{
-			decodeData.fValue2 = json_floatValue(value);
-		}
-		else if (strcmp(key, "s") == 0)
-		{
-			decodeData.fValue3 = json_floatValue(value);
-		}
-		else if (strcmp(key, "r") == 0)
+		BeatLoadContext* pLoad = pBeatMachine->pLoad;
+
+		uint32_t nElapsed = pd->sound->getCurrentTime() - pTransition->nFadeStart;
+
+		if (nElapsed < pTransition->nFadeLength)
 		{
-			decodeData.fValue4 = json_floatValue(value);
+			// equal power, sin^2 + cos^2 keeps the loudness of the mix flat
+			float fAngle = (float)nElapsed / pTransition->nFadeLength * 1.5707963f;
+
+			BeatMachineSetTracksGain(pBeatMachine, pBeatMachine->pTracks, sinf(fAngle));
+			BeatMachineSetTracksGain(pBeatMachine, pLoad->pTracks, cosf(fAngle));
+			return;
 		}
 
+		BeatMachineSetTracksGain(pBeatMachine, pBeatMachine->pTracks, 1.0f);
+		pTransition->nState = BM_TRANSITION_NONE;
+
+		pBeatMachine->pLoad = NULL;
+		BeatMachineFreeLoad(pBeatMachine, pLoad);
 	}
-	else if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_SCALE)
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Jumps the playing beat to szLabel on its next bar, or on the end of the loop
+// region if that comes first. The sequence keeps its notes, so whatever rings
+// into the bar rings on. BeatMachineUpdateSeek() has to be called every frame
+// until seek.bPending is cleared.
+// --------------------------------------------------------------------------------
+int BeatMachineSeekToLabel(BeatMachine* pBeatMachine, const char* szLabel)
+{
+	if (pBeatMachine == NULL || pBeatMachine->pSequence == NULL)
+		return -1;
+
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	BeatSeek* pSeek = &pBeatMachine->seek;
+
+	// a transition counts the steps of the playing beat, a jump would throw it off
+	if (pBeatMachine->transition.nState != BM_TRANSITION_NONE || !pd->sound->sequence->isPlaying(pBeatMachine->pSequence))
+		return -1;
+
+	int nLoopStart;
+	int nLoopEnd;
+	BeatMachineGetLoopRegion(pBeatMachine->bLoopOn, pBeatMachine->nLoopStart, pBeatMachine->nLoopLast, pBeatMachine->nBeatLength, &nLoopStart, &nLoopEnd);
+
+	// a label past the loop region is never played again
+	int nTargetStep = BeatMachineFindLabel(pBeatMachine, szLabel);
+	if (nTargetStep < 0 || nTargetStep >= nLoopEnd)
+		return -1;
+
+	int nStep = pd->sound->sequence->getCurrentStep(pBeatMachine->pSequence, NULL);
+
+	int nBarStep = (nStep / BM_STEPS_PER_BAR + 1) * BM_STEPS_PER_BAR;
+	if (nBarStep > nLoopEnd)
+		nBarStep = nLoopEnd;
+
+	pSeek->nTargetStep = nTargetStep;
+	pSeek->nBarStep = nBarStep;
+	pSeek->nStepsToBar = nBarStep - nStep;
+	pSeek->nStepsPlayed = 0;
+	pSeek->nLastStep = nStep;
+	pSeek->nCallTime = pd->sound->getCurrentTime();
+	pSeek->bPending = TRUE;
+
+	return 0;
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMachineUpdateSeek(BeatMachine* pBeatMachine)
+{
+	if (pBeatMachine == NULL || !pBeatMachine->seek.bPending)
+		return;
+
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	BeatSeek* pSeek = &pBeatMachine->seek;
+	SoundSequence* pSequence = pBeatMachine->pSequence;
+
+	if (!pd->sound->sequence->isPlaying(pSequence))
 	{
-		if (strcmp(key, "type") == 0)
-		{
-			strcpy(decodeData.szBuffer, json_stringValue(value));
-		}
-		else if (strcmp(key, "base") == 0)
-		{
-			strcpy(decodeData.szBufferSmall, json_stringValue(value));
-		}
+		pSeek->bPending = FALSE;
+		return;
 	}
-	else if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_FILTER)
-	{
-		if (strcmp(key, "freq") == 0)
-		{
-			decodeData.nValue = json_intValue(value);
-		}
-		else if (strcmp(key, "type") == 0)
-		{
-			decodeData.nExtra = json_intValue(value);
-		}
-		else if (strcmp(key, "resn") == 0)
-		{
-			decodeData.fValue1 = json_floatValue(value);
-		}
-		else if (strcmp(key, "mix") == 0)
-		{
-			decodeData.fValue2 = json_floatValue(value);
-		}
 
-	}
-	else if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_DELAY)
+	int nLoopStart;
+	int nLoopEnd;
+	BeatMachineGetLoopRegion(pBeatMachine->bLoopOn, pBeatMachine->nLoopStart, pBeatMachine->nLoopLast, pBeatMachine->nBeatLength, &nLoopStart, &nLoopEnd);
+
+	int nOffset = 0;
+	int nStep = pd->sound->sequence->getCurrentStep(pSequence, &nOffset);
+
+	pSeek->nStepsPlayed += BeatMachineStepsBetween(pSeek->nLastStep, nStep, nLoopStart, nLoopEnd);
+	pSeek->nLastStep = nStep;
+
+	int nStepsLeft = pSeek->nStepsToBar - pSeek->nStepsPlayed;
+	if (nStepsLeft > 1)
+		return;
+
+	// the loop end would count as a loop, so a label on step 0 waits for the bar and jumps on it
+	int nStepBefore = pSeek->nTargetStep - 1;
+
+	uint32_t nNow = pd->sound->getCurrentTime();
+	uint32_t nFramesPerStep = (uint32_t)(BM_SAMPLE_RATE / BeatMachineStepsPerSecond(pBeatMachine->nBPM));
+	uint32_t nHeardAt;
+
+	if (nStepsLeft == 1)
 	{
-		if (strcmp(key, "feedback") == 0)
-		{
-			decodeData.fValue1 = json_floatValue(value);
-		}
-		else if (strcmp(key, "mix") == 0)
-		{
-			decodeData.fValue2 = json_floatValue(value);
-		}
+		if (nStepBefore < 0)
+			return;
 
+		// same place in the step before the label, its notes have been played by the step we are in
+		pd->sound->sequence->setCurrentStep(pSequence, nStepBefore, nOffset, 0);
+
+		nHeardAt = nNow + (nFramesPerStep > (uint32_t)nOffset ? nFramesPerStep - nOffset : 0);
+		pSeek->nLastLateSteps = 0;
 	}
-	else if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_BITCRUSHER)
+	else
 	{
-		if (strcmp(key, "amount") == 0)
-		{
-			decodeData.fValue1 = json_floatValue(value);
-		}
-		else if (strcmp(key, "mix") == 0)
-		{
-			decodeData.fValue2 = json_floatValue(value);
-		}
+		// the bar has gone by, land as far into the label as the playhead is past the bar
+		int nLateSteps = -nStepsLeft;
+		int nLandStep = pSeek->nTargetStep + nLateSteps;
+
+		while (nLandStep >= nLoopEnd)
+			nLandStep -= nLoopEnd - nLoopStart;
 
+		pd->sound->sequence->setCurrentStep(pSequence, nLandStep, nOffset, nLateSteps == 0);
+
+		nHeardAt = nNow;
+		pSeek->nLastLateSteps = nLateSteps;
+		pSeek->nLateCount++;
 	}
-	
+
+	pSeek->nLastLatency = nHeardAt - pSeek->nCallTime;
+	if (pSeek->nLastLatency > pSeek->nMaxLatency)
+		pSeek->nMaxLatency = pSeek->nLastLatency;
+
+	pSeek->nSeekCount++;
+	pSeek->bPending = FALSE;
 
 }
 
 
 // --------------------------------------------------------------------------------
-int shouldDecodeArrayValueAtIndex(json_decoder* decoder, int pos)
+// Runs on the audio thread once per block and renders nothing. The first block of
+// a step puts the step into the event ring, stamped with the time it started on.
+// The loop region and labels are read while the main loop may swap beats, at
+// worst the step of a swap gets the flags of the beat before it.
+// --------------------------------------------------------------------------------
+static int BeatMachineEventSource(void* pContext, int16_t* pLeft, int16_t* pRight, int nLength)
 {
+	BeatMachine* pBeatMachine = pContext;
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	SoundSequence* pSequence = pBeatMachine->pSequence;
 
-	if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_NOTES)
+	if (pSequence == NULL || !pd->sound->sequence->isPlaying(pSequence))
 	{
-		decodeData.nArrayPos = pos;
-		decodeData.note.pitch = 0;
-		decodeData.note.len = 0;
-		decodeData.note.velocity = 0.0f;
+		pBeatMachine->nEventStep = -1;
+		return 0;
 	}
-	else if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_LABELS)
+
+	int nOffset = 0;
+	int nStep = pd->sound->sequence->getCurrentStep(pSequence, &nOffset);
+
+	int nLastStep = pBeatMachine->nEventStep;
+	if (nStep == nLastStep)
+		return 0;
+
+	pBeatMachine->nEventStep = nStep;
+
+	// a seek lands in the middle of the step before its label, that step never started
+	if (nOffset >= nLength)
+		return 0;
+
+	int nTypes = BM_EVENT_STEP;
+
+	if (nStep % BM_STEPS_PER_BEAT == 0)
+		nTypes |= BM_EVENT_BEAT;
+
+	if (nStep % BM_STEPS_PER_BAR == 0)
+		nTypes |= BM_EVENT_BAR;
+
+	int nLabel = BM_EVENT_NO_LABEL;
+	for (int i = 0; i < pBeatMachine->nLabelCount; i++)
 	{
-		decodeData.nArrayPos = pos;
-		memset(decodeData.szBuffer, 0, 128);
-		decodeData.nValue = 0;
+		if (pBeatMachine->labels[i].nStep == nStep)
+		{
+			nLabel = i;
+			nTypes |= BM_EVENT_LABEL;
+			break;
+		}
 	}
 
-	return 1;
+	int nLoopStart;
+	int nLoopEnd;
+	BeatMachineGetLoopRegion(pBeatMachine->bLoopOn, pBeatMachine->nLoopStart, pBeatMachine->nLoopLast, pBeatMachine->nBeatLength, &nLoopStart, &nLoopEnd);
+
+	if (nStep == nLoopStart && nLastStep == nLoopEnd - 1)
+		nTypes |= BM_EVENT_LOOP;
+
+	BeatEventBusPush(&pBeatMachine->events, nTypes, nStep, pd->sound->getCurrentTime() - nOffset, nLabel);
+
+	return 0;
 }
 
 
 // --------------------------------------------------------------------------------
-void didDecodeArrayValue(json_decoder* decoder, int pos, json_value value)
+// nMask is a set of BM_EVENT_ bits. Returns the id for BeatMachineUnsubscribe(),
+// -1 when all BM_EVENT_MAX_SUBSCRIBERS are taken. The callbacks are made from
+// BeatMachineDispatchEvents() on the main loop, never from the audio thread.
+// --------------------------------------------------------------------------------
+int BeatMachineSubscribe(BeatMachine* pBeatMachine, int nMask, BeatEventCallback* pfnCallback, void* pUserdata)
 {
+	if (pBeatMachine == NULL)
+		return -1;
 
-	if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_NOTES)
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	int nId = BeatEventBusSubscribe(&pBeatMachine->events, nMask, pfnCallback, pUserdata);
+
+	// nobody listening costs nothing, the source only comes with the first subscriber
+	if (nId >= 0 && pBeatMachine->pEventSource == NULL)
 	{
-		if (decodeData.nArrayPos == pos)
-		{
-			if (pBeatMachine)
-			{
-				int nStep = decodeData.nStep;
-				int nTrack = decodeData.nTrack;
+		pBeatMachine->pEventChannel = pd->sound->channel->newChannel();
+		pBeatMachine->pEventSource = pd->sound->channel->addCallbackSource(pBeatMachine->pEventChannel, BeatMachineEventSource, pBeatMachine, 0);
+	}
+
+	return nId;
+}
 
-				pd->sound->track->addNoteEvent(pBeatMachine->pTracks[nTrack]->pTrack, nStep, decodeData.note.len, decodeData.note.pitch, decodeData.note.velocity);
 
-				int nLength = nStep + decodeData.note.len;
-				if (nLength > pBeatMachine->nBeatLength)
-					pBeatMachine->nBeatLength = nLength;
+// --------------------------------------------------------------------------------
+void BeatMachineUnsubscribe(BeatMachine* pBeatMachine, int nId)
+{
+	if (pBeatMachine)
+		BeatEventBusUnsubscribe(&pBeatMachine->events, nId);
 
-				if (pBeatMachine->pTracks[nTrack]->bIsChordTrack && pBeatMachine->pScaleManager->nCurrentScale != SCALE_CHROMATIC)
-				{
-					int nPitchIndex = pBeatMachine->pScaleManager->nPitchToIndexTable[decodeData.note.pitch];
+}
 
-					int nPitch3Index = nPitchIndex + 2;
-					if (nPitch3Index > pBeatMachine->pScaleManager->nMaxIndex)
-						nPitch3Index -= pBeatMachine->pScaleManager->nCurrentScalePitchCount;
-					int nPitch3 = pBeatMachine->pScaleManager->nCurrentPitchTable[nPitch3Index];
-					pd->sound->track->addNoteEvent(pBeatMachine->pTracks[nTrack]->pTrack, nStep, decodeData.note.len, nPitch3, decodeData.note.velocity);
 
-					int nPitch5Index = nPitchIndex + 4;
-					if (nPitch5Index > pBeatMachine->pScaleManager->nMaxIndex)
-						nPitch5Index -= pBeatMachine->pScaleManager->nCurrentScalePitchCount;
-					int nPitch5 = pBeatMachine->pScaleManager->nCurrentPitchTable[nPitch5Index];
-					pd->sound->track->addNoteEvent(pBeatMachine->pTracks[nTrack]->pTrack, nStep, decodeData.note.len, nPitch5, decodeData.note.velocity);
+// --------------------------------------------------------------------------------
+// Call once per frame. Every step since the last frame is handed out in order, each
+// with the time it started on, so a late frame still knows where the beat was.
+// --------------------------------------------------------------------------------
+void BeatMachineDispatchEvents(BeatMachine* pBeatMachine)
+{
+	if (pBeatMachine == NULL)
+		return;
 
+	BeatEventBus* pBus = &pBeatMachine->events;
 
-				}
+	int nTypes;
+	int nStep;
+	uint32_t nTime;
+	int nLabel;
 
-			}
-		}
+	while (BeatEventBusPop(pBus, &nTypes, &nStep, &nTime, &nLabel))
+	{
+		const char* szLabel = NULL;
+		if (nLabel >= 0 && nLabel < pBeatMachine->nLabelCount)
+			szLabel = pBeatMachine->labels[nLabel].szText;
+
+		BeatEventBusDispatch(pBus, nTypes, nStep, nTime, szLabel);
 	}
-	
 
 }
 
 
 // --------------------------------------------------------------------------------
-void* didDecodeSublist(json_decoder* decoder, const char* name, json_value_type type)
+// Plays szSample, the sample name of a track of the loaded beat, on the next step
+// that is a multiple of nQuantum steps (BM_QUANTUM_STEP, _BEAT, _BAR). The start
+// is worked out from where the sequence is within its step and handed to the
+// synth as a time, so it lands on the grid to the sample whenever the frame ran.
+// A step that starts right now counts as the next one. Without a playing beat the
+// sample plays straight away. Returns -1 when the beat has no such sample.
+// --------------------------------------------------------------------------------
+int BeatMachineTriggerQuantized(BeatMachine* pBeatMachine, const char* szSample, int nQuantum, float fVelocity)
 {
+	if (pBeatMachine == NULL || szSample == NULL || nQuantum < 1)
+		return -1;
 
-	if (strcmp(name, "beat") == 0)
-	{
-		if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_HEADER)
-			decodeData.nStateCount--;
+	PlaydateAPI* pd = pBeatMachine->pd;
+
+	BeatTriggerPool* pPool = &pBeatMachine->triggers;
 
+	AudioSample* pSample = NULL;
+	for (int i = 0; i < BM_MAX_TRACK && pSample == NULL; i++)
+	{
+		BeatMachineTrack* pTrack = pBeatMachine->pTracks[i];
+		if (pTrack && pTrack->pSample && pTrack->pSampleName && strcmp(pTrack->pSampleName, szSample) == 0)
+			pSample = pTrack->pSample;
 	}
-	else if (strcmp(name, "tracks") == 0)
+
+	if (pSample == NULL)
+		return -1;
+
+	uint32_t nNow = pd->sound->getCurrentTime();
+	uint32_t nWhen = nNow;
+	int nTargetStep = -1;
+
+	SoundSequence* pSequence = pBeatMachine->pSequence;
+
+	if (pSequence && pd->sound->sequence->isPlaying(pSequence))
 	{
-	
-		if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_TRACK_INFO)
-			decodeData.nStateCount--;
+		int nOffset = 0;
+		int nStep = pd->sound->sequence->getCurrentStep(pSequence, &nOffset);
+
+		int nStepsAhead = nQuantum - nStep % nQuantum;
+		if (nOffset == 0 && nStep % nQuantum == 0)
+			nStepsAhead = 0;
+
+		int nLoopStart;
+		int nLoopEnd;
+		BeatMachineGetLoopRegion(pBeatMachine->bLoopOn, pBeatMachine->nLoopStart, pBeatMachine->nLoopLast, pBeatMachine->nBeatLength, &nLoopStart, &nLoopEnd);
+
+		nTargetStep = nStep + nStepsAhead;
+
+		// past the loop end the grid starts again from the loop start
+		if (nTargetStep >= nLoopEnd && nLoopEnd > nLoopStart)
+		{
+			nTargetStep = (nLoopStart + nQuantum - 1) / nQuantum * nQuantum;
+			nStepsAhead = (nLoopEnd - nStep) + (nTargetStep - nLoopStart);
+		}
+
+		float fFramesPerStep = BM_SAMPLE_RATE / BeatMachineStepsPerSecond(pBeatMachine->nBPM);
 
+		nWhen = nNow - nOffset + (uint32_t)(nStepsAhead * fFramesPerStep + 0.5f);
 	}
-	else if (strcmp(name, "env") == 0)
+
+	// a voice with this sample that is done by then, else the voice that is done first
+	int nVoice = 0;
+	for (int v = 0; v < BM_TRIGGER_VOICES; v++)
 	{
-		if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_ENVOLOPE)
+		if ((int32_t)(pPool->nVoiceEnds[v] - nWhen) <= 0 && pPool->pVoiceSamples[v] == pSample)
 		{
-			decodeData.nStateCount--;
-
-			BeatMachineSetADSR(decodeData.nTrack, decodeData.fValue1, decodeData.fValue2, decodeData.fValue3, decodeData.fValue4);
+			nVoice = v;
+			break;
 		}
-		
+
+		if ((int32_t)(pPool->nVoiceEnds[v] - pPool->nVoiceEnds[nVoice]) < 0)
+			nVoice = v;
 	}
-	else if (strcmp(name, "loop") == 0)
+
+	if ((int32_t)(pPool->nVoiceEnds[nVoice] - nWhen) > 0)
+		pPool->nStolenCount++;
+
+	PDSynth* pVoice = pPool->pVoices[nVoice];
+
+	if (pPool->pVoiceSamples[nVoice] != pSample)
 	{
-		if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_LOOP)
-			decodeData.nStateCount--;
+		pd->sound->synth->setSample(pVoice, pSample, 0, 0);
+		pPool->pVoiceSamples[nVoice] = pSample;
+	}
+
+	float fLength = pd->sound->sample->getLength(pSample);
+
+	pd->sound->synth->playMIDINote(pVoice, BM_TRIGGER_NOTE, fVelocity, fLength, nWhen);
+
+	pPool->nVoiceEnds[nVoice] = nWhen + (uint32_t)(fLength * BM_SAMPLE_RATE);
+	pPool->nLastCallTime = nNow;
+	pPool->nLastWhen = nWhen;
+	pPool->nLastStep = nTargetStep;
+	pPool->nTriggerCount++;
+
+	return 0;
+}
 
+
+// --------------------------------------------------------------------------------
+static int BeatMachineLoadNow(BeatMachine* pBeatMachine, const char* szName)
+{
+	if (BeatMachineBeginLoad(pBeatMachine, szName) != 0)
+	{
+		BeatMachineCancelLoad(pBeatMachine);
+		return -1;
 	}
-	else if (strcmp(name, "lpf") == 0)
+
+	int nPhase = BM_LOAD_IDLE;
+	while (nPhase != BM_LOAD_READY && nPhase != BM_LOAD_FAILED)
+		nPhase = BeatMachineStepLoad(pBeatMachine, BM_LOAD_NO_BUDGET);
+
+	if (nPhase == BM_LOAD_FAILED)
 	{
-		if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_FILTER)
-		{
-			decodeData.nStateCount--;
-			BeatMachineEnableFilter(decodeData.nTrack, decodeData.nExtra, decodeData.nValue, decodeData.fValue1, decodeData.fValue2);
-		}
+		BeatMachineCancelLoad(pBeatMachine);
+		return -1;
+	}
+
+	return BeatMachineCommitLoad(pBeatMachine);
+}
+
+
+// --------------------------------------------------------------------------------
+int BeatMachineLoadBeat(BeatMachine* pBeatMachine, const char* szName)
+{
+	return BeatMachineLoadNow(pBeatMachine, szName);
+}
+
+
+// --------------------------------------------------------------------------------
+int BeatMachineLoadCompiledBeat(BeatMachine* pBeatMachine, const char* szName)
+{
+	return BeatMachineLoadNow(pBeatMachine, szName);
+}
+
+
+// --------------------------------------------------------------------------------
+// Starts mixing the loop region of the playing beat, or the whole beat when it has
+// no loop, into one buffer of at most nMaxBytes. Nothing changes for the listener
+// until it is done, BeatMachineStepPrerender() does the work a little per frame.
+// --------------------------------------------------------------------------------
+int BeatMachineBeginPrerender(BeatMachine* pBeatMachine, int nMaxBytes)
+{
+	if (pBeatMachine == NULL)
+		return BM_PRERENDER_NO_BEAT;
+
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_OK);
+
+	if (pBeatMachine->nBeatLength <= 0)
+		return pBeatMachine->prerender.nError = BM_PRERENDER_NO_BEAT;
+
+	// the buffer is mixed dry, synth tracks have their effects from the freeze
+	int bStereo = FALSE;
+	for (int i = 0; i < BM_MAX_TRACK; i++)
+	{
+		BeatMachineTrack* pTrack = pBeatMachine->pTracks[i];
+		if (pTrack == NULL || pTrack->bMuted)
+			continue;
+
+		if (BeatBusSendIsActive(&pTrack->send) || (pTrack->nSoundSource == BM_TYPE_SAMPLE && BeatMachineTrackHasEffects(pTrack)))
+			return pBeatMachine->prerender.nError = BM_PRERENDER_UNSUPPORTED;
+
+		if (pTrack->fPanning != 0.0f)
+			bStereo = TRUE;
+	}
+
+	int nLoopStart;
+	int nLoopEnd;
+	BeatMachineGetLoopRegion(pBeatMachine->bLoopOn, pBeatMachine->nLoopStart, pBeatMachine->nLoopLast, pBeatMachine->nBeatLength, &nLoopStart, &nLoopEnd);
+
+	return BeatPrerenderBegin(&pBeatMachine->prerender, pBeatMachine->pd, nLoopStart, nLoopEnd - nLoopStart, BeatMachineStepsPerSecond(pBeatMachine->nBPM), bStereo, nMaxBytes);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMachinePrerenderNextTrack(BeatPrerender* pRender)
+{
+	pRender->nTrackCursor++;
+	pRender->nNoteCursor = 0;
+}
+
+
+// --------------------------------------------------------------------------------
+// One unit of the render: a note of a sampler track, or for a synth track one of
+// the keys freezing would render and then a note of those. Muted tracks are left
+// out, the way they are heard.
+// --------------------------------------------------------------------------------
+static void BeatMachinePrerenderNext(BeatMachine* pBeatMachine)
+{
+	PlaydateAPI* pd = pBeatMachine->pd;
+	BeatPrerender* pRender = &pBeatMachine->prerender;
+
+	if (pRender->nTrackCursor == BM_MAX_TRACK)
+	{
+		BeatPrerenderFinish(pRender);
+		return;
+	}
+
+	BeatMachineTrack* pTrack = pBeatMachine->pTracks[pRender->nTrackCursor];
 
+	if (pTrack == NULL || pTrack->pTrack == NULL || pTrack->bMuted)
+	{
+		BeatMachinePrerenderNextTrack(pRender);
+		return;
 	}
-	else if (strcmp(name, "delay") == 0)
+
+	BeatPrerenderSource source;
+
+	if (pTrack->nSoundSource == BM_TYPE_SAMPLE)
 	{
-		if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_DELAY)
+		uint32_t nStep;
+		uint32_t nLen;
+		MIDINote fNote;
+		float fVelocity;
+
+		if (pTrack->pSample == NULL || !pd->sound->track->getNoteAtIndex(pTrack->pTrack, pRender->nNoteCursor++, &nStep, &nLen, &fNote, &fVelocity))
 		{
-			decodeData.nStateCount--;
-			BeatMachineEnableDelay(decodeData.nTrack, decodeData.fValue1, decodeData.fValue2);
-			
+			BeatMachinePrerenderNextTrack(pRender);
+			return;
 		}
 
+		BeatPrerenderSourceFromSample(pd, pTrack->pSample, &source);
+		source.fGain = pTrack->fVolume;
+		source.fPanning = pTrack->fPanning;
+		source.nReleaseFrames = (int)(pTrack->fRelease * BM_PRERENDER_RATE);
+
+		BeatPrerenderMixNote(pRender, &source, nStep, (float)nLen, fNote, fVelocity);
+		return;
 	}
-	else if (strcmp(name, "bitcrush") == 0)
+
+	// a frozen track has its keys already
+	if (pRender->pFreeze == NULL)
 	{
-		if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_BITCRUSHER)
-		{
-			decodeData.nStateCount--;
-			BeatMachineEnableBitCrusher(decodeData.nTrack, decodeData.fValue1, decodeData.fValue2);
+		pRender->pFreeze = pTrack->pFrozen;
+		pRender->bOwnsFreeze = FALSE;
 
+		if (pRender->pFreeze == NULL)
+		{
+			BeatFreezeVoice voice;
+			BeatMachineTrackFreezeVoice(pTrack, &voice, pBeatMachine->nBPM);
+
+			int nError = BM_FREEZE_OK;
+			pRender->pFreeze = BeatFreezeBegin(pd, pTrack->pTrack, &voice, BeatMachineFramesPerStep(pBeatMachine->nBPM), &nError);
+			pRender->bOwnsFreeze = TRUE;
+
+			// too many keys is too much memory as well
+			if (nError != BM_FREEZE_OK)
+				BeatMachinePrerenderDrop(pBeatMachine, nError == BM_FREEZE_UNSUPPORTED ? BM_PRERENDER_UNSUPPORTED : BM_PRERENDER_TOO_BIG);
+			else if (pRender->pFreeze == NULL)
+				BeatMachinePrerenderNextTrack(pRender);
 		}
 
+		return;
 	}
-	else if (strcmp(name, "notes") == 0)
+
+	BeatFreeze* pFreeze = pRender->pFreeze;
+
+	if (pFreeze->nKeysRendered < pFreeze->cost.nKeyCount)
 	{
-		if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_NOTES)
-			decodeData.nStateCount--;
+		BeatFreezeRenderKeys(pFreeze, 1);
+		return;
 	}
-	else if (strcmp(name, "scale") == 0)
-	{
-		if (decodeData.nLoadStates[decodeData.nStateCount - 1] == LOAD_STATE_SCALE)
-		{
-			decodeData.nStateCount--;
 
-			SetupScaleWithString(pBeatMachine->pScaleManager, decodeData.szBuffer, decodeData.szBufferSmall);
-		}
+	if (pRender->nNoteCursor < pFreeze->cost.nNoteCount)
+	{
+		int i = pRender->nNoteCursor++;
+		int nKey = pFreeze->pNoteKeys[i];
+
+		// the envelope and the velocity are in the key, it plays to its end
+		source.pData = (const uint8_t*)pFreeze->pSampleData[nKey];
+		source.format = kSound16bitMono;
+		source.nFrameCount = pFreeze->keys[nKey].nFrames;
+		source.nSampleRate = BM_FREEZE_SAMPLE_RATE;
+		source.fGain = pTrack->fVolume;
+		source.fPanning = pTrack->fPanning;
+		source.nReleaseFrames = 0;
+
+		BeatPrerenderMixNote(pRender, &source, pFreeze->pNotes[i].nStep, (float)pFreeze->keys[nKey].nEventLen, BM_PRERENDER_MIDDLE_C, 1.0f);
+		return;
 	}
-	
 
+	if (pRender->bOwnsFreeze)
+		BeatFreezeFree(pFreeze);
+
+	pRender->pFreeze = NULL;
+	pRender->bOwnsFreeze = FALSE;
+
+	BeatMachinePrerenderNextTrack(pRender);
 
-	return NULL;
 }
 
 
 // --------------------------------------------------------------------------------
-int BeatMachineLoadBeat(const char* szName)
+// Plays the buffer while the playhead of the sequence is in the rendered region
+// and the live tracks everywhere else, before the loop and after a seek out of it.
+// --------------------------------------------------------------------------------
+static void BeatMachinePrerenderFollow(BeatMachine* pBeatMachine)
 {
+	PlaydateAPI* pd = pBeatMachine->pd;
+	BeatPrerender* pRender = &pBeatMachine->prerender;
 
-	json_decoder decoder =
-	{
-		.decodeError = decodeError,
-		.willDecodeSublist = willDecodeSublist,
-		.shouldDecodeTableValueForKey = shouldDecodeTableValueForKey,
-		.didDecodeTableValue = didDecodeTableValue,
-		.shouldDecodeArrayValueAtIndex = shouldDecodeArrayValueAtIndex,
-		.didDecodeArrayValue = didDecodeArrayValue,
-		.didDecodeSublist = didDecodeSublist
-	};
+	int nOffset = 0;
+	int nStep = pd->sound->sequence->getCurrentStep(pBeatMachine->pSequence, &nOffset);
 
-	char szPath[256];
-	memset(szPath, 0, 256);
-	strcpy(szPath, "beats/");
-	strcat(szPath, szName);
+	int bInRegion = pd->sound->sequence->isPlaying(pBeatMachine->pSequence)
+		&& nStep >= pRender->nFirstStep && nStep < pRender->nFirstStep + pRender->nStepCount;
 
-	if (pBeatMachine)
-	{
-		if (pBeatMachine->szBeatName)
-			Engine_MemFree(pBeatMachine->szBeatName);
+	float fOffset = (nStep - pRender->nFirstStep + nOffset / BeatMachineFramesPerStep(pBeatMachine->nBPM)) / BeatMachineStepsPerSecond(pBeatMachine->nBPM);
 
-		pBeatMachine->szBeatName = Engine_StrDup(szName);
+	if (pRender->nState == BM_PRERENDER_READY && bInRegion)
+	{
+		BeatPrerenderPlay(pRender, fOffset);
+		BeatMachineSetChannelsLive(pBeatMachine, FALSE);
+	}
+	else if (pRender->nState == BM_PRERENDER_PLAYING && !bInRegion)
+	{
+		BeatPrerenderStop(pRender);
+		BeatMachineSetChannelsLive(pBeatMachine, TRUE);
+	}
+	else if (pRender->nState == BM_PRERENDER_PLAYING)
+	{
+		BeatPrerenderSync(pRender, fOffset);
 	}
 
-	SDFile* file = pd->file->open(szPath, kFileRead | kFileReadData);
+}
 
-	if (file == NULL)
-		pd->system->logToConsole("filerror: %s", pd->file->geterr());
 
-	json_value val;
+// --------------------------------------------------------------------------------
+// Renders for at most about nBudgetMicros and, once the buffer is done, switches
+// between it and the live tracks. Has to be called every frame for as long as the
+// prerendered beat is wanted, returns the BM_PRERENDER_ state it is in.
+// --------------------------------------------------------------------------------
+int BeatMachineStepPrerender(BeatMachine* pBeatMachine, int nBudgetMicros)
+{
+	if (pBeatMachine == NULL)
+		return BM_PRERENDER_IDLE;
+
+	BeatPrerender* pRender = &pBeatMachine->prerender;
 
-	pd->json->decode(&decoder, (json_reader) { .read = (json_readFunc*)pd->file->read, .userdata = file }, & val);
-	pd->file->close(file);
+	if (pRender->nState == BM_PRERENDER_RENDERING)
+	{
+		float fStart = BeatMachineLoadTimer(pBeatMachine);
+		float fBudget = nBudgetMicros / 1000000.0f;
+		float fNow = fStart;
 
-	return 0;
+		// at least one unit of work per step so a render always finishes
+		do
+		{
+			BeatMachinePrerenderNext(pBeatMachine);
+			fNow = BeatMachineLoadTimer(pBeatMachine);
+		}
+		while (pRender->nState == BM_PRERENDER_RENDERING && fNow - fStart < fBudget);
+
+		pRender->fRenderTime += fNow - fStart;
+	}
+
+	if (pRender->nState == BM_PRERENDER_READY || pRender->nState == BM_PRERENDER_PLAYING)
+		BeatMachinePrerenderFollow(pBeatMachine);
+
+	return pRender->nState;
 }
 
 
 // --------------------------------------------------------------------------------
-void BeatMachinePlayTheBeat(int nLoops)
+void BeatMachineEndPrerender(BeatMachine* pBeatMachine)
 {
+	BeatMachinePrerenderDrop(pBeatMachine, BM_PRERENDER_OK);
+}
+
 
+// --------------------------------------------------------------------------------
+void BeatMachinePlayTheBeat(BeatMachine* pBeatMachine, int nLoops)
+{
 	if (pBeatMachine && pBeatMachine->pSequence)
 	{
-		pd->sound->sequence->setLoops(pBeatMachine->pSequence, 0, pBeatMachine->nBeatLength, nLoops);
+		PlaydateAPI* pd = pBeatMachine->pd;
+
+		int nLoopStart;
+		int nLoopEnd;
+		BeatMachineGetLoopRegion(pBeatMachine->bLoopOn, pBeatMachine->nLoopStart, pBeatMachine->nLoopLast, pBeatMachine->nBeatLength, &nLoopStart, &nLoopEnd);
+
+		// the steps before the loop region play once, the sequence wraps on its own so release tails ring across
+		pd->sound->sequence->setLoops(pBeatMachine->pSequence, nLoopStart, nLoopEnd, nLoops);
 
 		pd->sound->sequence->setCurrentStep(pBeatMachine->pSequence, 0, 0, 0);
 
@@ -897,8 +3978,31 @@ void BeatMachinePlayTheBeat(int nLoops)
 
 
 // --------------------------------------------------------------------------------
-void BeatMachineStopTheBeat()
+void BeatMachineStopTheBeat(BeatMachine* pBeatMachine)
 {
-	if (pBeatMachine && pBeatMachine->pSequence)
-		pd->sound->sequence->stop(pBeatMachine->pSequence);
+	if (pBeatMachine == NULL)
+		return;
+
+	// stopping drops a fade and keeps an armed beat loaded, but it won't start by itself
+	if (pBeatMachine->transition.nState == BM_TRANSITION_FADING)
+	{
+		BeatMachineCancelLoad(pBeatMachine);
+	}
+	else if (pBeatMachine->transition.nState == BM_TRANSITION_ARMED)
+	{
+		BeatMachineSetTracksGain(pBeatMachine, pBeatMachine->pLoad->pTracks, 1.0f);
+		pBeatMachine->transition.nState = BM_TRANSITION_NONE;
+	}
+
+	pBeatMachine->seek.bPending = FALSE;
+
+	// the buffer is kept, it plays again once the beat does
+	if (pBeatMachine->prerender.nState == BM_PRERENDER_PLAYING)
+	{
+		BeatPrerenderStop(&pBeatMachine->prerender);
+		BeatMachineSetChannelsLive(pBeatMachine, TRUE);
+	}
+
+	if (pBeatMachine->pSequence)
+		pBeatMachine->pd->sound->sequence->stop(pBeatMachine->pSequence);
 }
@@ -26,6 +26,16 @@ PERFORMANCE OF THIS SOFTWARE.
 #include "pd_api.h"
 
 #include "scale_manager.h"
+#include "sample_cache.h"
+#include "beat_format.h"
+#include "beat_arena.h"
+#include "beat_mixer.h"
+#include "beat_events.h"
+#include "beat_freeze.h"
+#include "beat_prerender.h"
+#include "beat_bus.h"
+#include "beat_delay.h"
+#include "beat_wavetable.h"
 
 
 // --------------------------------------------------------------------------------
@@ -46,10 +56,35 @@ typedef enum
 	LOAD_STATE_LABELS,
 	LOAD_STATE_SCALE,
 	LOAD_STATE_LOOP,
-	LOAD_STATE_OPTIONS
+	LOAD_STATE_OPTIONS,
+	LOAD_STATE_HARMONICS
 } BM_LOAD_STATES;
 
 
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BM_LOAD_IDLE,
+	BM_LOAD_READING,
+	BM_LOAD_DECODING,
+	BM_LOAD_SORTING,
+	BM_LOAD_TRACKS,
+	BM_LOAD_NOTES,
+	BM_LOAD_FREEZING,
+	BM_LOAD_READY,
+	BM_LOAD_FAILED
+} BM_LOAD_PHASES;
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BM_TRANSITION_NONE,
+	BM_TRANSITION_ARMED,		// the loaded beat waits for its start step
+	BM_TRANSITION_FADING		// both beats play, the old one is freed when the fade is over
+} BM_TRANSITION_STATES;
+
+
 // --------------------------------------------------------------------------------
 typedef enum
 {
@@ -82,8 +117,20 @@ typedef enum
 	BM_TRACK_FILENAMEL_SIZE = 48,
 
 	BM_CHORD_TRACK = 8,
+	BM_CHORD_VOICE_COUNT = SCALE_CHORD_MAX_NOTES - 1,
+
+	BM_MAX_NOTE_LENGTH = 64,
+	BM_ROOT_BLOCK = 64,
+	BM_MAX_LABEL = 16,
 
-	BM_MAX_NOTE_LENGTH = 64
+	BM_LOAD_READ_CHUNK = 4096,
+	BM_LOAD_NOTE_BATCH = 64,
+	BM_LOAD_SCAN_BATCH = 128,		// values beat_scanner.c reads in one unit of a load
+	BM_LOAD_NO_BUDGET = 0,
+
+	BM_SCAN_MAX_DEPTH = 16,
+
+	BM_SAMPLE_RATE = 44100
 
 } BM_CONST;
 
@@ -97,6 +144,21 @@ typedef struct
 } Note;
 
 
+// --------------------------------------------------------------------------------
+// A note the way a track was given it, with every transpose since added to nPitch.
+// The pitch isn't clamped, so a transpose and its opposite always come back to the
+// same note, only the events written from it are held to 0..127.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int nPitch;
+	float fVelocity;
+	uint16_t nStep;
+	uint8_t nLen;
+
+} BeatRootNote;
+
+
 // --------------------------------------------------------------------------------
 typedef struct
 {
@@ -114,14 +176,30 @@ typedef struct
 	char szTrackName[16];
 
 	char* pSampleName;
+	AudioSample* pSample;
+
+	// what a wavetable track plays, from the arena of its beat
+	BeatWavetable* pWavetable;
 
 	float fVolume;
 	float fPanning;
 
 	int bMuted;
 	int bIsChordTrack;
-
-	DelayLine* delay;
+	int nChordType;					// SCALE_CHORD_TRIAD or SCALE_CHORD_SEVENTH
+	int nChordInversion;
+	PDSynth* pChordVoices[BM_CHORD_VOICE_COUNT];
+
+	// the roots of a chord track, or the notes of a synth track once it was first
+	// transposed, in step order. The events of a step are written again from them
+	// when a scale change or transpose moves any of its tones
+	BeatRootNote* pRoots;
+	int nRootCount;
+	int nRootCapacity;
+	int bKeepNotes;
+
+	BeatDelayLine* delay;			// from the machine's pool, NULL when it had none left
+	int nDelaySteps;
 	int bDelayEnabled;
 	float fDelayFeedback;
 	float fDelayMix;
@@ -138,6 +216,16 @@ typedef struct
 	float fBitcrusherAmount;
 	float fBitcrusherMix;
 
+	// what it sends to the shared buses, the tap goes after the effects above
+	BeatBusSend send;
+
+	// set while the track plays through the beat mixer instead of its own channel
+	BeatMixerInput* pMixerInput;
+	int nPolyphony;					// voices it may hold in the mixer's pool, 0 for the default
+
+	// set while a synth track plays from rendered samples, pInstrument is kept for thawing
+	BeatFreeze* pFrozen;
+
 
 } BeatMachineTrack;
 
@@ -145,11 +233,230 @@ typedef struct
 // --------------------------------------------------------------------------------
 typedef struct
 {
+	int nFileVersion;
+	int nStep;
+	Note note;
+	int nTrack;
+
+	char szBuffer[128];
+	char szBufferSmall[32];
+	float fValue1;
+	float fValue2;
+	float fValue3;
+	float fValue4;
+	int nValue;
+	int nExtra;
+
+	int nArrayPos;
+
+	int nStateCount;
+	int nLoadStates[16];
+} DecodeData;
+
+
+// --------------------------------------------------------------------------------
+// Where beat_scanner.c is in the file. It is kept in the load context between two
+// load steps, so a scan can stop after any value and go on from there.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int nOffset;				// into the file data, the next byte to read
+	int bStarted;
+
+	int nTrack;
+	int nStep;					// of the note before, a note without one keeps it
+	int nHarmonic;
+	BMBNote note;
+	BMBLabel label;
+
+	int nStateCount;
+	int nStates[BM_SCAN_MAX_DEPTH];
+	int bHasMembers[BM_SCAN_MAX_DEPTH];
+} ScanData;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int nNoteCount;
+	int nEventCount;			// chord notes add an event per chord tone
+	int nUnsortedTracks;		// tracks whose notes were not in step order in the file
+
+	float fReadTime;
+	float fDecodeTime;
+	float fSortTime;
+	float fTrackTime;
+	float fCommitTime;			// inserting the notes into the sequence
+	float fFreezeTime;			// rendering the tracks of nFreezeMask
+
+} BeatLoadStats;
+
+
+// --------------------------------------------------------------------------------
+// Which tracks start a note on which step, built while the notes go into the
+// sequence so nobody has to walk the tracks through pd->sound to find out. A step
+// is one bit per track, a bar has its steps or-ed together for range queries.
+// The notes of track t are numbers nNoteOffsets[t] to nNoteOffsets[t + 1] - 1 of
+// the beat, in the order of the file.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	uint16_t nStepTracks[BM_MAX_STEP_COUNT];
+	uint16_t nBarTracks[BM_MAX_BAR_NUMBER];
+	uint16_t nNoteOffsets[BM_MAX_TRACK + 1];
+
+} BeatOccupancy;
+
+
+// --------------------------------------------------------------------------------
+// A beat being loaded a slice at a time. The file is staged into the .bmb layout
+// first, then tracks and notes are built into a sequence of its own, so whatever
+// is playing is not touched until BeatMachineCommitLoad().
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	PlaydateAPI* pd;
+
+	int nPhase;
+	int bCompiled;
+	int bSortNotes;
+	int bUseScanner;
+	int bNoBudget;
+	int nFreezeMask;
+
+	char szName[BM_TRACK_FILENAMEL_SIZE];
+
+	SDFile* file;
+	uint8_t* pFileData;
+	int nFileSize;
+	int nBytesRead;
+
+	BMBHeader header;
+	BMBTrack tracks[BM_MAX_TRACK];
+	int bTrackUsed[BM_MAX_TRACK];
+	BMBLabel labels[BM_MAX_LABEL];
+
+	BMBNote* pNotes;
+	int nNoteCapacity;
+
+	int nTrackCursor;
+	int nNoteCursor;
+	int nNotesAdded;
+
+	BeatArena* pArena;
 	ScaleManager* pScaleManager;
+	SoundSequence* pSequence;
+	BeatMachineTrack* pTracks[BM_MAX_TRACK];
+	BeatOccupancy* pOccupancy;
+	int nBeatLength;
+	char* szBeatName;
+
+	DecodeData decodeData;
+	ScanData scanData;
+
+	BeatLoadStats stats;
+
+} BeatLoadContext;
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	// grid sizes for BeatMachineTriggerQuantized(), in steps, any other step count works too
+	BM_QUANTUM_STEP = 1,
+	BM_QUANTUM_BEAT = BM_STEPS_PER_BEAT,
+	BM_QUANTUM_BAR = BM_STEPS_PER_BAR,
+
+	BM_TRIGGER_VOICES = 4,
+	BM_TRIGGER_NOTE = 60			// a sample plays at its own pitch on middle C
+
+} BM_TRIGGER_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+// Sound effects played on the beat grid. The voices are made with the BeatMachine,
+// a trigger only picks one and schedules its note, and a voice keeps the last
+// sample it was given so a repeated effect doesn't even set it again.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	SoundChannel* pChannel;
+	PDSynth* pVoices[BM_TRIGGER_VOICES];
+	AudioSample* pVoiceSamples[BM_TRIGGER_VOICES];
+	uint32_t nVoiceEnds[BM_TRIGGER_VOICES];		// pd->sound->getCurrentTime() the voice is done
+
+	// the last trigger, pd->sound->getCurrentTime() of the call and of the grid step it plays on
+	uint32_t nLastCallTime;
+	uint32_t nLastWhen;
+	int nLastStep;
+
+	int nTriggerCount;
+	int nStolenCount;
+
+} BeatTriggerPool;
+
+
+// --------------------------------------------------------------------------------
+// While a transition is fading, the load context holds the beat that is fading out.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int nState;
+
+	int nStartStep;				// step of the playing beat the loaded one starts on
+	int nStepsToStart;
+	int nStepsPlayed;
+	int nLastStep;
+
+	int nLoops;
+
+	uint32_t nFadeStart;		// pd->sound->getCurrentTime() when the new beat started
+	uint32_t nFadeLength;		// in samples, 0 cuts over on the start step
+
+} BeatTransition;
+
+
+// --------------------------------------------------------------------------------
+// A seek jumps the playing sequence to a label on the next bar. The jump is made
+// from the step before the bar, to the step before the label, so the sequence
+// itself crosses onto the label on the bar and nothing has to be in time with
+// the frame. A frame that comes too late jumps as soon as it can instead.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int bPending;
+
+	int nTargetStep;			// step of the label
+	int nBarStep;				// step of the playing beat the label comes in on
+	int nStepsToBar;
+	int nStepsPlayed;
+	int nLastStep;
+
+	uint32_t nCallTime;			// pd->sound->getCurrentTime() of BeatMachineSeekToLabel()
+
+	// latency is counted in samples from the call to the first sample of the label
+	int nSeekCount;
+	int nLateCount;
+	int nLastLateSteps;
+	uint32_t nLastLatency;
+	uint32_t nMaxLatency;
+
+} BeatSeek;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	PlaydateAPI* pd;
+
+	ScaleManager* pScaleManager;
+	SampleCache* pSampleCache;
+	int bOwnsSampleCache;
 
 	SoundSequence* pSequence;
 
 	BeatMachineTrack* pTracks[BM_MAX_TRACK];
+	BeatOccupancy* pOccupancy;
 
 	int nBeatLength;
 
@@ -159,6 +466,59 @@ typedef struct
 	char* szBeatName;
 	char* szProducer;
 
+	BMBLabel labels[BM_MAX_LABEL];
+	int nLabelCount;
+
+	// loop region of the beat, nLoopLast is the last step in it as the file has it
+	int bLoopOn;
+	int nLoopStart;
+	int nLoopLast;
+
+	// tracks, scale and names of the playing beat live in pArena, a load builds into pSpareArena
+	BeatArena arenas[2];
+	BeatArena* pArena;
+	BeatArena* pSpareArena;
+
+	BeatLoadContext* pLoad;
+
+	// notes are sorted by step before they go into the sequence so every insert is an append
+	int bSortNotes;
+	BeatLoadStats loadStats;
+
+	// .bmf files go through beat_scanner.c instead of pd->json. A load stepped with a
+	// budget always does, pd->json can't stop part way through a file
+	int bUseScanner;
+
+	// the shared send effects, made the first time they are set up
+	BeatBus* pBuses[BM_BUS_COUNT];
+	int nBusDelaySteps;
+
+	// the delay tracks of a beat share nDelayLines lines, set before the first delay. The
+	// pool holds twice that, so a beat loading next to the playing one gets its own
+	int nDelayLines;
+	BeatDelayPool* pDelayPool;
+
+	// sampler tracks without effects or sends are mixed by pMixer from a pool of nMixerVoices, set before loading
+	int bUseMixer;
+	int nMixerVoices;
+	BeatMixer* pMixer;
+
+	// bit t freezes synth track t as the beat loads, set before loading
+	int nFreezeMask;
+
+	BeatTransition transition;
+	BeatSeek seek;
+
+	// step events come from a silent callback source, it is added with the first subscriber
+	BeatEventBus events;
+	SoundChannel* pEventChannel;
+	SoundSource* pEventSource;
+	int nEventStep;				// audio side only, the step the last event was for
+
+	BeatTriggerPool triggers;
+
+	// the loop region mixed down into one buffer, see BeatMachineBeginPrerender()
+	BeatPrerender prerender;
 
 } BeatMachine;
 
@@ -166,50 +526,97 @@ typedef struct
 // --------------------------------------------------------------------------------
 typedef struct
 {
-	int nFileVersion;
-	int nStep;
-	Note note;
-	int nTrack;
+	int nAllocCount;
+	int nFreeCount;
 
-	char szBuffer[128];
-	char szBufferSmall[32];
-	float fValue1;
-	float fValue2;
-	float fValue3;
-	float fValue4;
-	int nValue;
-	int nExtra;
+	int nLiveBytes;
+	int nPeakBytes;
 
-	int nArrayPos;
-
-	int nStateCount;
-	int nLoadStates[16];
-} DecodeData;
+} BeatMachineMemStats;
 
 
 // --------------------------------------------------------------------------------
 BeatMachine* BeatMachineCreate(PlaydateAPI* playdateApi);
-void BeatMachineDestroy();
+BeatMachine* BeatMachineCreateWithCache(PlaydateAPI* playdateApi, SampleCache* pSharedCache);
+void BeatMachineDestroy(BeatMachine* pBeatMachine);
+
+void BeatMachineSetBPM(BeatMachine* pBeatMachine, int nBPM);
+
+int BeatMachineLoadBeat(BeatMachine* pBeatMachine, const char* szName);
+int BeatMachineLoadCompiledBeat(BeatMachine* pBeatMachine, const char* szName);
+
+int BeatMachineBeginLoad(BeatMachine* pBeatMachine, const char* szName);
+int BeatMachineStepLoad(BeatMachine* pBeatMachine, int nBudgetMicros);
+float BeatMachineGetLoadProgress(BeatMachine* pBeatMachine);
+int BeatMachineCommitLoad(BeatMachine* pBeatMachine);
+void BeatMachineCancelLoad(BeatMachine* pBeatMachine);
 
-void BeatMachineSetBPM(int nBPM);
+int BeatMachineQueueTransition(BeatMachine* pBeatMachine, const char* szLabel, int nFadeSteps, int nLoops);
+void BeatMachineUpdateTransition(BeatMachine* pBeatMachine);
+int BeatMachineFindLabel(BeatMachine* pBeatMachine, const char* szLabel);
 
-int BeatMachineLoadBeat(const char* szName);
+int BeatMachineSeekToLabel(BeatMachine* pBeatMachine, const char* szLabel);
+void BeatMachineUpdateSeek(BeatMachine* pBeatMachine);
 
-void BeatMachineSetADSR(int nTrack, float a, float d, float s, float r);
+int BeatMachineSubscribe(BeatMachine* pBeatMachine, int nMask, BeatEventCallback* pfnCallback, void* pUserdata);
+void BeatMachineUnsubscribe(BeatMachine* pBeatMachine, int nId);
+void BeatMachineDispatchEvents(BeatMachine* pBeatMachine);
 
-void BeatMachineSetSample(int nTrack, const char* szPath, const char* szSampleName);
+int BeatMachineTriggerQuantized(BeatMachine* pBeatMachine, const char* szSample, int nQuantum, float fVelocity);
 
-void BeatMachineCreateSynth(int nTrack, int nWaveFormIndex);
-void BeatMachineCreateSynthByName(int nTrack, const char *szWaveFormName);
+void BeatMachineAddNote(BeatMachine* pBeatMachine, int nTrack, int nStep, int nLen, int nPitch, float fVelocity);
 
-void BeatMachineEnableFilter(int nTrack, int nType, int nFreq, float resonant, float mix);
-void BeatMachineEnableDelay(int nTrack, float feedback, float mix);
-void BeatMachineEnableBitCrusher(int nTrack, float amount, float mix);
+int BeatMachineGetTracksAtStep(BeatMachine* pBeatMachine, int nStep);
+int BeatMachineGetTracksInRange(BeatMachine* pBeatMachine, int nFirstStep, int nEndStep);
+int BeatMachineGetTrackNotes(BeatMachine* pBeatMachine, int nTrack, int* pFirstNote);
+
+void BeatMachineSetADSR(BeatMachine* pBeatMachine, int nTrack, float a, float d, float s, float r);
+
+void BeatMachineSetSample(BeatMachine* pBeatMachine, int nTrack, const char* szPath, const char* szSampleName);
+
+void BeatMachineCreateSampler(BeatMachine* pBeatMachine, int nTrack);
+void BeatMachineCreateSynth(BeatMachine* pBeatMachine, int nTrack, int nWaveFormIndex);
+void BeatMachineCreateSynthByName(BeatMachine* pBeatMachine, int nTrack, const char *szWaveFormName);
+void BeatMachineSetHarmonics(BeatMachine* pBeatMachine, int nTrack, const float* pLevels, int nCount);
+void BeatMachineSetWavetable(BeatMachine* pBeatMachine, int nTrack, const char* szPath, const char* szWaveName);
+void BeatMachineSetChordTrack(BeatMachine* pBeatMachine, int nTrack, int bFlag);
+void BeatMachineSetChordVoicing(BeatMachine* pBeatMachine, int nTrack, int nChordType, int nInversion);
+
+void BeatMachineSetScale(BeatMachine* pBeatMachine, int nScale, int nRoot);
+void BeatMachineTranspose(BeatMachine* pBeatMachine, int nSemitones);
+void BeatMachineSetTrackPolyphony(BeatMachine* pBeatMachine, int nTrack, int nVoices);
+
+void BeatMachineSetVolume(BeatMachine* pBeatMachine, int nTrack, float fVolume);
+void BeatMachineSetPanning(BeatMachine* pBeatMachine, int nTrack, float fValue);
+void BeatMachineMuteTrack(BeatMachine* pBeatMachine, int nTrack, int bFlag);
+
+void BeatMachineEnableFilter(BeatMachine* pBeatMachine, int nTrack, int nType, int nFreq, float resonant, float mix);
+void BeatMachineEnableDelay(BeatMachine* pBeatMachine, int nTrack, float feedback, float mix);
+void BeatMachineEnableBitCrusher(BeatMachine* pBeatMachine, int nTrack, float amount, float mix);
+void BeatMachineSetDelayTime(BeatMachine* pBeatMachine, int nTrack, int nSteps);
+
+void BeatMachineSetDelayBus(BeatMachine* pBeatMachine, int nSteps, float fFeedback, float fReturn);
+void BeatMachineSetFilterBus(BeatMachine* pBeatMachine, int nType, int nFreq, float fResonance, float fReturn);
+void BeatMachineSetSend(BeatMachine* pBeatMachine, int nTrack, int nBus, float fLevel);
+
+int BeatMachineFreezeTrack(BeatMachine* pBeatMachine, int nTrack);
+void BeatMachineUnfreezeTrack(BeatMachine* pBeatMachine, int nTrack);
+int BeatMachineGetFreezeCost(BeatMachine* pBeatMachine, int nTrack, BeatFreezeCost* pCost);
+
+int BeatMachineBeginPrerender(BeatMachine* pBeatMachine, int nMaxBytes);
+int BeatMachineStepPrerender(BeatMachine* pBeatMachine, int nBudgetMicros);
+void BeatMachineEndPrerender(BeatMachine* pBeatMachine);
 
 char** BeatMachineGetSoundSrcStrings();
+int BeatMachineFindSoundSource(const char* szWaveFormName);
+
+void BeatMachinePlayTheBeat(BeatMachine* pBeatMachine, int nLoops);
+void BeatMachineStopTheBeat(BeatMachine* pBeatMachine);
 
-void BeatMachinePlayTheBeat(int nLoops);
-void BeatMachineStopTheBeat();
+BeatMachineMemStats* BeatMachineGetMemStats();
+SampleCache* BeatMachineGetSampleCache(BeatMachine* pBeatMachine);
+const BeatArenaStats* BeatMachineGetArenaStats(BeatMachine* pBeatMachine);
+const BeatLoadStats* BeatMachineGetLoadStats(BeatMachine* pBeatMachine);
 
 
 #endif
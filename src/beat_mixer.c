@@ -0,0 +1,670 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <string.h>
+#include <math.h>
+
+#include "beat_mixer.h"
+
+#if defined(__ARM_FEATURE_SIMD32) || defined(__ARM_FEATURE_SAT)
+#include <arm_acle.h>
+#endif
+
+// --------------------------------------------------------------------------------
+
+void* Engine_MemAlloc(int nSize);
+void Engine_MemFree(void* pData);
+
+
+// --------------------------------------------------------------------------------
+// Two signed 16 bit products summed, a single SMUAD on the Cortex-M7. The C
+// version is for the simulator and the host tools. Gains are never negative and
+// stay below 1.0, so the sum can't overflow.
+// --------------------------------------------------------------------------------
+static inline int32_t BeatMixerDualMultiply(uint32_t nA, uint32_t nB)
+{
+#if defined(__ARM_FEATURE_SIMD32)
+	return __smuad((int16x2_t)nA, (int16x2_t)nB);
+#else
+	return (int16_t)nA * (int16_t)nB + (int16_t)(nA >> 16) * (int16_t)(nB >> 16);
+#endif
+}
+
+
+// --------------------------------------------------------------------------------
+static inline int16_t BeatMixerSaturate(int32_t nValue)
+{
+#if defined(__ARM_FEATURE_SAT)
+	return (int16_t)__ssat(nValue, 16);
+#else
+	return nValue > 32767 ? 32767 : (nValue < -32768 ? -32768 : (int16_t)nValue);
+#endif
+}
+
+
+// --------------------------------------------------------------------------------
+static inline uint32_t BeatMixerLoadFrame(const int16_t* pFrame)
+{
+	// left in the low half, right in the high half
+	uint32_t nFrame;
+	memcpy(&nFrame, pFrame, sizeof(uint32_t));
+
+	return nFrame;
+}
+
+
+// --------------------------------------------------------------------------------
+// The low halves of two frames and the high halves of two frames, PKHBT and PKHTB.
+// --------------------------------------------------------------------------------
+static inline uint32_t BeatMixerPackLow(uint32_t nA, uint32_t nB)
+{
+	return (nA & 0xFFFF) | (nB << 16);
+}
+
+
+// --------------------------------------------------------------------------------
+static inline uint32_t BeatMixerPackHigh(uint32_t nA, uint32_t nB)
+{
+	return (nA >> 16) | (nB & 0xFFFF0000);
+}
+
+
+// --------------------------------------------------------------------------------
+static inline uint32_t BeatMixerPackGains(int16_t nA, int16_t nB)
+{
+	return (uint16_t)nA | ((uint32_t)(uint16_t)nB << 16);
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMixerMixReference(const int16_t** pBlocks, const int16_t* pGains, int nVoices, int32_t* pLeft, int32_t* pRight, int nFrameCount)
+{
+	for (int v = 0; v < nVoices; v++)
+	{
+		const int16_t* pFrame = pBlocks[v];
+		int32_t nGainLeft = pGains[v * 2];
+		int32_t nGainRight = pGains[v * 2 + 1];
+
+		for (int i = 0; i < nFrameCount; i++, pFrame += 2)
+		{
+			pLeft[i] += (pFrame[0] * nGainLeft) >> 15;
+			pRight[i] += (pFrame[1] * nGainRight) >> 15;
+		}
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Same mix as the reference, but the left samples of two voices are packed into one
+// word, the right ones into another, and each word takes one dual multiply. Four
+// voices go through per pass so the accumulators are loaded and stored once for
+// all of them. The result can differ from the reference by one per voice pair,
+// the pair is rounded once instead of each voice.
+// --------------------------------------------------------------------------------
+void BeatMixerMixPacked(const int16_t** pBlocks, const int16_t* pGains, int nVoices, int32_t* pLeft, int32_t* pRight, int nFrameCount)
+{
+	int v = 0;
+
+	for (; v + 3 < nVoices; v += 4)
+	{
+		const int16_t* pA = pBlocks[v];
+		const int16_t* pB = pBlocks[v + 1];
+		const int16_t* pC = pBlocks[v + 2];
+		const int16_t* pD = pBlocks[v + 3];
+
+		const int16_t* pGain = &pGains[v * 2];
+		uint32_t nLeftAB = BeatMixerPackGains(pGain[0], pGain[2]);
+		uint32_t nRightAB = BeatMixerPackGains(pGain[1], pGain[3]);
+		uint32_t nLeftCD = BeatMixerPackGains(pGain[4], pGain[6]);
+		uint32_t nRightCD = BeatMixerPackGains(pGain[5], pGain[7]);
+
+		for (int i = 0; i < nFrameCount; i++)
+		{
+			uint32_t nA = BeatMixerLoadFrame(pA + i * 2);
+			uint32_t nB = BeatMixerLoadFrame(pB + i * 2);
+			uint32_t nC = BeatMixerLoadFrame(pC + i * 2);
+			uint32_t nD = BeatMixerLoadFrame(pD + i * 2);
+
+			pLeft[i] += (BeatMixerDualMultiply(BeatMixerPackLow(nA, nB), nLeftAB) >> 15) + (BeatMixerDualMultiply(BeatMixerPackLow(nC, nD), nLeftCD) >> 15);
+			pRight[i] += (BeatMixerDualMultiply(BeatMixerPackHigh(nA, nB), nRightAB) >> 15) + (BeatMixerDualMultiply(BeatMixerPackHigh(nC, nD), nRightCD) >> 15);
+		}
+	}
+
+	for (; v + 1 < nVoices; v += 2)
+	{
+		const int16_t* pA = pBlocks[v];
+		const int16_t* pB = pBlocks[v + 1];
+
+		const int16_t* pGain = &pGains[v * 2];
+		uint32_t nLeftAB = BeatMixerPackGains(pGain[0], pGain[2]);
+		uint32_t nRightAB = BeatMixerPackGains(pGain[1], pGain[3]);
+
+		for (int i = 0; i < nFrameCount; i++)
+		{
+			uint32_t nA = BeatMixerLoadFrame(pA + i * 2);
+			uint32_t nB = BeatMixerLoadFrame(pB + i * 2);
+
+			pLeft[i] += BeatMixerDualMultiply(BeatMixerPackLow(nA, nB), nLeftAB) >> 15;
+			pRight[i] += BeatMixerDualMultiply(BeatMixerPackHigh(nA, nB), nRightAB) >> 15;
+		}
+	}
+
+	if (v < nVoices)
+		BeatMixerMixReference(&pBlocks[v], &pGains[v * 2], 1, pLeft, pRight, nFrameCount);
+
+}
+
+
+// --------------------------------------------------------------------------------
+static int16_t BeatMixerToQ15(float fValue)
+{
+	if (fValue <= 0.0f)
+		return 0;
+
+	if (fValue >= 1.0f)
+		return 32767;
+
+	return (int16_t)(fValue * 32767.0f);
+}
+
+
+// --------------------------------------------------------------------------------
+static float BeatMixerVoiceLevel(const BeatMixerVoice* pVoice)
+{
+	const BeatMixerInput* pInput = pVoice->pInput;
+	float fLevel = pVoice->fVelocity * pInput->fVolume * pInput->fGain;
+
+	// the release is a straight line, stepped once a block
+	if (pVoice->bReleasing)
+		fLevel = pInput->nReleaseFrames > 0 ? fLevel * pVoice->nReleaseLeft / pInput->nReleaseFrames : 0.0f;
+
+	return fLevel;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMixerVoiceGains(const BeatMixerVoice* pVoice, int16_t* pGains)
+{
+	// same pan law as a channel, the far side is turned down and the near one kept
+	float fLevel = BeatMixerVoiceLevel(pVoice);
+	float fPanning = pVoice->pInput->fPanning;
+
+	pGains[0] = BeatMixerToQ15(fLevel * (fPanning > 0.0f ? 1.0f - fPanning : 1.0f));
+	pGains[1] = BeatMixerToQ15(fLevel * (fPanning < 0.0f ? 1.0f + fPanning : 1.0f));
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMixerFreeVoice(BeatMixer* pMixer, BeatMixerVoice* pVoice)
+{
+	if (pVoice->pInput == NULL)
+		return;
+
+	pVoice->pInput->nActiveVoices--;
+	pVoice->pInput = NULL;
+
+	pMixer->stats.nActiveVoices--;
+
+}
+
+
+// --------------------------------------------------------------------------------
+// A held voice goes into its release, or stops if the track has none.
+// --------------------------------------------------------------------------------
+static void BeatMixerReleaseVoice(BeatMixer* pMixer, BeatMixerVoice* pVoice)
+{
+	if (pVoice->bReleasing)
+		return;
+
+	if (pVoice->pInput->nReleaseFrames <= 0)
+	{
+		BeatMixerFreeVoice(pMixer, pVoice);
+		return;
+	}
+
+	pVoice->bReleasing = 1;
+	pVoice->nReleaseLeft = pVoice->pInput->nReleaseFrames;
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Returns the next block of a voice as interleaved stereo. A stereo sample at its
+// own pitch is mixed straight from the sample data, anything else is pitched,
+// widened or padded into the scratch block first.
+// --------------------------------------------------------------------------------
+static const int16_t* BeatMixerVoiceBlock(BeatMixer* pMixer, BeatMixerVoice* pVoice, int16_t* pScratch, int nFrameCount)
+{
+	const BeatMixerInput* pInput = pVoice->pInput;
+	int nChannels = pInput->nChannels;
+
+	if (pVoice->nPitchStep == (1 << BM_MIXER_PITCH_SHIFT) && nChannels == 2 && pVoice->nFrame + nFrameCount < pInput->nFrameCount)
+	{
+		const int16_t* pBlock = pInput->pData + pVoice->nFrame * 2;
+		pVoice->nFrame += nFrameCount;
+
+		return pBlock;
+	}
+
+	pMixer->stats.nResampledFrames += nFrameCount;
+
+	int nRight = nChannels - 1;
+	int i = 0;
+
+	for (; i < nFrameCount && pVoice->nFrame + 1 < pInput->nFrameCount; i++)
+	{
+		// linear interpolation, the fraction drops to 15 bits to keep the product in range
+		const int16_t* pFrame = pInput->pData + pVoice->nFrame * nChannels;
+		int32_t nFraction = pVoice->nFraction >> 1;
+
+		pScratch[i * 2] = (int16_t)(pFrame[0] + (((pFrame[nChannels] - pFrame[0]) * nFraction) >> 15));
+		pScratch[i * 2 + 1] = (int16_t)(pFrame[nRight] + (((pFrame[nChannels + nRight] - pFrame[nRight]) * nFraction) >> 15));
+
+		uint32_t nPosition = pVoice->nFraction + pVoice->nPitchStep;
+		pVoice->nFrame += nPosition >> BM_MIXER_PITCH_SHIFT;
+		pVoice->nFraction = nPosition & ((1 << BM_MIXER_PITCH_SHIFT) - 1);
+	}
+
+	memset(&pScratch[i * 2], 0, (nFrameCount - i) * 2 * sizeof(int16_t));
+
+	return pScratch;
+}
+
+
+// --------------------------------------------------------------------------------
+// Moves a voice on by one block: the held time runs down into the release and the
+// release down to silence. A voice that reached the end of its sample is freed.
+// --------------------------------------------------------------------------------
+static void BeatMixerVoiceAdvance(BeatMixer* pMixer, BeatMixerVoice* pVoice, int nFrameCount)
+{
+	if (pVoice->nFrame + 1 >= pVoice->pInput->nFrameCount)
+	{
+		BeatMixerFreeVoice(pMixer, pVoice);
+		return;
+	}
+
+	if (pVoice->bReleasing)
+	{
+		pVoice->nReleaseLeft -= nFrameCount;
+		if (pVoice->nReleaseLeft <= 0)
+			BeatMixerFreeVoice(pMixer, pVoice);
+	}
+	else if (pVoice->nHoldFrames >= 0)
+	{
+		pVoice->nHoldFrames -= nFrameCount;
+		if (pVoice->nHoldFrames <= 0)
+			BeatMixerReleaseVoice(pMixer, pVoice);
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static int BeatMixerRender(void* pContext, int16_t* pOutLeft, int16_t* pOutRight, int nFrameCount)
+{
+	BeatMixer* pMixer = pContext;
+
+	// nothing to add this cycle, the channel skips the source
+	if (pMixer->stats.nActiveVoices == 0)
+		return 0;
+
+	for (int nDone = 0; nDone < nFrameCount; nDone += BM_MIXER_BLOCK_FRAMES)
+	{
+		int nBlock = nFrameCount - nDone < BM_MIXER_BLOCK_FRAMES ? nFrameCount - nDone : BM_MIXER_BLOCK_FRAMES;
+		int nVoices = 0;
+
+		for (int v = 0; v < pMixer->nVoiceCount; v++)
+		{
+			BeatMixerVoice* pVoice = &pMixer->voices[v];
+			if (pVoice->pInput == NULL)
+				continue;
+
+			BeatMixerVoiceGains(pVoice, &pMixer->nGains[nVoices * 2]);
+			pMixer->pBlocks[nVoices] = BeatMixerVoiceBlock(pMixer, pVoice, pMixer->nScratch[nVoices], nBlock);
+			nVoices++;
+
+			BeatMixerVoiceAdvance(pMixer, pVoice, nBlock);
+		}
+
+		memset(pMixer->nLeft, 0, nBlock * sizeof(int32_t));
+		memset(pMixer->nRight, 0, nBlock * sizeof(int32_t));
+
+		if (pMixer->nKernel == BM_MIXER_KERNEL_PACKED)
+			BeatMixerMixPacked(pMixer->pBlocks, pMixer->nGains, nVoices, pMixer->nLeft, pMixer->nRight, nBlock);
+		else
+			BeatMixerMixReference(pMixer->pBlocks, pMixer->nGains, nVoices, pMixer->nLeft, pMixer->nRight, nBlock);
+
+		for (int i = 0; i < nBlock; i++)
+		{
+			pOutLeft[nDone + i] = BeatMixerSaturate(pMixer->nLeft[i]);
+			pOutRight[nDone + i] = BeatMixerSaturate(pMixer->nRight[i]);
+		}
+
+		pMixer->stats.nBlocks++;
+		pMixer->stats.nVoiceFrames += nVoices * nBlock;
+		pMixer->stats.nOccupancy[nVoices]++;
+		if (nVoices > pMixer->stats.nPeakVoices)
+			pMixer->stats.nPeakVoices = nVoices;
+	}
+
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+// Picks the voice a new note takes over, from all voices or only those of one
+// track. Voices already releasing are given up before held ones.
+// --------------------------------------------------------------------------------
+static BeatMixerVoice* BeatMixerFindVictim(BeatMixer* pMixer, const BeatMixerInput* pOwner)
+{
+	BeatMixerVoice* pVictim = NULL;
+	float fVictimScore = 0.0f;
+
+	for (int v = 0; v < pMixer->nVoiceCount; v++)
+	{
+		BeatMixerVoice* pVoice = &pMixer->voices[v];
+		if (pVoice->pInput == NULL || (pOwner && pVoice->pInput != pOwner))
+			continue;
+
+		// lower scores go first, the age counts back from the youngest voice
+		float fScore = pMixer->nStealMode == BM_MIXER_STEAL_QUIETEST ? BeatMixerVoiceLevel(pVoice) : (float)(int32_t)(pVoice->nStartOrder - pMixer->nStartOrder);
+
+		if (pVictim == NULL || pVoice->bReleasing > pVictim->bReleasing || (pVoice->bReleasing == pVictim->bReleasing && fScore < fVictimScore))
+		{
+			pVictim = pVoice;
+			fVictimScore = fScore;
+		}
+	}
+
+	return pVictim;
+}
+
+
+// --------------------------------------------------------------------------------
+static BeatMixerVoice* BeatMixerAllocVoice(BeatMixer* pMixer, BeatMixerInput* pInput)
+{
+	BeatMixerVoice* pVoice = NULL;
+
+	if (pInput->nActiveVoices >= pInput->nMaxVoices)
+	{
+		pVoice = BeatMixerFindVictim(pMixer, pInput);
+		pMixer->stats.nLimitedVoices++;
+	}
+	else
+	{
+		for (int v = 0; v < pMixer->nVoiceCount && pVoice == NULL; v++)
+		{
+			if (pMixer->voices[v].pInput == NULL)
+				pVoice = &pMixer->voices[v];
+		}
+
+		if (pVoice == NULL)
+		{
+			pVoice = BeatMixerFindVictim(pMixer, NULL);
+			pMixer->stats.nStolenVoices++;
+		}
+	}
+
+	if (pVoice)
+		BeatMixerFreeVoice(pMixer, pVoice);
+
+	return pVoice;
+}
+
+
+// --------------------------------------------------------------------------------
+// The generator of a routed synth. The sequence calls these on the audio thread,
+// so a voice is started and stopped there too. The voice begins with the next
+// mixer block, not on the exact frame of the step.
+// --------------------------------------------------------------------------------
+static int BeatMixerSynthRender(void* pUserdata, int32_t* pLeft, int32_t* pRight, int nFrameCount, uint32_t nRate, int32_t nRateDelta)
+{
+	return 0;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMixerSynthNoteOn(void* pUserdata, MIDINote note, float fVelocity, float fLength)
+{
+	BeatMixerInput* pInput = pUserdata;
+	BeatMixer* pMixer = pInput->pMixer;
+
+	float fPitch = exp2f(((float)note - BM_MIXER_MIDDLE_C) / 12.0f) * pInput->nSampleRate / BM_MIXER_RATE;
+	uint32_t nPitchStep = (uint32_t)(fPitch * (1 << BM_MIXER_PITCH_SHIFT) + 0.5f);
+
+	if (nPitchStep == 0 || pInput->nMaxVoices <= 0)
+		return;
+
+	BeatMixerVoice* pVoice = BeatMixerAllocVoice(pMixer, pInput);
+	if (pVoice == NULL)
+		return;
+
+	pVoice->nFrame = 0;
+	pVoice->nFraction = 0;
+	pVoice->nPitchStep = nPitchStep;
+	pVoice->fVelocity = fVelocity;
+	pVoice->nStartOrder = ++pMixer->nStartOrder;
+
+	// a note from the sequence knows its length, the chord notes of a track share one synth
+	// and only the last of them would hear the release
+	pVoice->nHoldFrames = fLength >= 0.0f ? (int)(fLength * BM_MIXER_RATE) : -1;
+	pVoice->bReleasing = 0;
+	pVoice->nReleaseLeft = 0;
+
+	pVoice->pInput = pInput;
+	pInput->nActiveVoices++;
+
+	pMixer->stats.nNotes++;
+	pMixer->stats.nActiveVoices++;
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMixerSynthRelease(void* pUserdata, int nEndOffset)
+{
+	BeatMixerInput* pInput = pUserdata;
+	BeatMixer* pMixer = pInput->pMixer;
+
+	// notes with a length release themselves
+	for (int v = 0; v < pMixer->nVoiceCount; v++)
+	{
+		BeatMixerVoice* pVoice = &pMixer->voices[v];
+		if (pVoice->pInput == pInput && pVoice->nHoldFrames < 0)
+			BeatMixerReleaseVoice(pMixer, pVoice);
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static int BeatMixerSynthSetParameter(void* pUserdata, int nParameter, float fValue)
+{
+	return 0;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatMixerSynthDealloc(void* pUserdata)
+{
+	// the input belongs to the track
+}
+
+
+// --------------------------------------------------------------------------------
+static void* BeatMixerSynthCopyUserdata(void* pUserdata)
+{
+	return pUserdata;
+}
+
+
+// --------------------------------------------------------------------------------
+BeatMixer* BeatMixerCreate(PlaydateAPI* playdateApi)
+{
+	PlaydateAPI* pd = playdateApi;
+
+	BeatMixer* pMixer = Engine_MemAlloc(sizeof(BeatMixer));
+	memset(pMixer, 0, sizeof(BeatMixer));
+
+	pMixer->pd = pd;
+	pMixer->nKernel = BM_MIXER_KERNEL_PACKED;
+	pMixer->nStealMode = BM_MIXER_STEAL_OLDEST;
+	pMixer->nVoiceCount = BM_MIXER_DEFAULT_VOICES;
+
+	pMixer->pChannel = pd->sound->channel->newChannel();
+	pMixer->pSource = pd->sound->channel->addCallbackSource(pMixer->pChannel, BeatMixerRender, pMixer, 1);
+
+	return pMixer;
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMixerDestroy(BeatMixer* pMixer)
+{
+	PlaydateAPI* pd = pMixer->pd;
+
+	// a callback source belongs to whoever added it
+	pd->sound->channel->removeSource(pMixer->pChannel, pMixer->pSource);
+	pd->system->realloc(pMixer->pSource, 0);
+
+	pd->sound->channel->freeChannel(pMixer->pChannel);
+
+	Engine_MemFree(pMixer);
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMixerSetKernel(BeatMixer* pMixer, int nKernel)
+{
+	pMixer->nKernel = nKernel;
+}
+
+
+// --------------------------------------------------------------------------------
+// A smaller pool costs less when many hits overlap, notes past it steal voices.
+// --------------------------------------------------------------------------------
+void BeatMixerSetVoiceCount(BeatMixer* pMixer, int nVoices)
+{
+	if (nVoices < 1)
+		nVoices = 1;
+
+	if (nVoices > BM_MIXER_MAX_VOICES)
+		nVoices = BM_MIXER_MAX_VOICES;
+
+	// voices past the new end stop, the callback can't run while this does
+	for (int v = nVoices; v < pMixer->nVoiceCount; v++)
+		BeatMixerFreeVoice(pMixer, &pMixer->voices[v]);
+
+	pMixer->nVoiceCount = nVoices;
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMixerSetStealMode(BeatMixer* pMixer, int nMode)
+{
+	pMixer->nStealMode = nMode;
+}
+
+
+// --------------------------------------------------------------------------------
+int BeatMixerCanPlay(BeatMixer* pMixer, AudioSample* pSample)
+{
+	if (pSample == NULL)
+		return 0;
+
+	uint8_t* pData = NULL;
+	SoundFormat format;
+	uint32_t nSampleRate = 0;
+	uint32_t nByteLength = 0;
+
+	pMixer->pd->sound->sample->getData(pSample, &pData, &format, &nSampleRate, &nByteLength);
+
+	// ADPCM and 8 bit samples stay with the platform sampler
+	return pData != NULL && nSampleRate > 0 && (format == kSound16bitMono || format == kSound16bitStereo);
+}
+
+
+// --------------------------------------------------------------------------------
+int BeatMixerAttach(BeatMixer* pMixer, BeatMixerInput* pInput, PDSynth* pSynth, AudioSample* pSample)
+{
+	PlaydateAPI* pd = pMixer->pd;
+
+	if (!BeatMixerCanPlay(pMixer, pSample))
+		return -1;
+
+	int nSlot = 0;
+	while (nSlot < BM_MIXER_MAX_INPUTS && pMixer->pInputs[nSlot] != NULL)
+		nSlot++;
+
+	if (nSlot == BM_MIXER_MAX_INPUTS)
+		return -1;
+
+	uint8_t* pData = NULL;
+	SoundFormat format;
+	uint32_t nSampleRate = 0;
+	uint32_t nByteLength = 0;
+	pd->sound->sample->getData(pSample, &pData, &format, &nSampleRate, &nByteLength);
+
+	memset(pInput, 0, sizeof(BeatMixerInput));
+	pInput->pData = (const int16_t*)pData;
+	pInput->nChannels = format == kSound16bitStereo ? 2 : 1;
+	pInput->nFrameCount = nByteLength / (pInput->nChannels * sizeof(int16_t));
+	pInput->nSampleRate = nSampleRate;
+	pInput->fVolume = 1.0f;
+	pInput->fGain = 1.0f;
+	pInput->nMaxVoices = BM_MIXER_DEFAULT_POLYPHONY;
+	pInput->pMixer = pMixer;
+
+	pd->sound->synth->setGenerator(pSynth, 0, BeatMixerSynthRender, BeatMixerSynthNoteOn, BeatMixerSynthRelease,
+		BeatMixerSynthSetParameter, BeatMixerSynthDealloc, BeatMixerSynthCopyUserdata, pInput);
+
+	// on the device the audio callback interrupts the game loop, it only sees the input once it is complete
+	pMixer->pInputs[nSlot] = pInput;
+
+	return 0;
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatMixerDetach(BeatMixer* pMixer, BeatMixerInput* pInput)
+{
+	// the callback can't run while this does, so the input is free to go once it returns
+	for (int n = 0; n < BM_MIXER_MAX_INPUTS; n++)
+	{
+		if (pMixer->pInputs[n] == pInput)
+			pMixer->pInputs[n] = NULL;
+	}
+
+	for (int v = 0; v < pMixer->nVoiceCount; v++)
+	{
+		if (pMixer->voices[v].pInput == pInput)
+			BeatMixerFreeVoice(pMixer, &pMixer->voices[v]);
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+const BeatMixerStats* BeatMixerGetStats(BeatMixer* pMixer)
+{
+	return &pMixer->stats;
+}
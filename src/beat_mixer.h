@@ -0,0 +1,166 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef BEATMIXER_H
+#define BEATMIXER_H
+
+#pragma once
+
+#include <stdio.h>
+
+#include "pd_api.h"
+
+
+// --------------------------------------------------------------------------------
+// Plays the one-shot sampler tracks through one callback source instead of a
+// synth, instrument and channel each. Routed tracks keep their synth so the
+// sequence still triggers them, but it is a generator that only starts a voice
+// here and renders nothing itself. Every note takes a voice from one pool shared
+// by all tracks, so a hit rings on while the next one starts.
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BM_MIXER_KERNEL_REFERENCE,		// one voice at a time in plain C
+	BM_MIXER_KERNEL_PACKED,			// voices in pairs with 16 bit SIMD multiplies
+
+	BM_MIXER_STEAL_OLDEST = 0,		// which voice a full pool gives up, releasing voices go first
+	BM_MIXER_STEAL_QUIETEST,
+
+	BM_MIXER_MAX_INPUTS = 32,		// two beats of tracks while a transition fades
+	BM_MIXER_MAX_VOICES = 32,
+	BM_MIXER_DEFAULT_VOICES = 16,
+	BM_MIXER_DEFAULT_POLYPHONY = 4,	// a chord and the tail of the hit before it
+	BM_MIXER_BLOCK_FRAMES = 64,
+
+	BM_MIXER_MIDDLE_C = 60,			// a sample plays at its own pitch on this note
+	BM_MIXER_RATE = 44100,
+	BM_MIXER_PITCH_SHIFT = 16		// voice positions are 16.16 fixed point
+
+} BEAT_MIXER_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+// One routed track. The sample, the levels and the limits are set from the main
+// thread, nActiveVoices is only touched on the audio thread.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	const int16_t* pData;			// 16 bit frames
+	int nFrameCount;
+	int nChannels;
+	int nSampleRate;
+
+	float fVolume;
+	float fPanning;
+	float fGain;					// transition fades, on top of the volume
+
+	int nMaxVoices;					// more notes than this take over the track's own voices
+	int nReleaseFrames;				// 0 cuts a note where it ends
+
+	void* pMixer;					// the BeatMixer it is attached to
+	int nActiveVoices;
+
+} BeatMixerInput;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	BeatMixerInput* pInput;			// NULL while the voice is free
+
+	int nFrame;
+	uint32_t nFraction;				// below nFrame, 16 bit
+	uint32_t nPitchStep;			// 16.16 frames per output frame
+	float fVelocity;
+
+	uint32_t nStartOrder;			// higher is younger
+	int nHoldFrames;				// until the release starts, -1 waits for the synth's release
+	int bReleasing;
+	int nReleaseLeft;
+
+} BeatMixerVoice;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	uint32_t nBlocks;
+	uint64_t nVoiceFrames;			// frames mixed for all voices
+	uint64_t nResampledFrames;		// of those, frames that needed pitching or a copy
+
+	uint32_t nNotes;
+	uint32_t nStolenVoices;			// the pool was full
+	uint32_t nLimitedVoices;		// the track was at its polyphony limit
+	int nActiveVoices;
+	int nPeakVoices;
+
+	// blocks mixed with n voices playing, to size the pool against the CPU left
+	uint32_t nOccupancy[BM_MIXER_MAX_VOICES + 1];
+
+} BeatMixerStats;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	PlaydateAPI* pd;
+
+	SoundChannel* pChannel;
+	SoundSource* pSource;
+
+	int nKernel;
+	int nStealMode;
+
+	BeatMixerInput* pInputs[BM_MIXER_MAX_INPUTS];
+
+	BeatMixerVoice voices[BM_MIXER_MAX_VOICES];
+	int nVoiceCount;				// the part of voices[] in use
+	uint32_t nStartOrder;
+
+	// per block: interleaved stereo frames and Q15 left/right gains of every voice
+	const int16_t* pBlocks[BM_MIXER_MAX_VOICES];
+	int16_t nGains[BM_MIXER_MAX_VOICES * 2];
+	int16_t nScratch[BM_MIXER_MAX_VOICES][BM_MIXER_BLOCK_FRAMES * 2];
+
+	int32_t nLeft[BM_MIXER_BLOCK_FRAMES];
+	int32_t nRight[BM_MIXER_BLOCK_FRAMES];
+
+	BeatMixerStats stats;
+
+} BeatMixer;
+
+
+// --------------------------------------------------------------------------------
+BeatMixer* BeatMixerCreate(PlaydateAPI* playdateApi);
+void BeatMixerDestroy(BeatMixer* pMixer);
+
+void BeatMixerSetKernel(BeatMixer* pMixer, int nKernel);
+void BeatMixerSetVoiceCount(BeatMixer* pMixer, int nVoices);
+void BeatMixerSetStealMode(BeatMixer* pMixer, int nMode);
+
+int BeatMixerCanPlay(BeatMixer* pMixer, AudioSample* pSample);
+int BeatMixerAttach(BeatMixer* pMixer, BeatMixerInput* pInput, PDSynth* pSynth, AudioSample* pSample);
+void BeatMixerDetach(BeatMixer* pMixer, BeatMixerInput* pInput);
+
+void BeatMixerMixReference(const int16_t** pBlocks, const int16_t* pGains, int nVoices, int32_t* pLeft, int32_t* pRight, int nFrameCount);
+void BeatMixerMixPacked(const int16_t** pBlocks, const int16_t* pGains, int nVoices, int32_t* pLeft, int32_t* pRight, int nFrameCount);
+
+const BeatMixerStats* BeatMixerGetStats(BeatMixer* pMixer);
+
+
+#endif
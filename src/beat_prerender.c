@@ -0,0 +1,326 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <string.h>
+#include <math.h>
+
+#include "beat_prerender.h"
+
+
+// --------------------------------------------------------------------------------
+void* Engine_MemAlloc(int nSize);
+void Engine_MemFree(void* pData);
+
+
+// --------------------------------------------------------------------------------
+// Frees the buffer and the player, the stats of the render stay.
+// --------------------------------------------------------------------------------
+void BeatPrerenderFree(BeatPrerender* pRender)
+{
+	PlaydateAPI* pd = pRender->pd;
+
+	if (pRender->pPlayer)
+	{
+		pd->sound->sampleplayer->stop(pRender->pPlayer);
+		pd->sound->sampleplayer->freePlayer(pRender->pPlayer);
+	}
+
+	if (pRender->pSample)
+		pd->sound->sample->freeSample(pRender->pSample);
+
+	if (pRender->pFrames)
+		Engine_MemFree(pRender->pFrames);
+
+	if (pRender->pFreeze && pRender->bOwnsFreeze)
+		BeatFreezeFree(pRender->pFreeze);
+
+	pRender->pPlayer = NULL;
+	pRender->pSample = NULL;
+	pRender->pFrames = NULL;
+	pRender->nFrameCount = 0;
+	pRender->nBytes = 0;
+	pRender->pFreeze = NULL;
+	pRender->bOwnsFreeze = 0;
+
+	pRender->nState = BM_PRERENDER_IDLE;
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Sizes and clears the buffer for nStepCount steps from nFirstStep, two channels
+// when bStereo is set. Nothing is allocated when it would take more than nMaxBytes.
+// --------------------------------------------------------------------------------
+int BeatPrerenderBegin(BeatPrerender* pRender, PlaydateAPI* pd, int nFirstStep, int nStepCount, float fStepsPerSecond, int bStereo, int nMaxBytes)
+{
+	pRender->pd = pd;
+	BeatPrerenderFree(pRender);
+
+	pRender->nNotesMixed = 0;
+	pRender->nClippedSamples = 0;
+	pRender->fRenderTime = 0.0f;
+	pRender->nResyncs = 0;
+	pRender->nTrackCursor = 0;
+	pRender->nNoteCursor = 0;
+
+	pRender->nFirstStep = nFirstStep;
+	pRender->nStepCount = nStepCount;
+	pRender->fFramesPerStep = BM_PRERENDER_RATE / fStepsPerSecond;
+
+	int nFrameCount = (int)(nStepCount * pRender->fFramesPerStep + 0.5f);
+	if (nFrameCount <= 0)
+		return pRender->nError = BM_PRERENDER_NO_BEAT;
+
+	int nChannels = bStereo ? 2 : 1;
+
+	if ((int64_t)nFrameCount * nChannels * (int64_t)sizeof(int16_t) > nMaxBytes)
+		return pRender->nError = BM_PRERENDER_TOO_BIG;
+
+	pRender->nFrameCount = nFrameCount;
+	pRender->nChannels = nChannels;
+	pRender->nBytes = nFrameCount * nChannels * (int)sizeof(int16_t);
+	pRender->pFrames = Engine_MemAlloc(pRender->nBytes);
+	if (pRender->pFrames == NULL)
+	{
+		pRender->nFrameCount = 0;
+		pRender->nBytes = 0;
+		return pRender->nError = BM_PRERENDER_TOO_BIG;
+	}
+
+	memset(pRender->pFrames, 0, pRender->nBytes);
+
+	pRender->nState = BM_PRERENDER_RENDERING;
+
+	return pRender->nError = BM_PRERENDER_OK;
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatPrerenderSourceFromSample(PlaydateAPI* pd, AudioSample* pSample, BeatPrerenderSource* pSource)
+{
+	memset(pSource, 0, sizeof(BeatPrerenderSource));
+
+	uint8_t* pData = NULL;
+	SoundFormat format = kSound16bitMono;
+	uint32_t nSampleRate = 0;
+	uint32_t nByteLength = 0;
+
+	pd->sound->sample->getData(pSample, &pData, &format, &nSampleRate, &nByteLength);
+
+	int nFrameBytes = (format == kSound16bitStereo) ? 4 : ((format == kSound16bitMono || format == kSound8bitStereo) ? 2 : 1);
+
+	pSource->pData = pData;
+	pSource->format = format;
+	pSource->nFrameCount = pData ? (int)(nByteLength / nFrameBytes) : 0;
+	pSource->nSampleRate = (int)nSampleRate;
+	pSource->fGain = 1.0f;
+
+}
+
+
+// --------------------------------------------------------------------------------
+// One frame of the source at 16 bit, a mono source has the same value on both sides.
+// --------------------------------------------------------------------------------
+static void BeatPrerenderRead(const BeatPrerenderSource* pSource, int nFrame, float* pLeft, float* pRight)
+{
+	switch (pSource->format)
+	{
+	case kSound16bitMono:
+		*pLeft = *pRight = ((const int16_t*)pSource->pData)[nFrame];
+		break;
+
+	case kSound16bitStereo:
+		*pLeft = ((const int16_t*)pSource->pData)[nFrame * 2];
+		*pRight = ((const int16_t*)pSource->pData)[nFrame * 2 + 1];
+		break;
+
+	case kSound8bitStereo:
+		*pLeft = 256.0f * ((int)pSource->pData[nFrame * 2] - 128);
+		*pRight = 256.0f * ((int)pSource->pData[nFrame * 2 + 1] - 128);
+		break;
+
+	default:
+		*pLeft = *pRight = 256.0f * ((int)pSource->pData[nFrame] - 128);
+		break;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatPrerenderAdd(BeatPrerender* pRender, int nSample, float fValue)
+{
+	int nValue = pRender->pFrames[nSample] + (int)fValue;
+	if (nValue > 32767 || nValue < -32768)
+	{
+		nValue = nValue > 0 ? 32767 : -32768;
+		pRender->nClippedSamples++;
+	}
+
+	pRender->pFrames[nSample] = (int16_t)nValue;
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Adds a note the way a sampler voice plays it: from the start of the sample at
+// its pitch against middle C, held for fHoldSteps and then released linearly, or
+// until the sample runs out. A note can't ring on longer than the buffer. In a
+// stereo buffer it is panned like a channel, a mono one folds a stereo source.
+// --------------------------------------------------------------------------------
+void BeatPrerenderMixNote(BeatPrerender* pRender, const BeatPrerenderSource* pSource, int nStep, float fHoldSteps, float fNote, float fVelocity)
+{
+	if (pRender->pFrames == NULL || pSource->nFrameCount <= 0 || nStep < pRender->nFirstStep || nStep >= pRender->nFirstStep + pRender->nStepCount)
+		return;
+
+	float fPitchStep = powf(2.0f, (fNote - BM_PRERENDER_MIDDLE_C) / 12.0f) * pSource->nSampleRate / BM_PRERENDER_RATE;
+
+	int nHold = (int)(fHoldSteps * pRender->fFramesPerStep + 0.5f);
+	int nRelease = pSource->nReleaseFrames;
+
+	int nLength = nHold + nRelease;
+	if (nLength > pRender->nFrameCount)
+		nLength = pRender->nFrameCount;
+
+	int nOut = (int)((nStep - pRender->nFirstStep) * pRender->fFramesPerStep + 0.5f) % pRender->nFrameCount;
+	float fGain = fVelocity * pSource->fGain;
+	float fPosition = 0.0f;
+
+	// same pan law as a channel, the far side is turned down and the near one kept
+	float fPanning = pSource->fPanning;
+	float fLeftGain = fPanning > 0.0f ? 1.0f - fPanning : 1.0f;
+	float fRightGain = fPanning < 0.0f ? 1.0f + fPanning : 1.0f;
+
+	for (int i = 0; i < nLength; i++)
+	{
+		int nFrame = (int)fPosition;
+		if (nFrame >= pSource->nFrameCount)
+			break;
+
+		float fLeft;
+		float fRight;
+		BeatPrerenderRead(pSource, nFrame, &fLeft, &fRight);
+
+		if (nFrame + 1 < pSource->nFrameCount)
+		{
+			float fFraction = fPosition - nFrame;
+
+			float fNextLeft;
+			float fNextRight;
+			BeatPrerenderRead(pSource, nFrame + 1, &fNextLeft, &fNextRight);
+
+			fLeft += (fNextLeft - fLeft) * fFraction;
+			fRight += (fNextRight - fRight) * fFraction;
+		}
+
+		float fLevel = i < nHold ? fGain : fGain * (nLength - i) / nRelease;
+
+		if (pRender->nChannels == 2)
+		{
+			BeatPrerenderAdd(pRender, nOut * 2, fLeft * fLevel * fLeftGain);
+			BeatPrerenderAdd(pRender, nOut * 2 + 1, fRight * fLevel * fRightGain);
+		}
+		else
+		{
+			BeatPrerenderAdd(pRender, nOut, 0.5f * (fLeft + fRight) * fLevel);
+		}
+
+		if (++nOut == pRender->nFrameCount)
+			nOut = 0;
+
+		fPosition += fPitchStep;
+	}
+
+	pRender->nNotesMixed++;
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Hands the buffer to a sample player, it does not play yet.
+// --------------------------------------------------------------------------------
+int BeatPrerenderFinish(BeatPrerender* pRender)
+{
+	PlaydateAPI* pd = pRender->pd;
+
+	pRender->pSample = pd->sound->sample->newSampleFromData((uint8_t*)pRender->pFrames, pRender->nChannels == 2 ? kSound16bitStereo : kSound16bitMono, BM_PRERENDER_RATE, pRender->nBytes, 0);
+	pRender->pPlayer = pd->sound->sampleplayer->newPlayer();
+
+	if (pRender->pSample == NULL || pRender->pPlayer == NULL)
+	{
+		BeatPrerenderFree(pRender);
+		return pRender->nError = BM_PRERENDER_TOO_BIG;
+	}
+
+	pd->sound->sampleplayer->setSample(pRender->pPlayer, pRender->pSample);
+	pRender->nState = BM_PRERENDER_READY;
+
+	return BM_PRERENDER_OK;
+}
+
+
+// --------------------------------------------------------------------------------
+// Loops the buffer from fOffset seconds into the region.
+// --------------------------------------------------------------------------------
+void BeatPrerenderPlay(BeatPrerender* pRender, float fOffset)
+{
+	PlaydateAPI* pd = pRender->pd;
+
+	pd->sound->sampleplayer->play(pRender->pPlayer, 0, 1.0f);
+	pd->sound->sampleplayer->setOffset(pRender->pPlayer, fOffset);
+
+	pRender->nState = BM_PRERENDER_PLAYING;
+
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatPrerenderStop(BeatPrerender* pRender)
+{
+	if (pRender->nState != BM_PRERENDER_PLAYING)
+		return;
+
+	pRender->pd->sound->sampleplayer->stop(pRender->pPlayer);
+	pRender->nState = BM_PRERENDER_READY;
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Moves the player to fOffset when it is more than BM_PRERENDER_MAX_DRIFT_MS off,
+// after a seek or when the buffer and the sequence clock have drifted apart.
+// --------------------------------------------------------------------------------
+int BeatPrerenderSync(BeatPrerender* pRender, float fOffset)
+{
+	PlaydateAPI* pd = pRender->pd;
+
+	float fLength = (float)pRender->nFrameCount / BM_PRERENDER_RATE;
+	float fDrift = fabsf(pd->sound->sampleplayer->getOffset(pRender->pPlayer) - fOffset);
+
+	// either side of the loop point
+	if (fDrift > fLength * 0.5f)
+		fDrift = fLength - fDrift;
+
+	if (fDrift * 1000.0f <= BM_PRERENDER_MAX_DRIFT_MS)
+		return 0;
+
+	pd->sound->sampleplayer->setOffset(pRender->pPlayer, fOffset);
+	pRender->nResyncs++;
+
+	return 1;
+}
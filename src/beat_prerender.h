@@ -0,0 +1,125 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef BEATPRERENDER_H
+#define BEATPRERENDER_H
+
+#pragma once
+
+#include <stdio.h>
+
+#include "pd_api.h"
+
+#include "beat_freeze.h"
+
+
+// --------------------------------------------------------------------------------
+// The loop region of a beat mixed down once into one buffer and played back by a
+// single looping sample player. The buffer is stereo when a track is panned and
+// mono otherwise, so a beat without panning costs half the memory. The notes are mixed into the buffer one at a
+// time, so a render can be spread over as many frames as it needs; notes ringing
+// past the end of the region wrap around to its start, the way the looping
+// sequence plays them into the next pass.
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BM_PRERENDER_IDLE,
+	BM_PRERENDER_RENDERING,			// the live tracks play while the buffer fills
+	BM_PRERENDER_READY,				// rendered, the live tracks play until the playhead is in the region
+	BM_PRERENDER_PLAYING,			// the buffer plays, the track channels are out of the mix
+
+	BM_PRERENDER_OK = 0,
+	BM_PRERENDER_NO_BEAT = -1,
+	BM_PRERENDER_TOO_BIG = -2,		// the buffer would be over the memory cap
+	BM_PRERENDER_UNSUPPORTED = -3,	// a track has a voice or an effect there is no renderer for
+	BM_PRERENDER_CHANGED = -4,		// the beat was changed, the buffer no longer matches it
+
+	BM_PRERENDER_RATE = 22050,
+	BM_PRERENDER_DEFAULT_MAX_BYTES = 2 * 1024 * 1024,
+	BM_PRERENDER_MIDDLE_C = 60,		// a sample plays at its own pitch on this note
+	BM_PRERENDER_MAX_DRIFT_MS = 20	// the player is put back on the sequence when it is further off
+
+} BEAT_PRERENDER_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+// Sample data a note is mixed from, as getData() gives it.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	const uint8_t* pData;
+	SoundFormat format;
+	int nFrameCount;
+	int nSampleRate;
+
+	float fGain;
+	float fPanning;					// -1 left to 1 right, only heard in a stereo buffer
+	int nReleaseFrames;				// at BM_PRERENDER_RATE, 0 cuts a note where it ends
+
+} BeatPrerenderSource;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	PlaydateAPI* pd;
+
+	int nState;
+	int nError;						// why the last render fell back to the live tracks
+
+	int nFirstStep;
+	int nStepCount;
+	float fFramesPerStep;			// at BM_PRERENDER_RATE
+
+	int16_t* pFrames;				// nChannels samples a frame, left first
+	int nFrameCount;
+	int nChannels;
+	int nBytes;
+
+	AudioSample* pSample;
+	SamplePlayer* pPlayer;
+
+	// where the render is, kept by the machine
+	int nTrackCursor;
+	int nNoteCursor;
+	BeatFreeze* pFreeze;			// the keys of a synth track
+	int bOwnsFreeze;				// rendered for this, the track is not frozen
+
+	// of the last render
+	int nNotesMixed;
+	uint32_t nClippedSamples;
+	float fRenderTime;
+	int nResyncs;
+
+} BeatPrerender;
+
+
+// --------------------------------------------------------------------------------
+int BeatPrerenderBegin(BeatPrerender* pRender, PlaydateAPI* pd, int nFirstStep, int nStepCount, float fStepsPerSecond, int bStereo, int nMaxBytes);
+void BeatPrerenderSourceFromSample(PlaydateAPI* pd, AudioSample* pSample, BeatPrerenderSource* pSource);
+void BeatPrerenderMixNote(BeatPrerender* pRender, const BeatPrerenderSource* pSource, int nStep, float fHoldSteps, float fNote, float fVelocity);
+int BeatPrerenderFinish(BeatPrerender* pRender);
+
+void BeatPrerenderPlay(BeatPrerender* pRender, float fOffset);
+void BeatPrerenderStop(BeatPrerender* pRender);
+int BeatPrerenderSync(BeatPrerender* pRender, float fOffset);
+
+void BeatPrerenderFree(BeatPrerender* pRender);
+
+
+#endif
@@ -0,0 +1,753 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+
+#include "beat_scanner.h"
+#include "beat_keys.h"
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BEAT_SCAN_MAX_DIGITS = 9,			// still fits an int
+	BEAT_SCAN_MAX_POWER = 10			// 10^10 is the largest power of ten a float holds exactly
+
+} BEAT_SCAN_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+// what the scanner is inside of, one per level of ScanData.nStates
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BEAT_SCAN_ROOT,
+	BEAT_SCAN_BEAT,
+	BEAT_SCAN_SCALE,
+	BEAT_SCAN_LOOP,
+	BEAT_SCAN_LABELS,
+	BEAT_SCAN_LABEL,
+	BEAT_SCAN_TRACKS,
+	BEAT_SCAN_TRACK,
+	BEAT_SCAN_ENVELOPE,
+	BEAT_SCAN_FILTER,
+	BEAT_SCAN_DELAY,
+	BEAT_SCAN_BITCRUSHER,
+	BEAT_SCAN_HARMONICS,
+	BEAT_SCAN_NOTES,
+	BEAT_SCAN_NOTE,
+	BEAT_SCAN_SKIP_TABLE,
+	BEAT_SCAN_SKIP_ARRAY
+
+} BEAT_SCAN_STATES;
+
+
+// --------------------------------------------------------------------------------
+static const float fPowersOfTen[BEAT_SCAN_MAX_POWER + 1] =
+{
+	1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	char* p;
+	char* pStart;
+	char* pEnd;
+
+	int bFailed;
+
+	BeatLoadContext* pLoad;
+	ScanData* pData;
+
+} BeatScanner;
+
+
+// --------------------------------------------------------------------------------
+static void BeatScanFail(BeatScanner* pScan)
+{
+	if (!pScan->bFailed)
+	{
+		pScan->bFailed = TRUE;
+		pScan->pEnd = pScan->p;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static char BeatScanPeek(BeatScanner* pScan)
+{
+	while (pScan->p < pScan->pEnd)
+	{
+		char c = *pScan->p;
+		if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+			return c;
+
+		pScan->p++;
+	}
+
+	return '\0';
+}
+
+
+// --------------------------------------------------------------------------------
+static int BeatScanExpect(BeatScanner* pScan, char c)
+{
+	if (BeatScanPeek(pScan) != c)
+	{
+		BeatScanFail(pScan);
+		return FALSE;
+	}
+
+	pScan->p++;
+	return TRUE;
+}
+
+
+// --------------------------------------------------------------------------------
+// after a member, TRUE when another one follows and FALSE at the closing bracket
+static int BeatScanNext(BeatScanner* pScan, char cClose)
+{
+	char c = BeatScanPeek(pScan);
+
+	if (c == ',')
+	{
+		pScan->p++;
+		return TRUE;
+	}
+
+	if (c != cClose)
+		BeatScanFail(pScan);
+	else
+		pScan->p++;
+
+	return FALSE;
+}
+
+
+// --------------------------------------------------------------------------------
+static const char* BeatScanString(BeatScanner* pScan)
+{
+	if (!BeatScanExpect(pScan, '"'))
+		return "";
+
+	char* szString = pScan->p;
+
+	// escapes are left as they are, none of the names in a beat file use them
+	while (pScan->p < pScan->pEnd && *pScan->p != '"')
+	{
+		if (*pScan->p == '\\' && pScan->p + 1 < pScan->pEnd)
+			pScan->p++;
+
+		pScan->p++;
+	}
+
+	if (pScan->p >= pScan->pEnd)
+	{
+		BeatScanFail(pScan);
+		return "";
+	}
+
+	*pScan->p++ = '\0';
+
+	return szString;
+}
+
+
+// --------------------------------------------------------------------------------
+static float BeatScanNumber(BeatScanner* pScan)
+{
+	char c = BeatScanPeek(pScan);
+
+	// true and false read as 1 and 0, the same as json_intValue() gives for them
+	if (c == 't' || c == 'f' || c == 'n')
+	{
+		while (pScan->p < pScan->pEnd && *pScan->p >= 'a' && *pScan->p <= 'z')
+			pScan->p++;
+
+		return c == 't' ? 1.0f : 0.0f;
+	}
+
+	int bNegative = FALSE;
+	if (c == '-')
+	{
+		bNegative = TRUE;
+		pScan->p++;
+	}
+
+	if (pScan->p >= pScan->pEnd || *pScan->p < '0' || *pScan->p > '9')
+	{
+		BeatScanFail(pScan);
+		return 0.0f;
+	}
+
+	// digits are gathered into one integer and divided once, so 0.45 comes out the same as from strtof
+	int nMantissa = 0;
+	int nDigits = 0;
+	int nExponent = 0;
+
+	while (pScan->p < pScan->pEnd && *pScan->p >= '0' && *pScan->p <= '9')
+	{
+		if (nDigits < BEAT_SCAN_MAX_DIGITS)
+		{
+			nMantissa = nMantissa * 10 + (*pScan->p - '0');
+			if (nMantissa)
+				nDigits++;
+		}
+		else
+		{
+			nExponent++;
+		}
+
+		pScan->p++;
+	}
+
+	if (pScan->p < pScan->pEnd && *pScan->p == '.')
+	{
+		pScan->p++;
+
+		while (pScan->p < pScan->pEnd && *pScan->p >= '0' && *pScan->p <= '9')
+		{
+			if (nDigits < BEAT_SCAN_MAX_DIGITS)
+			{
+				nMantissa = nMantissa * 10 + (*pScan->p - '0');
+				if (nMantissa)
+					nDigits++;
+
+				nExponent--;
+			}
+
+			pScan->p++;
+		}
+	}
+
+	if (pScan->p < pScan->pEnd && (*pScan->p == 'e' || *pScan->p == 'E'))
+	{
+		pScan->p++;
+
+		int bNegativeExponent = FALSE;
+		if (pScan->p < pScan->pEnd && (*pScan->p == '-' || *pScan->p == '+'))
+			bNegativeExponent = (*pScan->p++ == '-');
+
+		int nValue = 0;
+		while (pScan->p < pScan->pEnd && *pScan->p >= '0' && *pScan->p <= '9')
+			nValue = nValue * 10 + (*pScan->p++ - '0');
+
+		nExponent += bNegativeExponent ? -nValue : nValue;
+	}
+
+	float fValue = (float)nMantissa;
+
+	while (nExponent > 0)
+	{
+		int nStep = nExponent > BEAT_SCAN_MAX_POWER ? BEAT_SCAN_MAX_POWER : nExponent;
+		fValue *= fPowersOfTen[nStep];
+		nExponent -= nStep;
+	}
+
+	while (nExponent < 0)
+	{
+		int nStep = -nExponent > BEAT_SCAN_MAX_POWER ? BEAT_SCAN_MAX_POWER : -nExponent;
+		fValue /= fPowersOfTen[nStep];
+		nExponent += nStep;
+	}
+
+	return bNegative ? -fValue : fValue;
+}
+
+
+// --------------------------------------------------------------------------------
+static int BeatScanInt(BeatScanner* pScan)
+{
+	return (int)BeatScanNumber(pScan);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatScanCopyString(BeatScanner* pScan, char* szDest, int nSize)
+{
+	const char* szSource = BeatScanString(pScan);
+
+	// cut to the field, always terminated whatever was in it before
+	int nLength = (int)strlen(szSource);
+	if (nLength > nSize - 1)
+		nLength = nSize - 1;
+
+	memcpy(szDest, szSource, nLength);
+	szDest[nLength] = '\0';
+
+}
+
+
+// --------------------------------------------------------------------------------
+static BMBTrack* BeatScanTrackInfo(BeatScanner* pScan)
+{
+	return &pScan->pLoad->tracks[pScan->pData->nTrack];
+}
+
+
+// --------------------------------------------------------------------------------
+// Consumes the opening bracket and goes one level down, the members are read by
+// the next calls of BeatScannerStep().
+// --------------------------------------------------------------------------------
+static void BeatScanPush(BeatScanner* pScan, int nState, char cOpen)
+{
+	ScanData* pData = pScan->pData;
+
+	if (!BeatScanExpect(pScan, cOpen))
+		return;
+
+	if (pData->nStateCount == BM_SCAN_MAX_DEPTH)
+	{
+		BeatScanFail(pScan);
+		return;
+	}
+
+	pData->nStates[pData->nStateCount] = nState;
+	pData->bHasMembers[pData->nStateCount] = FALSE;
+	pData->nStateCount++;
+
+}
+
+
+// --------------------------------------------------------------------------------
+// after the closing bracket, a note or label is only stored once all of it is read
+// --------------------------------------------------------------------------------
+static void BeatScanPop(BeatScanner* pScan)
+{
+	ScanData* pData = pScan->pData;
+	BeatLoadContext* pLoad = pScan->pLoad;
+
+	int nState = pData->nStates[--pData->nStateCount];
+
+	if (nState == BEAT_SCAN_NOTE)
+	{
+		BMBTrack* pInfo = BeatScanTrackInfo(pScan);
+
+		pData->nStep = pData->note.nStep;
+
+		if ((int)pLoad->header.nNoteCount < pLoad->nNoteCapacity)
+		{
+			pLoad->pNotes[pLoad->header.nNoteCount++] = pData->note;
+			pInfo->nNoteCount++;
+
+			int nLength = pData->note.nStep + pData->note.nLen;
+			if (nLength > pLoad->header.nBeatLength)
+				pLoad->header.nBeatLength = nLength;
+		}
+	}
+	else if (nState == BEAT_SCAN_LABEL)
+	{
+		if (pLoad->header.nLabelCount < BM_MAX_LABEL)
+			pLoad->labels[pLoad->header.nLabelCount++] = pData->label;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatScanSkipValue(BeatScanner* pScan)
+{
+	char c = BeatScanPeek(pScan);
+
+	if (c == '{')
+		BeatScanPush(pScan, BEAT_SCAN_SKIP_TABLE, '{');
+	else if (c == '[')
+		BeatScanPush(pScan, BEAT_SCAN_SKIP_ARRAY, '[');
+	else if (c == '"')
+		BeatScanString(pScan);
+	else
+		BeatScanNumber(pScan);
+
+}
+
+
+// --------------------------------------------------------------------------------
+static const char* BeatScanKey(BeatScanner* pScan)
+{
+	const char* szKey = BeatScanString(pScan);
+	BeatScanExpect(pScan, ':');
+
+	return szKey;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatScanEnvelope(BeatScanner* pScan, int nKey)
+{
+	BMBTrack* pInfo = BeatScanTrackInfo(pScan);
+
+	switch (nKey)
+	{
+	case BEAT_KEY_A:		pInfo->fAttack = BeatScanNumber(pScan);		break;
+	case BEAT_KEY_D:		pInfo->fDecay = BeatScanNumber(pScan);		break;
+	case BEAT_KEY_S:		pInfo->fSustain = BeatScanNumber(pScan);	break;
+	case BEAT_KEY_R:		pInfo->fRelease = BeatScanNumber(pScan);	break;
+	default:				BeatScanSkipValue(pScan);					break;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatScanFilter(BeatScanner* pScan, int nKey)
+{
+	BMBTrack* pInfo = BeatScanTrackInfo(pScan);
+
+	switch (nKey)
+	{
+	case BEAT_KEY_FREQ:		pInfo->nFilterFreq = BeatScanInt(pScan);	break;
+	case BEAT_KEY_TYPE:		pInfo->nFilterType = BeatScanInt(pScan);	break;
+	case BEAT_KEY_RESN:		pInfo->fFilterResn = BeatScanNumber(pScan);	break;
+	case BEAT_KEY_MIX:		pInfo->fFilterMix = BeatScanNumber(pScan);	break;
+	default:				BeatScanSkipValue(pScan);					break;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatScanDelay(BeatScanner* pScan, int nKey)
+{
+	BMBTrack* pInfo = BeatScanTrackInfo(pScan);
+
+	switch (nKey)
+	{
+	case BEAT_KEY_FEEDBACK:	pInfo->fDelayFeedback = BeatScanNumber(pScan);	break;
+	case BEAT_KEY_MIX:		pInfo->fDelayMix = BeatScanNumber(pScan);		break;
+	default:				BeatScanSkipValue(pScan);						break;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatScanBitCrusher(BeatScanner* pScan, int nKey)
+{
+	BMBTrack* pInfo = BeatScanTrackInfo(pScan);
+
+	switch (nKey)
+	{
+	case BEAT_KEY_AMOUNT:	pInfo->fBitcrusherAmount = BeatScanNumber(pScan);	break;
+	case BEAT_KEY_MIX:		pInfo->fBitcrusherMix = BeatScanNumber(pScan);		break;
+	default:				BeatScanSkipValue(pScan);							break;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatScanHarmonic(BeatScanner* pScan)
+{
+	BMBTrack* pInfo = BeatScanTrackInfo(pScan);
+	ScanData* pData = pScan->pData;
+
+	float fLevel = BeatScanNumber(pScan);
+	fLevel = fLevel < 0.0f ? 0.0f : (fLevel > 1.0f ? 1.0f : fLevel);
+
+	if (pData->nHarmonic < BMB_HARMONIC_COUNT)
+		pInfo->nHarmonics[pData->nHarmonic++] = (uint8_t)(fLevel * 255.0f + 0.5f);
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatScanNote(BeatScanner* pScan, int nKey)
+{
+	BMBNote* pNote = &pScan->pData->note;
+
+	switch (nKey)
+	{
+	case BEAT_KEY_STEP:		pNote->nStep = BeatScanInt(pScan);			break;
+	case BEAT_KEY_PITCH:	pNote->nPitch = BeatScanInt(pScan);			break;
+	case BEAT_KEY_LEN:		pNote->nLen = BeatScanInt(pScan);			break;
+	case BEAT_KEY_VEL:		pNote->fVelocity = BeatScanNumber(pScan);	break;
+	default:				BeatScanSkipValue(pScan);					break;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatScanTrack(BeatScanner* pScan, int nKey)
+{
+	BeatLoadContext* pLoad = pScan->pLoad;
+	ScanData* pData = pScan->pData;
+
+	// the track slot is only known once "id" has been read, which comes first in every file
+	BMBTrack* pInfo = BeatScanTrackInfo(pScan);
+
+	switch (nKey)
+	{
+	case BEAT_KEY_ID:
+	{
+		int nTrack = BeatScanInt(pScan);
+		if (nTrack < 0 || nTrack >= BM_MAX_TRACK)
+			nTrack = 0;
+
+		pData->nTrack = nTrack;
+
+		pLoad->bTrackUsed[nTrack] = TRUE;
+		pLoad->tracks[nTrack].nId = nTrack;
+		break;
+	}
+
+	case BEAT_KEY_NAME:		BeatScanCopyString(pScan, pInfo->szTrackName, BMB_NAME_SIZE);		break;
+	case BEAT_KEY_SAMPLE:	BeatScanCopyString(pScan, pInfo->szSampleName, BMB_SAMPLE_SIZE);	break;
+	case BEAT_KEY_VOL:		pInfo->fVolume = BeatScanNumber(pScan);								break;
+	case BEAT_KEY_PAN:		pInfo->fPanning = BeatScanNumber(pScan);							break;
+	case BEAT_KEY_COLOR:	pInfo->nColour = BeatScanInt(pScan);								break;
+	case BEAT_KEY_MUTE:		pInfo->bMuted = BeatScanInt(pScan);									break;
+	case BEAT_KEY_CHORD:	pInfo->bIsChordTrack = BeatScanInt(pScan);							break;
+
+	case BEAT_KEY_TYPE:
+	{
+		int nIndex = BeatMachineFindSoundSource(BeatScanString(pScan));
+		if (nIndex != -1)
+			pInfo->nSoundSource = nIndex;
+		break;
+	}
+
+	case BEAT_KEY_ENV:
+		pInfo->bHasEnvelope = TRUE;
+		BeatScanPush(pScan, BEAT_SCAN_ENVELOPE, '{');
+		break;
+
+	case BEAT_KEY_FILTER:
+	case BEAT_KEY_LPF:
+		pInfo->bFilterEnabled = TRUE;
+		BeatScanPush(pScan, BEAT_SCAN_FILTER, '{');
+		break;
+
+	case BEAT_KEY_DELAY:
+		pInfo->bDelayEnabled = TRUE;
+		BeatScanPush(pScan, BEAT_SCAN_DELAY, '{');
+		break;
+
+	case BEAT_KEY_BITCRUSH:
+		pInfo->bBitCrusherEnabled = TRUE;
+		BeatScanPush(pScan, BEAT_SCAN_BITCRUSHER, '{');
+		break;
+
+	case BEAT_KEY_NOTES:
+		pInfo->nFirstNote = pLoad->header.nNoteCount;
+		pInfo->nNoteCount = 0;
+		BeatScanPush(pScan, BEAT_SCAN_NOTES, '[');
+		break;
+
+	case BEAT_KEY_HARMONICS:
+		memset(pInfo->nHarmonics, 0, BMB_HARMONIC_COUNT);
+		pData->nHarmonic = 0;
+		BeatScanPush(pScan, BEAT_SCAN_HARMONICS, '[');
+		break;
+
+	default:
+		BeatScanSkipValue(pScan);
+		break;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatScanScale(BeatScanner* pScan, int nKey)
+{
+	BMBHeader* pHeader = &pScan->pLoad->header;
+
+	switch (nKey)
+	{
+	case BEAT_KEY_TYPE:		BeatScanCopyString(pScan, pHeader->szScale, BMB_SCALE_SIZE);			break;
+	case BEAT_KEY_BASE:		BeatScanCopyString(pScan, pHeader->szBaseNote, BMB_BASE_NOTE_SIZE);	break;
+	default:				BeatScanSkipValue(pScan);											break;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatScanLoop(BeatScanner* pScan, int nKey)
+{
+	BMBHeader* pHeader = &pScan->pLoad->header;
+
+	switch (nKey)
+	{
+	case BEAT_KEY_ON:		pHeader->bLoopOn = BeatScanInt(pScan);		break;
+	case BEAT_KEY_START:	pHeader->nLoopStart = BeatScanInt(pScan);	break;
+	case BEAT_KEY_END:		pHeader->nLoopEnd = BeatScanInt(pScan);		break;
+	default:				BeatScanSkipValue(pScan);					break;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatScanLabel(BeatScanner* pScan, int nKey)
+{
+	BMBLabel* pLabel = &pScan->pData->label;
+
+	switch (nKey)
+	{
+	case BEAT_KEY_STEP:		pLabel->nStep = BeatScanInt(pScan);							break;
+	case BEAT_KEY_TXT:		BeatScanCopyString(pScan, pLabel->szText, BMB_NAME_SIZE);	break;
+	default:				BeatScanSkipValue(pScan);									break;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatScanBeat(BeatScanner* pScan, int nKey)
+{
+	BMBHeader* pHeader = &pScan->pLoad->header;
+
+	switch (nKey)
+	{
+	case BEAT_KEY_VER:		pHeader->nFileVersion = BeatScanInt(pScan);		break;
+	case BEAT_KEY_BPM:		pHeader->nBPM = BeatScanInt(pScan);				break;
+	case BEAT_KEY_SCALE:	BeatScanPush(pScan, BEAT_SCAN_SCALE, '{');		break;
+	case BEAT_KEY_LOOP:		BeatScanPush(pScan, BEAT_SCAN_LOOP, '{');		break;
+	case BEAT_KEY_LABELS:	BeatScanPush(pScan, BEAT_SCAN_LABELS, '[');		break;
+	case BEAT_KEY_TRACKS:	BeatScanPush(pScan, BEAT_SCAN_TRACKS, '[');		break;
+	default:				BeatScanSkipValue(pScan);						break;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+// One member of the container the scanner is in, a key and its value in a table.
+// --------------------------------------------------------------------------------
+static void BeatScanMember(BeatScanner* pScan, int nState)
+{
+	ScanData* pData = pScan->pData;
+
+	switch (nState)
+	{
+	case BEAT_SCAN_LABELS:
+		memset(&pData->label, 0, sizeof(BMBLabel));
+		BeatScanPush(pScan, BEAT_SCAN_LABEL, '{');
+		return;
+
+	case BEAT_SCAN_TRACKS:
+		BeatScanPush(pScan, BEAT_SCAN_TRACK, '{');
+		return;
+
+	case BEAT_SCAN_NOTES:
+	{
+		// a missing step keeps the one of the note before, like the decoder does
+		BMBNote note = { pData->nStep, 0, 0, 0.0f };
+		pData->note = note;
+
+		BeatScanPush(pScan, BEAT_SCAN_NOTE, '{');
+		return;
+	}
+
+	case BEAT_SCAN_HARMONICS:	BeatScanHarmonic(pScan);	return;
+	case BEAT_SCAN_SKIP_ARRAY:	BeatScanSkipValue(pScan);	return;
+	}
+
+	int nKey = BeatKeyLookup(BeatScanKey(pScan));
+
+	switch (nState)
+	{
+	case BEAT_SCAN_ROOT:
+		if (nKey == BEAT_KEY_BEAT)
+			BeatScanPush(pScan, BEAT_SCAN_BEAT, '{');
+		else
+			BeatScanSkipValue(pScan);
+		break;
+
+	case BEAT_SCAN_BEAT:		BeatScanBeat(pScan, nKey);			break;
+	case BEAT_SCAN_SCALE:		BeatScanScale(pScan, nKey);			break;
+	case BEAT_SCAN_LOOP:		BeatScanLoop(pScan, nKey);			break;
+	case BEAT_SCAN_LABEL:		BeatScanLabel(pScan, nKey);			break;
+	case BEAT_SCAN_TRACK:		BeatScanTrack(pScan, nKey);			break;
+	case BEAT_SCAN_ENVELOPE:	BeatScanEnvelope(pScan, nKey);		break;
+	case BEAT_SCAN_FILTER:		BeatScanFilter(pScan, nKey);		break;
+	case BEAT_SCAN_DELAY:		BeatScanDelay(pScan, nKey);			break;
+	case BEAT_SCAN_BITCRUSHER:	BeatScanBitCrusher(pScan, nKey);	break;
+	case BEAT_SCAN_NOTE:		BeatScanNote(pScan, nKey);			break;
+	default:					BeatScanSkipValue(pScan);			break;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static int BeatScanIsArray(int nState)
+{
+	return nState == BEAT_SCAN_LABELS || nState == BEAT_SCAN_TRACKS || nState == BEAT_SCAN_NOTES || nState == BEAT_SCAN_HARMONICS || nState == BEAT_SCAN_SKIP_ARRAY;
+}
+
+
+// --------------------------------------------------------------------------------
+int BeatScannerStep(BeatLoadContext* pLoad, char* pText, int nSize, int nValues)
+{
+	ScanData* pData = &pLoad->scanData;
+
+	BeatScanner scan;
+	memset(&scan, 0, sizeof(BeatScanner));
+
+	scan.p = pText + pData->nOffset;
+	scan.pStart = pText;
+	scan.pEnd = pText + nSize;
+	scan.pLoad = pLoad;
+	scan.pData = pData;
+
+	if (!pData->bStarted)
+	{
+		pData->bStarted = TRUE;
+		BeatScanPush(&scan, BEAT_SCAN_ROOT, '{');
+	}
+
+	while (nValues-- > 0 && pData->nStateCount > 0 && !scan.bFailed)
+	{
+		int nLevel = pData->nStateCount - 1;
+		int nState = pData->nStates[nLevel];
+		char cClose = BeatScanIsArray(nState) ? ']' : '}';
+
+		if (!pData->bHasMembers[nLevel])
+		{
+			pData->bHasMembers[nLevel] = TRUE;
+
+			// the push took the opening bracket, a closing one right after it is an empty container
+			if (BeatScanPeek(&scan) == cClose)
+			{
+				scan.p++;
+				BeatScanPop(&scan);
+				continue;
+			}
+		}
+		else if (!BeatScanNext(&scan, cClose))
+		{
+			if (!scan.bFailed)
+				BeatScanPop(&scan);
+			continue;
+		}
+
+		BeatScanMember(&scan, nState);
+	}
+
+	pData->nOffset = (int)(scan.p - pText);
+
+	if (scan.bFailed)
+		return (int)(scan.pEnd - scan.pStart) + 1;
+
+	return pData->nStateCount > 0 ? BEAT_SCAN_MORE : BEAT_SCAN_DONE;
+}
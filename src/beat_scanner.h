@@ -0,0 +1,53 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+
+#ifndef BEATSCANNER_H
+#define BEATSCANNER_H
+
+#pragma once
+
+#include "beat_machine.h"
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BEAT_SCAN_DONE = 0,
+	BEAT_SCAN_MORE = -1
+
+} BEAT_SCANNER_RESULTS;
+
+
+// --------------------------------------------------------------------------------
+// Alternative to pd->json for .bmf files. The whole file is in one buffer and the
+// scanner walks it in place: keys and strings are terminated where they stand,
+// numbers are read straight from the text and everything goes into the load
+// context tables the decoder callbacks fill. It only knows the .bmf layout,
+// anything else is skipped.
+//
+// Each call reads up to nValues keys or array values and leaves its place in
+// pLoad->scanData, so a load can decode a slice of the file per step. pText must be
+// writable, zero terminated and stay where it is until the scan is done, it is not
+// usable as JSON afterwards. Returns BEAT_SCAN_MORE until the file is read, then
+// BEAT_SCAN_DONE, or the byte offset + 1 of the first error.
+// --------------------------------------------------------------------------------
+int BeatScannerStep(BeatLoadContext* pLoad, char* pText, int nSize, int nValues);
+
+
+#endif
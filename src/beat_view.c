@@ -0,0 +1,423 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "beat_view.h"
+
+
+// --------------------------------------------------------------------------------
+void* Engine_MemAlloc(int nSize);
+void Engine_MemFree(void* pData);
+
+
+// --------------------------------------------------------------------------------
+// Writes nValue in decimal and returns the length, the digits go backwards into a
+// scratch buffer once and are copied out in one go.
+// --------------------------------------------------------------------------------
+int BeatViewFormatInt(char* szBuffer, int nValue)
+{
+	char szDigits[BEAT_VIEW_INT_SIZE];
+	int nCount = 0;
+
+	unsigned int nRemaining = (nValue < 0) ? 0u - (unsigned int)nValue : (unsigned int)nValue;
+
+	do
+	{
+		szDigits[nCount++] = (char)('0' + nRemaining % 10);
+		nRemaining /= 10;
+
+	} while (nRemaining > 0);
+
+	int nLen = 0;
+	if (nValue < 0)
+		szBuffer[nLen++] = '-';
+
+	while (nCount > 0)
+		szBuffer[nLen++] = szDigits[--nCount];
+
+	szBuffer[nLen] = 0;
+
+	return nLen;
+}
+
+
+// --------------------------------------------------------------------------------
+static int BeatViewBitmapBytes(int nWidth, int nHeight)
+{
+	// rows are padded to 32 bits
+	return ((nWidth + 31) / 32) * 4 * nHeight;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatViewFreeBitmaps(BeatView* pView)
+{
+	PlaydateAPI* pd = pView->pd;
+
+	for (int i = 0; i < pView->nPageCount; i++)
+	{
+		pd->graphics->freeBitmap(pView->pPages[i]);
+		pView->pPages[i] = NULL;
+	}
+
+	if (pView->pLabels)
+		pd->graphics->freeBitmap(pView->pLabels);
+
+	pView->pLabels = NULL;
+	pView->nPageCount = 0;
+	pView->nBitmapBytes = 0;
+
+}
+
+
+// --------------------------------------------------------------------------------
+BeatView* BeatViewCreate(PlaydateAPI* playdateApi, LCDFont* pFont)
+{
+	BeatView* pView = Engine_MemAlloc(sizeof(BeatView));
+	memset(pView, 0, sizeof(BeatView));
+
+	pView->pd = playdateApi;
+	pView->pFont = pFont;
+
+	BeatViewInvalidate(pView);
+
+	return pView;
+}
+
+
+// --------------------------------------------------------------------------------
+void BeatViewDestroy(BeatView* pView)
+{
+	if (pView == NULL)
+		return;
+
+	BeatViewFreeBitmaps(pView);
+	Engine_MemFree(pView);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Makes the page of nPage the drawing target, the notes of a track come in step
+// order so this switches about once per page and track.
+// --------------------------------------------------------------------------------
+static void BeatViewTargetPage(BeatView* pView, int nPage, int* pTarget)
+{
+	PlaydateAPI* pd = pView->pd;
+
+	if (*pTarget == nPage)
+		return;
+
+	if (*pTarget >= 0)
+		pd->graphics->popContext();
+
+	pd->graphics->pushContext(pView->pPages[nPage]);
+	*pTarget = nPage;
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatViewDrawPageGrid(BeatView* pView, int nPage)
+{
+	PlaydateAPI* pd = pView->pd;
+
+	pd->graphics->pushContext(pView->pPages[nPage]);
+
+	int nFirstStep = nPage * BEAT_VIEW_PAGE_STEPS;
+
+	for (int i = 0; i < BEAT_VIEW_PAGE_STEPS; i++)
+	{
+		int nStep = nFirstStep + i;
+		int x = i * BEAT_VIEW_CELL_WIDTH;
+
+		if (nStep == pView->nBeatLength)
+		{
+			pd->graphics->drawLine(x, 0, x, BEAT_VIEW_GRID_HEIGHT - 1, 1, kColorBlack);
+			break;
+		}
+
+		// bars get a line, beats a tick above every row
+		if (nStep % BM_STEPS_PER_BAR == 0)
+			pd->graphics->drawLine(x, 0, x, BEAT_VIEW_GRID_HEIGHT - 1, 1, kColorBlack);
+		else if (nStep % BM_STEPS_PER_BEAT == 0)
+		{
+			for (int y = 0; y < BEAT_VIEW_GRID_HEIGHT; y += BEAT_VIEW_CELL_HEIGHT)
+				pd->graphics->drawLine(x, y, x, y + 1, 1, kColorBlack);
+		}
+	}
+
+	pd->graphics->popContext();
+
+}
+
+
+// --------------------------------------------------------------------------------
+// A note fills the cell of its first step, the steps it is held for get a bar
+// through the middle of the row.
+// --------------------------------------------------------------------------------
+static void BeatViewDrawTrackNotes(BeatView* pView, SequenceTrack* pTrack, int nRow, int* pTarget)
+{
+	PlaydateAPI* pd = pView->pd;
+
+	int y = nRow * BEAT_VIEW_CELL_HEIGHT;
+
+	uint32_t nStep;
+	uint32_t nLen;
+	MIDINote fNote;
+	float fVelocity;
+
+	for (int nIndex = 0; pd->sound->track->getNoteAtIndex(pTrack, nIndex, &nStep, &nLen, &fNote, &fVelocity); nIndex++)
+	{
+		int nEnd = (int)(nStep + (nLen > 0 ? nLen : 1));
+		if (nEnd > pView->nBeatLength)
+			nEnd = pView->nBeatLength;
+
+		for (int nCell = (int)nStep; nCell < nEnd; nCell++)
+		{
+			BeatViewTargetPage(pView, nCell / BEAT_VIEW_PAGE_STEPS, pTarget);
+
+			int x = (nCell % BEAT_VIEW_PAGE_STEPS) * BEAT_VIEW_CELL_WIDTH;
+
+			if (nCell == (int)nStep)
+				pd->graphics->fillRect(x + 2, y + 2, BEAT_VIEW_CELL_WIDTH - 3, BEAT_VIEW_CELL_HEIGHT - 4, kColorBlack);
+			else
+				pd->graphics->fillRect(x, y + BEAT_VIEW_CELL_HEIGHT / 2 - 1, BEAT_VIEW_CELL_WIDTH, 2, kColorBlack);
+		}
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Draws every page of the loaded beat into its own bitmap, the notes are read back
+// from the sequence tracks. Call it after a load was committed.
+// --------------------------------------------------------------------------------
+void BeatViewBuild(BeatView* pView, BeatMachine* pBeatMachine)
+{
+	PlaydateAPI* pd = pView->pd;
+
+	BeatViewFreeBitmaps(pView);
+
+	int nBeatLength = pBeatMachine->nBeatLength;
+	if (nBeatLength > BM_MAX_STEP_COUNT)
+		nBeatLength = BM_MAX_STEP_COUNT;
+
+	pView->nBeatLength = nBeatLength;
+	pView->nPageCount = (nBeatLength + BEAT_VIEW_PAGE_STEPS - 1) / BEAT_VIEW_PAGE_STEPS;
+
+	for (int i = 0; i < pView->nPageCount; i++)
+	{
+		pView->pPages[i] = pd->graphics->newBitmap(BEAT_VIEW_GRID_WIDTH, BEAT_VIEW_GRID_HEIGHT, kColorWhite);
+		BeatViewDrawPageGrid(pView, i);
+	}
+
+	pView->pLabels = pd->graphics->newBitmap(BEAT_VIEW_LABEL_WIDTH, BEAT_VIEW_GRID_HEIGHT, kColorWhite);
+
+	pView->nBitmapBytes = pView->nPageCount * BeatViewBitmapBytes(BEAT_VIEW_GRID_WIDTH, BEAT_VIEW_GRID_HEIGHT) +
+		BeatViewBitmapBytes(BEAT_VIEW_LABEL_WIDTH, BEAT_VIEW_GRID_HEIGHT);
+
+	int nTarget = -1;
+
+	for (int i = 0; i < BM_MAX_TRACK; i++)
+	{
+		BeatMachineTrack* pTrack = pBeatMachine->pTracks[i];
+		if (pTrack == NULL || pTrack->pTrack == NULL || pView->nPageCount == 0)
+			continue;
+
+		// the occupancy index knows the empty tracks, those aren't walked at all
+		if (BeatMachineGetTrackNotes(pBeatMachine, i, NULL) == 0)
+			continue;
+
+		BeatViewDrawTrackNotes(pView, pTrack->pTrack, i, &nTarget);
+	}
+
+	if (nTarget >= 0)
+		pd->graphics->popContext();
+
+	pd->graphics->pushContext(pView->pLabels);
+
+	if (pView->pFont)
+		pd->graphics->setFont(pView->pFont);
+
+	for (int i = 0; i < BM_MAX_TRACK; i++)
+	{
+		BeatMachineTrack* pTrack = pBeatMachine->pTracks[i];
+		if (pTrack == NULL || pTrack->pTrack == NULL)
+			continue;
+
+		pd->graphics->drawText(pTrack->szTrackName, strlen(pTrack->szTrackName), kASCIIEncoding, 2, i * BEAT_VIEW_CELL_HEIGHT + 2);
+	}
+
+	pd->graphics->popContext();
+
+	BeatViewInvalidate(pView);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// The next update draws the whole screen, for when something else drew over it.
+// --------------------------------------------------------------------------------
+void BeatViewInvalidate(BeatView* pView)
+{
+	pView->bDrawFrame = 1;
+	pView->nShownPage = BEAT_VIEW_NO_STEP;
+	pView->nShownStep = BEAT_VIEW_NO_STEP;
+	pView->nShownMutes = 0;
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatViewDrawFrame(BeatView* pView, BeatMachine* pBeatMachine)
+{
+	PlaydateAPI* pd = pView->pd;
+
+	pd->graphics->clear(kColorWhite);
+
+	if (pView->pFont)
+		pd->graphics->setFont(pView->pFont);
+
+	const char* szTitle = pBeatMachine->szBeatName ? pBeatMachine->szBeatName : "";
+	pd->graphics->drawText(szTitle, strlen(szTitle), kASCIIEncoding, BEAT_VIEW_TITLE_X, BEAT_VIEW_TITLE_Y);
+
+	if (pView->pLabels)
+		pd->graphics->drawBitmap(pView->pLabels, 0, BEAT_VIEW_GRID_Y, kBitmapUnflipped);
+
+	pView->bDrawFrame = 0;
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatViewDrawStatus(BeatView* pView, int nStep)
+{
+	PlaydateAPI* pd = pView->pd;
+
+	char szStatus[48];
+	int nLen = 0;
+
+	memcpy(szStatus, "BAR ", 4);
+	nLen = 4;
+	nLen += BeatViewFormatInt(szStatus + nLen, nStep / BM_STEPS_PER_BAR + 1);
+
+	memcpy(szStatus + nLen, "  STEP ", 7);
+	nLen += 7;
+	nLen += BeatViewFormatInt(szStatus + nLen, nStep);
+
+	int nHeight = BEAT_VIEW_GRID_Y - BEAT_VIEW_STATUS_Y - 2;
+	pd->graphics->fillRect(BEAT_VIEW_TITLE_X, BEAT_VIEW_STATUS_Y, BEAT_VIEW_WIDTH - BEAT_VIEW_TITLE_X, nHeight, kColorWhite);
+	pd->graphics->drawText(szStatus, nLen, kASCIIEncoding, BEAT_VIEW_TITLE_X, BEAT_VIEW_STATUS_Y);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Two frames per step so the playhead is at most half a step behind and a seek
+// finds a frame in the step before its bar, but not faster than that.
+// --------------------------------------------------------------------------------
+static void BeatViewUpdateRefreshRate(BeatView* pView, int nBPM)
+{
+	if (nBPM == pView->nBPM)
+		return;
+
+	float fRate = (float)(nBPM * BM_STEPS_PER_BEAT * BEAT_VIEW_FRAMES_PER_STEP) / 60.0f;
+
+	if (fRate < BEAT_VIEW_MIN_FPS)
+		fRate = BEAT_VIEW_MIN_FPS;
+	else if (fRate > BEAT_VIEW_MAX_FPS)
+		fRate = BEAT_VIEW_MAX_FPS;
+
+	pView->pd->display->setRefreshRate(fRate);
+
+	pView->nBPM = nBPM;
+	pView->fRefreshRate = fRate;
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Call once per frame with the step the beat is on. Draws nothing when the step
+// and mutes are what is already on the screen.
+// --------------------------------------------------------------------------------
+void BeatViewUpdate(BeatView* pView, BeatMachine* pBeatMachine, int nStep)
+{
+	PlaydateAPI* pd = pView->pd;
+
+	BeatViewUpdateRefreshRate(pView, pBeatMachine->nBPM);
+
+	if (pView->bDrawFrame)
+		BeatViewDrawFrame(pView, pBeatMachine);
+
+	if (pView->nPageCount == 0)
+		return;
+
+	if (nStep < 0)
+		nStep = 0;
+	else if (nStep >= pView->nBeatLength)
+		nStep = pView->nBeatLength - 1;
+
+	int nPage = nStep / BEAT_VIEW_PAGE_STEPS;
+
+	if (nPage != pView->nShownPage)
+	{
+		pd->graphics->drawBitmap(pView->pPages[nPage], BEAT_VIEW_GRID_X, BEAT_VIEW_GRID_Y, kBitmapUnflipped);
+
+		pView->nShownPage = nPage;
+		pView->nShownStep = BEAT_VIEW_NO_STEP;
+		pView->nPageDraws++;
+	}
+
+	// the playhead is an inverted column, inverting it again puts the page back
+	if (nStep != pView->nShownStep)
+	{
+		if (pView->nShownStep != BEAT_VIEW_NO_STEP)
+		{
+			int x = BEAT_VIEW_GRID_X + (pView->nShownStep % BEAT_VIEW_PAGE_STEPS) * BEAT_VIEW_CELL_WIDTH;
+			pd->graphics->fillRect(x, BEAT_VIEW_GRID_Y, BEAT_VIEW_CELL_WIDTH, BEAT_VIEW_GRID_HEIGHT, kColorXOR);
+		}
+
+		int x = BEAT_VIEW_GRID_X + (nStep % BEAT_VIEW_PAGE_STEPS) * BEAT_VIEW_CELL_WIDTH;
+		pd->graphics->fillRect(x, BEAT_VIEW_GRID_Y, BEAT_VIEW_CELL_WIDTH, BEAT_VIEW_GRID_HEIGHT, kColorXOR);
+
+		BeatViewDrawStatus(pView, nStep);
+
+		pView->nShownStep = nStep;
+		pView->nStepDraws++;
+	}
+
+	// muted tracks have their label inverted
+	int nMutes = 0;
+	for (int i = 0; i < BM_MAX_TRACK; i++)
+	{
+		if (pBeatMachine->pTracks[i] && pBeatMachine->pTracks[i]->bMuted)
+			nMutes |= 1 << i;
+	}
+
+	int nChanged = nMutes ^ pView->nShownMutes;
+	for (int i = 0; nChanged; i++, nChanged >>= 1)
+	{
+		if (nChanged & 1)
+			pd->graphics->fillRect(0, BEAT_VIEW_GRID_Y + i * BEAT_VIEW_CELL_HEIGHT, BEAT_VIEW_LABEL_WIDTH, BEAT_VIEW_CELL_HEIGHT, kColorXOR);
+	}
+
+	pView->nShownMutes = nMutes;
+
+}
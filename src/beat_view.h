@@ -0,0 +1,107 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef BEATVIEW_H
+#define BEATVIEW_H
+
+#pragma once
+
+#include <stdio.h>
+
+#include "pd_api.h"
+
+#include "beat_machine.h"
+
+
+// --------------------------------------------------------------------------------
+// Step grid of the playing beat, one row per track. Every page of the grid is
+// drawn into a bitmap when the beat is loaded, a frame only puts a page up when
+// the playhead moves onto it and otherwise inverts the two playhead columns and
+// the labels of tracks whose mute changed.
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BEAT_VIEW_WIDTH = 400,
+	BEAT_VIEW_HEIGHT = 240,
+
+	BEAT_VIEW_VISIBLE_BARS = 2,
+	BEAT_VIEW_PAGE_STEPS = BEAT_VIEW_VISIBLE_BARS * BM_STEPS_PER_BAR,
+	BEAT_VIEW_MAX_PAGES = (BM_MAX_STEP_COUNT + BEAT_VIEW_PAGE_STEPS - 1) / BEAT_VIEW_PAGE_STEPS,
+
+	BEAT_VIEW_CELL_WIDTH = 11,
+	BEAT_VIEW_CELL_HEIGHT = 12,
+	BEAT_VIEW_LABEL_WIDTH = 48,
+
+	BEAT_VIEW_GRID_X = BEAT_VIEW_LABEL_WIDTH,
+	BEAT_VIEW_GRID_Y = BEAT_VIEW_HEIGHT - BM_MAX_TRACK * BEAT_VIEW_CELL_HEIGHT - 8,
+	BEAT_VIEW_GRID_WIDTH = BEAT_VIEW_PAGE_STEPS * BEAT_VIEW_CELL_WIDTH,
+	BEAT_VIEW_GRID_HEIGHT = BM_MAX_TRACK * BEAT_VIEW_CELL_HEIGHT,
+
+	BEAT_VIEW_TITLE_X = 64,			// right of drawFPS
+	BEAT_VIEW_TITLE_Y = 4,
+	BEAT_VIEW_STATUS_Y = 20,
+
+	BEAT_VIEW_FRAMES_PER_STEP = 2,	// a seek needs a frame in the step before the bar
+	BEAT_VIEW_MIN_FPS = 5,
+	BEAT_VIEW_MAX_FPS = 50,
+
+	BEAT_VIEW_NO_STEP = -1,
+	BEAT_VIEW_INT_SIZE = 12
+
+} BEAT_VIEW_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	PlaydateAPI* pd;
+	LCDFont* pFont;
+
+	LCDBitmap* pPages[BEAT_VIEW_MAX_PAGES];
+	LCDBitmap* pLabels;
+	int nPageCount;
+	int nBeatLength;
+	int nBitmapBytes;
+
+	// what is on the screen now, a frame only draws what differs
+	int bDrawFrame;
+	int nShownPage;
+	int nShownStep;
+	int nShownMutes;
+
+	int nBPM;						// tempo the refresh rate was set for
+	float fRefreshRate;
+
+	int nPageDraws;
+	int nStepDraws;
+
+} BeatView;
+
+
+// --------------------------------------------------------------------------------
+BeatView* BeatViewCreate(PlaydateAPI* playdateApi, LCDFont* pFont);
+void BeatViewDestroy(BeatView* pView);
+
+void BeatViewBuild(BeatView* pView, BeatMachine* pBeatMachine);
+void BeatViewInvalidate(BeatView* pView);
+void BeatViewUpdate(BeatView* pView, BeatMachine* pBeatMachine, int nStep);
+
+int BeatViewFormatInt(char* szBuffer, int nValue);
+
+
+#endif
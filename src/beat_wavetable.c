@@ -0,0 +1,387 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <math.h>
+#include <string.h>
+
+#include "beat_wavetable.h"
+
+// --------------------------------------------------------------------------------
+
+void* Engine_MemAlloc(int nSize);
+void Engine_MemFree(void* pData);
+
+
+// --------------------------------------------------------------------------------
+// the rate the octaves are worked out for, the device plays at nothing else
+#define BM_WAVETABLE_RATE		44100.0f
+#define BM_WAVETABLE_TWO_PI		6.28318530718f
+
+
+// --------------------------------------------------------------------------------
+// What a synth playing a wavetable keeps, one per synth. The chord voices of a
+// track are copies of its synth and get their own.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	const BeatWavetable* pTable;
+	uint32_t nPhase;
+
+} BeatWavetableVoice;
+
+
+// --------------------------------------------------------------------------------
+// One cycle of a sine, harmonic k of a table frame i is at (k * i) modulo the size
+static float fSine[BM_WAVETABLE_SIZE];
+static int bSineReady = 0;
+
+
+// --------------------------------------------------------------------------------
+static void BeatWavetableInitSine()
+{
+	if (bSineReady)
+		return;
+
+	for (int i = 0; i < BM_WAVETABLE_SIZE; i++)
+		fSine[i] = sinf(BM_WAVETABLE_TWO_PI * i / BM_WAVETABLE_SIZE);
+
+	bSineReady = 1;
+}
+
+
+// --------------------------------------------------------------------------------
+// The phase step a note at the top of level nLevel has, a step of 1 << 32 is one
+// cycle per frame.
+// --------------------------------------------------------------------------------
+static float BeatWavetableLevelTop(int nLevel)
+{
+	float fLowest = 440.0f * exp2f((BM_WAVETABLE_LOWEST_NOTE - 69) / 12.0f);
+
+	return fLowest * (float)(2 << nLevel) / BM_WAVETABLE_RATE;
+}
+
+
+// --------------------------------------------------------------------------------
+// Adds up the harmonics for every level. pSin and pCos are indexed by harmonic,
+// from 1 to nHarmonics. The levels share one gain, so a note sounds as loud in
+// every octave, and the loudest of them is at full scale.
+// --------------------------------------------------------------------------------
+static BeatWavetable* BeatWavetableBuild(BeatArena* pArena, const float* pSin, const float* pCos, int nHarmonics)
+{
+	BeatWavetableInitSine();
+
+	BeatWavetable* pTable = BeatArenaAlloc(pArena, sizeof(BeatWavetable));
+	pTable->pFrames = BeatArenaAlloc(pArena, BM_WAVETABLE_LEVELS * (BM_WAVETABLE_SIZE + 1) * sizeof(int16_t));
+	pTable->nHarmonics = nHarmonics;
+
+	float* pLevels = Engine_MemAlloc(BM_WAVETABLE_LEVELS * BM_WAVETABLE_SIZE * sizeof(float));
+	float fPeak = 0.0f;
+	int nLastCount = -1;
+
+	for (int l = 0; l < BM_WAVETABLE_LEVELS; l++)
+	{
+		float fTop = BeatWavetableLevelTop(l);
+		float* pOut = pLevels + l * BM_WAVETABLE_SIZE;
+
+		pTable->nLevelSteps[l] = fTop < 1.0f ? (uint32_t)(fTop * 4294967296.0f) : 0xffffffffu;
+
+		// the fundamental always plays, the top octave would have nothing else
+		int nCount = (int)(0.5f / fTop);
+		nCount = nCount < 1 ? 1 : (nCount > nHarmonics ? nHarmonics : nCount);
+
+		// the low octaves mostly have room for every harmonic there is
+		if (nCount == nLastCount)
+		{
+			memcpy(pOut, pOut - BM_WAVETABLE_SIZE, BM_WAVETABLE_SIZE * sizeof(float));
+			continue;
+		}
+
+		memset(pOut, 0, BM_WAVETABLE_SIZE * sizeof(float));
+
+		for (int k = 1; k <= nCount; k++)
+		{
+			float s = pSin[k];
+			float c = pCos[k];
+			if (s == 0.0f && c == 0.0f)
+				continue;
+
+			int nIndex = 0;
+			for (int i = 0; i < BM_WAVETABLE_SIZE; i++)
+			{
+				pOut[i] += s * fSine[nIndex] + c * fSine[(nIndex + BM_WAVETABLE_SIZE / 4) & (BM_WAVETABLE_SIZE - 1)];
+				nIndex = (nIndex + k) & (BM_WAVETABLE_SIZE - 1);
+			}
+		}
+
+		for (int i = 0; i < BM_WAVETABLE_SIZE; i++)
+		{
+			float fValue = fabsf(pOut[i]);
+			if (fValue > fPeak)
+				fPeak = fValue;
+		}
+
+		nLastCount = nCount;
+	}
+
+	float fGain = fPeak > 0.0f ? 32767.0f / fPeak : 0.0f;
+
+	for (int l = 0; l < BM_WAVETABLE_LEVELS; l++)
+	{
+		const float* pIn = pLevels + l * BM_WAVETABLE_SIZE;
+		int16_t* pOut = pTable->pFrames + l * (BM_WAVETABLE_SIZE + 1);
+
+		for (int i = 0; i < BM_WAVETABLE_SIZE; i++)
+			pOut[i] = (int16_t)lrintf(pIn[i] * fGain);
+
+		pOut[BM_WAVETABLE_SIZE] = pOut[0];
+	}
+
+	Engine_MemFree(pLevels);
+
+	return pTable;
+}
+
+
+// --------------------------------------------------------------------------------
+// pLevels[0] is the fundamental, every harmonic starts in sine phase. Without
+// any, the table is the fundamental alone.
+// --------------------------------------------------------------------------------
+BeatWavetable* BeatWavetableCreate(BeatArena* pArena, const float* pLevels, int nCount)
+{
+	float fSin[BM_WAVETABLE_MAX_HARMONICS + 1];
+	float fCos[BM_WAVETABLE_MAX_HARMONICS + 1];
+
+	memset(fSin, 0, sizeof(fSin));
+	memset(fCos, 0, sizeof(fCos));
+
+	if (nCount > BM_WAVETABLE_MAX_HARMONICS)
+		nCount = BM_WAVETABLE_MAX_HARMONICS;
+
+	int nHarmonics = 1;
+	for (int k = 1; k <= nCount; k++)
+	{
+		fSin[k] = pLevels[k - 1];
+		if (fSin[k] != 0.0f)
+			nHarmonics = k;
+	}
+
+	if (nCount < 1 || fSin[nHarmonics] == 0.0f)
+		fSin[1] = 1.0f;
+
+	return BeatWavetableBuild(pArena, fSin, fCos, nHarmonics);
+}
+
+
+// --------------------------------------------------------------------------------
+// pFrames is one cycle of nFrameCount frames, nStride values apart. It is
+// stretched to the table size and taken apart into its harmonics, which keeps
+// their phases, then built up again level by level.
+// --------------------------------------------------------------------------------
+BeatWavetable* BeatWavetableCreateFromCycle(BeatArena* pArena, const int16_t* pFrames, int nFrameCount, int nStride)
+{
+	BeatWavetableInitSine();
+
+	float fCycle[BM_WAVETABLE_SIZE];
+	for (int i = 0; i < BM_WAVETABLE_SIZE; i++)
+	{
+		float fPosition = (float)i * nFrameCount / BM_WAVETABLE_SIZE;
+		int nIndex = (int)fPosition;
+		int nNext = nIndex + 1 < nFrameCount ? nIndex + 1 : 0;
+		float fFraction = fPosition - nIndex;
+
+		fCycle[i] = pFrames[nIndex * nStride] + (pFrames[nNext * nStride] - pFrames[nIndex * nStride]) * fFraction;
+	}
+
+	float fSin[BM_WAVETABLE_MAX_HARMONICS + 1];
+	float fCos[BM_WAVETABLE_MAX_HARMONICS + 1];
+	float fLoudest = 0.0f;
+
+	fSin[0] = 0.0f;
+	fCos[0] = 0.0f;
+
+	for (int k = 1; k <= BM_WAVETABLE_MAX_HARMONICS; k++)
+	{
+		float s = 0.0f;
+		float c = 0.0f;
+
+		int nIndex = 0;
+		for (int i = 0; i < BM_WAVETABLE_SIZE; i++)
+		{
+			s += fCycle[i] * fSine[nIndex];
+			c += fCycle[i] * fSine[(nIndex + BM_WAVETABLE_SIZE / 4) & (BM_WAVETABLE_SIZE - 1)];
+			nIndex = (nIndex + k) & (BM_WAVETABLE_SIZE - 1);
+		}
+
+		// the gain is set when the table is built, the scale doesn't matter here
+		fSin[k] = s;
+		fCos[k] = c;
+
+		float fLevel = s * s + c * c;
+		if (fLevel > fLoudest)
+			fLoudest = fLevel;
+	}
+
+	// harmonics 60 dB under the loudest are left out
+	int nHarmonics = 1;
+	for (int k = 1; k <= BM_WAVETABLE_MAX_HARMONICS; k++)
+	{
+		if (fSin[k] * fSin[k] + fCos[k] * fCos[k] > fLoudest * 1e-6f)
+			nHarmonics = k;
+	}
+
+	if (fLoudest == 0.0f)
+		fSin[1] = 1.0f;
+
+	return BeatWavetableBuild(pArena, fSin, fCos, nHarmonics);
+}
+
+
+// --------------------------------------------------------------------------------
+// A 16 bit wave file holding one cycle, the left channel of a stereo one. The
+// sample is freed again once its harmonics are known.
+// --------------------------------------------------------------------------------
+BeatWavetable* BeatWavetableLoad(PlaydateAPI* pd, BeatArena* pArena, const char* szPath, const char* szName)
+{
+	char szFullPath[256];
+	snprintf(szFullPath, sizeof(szFullPath), "%s%s", szPath, szName);
+
+	AudioSample* pSample = pd->sound->sample->load(szFullPath);
+	if (pSample == NULL)
+	{
+		pd->system->logToConsole("wavetable: cannot load %s", szFullPath);
+		return NULL;
+	}
+
+	uint8_t* pData = NULL;
+	SoundFormat format;
+	uint32_t nSampleRate = 0;
+	uint32_t nByteLength = 0;
+	pd->sound->sample->getData(pSample, &pData, &format, &nSampleRate, &nByteLength);
+
+	int nStride = format == kSound16bitStereo ? 2 : 1;
+	int nFrameCount = nByteLength / (nStride * sizeof(int16_t));
+
+	BeatWavetable* pTable = NULL;
+	if (pData == NULL || (format != kSound16bitMono && format != kSound16bitStereo) || nFrameCount < 2 || nFrameCount > BM_WAVETABLE_MAX_CYCLE_FRAMES)
+		pd->system->logToConsole("wavetable: %s is not one cycle of 16 bit sound", szFullPath);
+	else
+		pTable = BeatWavetableCreateFromCycle(pArena, (const int16_t*)pData, nFrameCount, nStride);
+
+	pd->sound->sample->freeSample(pSample);
+
+	return pTable;
+}
+
+
+// --------------------------------------------------------------------------------
+// The whole oscillator: the level for the step, then one lookup and one
+// interpolation per frame. The synth puts its envelope on what comes out.
+// --------------------------------------------------------------------------------
+static int BeatWavetableRender(void* pUserdata, int32_t* pLeft, int32_t* pRight, int nFrameCount, uint32_t nRate, int32_t nRateDelta)
+{
+	BeatWavetableVoice* pVoice = pUserdata;
+	const BeatWavetable* pTable = pVoice->pTable;
+
+	// a rising step picks the level it ends the block on
+	uint32_t nTopRate = nRateDelta > 0 ? nRate + (uint32_t)nRateDelta * nFrameCount : nRate;
+
+	const int16_t* pFrames = pTable->pFrames;
+	for (int l = 0; l < BM_WAVETABLE_LEVELS - 1 && nTopRate >= pTable->nLevelSteps[l]; l++)
+		pFrames += BM_WAVETABLE_SIZE + 1;
+
+	uint32_t nPhase = pVoice->nPhase;
+
+	for (int i = 0; i < nFrameCount; i++)
+	{
+		uint32_t nIndex = nPhase >> (32 - BM_WAVETABLE_BITS);
+		int32_t nFraction = (nPhase >> (17 - BM_WAVETABLE_BITS)) & 0x7fff;
+
+		int32_t a = pFrames[nIndex];
+		int32_t b = pFrames[nIndex + 1];
+
+		// 16 bit to Q8.24, the 15 bit fraction keeps the product in range
+		pLeft[i] = (a << 9) + (((b - a) * nFraction) >> 6);
+
+		nPhase += nRate;
+		nRate += nRateDelta;
+	}
+
+	pVoice->nPhase = nPhase;
+
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatWavetableNoteOn(void* pUserdata, MIDINote note, float fVelocity, float fLength)
+{
+	BeatWavetableVoice* pVoice = pUserdata;
+
+	// every note starts on the same part of the cycle
+	pVoice->nPhase = 0;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatWavetableRelease(void* pUserdata, int nEndOffset)
+{
+	// the synth's envelope does the release
+}
+
+
+// --------------------------------------------------------------------------------
+static int BeatWavetableSetParameter(void* pUserdata, int nParameter, float fValue)
+{
+	return 0;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BeatWavetableDealloc(void* pUserdata)
+{
+	// the voice goes with its synth, the table belongs to the beat
+	Engine_MemFree(pUserdata);
+}
+
+
+// --------------------------------------------------------------------------------
+static void* BeatWavetableCopyUserdata(void* pUserdata)
+{
+	const BeatWavetableVoice* pVoice = pUserdata;
+
+	BeatWavetableVoice* pCopy = Engine_MemAlloc(sizeof(BeatWavetableVoice));
+	pCopy->pTable = pVoice->pTable;
+	pCopy->nPhase = 0;
+
+	return pCopy;
+}
+
+
+// --------------------------------------------------------------------------------
+// The synth plays pTable from now on, in place of its waveform or sample.
+// --------------------------------------------------------------------------------
+void BeatWavetableAttach(PlaydateAPI* pd, PDSynth* pSynth, const BeatWavetable* pTable)
+{
+	BeatWavetableVoice* pVoice = Engine_MemAlloc(sizeof(BeatWavetableVoice));
+	pVoice->pTable = pTable;
+	pVoice->nPhase = 0;
+
+	pd->sound->synth->setGenerator(pSynth, 0, BeatWavetableRender, BeatWavetableNoteOn, BeatWavetableRelease,
+		BeatWavetableSetParameter, BeatWavetableDealloc, BeatWavetableCopyUserdata, pVoice);
+
+}
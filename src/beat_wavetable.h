@@ -0,0 +1,71 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef BEATWAVETABLE_H
+#define BEATWAVETABLE_H
+
+#pragma once
+
+#include <stdio.h>
+
+#include "pd_api.h"
+#include "beat_arena.h"
+
+
+// --------------------------------------------------------------------------------
+// A wavetable is one cycle of a wave rendered once per octave, each copy with
+// only the harmonics that stay under half the sample rate for every note of its
+// octave. A note plays the copy of its octave, so nothing it plays aliases and
+// the oscillator is a table lookup with linear interpolation.
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BM_WAVETABLE_BITS = 8,
+	BM_WAVETABLE_SIZE = 1 << BM_WAVETABLE_BITS,		// frames of one cycle
+	BM_WAVETABLE_LEVELS = 9,						// an octave each, from BM_WAVETABLE_LOWEST_NOTE past note 127
+	BM_WAVETABLE_LOWEST_NOTE = 24,					// the lowest note an instrument voice takes
+	BM_WAVETABLE_MAX_HARMONICS = 64,
+	BM_WAVETABLE_MAX_CYCLE_FRAMES = 4096			// a wave file longer than this is not one cycle
+
+} BEAT_WAVETABLE_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+// pFrames holds the levels one after the other, each BM_WAVETABLE_SIZE + 1 frames
+// long with the first frame repeated at the end for the interpolation. A voice
+// moves up a level when its phase step reaches nLevelSteps of the one it is on.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int16_t* pFrames;
+	uint32_t nLevelSteps[BM_WAVETABLE_LEVELS];
+
+	int nHarmonics;
+
+} BeatWavetable;
+
+
+// --------------------------------------------------------------------------------
+BeatWavetable* BeatWavetableCreate(BeatArena* pArena, const float* pLevels, int nCount);
+BeatWavetable* BeatWavetableCreateFromCycle(BeatArena* pArena, const int16_t* pFrames, int nFrameCount, int nStride);
+BeatWavetable* BeatWavetableLoad(PlaydateAPI* pd, BeatArena* pArena, const char* szPath, const char* szName);
+
+void BeatWavetableAttach(PlaydateAPI* pd, PDSynth* pSynth, const BeatWavetable* pTable);
+
+
+#endif
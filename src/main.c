@@ -23,75 +23,41 @@ PERFORMANCE OF THIS SOFTWARE.
 #include "pd_api.h"
 
 #include "beat_machine.h"
+#include "beat_benchmark.h"
+#include "beat_view.h"
 
 // --------------------------------------------------------------------------------
 LCDFont* pFont = NULL;
 BeatMachine* pBeatMachine = NULL;
+BeatView* pBeatView = NULL;
 PlaydateAPI* pd = NULL;
 int nCurrentStep = 0;
 
 
 // --------------------------------------------------------------------------------
-void PrintIntValueToString(char* szBuffer, int nBufferSize, int nDigitCount, int nValue)
+void OnStep(const BeatEvent* pEvent, void* pUserdata)
 {
-	memset(szBuffer, 0, nBufferSize);
-
-	int nRemaining = nValue;
-
-	int nCount = 0;
-
-	while (nRemaining > 0 || nCount < nDigitCount)
-	{
-		int nDigit = nRemaining % 10;
-		nRemaining = nRemaining / 10;
-
-		char* pDest = szBuffer + nBufferSize - 1;
-		char* pSrc = pDest - 1;
-		while (pSrc >= szBuffer)
-		{
-			*pDest-- = *pSrc--;
-		}
-
-		*szBuffer = '0' + nDigit;
-
-		nCount++;
-
-
-	}
-
+	nCurrentStep = pEvent->nStep;
 }
 
 
 // --------------------------------------------------------------------------------
 int update(void* userData)
 {
-	if (pd && pBeatMachine && pFont)
+	if (pd && pBeatMachine && pBeatView)
 	{
-		if (pd->sound->sequence->isPlaying(pBeatMachine->pSequence))
-		{
-
-			int nStep = pd->sound->sequence->getCurrentStep(pBeatMachine->pSequence, 0);
-			
-			if (nStep != nCurrentStep)
-			{
-				pd->graphics->fillRect(0, 0, 400, 240, kColorWhite);
+		PDButtons pushed;
+		pd->system->getButtonState(NULL, &pushed, NULL);
 
-				nCurrentStep = nStep;
-			
-				char szBuffer[16];
-				memset(szBuffer, 0, 16);
-				PrintIntValueToString(szBuffer, 16, 1, nStep);
+		// A jumps to the drop on the next bar
+		if (pushed & kButtonA)
+			BeatMachineSeekToLabel(pBeatMachine, "drop");
 
-				char szOutString[80];
-				memset(szOutString, 0, 80);
-				strcpy(szOutString, "STEP: ");
-				strcat(szOutString, szBuffer);
+		BeatMachineUpdateSeek(pBeatMachine);
 
-				int nLen = strlen(szOutString);
-				pd->graphics->drawText(szOutString, nLen, kASCIIEncoding, 10, 100);
-			}
-
-		}
+		// the steps come from the sequencer, the view only draws what changed since the last frame
+		BeatMachineDispatchEvents(pBeatMachine);
+		BeatViewUpdate(pBeatView, pBeatMachine, nCurrentStep);
 
 		pd->system->drawFPS(0, 0);
 
@@ -116,12 +82,20 @@ int eventHandler(PlaydateAPI* playdate, PDSystemEvent event, uint32_t arg)
 
 		pFont = pd->graphics->loadFont("assets/fonts/font-rains-1x", &err);
 
+#ifdef BM_BENCHMARK
+		BeatBenchmarkRun(playdate);
+#endif
+
 		pBeatMachine = BeatMachineCreate(playdate);
 
-		BeatMachineLoadBeat("demo.bmf");
-		BeatMachinePlayTheBeat(0);
+		BeatMachineLoadBeat(pBeatMachine, "demo.bmf");
+		BeatMachineSubscribe(pBeatMachine, BM_EVENT_STEP, OnStep, NULL);
+		BeatMachinePlayTheBeat(pBeatMachine, 0);
+
+		// the view sets the refresh rate from the tempo
+		pBeatView = BeatViewCreate(playdate, pFont);
+		BeatViewBuild(pBeatView, pBeatMachine);
 
-		playdate->display->setRefreshRate(0);
 		playdate->system->setUpdateCallback(update, 0);
 	}
 		break;
@@ -129,7 +103,8 @@ int eventHandler(PlaydateAPI* playdate, PDSystemEvent event, uint32_t arg)
 	case kEventTerminate:
 		
 
-		BeatMachineDestroy();
+		BeatViewDestroy(pBeatView);
+		BeatMachineDestroy(pBeatMachine);
 		
 		break;
 	}
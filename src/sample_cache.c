@@ -0,0 +1,240 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "sample_cache.h"
+
+// --------------------------------------------------------------------------------
+
+void* Engine_MemAlloc(int nSize);
+void Engine_MemFree(void* pData);
+
+
+// --------------------------------------------------------------------------------
+static void SampleCacheFreeEntry(SampleCache* pCache, SampleCacheEntry* pEntry)
+{
+	pCache->pd->sound->sample->freeSample(pEntry->pSample);
+
+	pCache->stats.nResidentBytes -= pEntry->nBytes;
+	pCache->stats.nResidentCount--;
+
+	memset(pEntry, 0, sizeof(SampleCacheEntry));
+
+}
+
+
+// --------------------------------------------------------------------------------
+static SampleCacheEntry* SampleCacheFindLeastRecentlyUsed(SampleCache* pCache)
+{
+	// only samples that no track is holding can be evicted
+	SampleCacheEntry* pOldest = NULL;
+
+	for (int i = 0; i < SAMPLE_CACHE_SIZE; i++)
+	{
+		SampleCacheEntry* pEntry = &pCache->entries[i];
+
+		if (pEntry->pSample && pEntry->nRefCount == 0)
+		{
+			if (pOldest == NULL || pEntry->nLastUse < pOldest->nLastUse)
+				pOldest = pEntry;
+		}
+	}
+
+	return pOldest;
+}
+
+
+// --------------------------------------------------------------------------------
+SampleCache* SampleCacheCreate(PlaydateAPI* playdateApi, int nBudgetBytes)
+{
+	SampleCache* pCache = Engine_MemAlloc(sizeof(SampleCache));
+	memset(pCache, 0, sizeof(SampleCache));
+
+	pCache->pd = playdateApi;
+	pCache->nBudgetBytes = nBudgetBytes;
+
+	return pCache;
+}
+
+
+// --------------------------------------------------------------------------------
+void SampleCacheDestroy(SampleCache* pCache)
+{
+	for (int i = 0; i < SAMPLE_CACHE_SIZE; i++)
+	{
+		if (pCache->entries[i].pSample)
+			SampleCacheFreeEntry(pCache, &pCache->entries[i]);
+	}
+
+	Engine_MemFree(pCache);
+
+}
+
+
+// --------------------------------------------------------------------------------
+void SampleCacheTrim(SampleCache* pCache, int nTargetBytes)
+{
+	while (pCache->stats.nResidentBytes > nTargetBytes)
+	{
+		SampleCacheEntry* pEntry = SampleCacheFindLeastRecentlyUsed(pCache);
+		if (pEntry == NULL)
+			break;
+
+		SampleCacheFreeEntry(pCache, pEntry);
+		pCache->stats.nEvictions++;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+void SampleCacheSetBudget(SampleCache* pCache, int nBudgetBytes)
+{
+	pCache->nBudgetBytes = nBudgetBytes;
+
+	SampleCacheTrim(pCache, nBudgetBytes);
+
+}
+
+
+// --------------------------------------------------------------------------------
+AudioSample* SampleCacheAcquire(SampleCache* pCache, const char* szPath, const char* szSampleName)
+{
+	pCache->nUseCounter++;
+
+	SampleCacheEntry* pFree = NULL;
+
+	for (int i = 0; i < SAMPLE_CACHE_SIZE; i++)
+	{
+		SampleCacheEntry* pEntry = &pCache->entries[i];
+
+		if (pEntry->pSample == NULL)
+		{
+			if (pFree == NULL)
+				pFree = pEntry;
+		}
+		else if (strcmp(pEntry->szName, szSampleName) == 0)
+		{
+			pEntry->nRefCount++;
+			pEntry->nLastUse = pCache->nUseCounter;
+
+			pCache->stats.nHits++;
+
+			return pEntry->pSample;
+		}
+	}
+
+	pCache->stats.nMisses++;
+
+	char szFullPath[256];
+	memset(szFullPath, 0, 256);
+
+	strcpy(szFullPath, szPath);
+	strcat(szFullPath, szSampleName);
+
+	AudioSample* pSample = pCache->pd->sound->sample->load(szFullPath);
+
+	if (pSample == NULL)
+	{
+		pCache->pd->system->logToConsole("sample cache: cannot load %s", szFullPath);
+		return NULL;
+	}
+
+	uint8_t* pData = NULL;
+	SoundFormat format;
+	uint32_t nSampleRate = 0;
+	uint32_t nByteLength = 0;
+	pCache->pd->sound->sample->getData(pSample, &pData, &format, &nSampleRate, &nByteLength);
+
+	// make room under the budget, held samples stay even if that means going over it
+	SampleCacheTrim(pCache, pCache->nBudgetBytes - (int)nByteLength);
+
+	if (pFree == NULL)
+	{
+		pFree = SampleCacheFindLeastRecentlyUsed(pCache);
+
+		if (pFree)
+		{
+			SampleCacheFreeEntry(pCache, pFree);
+			pCache->stats.nEvictions++;
+		}
+	}
+
+	if (pFree == NULL)
+	{
+		pCache->pd->system->logToConsole("sample cache: all %d slots are in use, %s not loaded", SAMPLE_CACHE_SIZE, szSampleName);
+		pCache->pd->sound->sample->freeSample(pSample);
+		return NULL;
+	}
+
+	strncpy(pFree->szName, szSampleName, SAMPLE_CACHE_NAME_SIZE - 1);
+	pFree->pSample = pSample;
+	pFree->nBytes = (int)nByteLength;
+	pFree->nRefCount = 1;
+	pFree->nLastUse = pCache->nUseCounter;
+
+	pCache->stats.nResidentBytes += pFree->nBytes;
+	pCache->stats.nResidentCount++;
+
+	if (pCache->stats.nResidentBytes > pCache->stats.nPeakResidentBytes)
+		pCache->stats.nPeakResidentBytes = pCache->stats.nResidentBytes;
+
+	if (pCache->stats.nResidentBytes > pCache->nBudgetBytes)
+		pCache->pd->system->logToConsole("sample cache: %d bytes resident, over the budget of %d", pCache->stats.nResidentBytes, pCache->nBudgetBytes);
+
+	return pSample;
+}
+
+
+// --------------------------------------------------------------------------------
+void SampleCacheRelease(SampleCache* pCache, AudioSample* pSample)
+{
+	if (pSample == NULL)
+		return;
+
+	for (int i = 0; i < SAMPLE_CACHE_SIZE; i++)
+	{
+		SampleCacheEntry* pEntry = &pCache->entries[i];
+
+		if (pEntry->pSample == pSample)
+		{
+			// unreferenced samples stay resident for the next beat until the budget needs the room
+			if (pEntry->nRefCount > 0)
+				pEntry->nRefCount--;
+
+			return;
+		}
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+const SampleCacheStats* SampleCacheGetStats(SampleCache* pCache)
+{
+	return &pCache->stats;
+}
+
+
+// --------------------------------------------------------------------------------
+void SampleCacheLogStats(SampleCache* pCache)
+{
+	pCache->pd->system->logToConsole("sample cache: %d hits, %d misses, %d evictions, %d samples, %d bytes resident (peak %d, budget %d)",
+		pCache->stats.nHits, pCache->stats.nMisses, pCache->stats.nEvictions, pCache->stats.nResidentCount,
+		pCache->stats.nResidentBytes, pCache->stats.nPeakResidentBytes, pCache->nBudgetBytes);
+
+}
@@ -0,0 +1,99 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef SAMPLECACHE_H
+#define SAMPLECACHE_H
+
+#pragma once
+
+#include <stdio.h>
+
+#include "pd_api.h"
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	SAMPLE_CACHE_SIZE = 32,
+	SAMPLE_CACHE_NAME_SIZE = 48,
+
+	// the whole game has 8 MB of heap (HEAP_SIZE in the Makefile), samples get a quarter of it
+	SAMPLE_CACHE_DEFAULT_BUDGET = 2 * 1024 * 1024
+
+} SAMPLE_CACHE_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	char szName[SAMPLE_CACHE_NAME_SIZE];
+
+	AudioSample* pSample;
+
+	int nBytes;
+	int nRefCount;
+
+	unsigned int nLastUse;
+
+} SampleCacheEntry;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int nHits;
+	int nMisses;
+	int nEvictions;
+
+	int nResidentBytes;
+	int nPeakResidentBytes;
+	int nResidentCount;
+
+} SampleCacheStats;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	PlaydateAPI* pd;
+
+	SampleCacheEntry entries[SAMPLE_CACHE_SIZE];
+
+	int nBudgetBytes;
+	unsigned int nUseCounter;
+
+	SampleCacheStats stats;
+
+} SampleCache;
+
+
+// --------------------------------------------------------------------------------
+SampleCache* SampleCacheCreate(PlaydateAPI* playdateApi, int nBudgetBytes);
+void SampleCacheDestroy(SampleCache* pCache);
+
+AudioSample* SampleCacheAcquire(SampleCache* pCache, const char* szPath, const char* szSampleName);
+void SampleCacheRelease(SampleCache* pCache, AudioSample* pSample);
+
+void SampleCacheSetBudget(SampleCache* pCache, int nBudgetBytes);
+void SampleCacheTrim(SampleCache* pCache, int nTargetBytes);
+
+const SampleCacheStats* SampleCacheGetStats(SampleCache* pCache);
+void SampleCacheLogStats(SampleCache* pCache);
+
+
+#endif
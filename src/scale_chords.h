@@ -0,0 +1,283 @@
+// Written by tools/bmchords from scale_intervals.h, "make chords" in tools.
+
+#ifndef SCALE_CHORDS_H
+#define SCALE_CHORDS_H
+
+#pragma once
+
+// [scale][root][pitch % 12]: semitones up to the third, fifth and seventh
+static const uint8_t nScaleChordTable[SCALE_COUNT][NOTE_COUNT][NOTE_COUNT][SCALE_CHORD_TONES] =
+{
+	// Chromatic
+	{
+		{ {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 } },	// C
+		{ {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 } },	// C#
+		{ {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 } },	// D
+		{ {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 } },	// D#
+		{ {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 } },	// E
+		{ {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 } },	// F
+		{ {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 } },	// F#
+		{ {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 } },	// G
+		{ {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 } },	// G#
+		{ {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 } },	// A
+		{ {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 } },	// A#
+		{ {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 }, {  2,  4,  6 } },	// B
+	},
+	// Major
+	{
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 } },	// C
+		{ {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 } },	// C#
+		{ {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 } },	// D
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 } },	// D#
+		{ {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 } },	// E
+		{ {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 } },	// F
+		{ {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 } },	// F#
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 } },	// G
+		{ {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 } },	// G#
+		{ {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 } },	// A
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 } },	// A#
+		{ {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 } },	// B
+	},
+	// Natural Minor
+	{
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 } },	// C
+		{ {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 } },	// C#
+		{ {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 } },	// D
+		{ {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 } },	// D#
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 } },	// E
+		{ {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 } },	// F
+		{ {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 } },	// F#
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 } },	// G
+		{ {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 } },	// G#
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 } },	// A
+		{ {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 } },	// A#
+		{ {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 } },	// B
+	},
+	// Melodic Minor
+	{
+		{ {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 } },	// C
+		{ {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 } },	// C#
+		{ {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 } },	// D
+		{ {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 } },	// D#
+		{ {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 } },	// E
+		{ {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 } },	// F
+		{ {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 } },	// F#
+		{ {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 } },	// G
+		{ {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 } },	// G#
+		{ {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 } },	// A
+		{ {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 } },	// A#
+		{ {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 } },	// B
+	},
+	// Harmonic Minor
+	{
+		{ {  3,  7, 11 }, {  2,  6, 10 }, {  3,  6, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  4,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6,  9 } },	// C
+		{ {  3,  6,  9 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  6, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  4,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 } },	// C#
+		{ {  2,  5,  9 }, {  3,  6,  9 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  6, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  4,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 } },	// D
+		{ {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6,  9 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  6, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  4,  7, 10 }, {  4,  7, 11 } },	// D#
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6,  9 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  6, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  4,  7, 10 } },	// E
+		{ {  4,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6,  9 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  6, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  3,  7, 10 }, {  2,  6,  9 } },	// F
+		{ {  2,  6,  9 }, {  4,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6,  9 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  6, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  3,  7, 10 } },	// F#
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  4,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6,  9 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  6, 10 }, {  4,  8, 11 }, {  3,  7, 10 } },	// G
+		{ {  3,  7, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  4,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6,  9 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  6, 10 }, {  4,  8, 11 } },	// G#
+		{ {  4,  8, 11 }, {  3,  7, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  4,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6,  9 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  6, 10 } },	// A
+		{ {  3,  6, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  4,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6,  9 }, {  3,  7, 11 }, {  2,  6, 10 } },	// A#
+		{ {  2,  6, 10 }, {  3,  6, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  4,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6,  9 }, {  3,  7, 11 } },	// B
+	},
+	// Dorian
+	{
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 } },	// C
+		{ {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 } },	// C#
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 } },	// D
+		{ {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 } },	// D#
+		{ {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 } },	// E
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 } },	// F
+		{ {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 } },	// F#
+		{ {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 } },	// G
+		{ {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 } },	// G#
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 } },	// A
+		{ {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 } },	// A#
+		{ {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 } },	// B
+	},
+	// Mixolydian
+	{
+		{ {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 } },	// C
+		{ {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 } },	// C#
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 } },	// D
+		{ {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 } },	// D#
+		{ {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 } },	// E
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 } },	// F
+		{ {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 } },	// F#
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 } },	// G
+		{ {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 } },	// G#
+		{ {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 } },	// A
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 } },	// A#
+		{ {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 } },	// B
+	},
+	// Lydian
+	{
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 } },	// C
+		{ {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 } },	// C#
+		{ {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 } },	// D
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 } },	// D#
+		{ {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 } },	// E
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 } },	// F
+		{ {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 } },	// F#
+		{ {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 } },	// G
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 } },	// G#
+		{ {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 } },	// A
+		{ {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 } },	// A#
+		{ {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 } },	// B
+	},
+	// Lydian Dominant
+	{
+		{ {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 } },	// C
+		{ {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 } },	// C#
+		{ {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 } },	// D
+		{ {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 } },	// D#
+		{ {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 } },	// E
+		{ {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 } },	// F
+		{ {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 } },	// F#
+		{ {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 } },	// G
+		{ {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 } },	// G#
+		{ {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 } },	// A
+		{ {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 } },	// A#
+		{ {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 } },	// B
+	},
+	// Lydian Augmented
+	{
+		{ {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 } },	// C
+		{ {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 } },	// C#
+		{ {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 } },	// D
+		{ {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 } },	// D#
+		{ {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 } },	// E
+		{ {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 } },	// F
+		{ {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 } },	// F#
+		{ {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 } },	// G
+		{ {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 } },	// G#
+		{ {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 } },	// A
+		{ {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 } },	// A#
+		{ {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 } },	// B
+	},
+	// Lydian Diminished
+	{
+		{ {  3,  7, 11 }, {  2,  6, 10 }, {  4,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6,  9 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  7, 10 } },	// C
+		{ {  3,  7, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  4,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6,  9 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  6, 10 }, {  2,  5,  9 } },	// C#
+		{ {  2,  5,  9 }, {  3,  7, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  4,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6,  9 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  6, 10 } },	// D
+		{ {  3,  6, 10 }, {  2,  5,  9 }, {  3,  7, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  4,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6,  9 }, {  4,  7, 11 }, {  3,  6, 10 } },	// D#
+		{ {  3,  6, 10 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  7, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  4,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6,  9 }, {  4,  7, 11 } },	// E
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  7, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  4,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6,  9 } },	// F
+		{ {  3,  6,  9 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  7, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  4,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  2,  6,  9 } },	// F#
+		{ {  2,  6,  9 }, {  3,  6,  9 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  7, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  4,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 } },	// G
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6,  9 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  7, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  4,  7, 10 }, {  4,  8, 11 } },	// G#
+		{ {  4,  8, 11 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6,  9 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  7, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  4,  7, 10 } },	// A
+		{ {  4,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6,  9 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  7, 10 }, {  3,  7, 11 }, {  2,  6, 10 } },	// A#
+		{ {  2,  6, 10 }, {  4,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6,  9 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  7, 10 }, {  3,  7, 11 } },	// B
+	},
+	// Phrygian
+	{
+		{ {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 } },	// C
+		{ {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 } },	// C#
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 } },	// D
+		{ {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 } },	// D#
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 } },	// E
+		{ {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 } },	// F
+		{ {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 } },	// F#
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 } },	// G
+		{ {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 } },	// G#
+		{ {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 } },	// A
+		{ {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 } },	// A#
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 } },	// B
+	},
+	// Locrian
+	{
+		{ {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 } },	// C
+		{ {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 } },	// C#
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 } },	// D
+		{ {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 } },	// D#
+		{ {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 } },	// E
+		{ {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 } },	// F
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 } },	// F#
+		{ {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 } },	// G
+		{ {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 } },	// G#
+		{ {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 }, {  3,  6, 10 } },	// A
+		{ {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 }, {  4,  7, 11 } },	// A#
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  7, 10 }, {  4,  7, 11 }, {  3,  6, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  7, 10 }, {  2,  6,  9 }, {  3,  6, 10 } },	// B
+	},
+	// Super Locrian
+	{
+		{ {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 } },	// C
+		{ {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 } },	// C#
+		{ {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 } },	// D
+		{ {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 } },	// D#
+		{ {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 } },	// E
+		{ {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 } },	// F
+		{ {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 } },	// F#
+		{ {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 } },	// G
+		{ {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 } },	// G#
+		{ {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 }, {  2,  6, 10 } },	// A
+		{ {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 }, {  3,  7, 11 } },	// A#
+		{ {  3,  7, 11 }, {  2,  6, 10 }, {  3,  7, 10 }, {  4,  8, 11 }, {  3,  7, 10 }, {  4,  7, 10 }, {  3,  6,  9 }, {  4,  7, 10 }, {  3,  6,  9 }, {  3,  6, 10 }, {  2,  5,  9 }, {  3,  6, 10 } },	// B
+	},
+	// Persian
+	{
+		{ {  4,  6, 11 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  2,  7,  9 }, {  3,  7, 11 }, {  5,  7, 11 }, {  4,  6, 10 }, {  4,  8, 10 }, {  3,  7,  9 }, {  2,  6,  8 }, {  2,  6,  9 } },	// C
+		{ {  2,  6,  9 }, {  4,  6, 11 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  2,  7,  9 }, {  3,  7, 11 }, {  5,  7, 11 }, {  4,  6, 10 }, {  4,  8, 10 }, {  3,  7,  9 }, {  2,  6,  8 } },	// C#
+		{ {  2,  6,  8 }, {  2,  6,  9 }, {  4,  6, 11 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  2,  7,  9 }, {  3,  7, 11 }, {  5,  7, 11 }, {  4,  6, 10 }, {  4,  8, 10 }, {  3,  7,  9 } },	// D
+		{ {  3,  7,  9 }, {  2,  6,  8 }, {  2,  6,  9 }, {  4,  6, 11 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  2,  7,  9 }, {  3,  7, 11 }, {  5,  7, 11 }, {  4,  6, 10 }, {  4,  8, 10 } },	// D#
+		{ {  4,  8, 10 }, {  3,  7,  9 }, {  2,  6,  8 }, {  2,  6,  9 }, {  4,  6, 11 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  2,  7,  9 }, {  3,  7, 11 }, {  5,  7, 11 }, {  4,  6, 10 } },	// E
+		{ {  4,  6, 10 }, {  4,  8, 10 }, {  3,  7,  9 }, {  2,  6,  8 }, {  2,  6,  9 }, {  4,  6, 11 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  2,  7,  9 }, {  3,  7, 11 }, {  5,  7, 11 } },	// F
+		{ {  5,  7, 11 }, {  4,  6, 10 }, {  4,  8, 10 }, {  3,  7,  9 }, {  2,  6,  8 }, {  2,  6,  9 }, {  4,  6, 11 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  2,  7,  9 }, {  3,  7, 11 } },	// F#
+		{ {  3,  7, 11 }, {  5,  7, 11 }, {  4,  6, 10 }, {  4,  8, 10 }, {  3,  7,  9 }, {  2,  6,  8 }, {  2,  6,  9 }, {  4,  6, 11 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  2,  7,  9 } },	// G
+		{ {  2,  7,  9 }, {  3,  7, 11 }, {  5,  7, 11 }, {  4,  6, 10 }, {  4,  8, 10 }, {  3,  7,  9 }, {  2,  6,  8 }, {  2,  6,  9 }, {  4,  6, 11 }, {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 } },	// G#
+		{ {  2,  5,  9 }, {  2,  7,  9 }, {  3,  7, 11 }, {  5,  7, 11 }, {  4,  6, 10 }, {  4,  8, 10 }, {  3,  7,  9 }, {  2,  6,  8 }, {  2,  6,  9 }, {  4,  6, 11 }, {  4,  7, 11 }, {  3,  6, 10 } },	// A
+		{ {  3,  6, 10 }, {  2,  5,  9 }, {  2,  7,  9 }, {  3,  7, 11 }, {  5,  7, 11 }, {  4,  6, 10 }, {  4,  8, 10 }, {  3,  7,  9 }, {  2,  6,  8 }, {  2,  6,  9 }, {  4,  6, 11 }, {  4,  7, 11 } },	// A#
+		{ {  4,  7, 11 }, {  3,  6, 10 }, {  2,  5,  9 }, {  2,  7,  9 }, {  3,  7, 11 }, {  5,  7, 11 }, {  4,  6, 10 }, {  4,  8, 10 }, {  3,  7,  9 }, {  2,  6,  8 }, {  2,  6,  9 }, {  4,  6, 11 } },	// B
+	},
+	// Major Pentatonic
+	{
+		{ {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 } },	// C
+		{ {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 } },	// C#
+		{ {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 } },	// D
+		{ {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 } },	// D#
+		{ {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 } },	// E
+		{ {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 } },	// F
+		{ {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 } },	// F#
+		{ {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 } },	// G
+		{ {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 } },	// G#
+		{ {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 } },	// A
+		{ {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 } },	// A#
+		{ {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 } },	// B
+	},
+	// Minor Pentatonic
+	{
+		{ {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 } },	// C
+		{ {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 } },	// C#
+		{ {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 } },	// D
+		{ {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 } },	// D#
+		{ {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 } },	// E
+		{ {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 } },	// F
+		{ {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 } },	// F#
+		{ {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 } },	// G
+		{ {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 } },	// G#
+		{ {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 } },	// A
+		{ {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 }, {  4,  9, 14 } },	// A#
+		{ {  4,  9, 14 }, {  3,  8, 13 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5, 10, 14 }, {  4,  9, 13 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  5,  9, 14 }, {  4,  8, 13 }, {  5, 10, 15 } },	// B
+	},
+	// Iwato
+	{
+		{ {  5, 10, 13 }, {  5, 11, 16 }, {  4, 10, 15 }, {  3,  9, 14 }, {  2,  8, 13 }, {  5,  8, 13 }, {  6, 11, 16 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  3,  8, 14 }, {  2,  7, 13 } },	// C
+		{ {  2,  7, 13 }, {  5, 10, 13 }, {  5, 11, 16 }, {  4, 10, 15 }, {  3,  9, 14 }, {  2,  8, 13 }, {  5,  8, 13 }, {  6, 11, 16 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  3,  8, 14 } },	// C#
+		{ {  3,  8, 14 }, {  2,  7, 13 }, {  5, 10, 13 }, {  5, 11, 16 }, {  4, 10, 15 }, {  3,  9, 14 }, {  2,  8, 13 }, {  5,  8, 13 }, {  6, 11, 16 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 } },	// D
+		{ {  3,  8, 13 }, {  3,  8, 14 }, {  2,  7, 13 }, {  5, 10, 13 }, {  5, 11, 16 }, {  4, 10, 15 }, {  3,  9, 14 }, {  2,  8, 13 }, {  5,  8, 13 }, {  6, 11, 16 }, {  5, 10, 15 }, {  4,  9, 14 } },	// D#
+		{ {  4,  9, 14 }, {  3,  8, 13 }, {  3,  8, 14 }, {  2,  7, 13 }, {  5, 10, 13 }, {  5, 11, 16 }, {  4, 10, 15 }, {  3,  9, 14 }, {  2,  8, 13 }, {  5,  8, 13 }, {  6, 11, 16 }, {  5, 10, 15 } },	// E
+		{ {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  3,  8, 14 }, {  2,  7, 13 }, {  5, 10, 13 }, {  5, 11, 16 }, {  4, 10, 15 }, {  3,  9, 14 }, {  2,  8, 13 }, {  5,  8, 13 }, {  6, 11, 16 } },	// F
+		{ {  6, 11, 16 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  3,  8, 14 }, {  2,  7, 13 }, {  5, 10, 13 }, {  5, 11, 16 }, {  4, 10, 15 }, {  3,  9, 14 }, {  2,  8, 13 }, {  5,  8, 13 } },	// F#
+		{ {  5,  8, 13 }, {  6, 11, 16 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  3,  8, 14 }, {  2,  7, 13 }, {  5, 10, 13 }, {  5, 11, 16 }, {  4, 10, 15 }, {  3,  9, 14 }, {  2,  8, 13 } },	// G
+		{ {  2,  8, 13 }, {  5,  8, 13 }, {  6, 11, 16 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  3,  8, 14 }, {  2,  7, 13 }, {  5, 10, 13 }, {  5, 11, 16 }, {  4, 10, 15 }, {  3,  9, 14 } },	// G#
+		{ {  3,  9, 14 }, {  2,  8, 13 }, {  5,  8, 13 }, {  6, 11, 16 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  3,  8, 14 }, {  2,  7, 13 }, {  5, 10, 13 }, {  5, 11, 16 }, {  4, 10, 15 } },	// A
+		{ {  4, 10, 15 }, {  3,  9, 14 }, {  2,  8, 13 }, {  5,  8, 13 }, {  6, 11, 16 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  3,  8, 14 }, {  2,  7, 13 }, {  5, 10, 13 }, {  5, 11, 16 } },	// A#
+		{ {  5, 11, 16 }, {  4, 10, 15 }, {  3,  9, 14 }, {  2,  8, 13 }, {  5,  8, 13 }, {  6, 11, 16 }, {  5, 10, 15 }, {  4,  9, 14 }, {  3,  8, 13 }, {  3,  8, 14 }, {  2,  7, 13 }, {  5, 10, 13 } },	// B
+	},
+};
+
+#endif
@@ -0,0 +1,112 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef SCALE_INTERVALS_H
+#define SCALE_INTERVALS_H
+
+#pragma once
+
+// --------------------------------------------------------------------------------
+// Semitones above the root of every scale, in SCALES order. Shared by the scale
+// manager and tools/bmchords, which builds the chord tables from them.
+// --------------------------------------------------------------------------------
+static const int arrChromaticScale[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+static const int arrMajorScale[] = { 0,2,4,5,7,9,11 };
+static const int arrNaturalMinorScale[] = { 0,2,3,5,7,8,10 };
+static const int arrMelodicMinorScale[] = { 0,2,3,5,7,9,11 };
+static const int arrHarmonicMinorScale[] = { 0,2,3,5,7,8,11 };
+
+static const int arrDorianMode[] = { 0,2,3,5,7,9,10 };
+static const int arrMixolydianMode[] = { 0,2,4,5,7,9,10 };
+static const int arrLydianMode[] = { 0,2,4,6,7,9,11 };
+
+static const int arrLydianDominant[] = { 0,2,4,6,7,9,10 };
+static const int arrLydianAugmented[] = { 0,2,4,6,8,9,11 };
+static const int arrLydianDiminished[] = { 0,2,3,6,7,9,11 };
+
+static const int arrPhrygianMode[] = { 0,1,3,5,7,8,10 };
+static const int arrLocrianMode[] = { 0,1,3,5,6,8,10 };
+static const int arrSuperLocrianMode[] = { 0,1,3,4,6,8,10 };
+
+static const int arrPersianScale[] = { 0,1,4,5,6,8,11 };
+
+static const int arrMajorPentatonicScale[] = { 0,2,4,7,9 };
+static const int arrMinorPentatonicScale[] = { 0,3,5,7,10 };
+static const int arrIwatoScale[] = { 0,1,5,6,10 };
+
+
+// --------------------------------------------------------------------------------
+static const int* const pScales[] =
+{
+	arrChromaticScale,
+
+	arrMajorScale,
+	arrNaturalMinorScale,
+	arrMelodicMinorScale,
+	arrHarmonicMinorScale,
+
+	arrDorianMode,
+	arrMixolydianMode,
+	arrLydianMode,
+
+	arrLydianDominant,
+	arrLydianAugmented,
+	arrLydianDiminished,
+
+	arrPhrygianMode,
+	arrLocrianMode,
+	arrSuperLocrianMode,
+
+	arrPersianScale,
+
+	arrMajorPentatonicScale,
+	arrMinorPentatonicScale,
+	arrIwatoScale
+
+};
+
+
+// --------------------------------------------------------------------------------
+static const int nScalePitchCount[] =
+{
+	12,
+
+	7,
+	7,
+	7,
+	7,
+
+	7,
+	7,
+	7,
+	7,
+	7,
+	7,
+
+	7,
+	7,
+	7,
+
+	7,
+
+	5,
+	5,
+	5
+};
+
+#endif
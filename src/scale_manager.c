@@ -17,35 +17,13 @@ PERFORMANCE OF THIS SOFTWARE.
 */
 
 #include "scale_manager.h"
+#include "scale_intervals.h"
+#include "scale_chords.h"
 
 // --------------------------------------------------------------------------------
 
 void* Engine_MemAlloc(int nSize);
 
-static int arrChromaticScale[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
-static int arrMajorScale[] = { 0,2,4,5,7,9,11 };
-static int arrNaturalMinorScale[] = { 0,2,3,5,7,8,10 };
-static int arrMelodicMinorScale[] = { 0,2,3,5,7,9,11 };
-static int arrHarmonicMinorScale[] = { 0,2,3,5,7,8,11 };
-
-static int arrDorianMode[] = { 0,2,3,5,7,9,10 };
-static int arrMixolydianMode[] = { 0,2,4,5,7,9,10 };
-static int arrLydianMode[] = { 0,2,4,6,7,9,11 };
-
-static int arrLydianDominant[] = { 0,2,4,6,7,9,10 };
-static int arrLydianAugmented[] = { 0,2,4,6,8,9,11 };
-static int arrLydianDiminished[] = { 0,2,3,6,7,9,11 };
-
-static int arrPhrygianMode[] = { 0,1,3,5,7,8,10 };
-static int arrLocrianMode[] = { 0,1,3,5,6,8,10 };
-static int arrSuperLocrianMode[] = { 0,1,3,4,6,8,10 };
-
-static int arrPersianScale[] = { 0,1,4,5,6,8,11 };
-
-static int arrMajorPentatonicScale[] = { 0,2,4,7,9 };
-static int arrMinorPentatonicScale[] = { 0,3,5,7,10 };
-static int arrIwatoScale[] = { 0,1,5,6,10 };
-
 // --------------------------------------------------------------------------------
 static char* szScaleNames[] =
 {
@@ -123,126 +101,86 @@ static char* szPitchNames[] =
 
 
 // --------------------------------------------------------------------------------
-static int* pScales[] =
+int GetNoteCountForScale(int nScaleIndex)
 {
-	arrChromaticScale,
-
-	arrMajorScale,
-	arrNaturalMinorScale,
-	arrMelodicMinorScale,
-	arrHarmonicMinorScale,
-
-	arrDorianMode,
-	arrMixolydianMode,
-	arrLydianMode,
-
-	arrLydianDominant,
-	arrLydianAugmented,
-	arrLydianDiminished,
-
-	arrPhrygianMode,
-	arrLocrianMode,
-	arrSuperLocrianMode,
-
-	arrPersianScale,
+	if (nScaleIndex < SCALE_COUNT)
+	{
+		return nScalePitchCount[nScaleIndex];
+	}
 
-	arrMajorPentatonicScale,
-	arrMinorPentatonicScale,
-	arrIwatoScale
+	return 0;
 
-};
+}
 
 
 // --------------------------------------------------------------------------------
-static int nScalePitchCount[] =
+void SetupScale(ScaleManager* pScaleManager, int nScaleIndex, int nFirstPitch)
 {
-	12,
-
-	7,
-	7,
-	7,
-	7,
-
-	7,
-	7,
-	7,
-	7,
-	7,
-	7,
-
-	7,
-	7,
-	7,
+	pScaleManager->pChordTable = nScaleChordTable[nScaleIndex][nFirstPitch];
 
-	7,
+	pScaleManager->nCurrentScale = nScaleIndex;
+	pScaleManager->nNoteIndex = nFirstPitch;
+	pScaleManager->nCurrentScalePitchCount = nScalePitchCount[nScaleIndex];
 
-	5,
-	5,
-	5
-};
+}
 
 
 // --------------------------------------------------------------------------------
-static ScaleManager* pScaleManagerCopy = NULL;
-
-
+// Writes the pitches of the chord built on nPitch in the current scale, lowest
+// first, and returns how many there are. Inversion n puts the nth tone in the
+// bass, the root position is the first. A chord reaching above SCALE_NOTE_MAX is
+// taken down by whole octaves, so it keeps its voicing. The chromatic scale has no
+// chords and gives back the pitch alone.
 // --------------------------------------------------------------------------------
-int GetNoteCountForScale(int nScaleIndex)
+int ScaleManagerGetChord(ScaleManager* pScaleManager, int nPitch, int nChordType, int nInversion, int* pPitches)
 {
-	if (nScaleIndex < SCALE_COUNT)
-	{
-		return nScalePitchCount[nScaleIndex];
-	}
-
-	return 0;
+	pPitches[0] = nPitch;
 
-}
+	if (pScaleManager->nCurrentScale == SCALE_CHROMATIC || nPitch < 0 || nPitch >= SCALE_BUFFER_SIZE)
+		return 1;
 
+	const uint8_t* pTones = pScaleManager->pChordTable[nPitch % SCALE_SEMITONE_COUNT];
+	int nCount = nChordType == SCALE_CHORD_SEVENTH ? 4 : 3;
 
-// --------------------------------------------------------------------------------
-void SetupScale(ScaleManager* pScaleManager, int nScaleIndex, int nFirstPitch)
-{
-	
-	for (int i = 0; i < SCALE_BUFFER_SIZE; i++)
-	{
-		pScaleManager->nPitchToIndexTable[i] = 0;
-		pScaleManager->nCurrentPitchTable[i] = 0;
-	}
+	if (nInversion < 0)
+		nInversion = 0;
+	else if (nInversion > nCount - 1)
+		nInversion = nCount - 1;
 
-	int* pScaleInfo = pScales[nScaleIndex];
-	int nPitchCount = nScalePitchCount[nScaleIndex];
+	// tone nInversion in the bass, within an octave of the root, and every other tone
+	// the octave or two above it that keeps it over the bass
+	int nBass = nPitch + (nInversion ? pTones[nInversion - 1] : 0);
+	if (nBass - nPitch >= SCALE_SEMITONE_COUNT)
+		nBass -= SCALE_SEMITONE_COUNT;
 
-	int nCurrentPitchFirst = SCALE_NOTE_MIN + nFirstPitch;
+	pPitches[0] = nBass;
 
-	int nPitchIndexInScale = 1;						// lets start from 1
-	while (nCurrentPitchFirst <= SCALE_NOTE_MAX)
+	for (int i = 1; i < nCount; i++)
 	{
-		for (int i = 0; i < nPitchCount; i++)
-		{
-			int nIndex = nCurrentPitchFirst + pScaleInfo[i];		// indexes of notes from a scale
-			if (nIndex <= SCALE_NOTE_MAX)
-			{
-				pScaleManager->nPitchToIndexTable[nIndex] = nPitchIndexInScale;
-				pScaleManager->nCurrentPitchTable[nPitchIndexInScale] = nIndex;
-
-				nPitchIndexInScale++;
-				
-			}
-		}
+		int nTone = (i + nInversion) % nCount;
+		int nTonePitch = nPitch + (nTone ? pTones[nTone - 1] : 0);
 
-		nCurrentPitchFirst += SCALE_SEMITONE_COUNT;
-	}
+		while (nTonePitch < nBass)
+			nTonePitch += SCALE_SEMITONE_COUNT;
 
-	pScaleManager->nMaxIndex = nPitchIndexInScale - 1;
+		// lowest first
+		int j = i;
+		for (; j > 1 && pPitches[j - 1] > nTonePitch; j--)
+			pPitches[j] = pPitches[j - 1];
 
-	pScaleManager->nDefaultPitchIndex = nPitchCount * 3 + 1;
+		pPitches[j] = nTonePitch;
+	}
 
+	int nTop = pPitches[nCount - 1];
 
-	pScaleManager->nCurrentScale = nScaleIndex;
-	pScaleManager->nNoteIndex = nFirstPitch;
-	pScaleManager->nCurrentScalePitchCount = nPitchCount;
+	int nShift = 0;
+	while (nTop - nShift > SCALE_NOTE_MAX)
+		nShift += SCALE_SEMITONE_COUNT;
 
+	for (int i = 0; i < nCount; i++)
+		pPitches[i] -= nShift;
 
+	return nCount;
 }
 
 
@@ -251,7 +189,16 @@ ScaleManager* ScaleManagerCreate()
 {
 	int nMemSize = sizeof(ScaleManager);
 	ScaleManager* pScaleManager = Engine_MemAlloc(nMemSize);
-	
+
+	ScaleManagerInit(pScaleManager);
+
+	return pScaleManager;
+}
+
+
+// --------------------------------------------------------------------------------
+void ScaleManagerInit(ScaleManager* pScaleManager)
+{
 	pScaleManager->nCurrentScale = 0;
 	pScaleManager->nCurrentScalePitchCount = 0;
 
@@ -269,31 +216,8 @@ ScaleManager* ScaleManagerCreate()
 		pScaleManager->bSharp[i] = bSharp[i];
 	}
 
-	for (int n = 0; n < SCALE_NOTE_MIN; n++)
-	{
-
-		pScaleManager->nOctave[n] = 0;
-
-	}
-
-	int nOctave = 1;
-	for (int n = SCALE_NOTE_MIN; n < SCALE_NOTE_MAX;)
-	{
-		for (int i = 0; i < SCALE_SEMITONE_COUNT; i++)
-		{
-			pScaleManager->nOctave[n] = nOctave;
-
-			n++;
-		}
-
-		nOctave++;
-	}
-
 	SetupScale(pScaleManager, SCALE_MAJOR, NOTE_C);
 
-	pScaleManagerCopy = pScaleManager;
-
-	return pScaleManager;
 }
 
 
@@ -341,20 +265,20 @@ int GetPitchCount()
 
 
 // --------------------------------------------------------------------------------
-const char* GetCurrentScaleName()
+const char* GetCurrentScaleName(ScaleManager* pScaleManager)
 {
-	if (pScaleManagerCopy)
-		return szScaleNames[pScaleManagerCopy->nCurrentScale];
+	if (pScaleManager)
+		return szScaleNames[pScaleManager->nCurrentScale];
 	else
 		return "";
 }
 
 
 // --------------------------------------------------------------------------------
-const char* GetCurrentBaseNoteName()
+const char* GetCurrentBaseNoteName(ScaleManager* pScaleManager)
 {
-	if (pScaleManagerCopy)
-		return szPitchNames[pScaleManagerCopy->nNoteIndex];
+	if (pScaleManager)
+		return szPitchNames[pScaleManager->nNoteIndex];
 	else
 		return "";
 
@@ -90,19 +90,32 @@ typedef enum
 	SCALE_NOTE_MIN = 24,	// C1
 	SCALE_NOTE_MAX = 119,
 
-	SCALE_BUFFER_SIZE = 128
+	SCALE_BUFFER_SIZE = 128,
+
+	SCALE_CHORD_TONES = 3,		// third, fifth and seventh
+	SCALE_CHORD_MAX_NOTES = 4
 
 } SCALE_CONSTS;
 
 
 // --------------------------------------------------------------------------------
-typedef struct
+typedef enum
 {
-	int nOctave[SCALE_BUFFER_SIZE];
+	SCALE_CHORD_TRIAD,
+	SCALE_CHORD_SEVENTH,
+	SCALE_CHORD_TYPE_COUNT
 
-	int nPitchToIndexTable[SCALE_BUFFER_SIZE];
+} SCALE_CHORD_TYPES;
 
-	int nCurrentPitchTable[SCALE_BUFFER_SIZE];
+
+// --------------------------------------------------------------------------------
+// The chord tables are built by tools/bmchords for every scale and root, so a
+// scale change only moves pChordTable.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	// semitones from a pitch up to its chord tones, indexed by pitch % 12
+	const uint8_t (*pChordTable)[SCALE_CHORD_TONES];
 
 	int nCurrentScale;
 	int nNoteIndex;
@@ -111,14 +124,12 @@ typedef struct
 	int cNoteChar[SCALE_SEMITONE_COUNT];
 	int bSharp[SCALE_SEMITONE_COUNT];
 
-	int nMaxIndex;
-	int nDefaultPitchIndex;
-
 } ScaleManager;
 
 
 // --------------------------------------------------------------------------------
 ScaleManager* ScaleManagerCreate();
+void ScaleManagerInit(ScaleManager* pScaleManager);
 void ScaleManagerDestroy(ScaleManager* pScaleManager);
 void SetupScale(ScaleManager* pScaleManager, int nScaleIndex, int nFirstPitch);
 
@@ -128,11 +139,13 @@ int GetScaleCount();
 char** GetPitchNameArray();
 int GetPitchCount();
 
-const char* GetCurrentScaleName();
-const char* GetCurrentBaseNoteName();
+const char* GetCurrentScaleName(ScaleManager* pScaleManager);
+const char* GetCurrentBaseNoteName(ScaleManager* pScaleManager);
 
 void SetupScaleWithString(ScaleManager* pScaleManager, const char* szScale, const char * szBaseNote);
 
 int GetNoteCountForScale(int nScaleIndex);
 
+int ScaleManagerGetChord(ScaleManager* pScaleManager, int nPitch, int nChordType, int nInversion, int* pPitches);
+
 #endif
@@ -0,0 +1,377 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// bmbench - host timings of the player's beat loading and .bmf decoding.
+//
+// Runs the player code on the same host PlaydateAPI as bmcheck and times what the
+// device benchmarks of beat_benchmark.c time on the Playdate, so a change can be
+// measured before it goes to the device. Every benchmark prints one line. "make
+// bench" in tools compiles the beats, generates the stress beat and runs them.
+//
+//	bmbench [-d data dir]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pd_api.h"
+#include "beat_machine.h"
+#include "beat_keys.h"
+#include "host_json.h"
+#include "host_sound.h"
+#include "host_system.h"
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	BMBENCH_REPEAT_COUNT = 20
+
+} BMBENCH_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+static PlaydateAPI api;
+static PlaydateAPI* pd = &api;
+
+
+// --------------------------------------------------------------------------------
+static int BenchFileExists(const char* szName)
+{
+	char szPath[256];
+	snprintf(szPath, sizeof(szPath), "beats/%s", szName);
+
+	FileStat stat;
+	return pd->file->stat(szPath, &stat) == 0;
+}
+
+
+// --------------------------------------------------------------------------------
+// Loads the beat BMBENCH_REPEAT_COUNT times into a new machine each and prints the
+// time per load and the peak of Engine_MemAlloc's bytes during a load. The .bmf
+// goes through pd->json or the scanner as bUseScanner says, the .bmb ignores it.
+// --------------------------------------------------------------------------------
+static void BenchLoad(const char* szLabel, const char* szName, int bUseScanner)
+{
+	if (!BenchFileExists(szName))
+	{
+		printf("load %s %s: beats/%s not found, skipped\n", szName, szLabel, szName);
+		return;
+	}
+
+	BeatMachineMemStats* pMemStats = BeatMachineGetMemStats();
+
+	int bCompiled = strstr(szName, ".bmb") != NULL;
+	float fTotalTime = 0.0f;
+	float fBestTime = 0.0f;
+	int nPeakBytes = 0;
+
+	for (int i = 0; i < BMBENCH_REPEAT_COUNT; i++)
+	{
+		BeatMachine* pBeatMachine = BeatMachineCreate(pd);
+		pBeatMachine->bUseScanner = bUseScanner;
+
+		int nBaseBytes = pMemStats->nLiveBytes;
+		pMemStats->nPeakBytes = nBaseBytes;
+
+		pd->system->resetElapsedTime();
+		int nResult = bCompiled ? BeatMachineLoadCompiledBeat(pBeatMachine, szName) : BeatMachineLoadBeat(pBeatMachine, szName);
+		float fTime = pd->system->getElapsedTime();
+
+		if (nResult != 0)
+		{
+			printf("load %s %s: FAILED\n", szName, szLabel);
+			BeatMachineDestroy(pBeatMachine);
+			return;
+		}
+
+		fTotalTime += fTime;
+		if (i == 0 || fTime < fBestTime)
+			fBestTime = fTime;
+
+		if (pMemStats->nPeakBytes - nBaseBytes > nPeakBytes)
+			nPeakBytes = pMemStats->nPeakBytes - nBaseBytes;
+
+		BeatMachineDestroy(pBeatMachine);
+	}
+
+	printf("load %s %s: %.3f ms per load, best %.3f ms, peak heap %d bytes\n", szName, szLabel, fTotalTime * 1000.0f / BMBENCH_REPEAT_COUNT, fBestTime * 1000.0f, nPeakBytes);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BenchBeatFormats(const char* szBeat)
+{
+	char szJson[64];
+	char szCompiled[64];
+
+	snprintf(szJson, sizeof(szJson), "%s.bmf", szBeat);
+	snprintf(szCompiled, sizeof(szCompiled), "%s.bmb", szBeat);
+
+	// the peak heap only counts the player's own allocations, the strings host_json
+	// hands to the callbacks are plain malloc and don't show up in it
+	BenchLoad("pd->json", szJson, FALSE);
+	BenchLoad("scanner", szJson, TRUE);
+	BenchLoad("compiled", szCompiled, FALSE);
+}
+
+
+// --------------------------------------------------------------------------------
+// the strcmp chains the decoder used before, note keys first as that was their best case
+static const char* szKeyChain[] =
+{
+	"step", "pitch", "len", "vel",
+	"id", "name", "vol", "pan", "color", "sample", "type", "mute", "chord",
+	"beat", "tracks", "env", "loop", "filter", "lpf", "delay", "bitcrush", "notes", "labels", "scale", "options",
+	"ver", "BPM", "a", "d", "s", "r", "base", "freq", "resn", "mix", "feedback", "amount"
+};
+
+static int nBenchKeyMode = 0;
+static int nBenchKeySum = 0;
+static int nBenchKeyCount = 0;
+
+
+// --------------------------------------------------------------------------------
+static void BenchResolveKey(const char* szKey)
+{
+	nBenchKeyCount++;
+
+	if (nBenchKeyMode == 1)
+	{
+		for (int i = 0; i < (int)(sizeof(szKeyChain) / sizeof(szKeyChain[0])); i++)
+		{
+			if (strcmp(szKeyChain[i], szKey) == 0)
+			{
+				nBenchKeySum += i;
+				break;
+			}
+		}
+	}
+	else if (nBenchKeyMode == 2)
+	{
+		nBenchKeySum += BeatKeyLookup(szKey);
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void BenchWillDecodeSublist(json_decoder* decoder, const char* name, json_value_type type)
+{
+	BenchResolveKey(name);
+}
+
+
+// --------------------------------------------------------------------------------
+static void BenchDidDecodeTableValue(json_decoder* decoder, const char* key, json_value value)
+{
+	BenchResolveKey(key);
+}
+
+
+// --------------------------------------------------------------------------------
+static void* BenchDidDecodeSublist(json_decoder* decoder, const char* name, json_value_type type)
+{
+	BenchResolveKey(name);
+	return NULL;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BenchKeyDispatch(const char* szName)
+{
+	if (!BenchFileExists(szName))
+		return;
+
+	char szPath[256];
+	snprintf(szPath, sizeof(szPath), "beats/%s", szName);
+
+	FileStat stat;
+	pd->file->stat(szPath, &stat);
+
+	char* pText = pd->system->realloc(NULL, stat.size + 1);
+	SDFile* file = pd->file->open(szPath, kFileRead | kFileReadData);
+	int nRead = file ? pd->file->read(file, pText, stat.size) : 0;
+	if (file)
+		pd->file->close(file);
+
+	if (nRead != (int)stat.size)
+	{
+		pd->system->realloc(pText, 0);
+		return;
+	}
+
+	pText[stat.size] = '\0';
+
+	json_decoder decoder =
+	{
+		.willDecodeSublist = BenchWillDecodeSublist,
+		.didDecodeTableValue = BenchDidDecodeTableValue,
+		.didDecodeSublist = BenchDidDecodeSublist
+	};
+
+	// mode 0 only counts keys, so the time of pd->json itself can be taken off the other two
+	float fTime[3] = { 0.0f, 0.0f, 0.0f };
+
+	// the first pass is not timed, it warms up the caches, then the modes take turns
+	for (int i = -1; i < BMBENCH_REPEAT_COUNT; i++)
+	{
+		for (int nMode = 0; nMode < 3; nMode++)
+		{
+			nBenchKeyMode = nMode;
+			nBenchKeyCount = 0;
+
+			json_value val;
+			pd->system->resetElapsedTime();
+			pd->json->decodeString(&decoder, pText, &val);
+
+			if (i >= 0)
+				fTime[nMode] += pd->system->getElapsedTime();
+		}
+	}
+
+	pd->system->realloc(pText, 0);
+
+	float fChain = (fTime[1] - fTime[0]) * 1000.0f / BMBENCH_REPEAT_COUNT;
+	float fHash = (fTime[2] - fTime[0]) * 1000.0f / BMBENCH_REPEAT_COUNT;
+
+	printf("keys %s: %d keys, json %.3f ms, strcmp chain +%.3f ms, hash +%.3f ms, %.1fx\n", szName, nBenchKeyCount, fTime[0] * 1000.0f / BMBENCH_REPEAT_COUNT, fChain, fHash, fHash > 0.0f ? fChain / fHash : 0.0f);
+}
+
+
+// --------------------------------------------------------------------------------
+static int BenchSameBeat(BeatMachine* pFirst, BeatMachine* pSecond)
+{
+	const BeatLoadStats* pFirstStats = BeatMachineGetLoadStats(pFirst);
+	const BeatLoadStats* pSecondStats = BeatMachineGetLoadStats(pSecond);
+
+	if (pFirst->nBeatLength != pSecond->nBeatLength || pFirst->nBPM != pSecond->nBPM)
+		return FALSE;
+
+	if (pFirstStats->nNoteCount != pSecondStats->nNoteCount || pFirstStats->nEventCount != pSecondStats->nEventCount)
+		return FALSE;
+
+	for (int i = 0; i < BM_MAX_TRACK; i++)
+	{
+		BeatMachineTrack* pA = pFirst->pTracks[i];
+		BeatMachineTrack* pB = pSecond->pTracks[i];
+
+		if (strcmp(pA->szTrackName, pB->szTrackName) != 0 || pA->nSoundSource != pB->nSoundSource || pA->fVolume != pB->fVolume || pA->fPanning != pB->fPanning)
+			return FALSE;
+
+		if (pA->bIsChordTrack != pB->bIsChordTrack || pA->fAttack != pB->fAttack || pA->fDecay != pB->fDecay || pA->fSustain != pB->fSustain || pA->fRelease != pB->fRelease)
+			return FALSE;
+	}
+
+	if (pFirst->nLabelCount != pSecond->nLabelCount)
+		return FALSE;
+
+	for (int i = 0; i < pFirst->nLabelCount; i++)
+	{
+		if (pFirst->labels[i].nStep != pSecond->labels[i].nStep || strcmp(pFirst->labels[i].szText, pSecond->labels[i].szText) != 0)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+// --------------------------------------------------------------------------------
+static void BenchScanner(const char* szName)
+{
+	if (!BenchFileExists(szName))
+		return;
+
+	float fDecodeTime[2] = { 0.0f, 0.0f };
+	float fLoadTime[2] = { 0.0f, 0.0f };
+	int bSame = TRUE;
+
+	for (int i = 0; i < BMBENCH_REPEAT_COUNT; i++)
+	{
+		BeatMachine* pBeatMachines[2];
+
+		for (int bUseScanner = 0; bUseScanner < 2; bUseScanner++)
+		{
+			pBeatMachines[bUseScanner] = BeatMachineCreate(pd);
+			pBeatMachines[bUseScanner]->bUseScanner = bUseScanner;
+
+			pd->system->resetElapsedTime();
+			BeatMachineLoadBeat(pBeatMachines[bUseScanner], szName);
+			fLoadTime[bUseScanner] += pd->system->getElapsedTime();
+
+			fDecodeTime[bUseScanner] += BeatMachineGetLoadStats(pBeatMachines[bUseScanner])->fDecodeTime;
+		}
+
+		if (!BenchSameBeat(pBeatMachines[0], pBeatMachines[1]))
+			bSame = FALSE;
+
+		BeatMachineDestroy(pBeatMachines[1]);
+		BeatMachineDestroy(pBeatMachines[0]);
+	}
+
+	printf("scanner %s: decode %.3f ms pd->json, %.3f ms scanner, load %.3f ms / %.3f ms, %s\n", szName,
+		fDecodeTime[0] * 1000.0f / BMBENCH_REPEAT_COUNT, fDecodeTime[1] * 1000.0f / BMBENCH_REPEAT_COUNT,
+		fLoadTime[0] * 1000.0f / BMBENCH_REPEAT_COUNT, fLoadTime[1] * 1000.0f / BMBENCH_REPEAT_COUNT, bSame ? "same beat" : "BEATS DIFFER");
+}
+
+
+// --------------------------------------------------------------------------------
+static int Usage(void)
+{
+	fprintf(stderr, "usage: bmbench [-d data dir]\n");
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	const char* szDataPath = "../Source/";
+
+	int nArg = 1;
+	for (; nArg + 1 < argc && argv[nArg][0] == '-'; nArg += 2)
+	{
+		if (strcmp(argv[nArg], "-d") == 0)
+			szDataPath = argv[nArg + 1];
+		else
+			return Usage();
+	}
+
+	if (nArg != argc)
+		return Usage();
+
+	HostSystemInit(szDataPath);
+	HostSoundInit(HOST_DEVICE_RATE, szDataPath);
+
+	memset(&api, 0, sizeof(api));
+	api.system = HostSystemGetAPI();
+	api.file = HostFileGetAPI();
+	api.sound = HostSoundGetAPI();
+	api.json = HostJsonGetAPI();
+
+	BenchBeatFormats("demo");
+	BenchBeatFormats("stress");
+
+	BenchKeyDispatch("demo.bmf");
+	BenchKeyDispatch("stress.bmf");
+
+	BenchScanner("demo.bmf");
+	BenchScanner("stress.bmf");
+
+	return 0;
+}
@@ -0,0 +1,865 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// bmcheck - checks of the player that have to hold on every build.
+//
+// Runs the player code on the same host PlaydateAPI as bmrender and checks what
+// the device benchmarks used to only log. Every check prints one line, the exit
+// code is 1 when any of them failed. "make check" in tools generates the stress
+// beat and runs them.
+//
+//	bmcheck [-d data dir]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pd_api.h"
+#include "beat_machine.h"
+#include "beat_library.h"
+#include "host_json.h"
+#include "host_sound.h"
+#include "host_system.h"
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	CHECK_LOAD_LOOP_COUNT = 100,
+	CHECK_DELAY_RELOADS = 8,
+	CHECK_SLICE_BUDGET = 500,			// microseconds a load step may take, a quarter of the device's usual 2 ms
+	CHECK_SLICE_TRIES = 3
+
+} CHECK_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+static PlaydateAPI api;
+static PlaydateAPI* pd = &api;
+
+static int nFailedChecks = 0;
+
+
+// --------------------------------------------------------------------------------
+static void CheckResult(const char* szCheck, int bPassed, const char* szWhy)
+{
+	if (bPassed)
+	{
+		printf("%s: ok\n", szCheck);
+		return;
+	}
+
+	printf("%s: FAILED, %s\n", szCheck, szWhy);
+	nFailedChecks++;
+
+}
+
+
+// --------------------------------------------------------------------------------
+static BeatMachine* CheckLoad(const char* szCheck, BeatMachine* pBeatMachine, const char* szName)
+{
+	pBeatMachine->bUseScanner = TRUE;
+
+	if (BeatMachineLoadBeat(pBeatMachine, szName) != 0)
+	{
+		printf("%s: FAILED, can't load %s\n", szCheck, szName);
+		nFailedChecks++;
+
+		BeatMachineDestroy(pBeatMachine);
+		return NULL;
+	}
+
+	return pBeatMachine;
+}
+
+
+// --------------------------------------------------------------------------------
+// Two machines sharing one sample cache: loading, retuning and mixing the second
+// must leave every bit of the first one's state where it was.
+// --------------------------------------------------------------------------------
+static void CheckInstances(const char* szFirst, const char* szSecond)
+{
+	const char* szCheck = "instances";
+
+	BeatMachine* pFirst = CheckLoad(szCheck, BeatMachineCreate(pd), szFirst);
+	if (pFirst == NULL)
+		return;
+
+	BeatMachine* pSecond = BeatMachineCreateWithCache(pd, pFirst->pSampleCache);
+
+	int nFirstLength = pFirst->nBeatLength;
+	int nFirstBPM = pFirst->nBPM;
+	int nFirstLabels = pFirst->nLabelCount;
+	float fFirstVolume = pFirst->pTracks[0] ? pFirst->pTracks[0]->fVolume : 0.0f;
+
+	char szFirstScale[64];
+	snprintf(szFirstScale, sizeof(szFirstScale), "%s", GetCurrentScaleName(pFirst->pScaleManager));
+
+	if (CheckLoad(szCheck, pSecond, szSecond) == NULL)
+	{
+		BeatMachineDestroy(pFirst);
+		return;
+	}
+
+	BeatMachineSetBPM(pSecond, nFirstBPM + 7);
+	BeatMachineSetScale(pSecond, SCALE_NATURALMINOR, NOTE_D);
+	BeatMachineSetVolume(pSecond, 0, fFirstVolume * 0.5f + 0.1f);
+
+	int bShared = pFirst->pSequence == pSecond->pSequence || pFirst->pArena == pSecond->pArena || pFirst->pScaleManager == pSecond->pScaleManager;
+	for (int i = 0; i < BM_MAX_TRACK; i++)
+	{
+		if (pFirst->pTracks[i] && pFirst->pTracks[i] == pSecond->pTracks[i])
+			bShared = TRUE;
+	}
+
+	int bKept = pFirst->nBeatLength == nFirstLength && pFirst->nBPM == nFirstBPM && pFirst->nLabelCount == nFirstLabels
+		&& strcmp(GetCurrentScaleName(pFirst->pScaleManager), szFirstScale) == 0
+		&& (pFirst->pTracks[0] == NULL || pFirst->pTracks[0]->fVolume == fFirstVolume);
+
+	CheckResult(szCheck, !bShared && bKept, bShared ? "the machines share a sequence, arena, scale or track" : "the second machine changed the state of the first");
+
+	BeatMachineDestroy(pSecond);
+	BeatMachineDestroy(pFirst);
+}
+
+
+// --------------------------------------------------------------------------------
+// Every per track call with a track out of range, and on a fresh machine with a
+// track nothing has built yet, must return without touching anything. Only the
+// calls that build a voice may build the slot they're given.
+// --------------------------------------------------------------------------------
+static void CheckTrackSetters(const char* szBeat)
+{
+	const char* szCheck = "track setters";
+	const int nTracks[] = { -1, BM_MAX_TRACK, 0 };
+	const float fLevels[] = { 1.0f, 0.5f };
+
+	BeatMachine* pFresh = BeatMachineCreate(pd);
+	BeatMachine* pLoaded = CheckLoad(szCheck, BeatMachineCreate(pd), szBeat);
+	if (pLoaded == NULL)
+	{
+		BeatMachineDestroy(pFresh);
+		return;
+	}
+
+	float fVolume = pLoaded->pTracks[0]->fVolume;
+	int nNotes = BeatMachineGetTrackNotes(pLoaded, 0, NULL);
+
+	BeatMachine* pBeatMachines[] = { pFresh, pLoaded };
+	for (int nMachine = 0; nMachine < 2; nMachine++)
+	{
+		BeatMachine* pBeatMachine = pBeatMachines[nMachine];
+
+		// the loaded machine's track 0 is built, only the fresh one's is left as it was
+		int nCount = pBeatMachine == pFresh ? 3 : 2;
+		for (int i = 0; i < nCount; i++)
+		{
+			int nTrack = nTracks[i];
+			BeatFreezeCost cost;
+
+			BeatMachineSetADSR(pBeatMachine, nTrack, 0.1f, 0.1f, 0.5f, 0.1f);
+			BeatMachineSetSample(pBeatMachine, nTrack, "samples/", "kick");
+			BeatMachineSetChordTrack(pBeatMachine, nTrack, TRUE);
+			BeatMachineSetChordVoicing(pBeatMachine, nTrack, 0, 1);
+			BeatMachineSetTrackPolyphony(pBeatMachine, nTrack, 2);
+			BeatMachineSetVolume(pBeatMachine, nTrack, 0.25f);
+			BeatMachineSetPanning(pBeatMachine, nTrack, -0.5f);
+			BeatMachineMuteTrack(pBeatMachine, nTrack, TRUE);
+			BeatMachineEnableFilter(pBeatMachine, nTrack, 0, 800, 0.5f, 0.5f);
+			BeatMachineEnableDelay(pBeatMachine, nTrack, 0.5f, 0.5f);
+			BeatMachineSetDelayTime(pBeatMachine, nTrack, 3);
+			BeatMachineEnableBitCrusher(pBeatMachine, nTrack, 0.5f, 0.5f);
+			BeatMachineSetSend(pBeatMachine, nTrack, 0, 0.5f);
+			BeatMachineAddNote(pBeatMachine, nTrack, 0, 1, 60, 1.0f);
+			BeatMachineFreezeTrack(pBeatMachine, nTrack);
+			BeatMachineUnfreezeTrack(pBeatMachine, nTrack);
+			BeatMachineGetFreezeCost(pBeatMachine, nTrack, &cost);
+
+			if (nTrack == 0)
+				continue;
+
+			BeatMachineCreateSynth(pBeatMachine, nTrack, 0);
+			BeatMachineCreateSampler(pBeatMachine, nTrack);
+			BeatMachineSetHarmonics(pBeatMachine, nTrack, fLevels, 2);
+			BeatMachineSetWavetable(pBeatMachine, nTrack, "waves/", "saw");
+		}
+	}
+
+	int bFreshKept = pFresh->pTracks[0] == NULL || pFresh->pTracks[0]->pTrack == NULL;
+	int bLoadedKept = pLoaded->pTracks[0]->fVolume == fVolume && BeatMachineGetTrackNotes(pLoaded, 0, NULL) == nNotes;
+
+	CheckResult(szCheck, bFreshKept && bLoadedKept, bFreshKept ? "a call out of range changed the loaded beat" : "a setter built an unbuilt track");
+
+	BeatMachineDestroy(pLoaded);
+	BeatMachineDestroy(pFresh);
+}
+
+
+// --------------------------------------------------------------------------------
+// Delays on two sampler and two synth tracks of the beat. Each line holds its
+// track's time at BM_DELAY_MIN_BPM, one channel for a synth, and once the
+// pool has them reloading the beat or changing the tempo must not grow it.
+// --------------------------------------------------------------------------------
+static int CheckEnableDelays(BeatMachine* pBeatMachine, const int* pTracks, int nCount)
+{
+	for (int i = 0; i < nCount; i++)
+	{
+		BeatMachineEnableDelay(pBeatMachine, pTracks[i], 0.4f, 0.3f);
+		BeatMachineSetDelayTime(pBeatMachine, pTracks[i], BM_DELAY_QUARTER);
+	}
+
+	return pBeatMachine->pDelayPool ? pBeatMachine->pDelayPool->nBytes : 0;
+}
+
+
+// --------------------------------------------------------------------------------
+static void CheckDelayPool(const char* szBeat)
+{
+	const char* szCheck = "delay pool";
+	const int nTracks[] = { 2, 3, 10, 11 };
+	const int nCount = sizeof(nTracks) / sizeof(nTracks[0]);
+
+	BeatMachine* pBeatMachine = CheckLoad(szCheck, BeatMachineCreate(pd), szBeat);
+	if (pBeatMachine == NULL)
+		return;
+
+	int nBytes = CheckEnableDelays(pBeatMachine, nTracks, nCount);
+	int nQuarterFrames = BM_DELAY_QUARTER * BM_SAMPLE_RATE * 60 / (BM_DELAY_MIN_BPM * 4);
+
+	char szWhy[128] = "";
+	for (int i = 0; i < nCount && szWhy[0] == '\0'; i++)
+	{
+		const BeatMachineTrack* pTrack = pBeatMachine->pTracks[nTracks[i]];
+		int nChannels = pTrack->nSoundSource == BM_TYPE_SAMPLE ? 2 : 1;
+
+		if (pTrack->delay == NULL)
+			snprintf(szWhy, sizeof(szWhy), "track %d got no line", nTracks[i]);
+		else if (pTrack->delay->nChannels != nChannels || BeatDelayMaxFrames(pTrack->delay) < nQuarterFrames)
+			snprintf(szWhy, sizeof(szWhy), "track %d has %d channels of %d frames", nTracks[i], pTrack->delay->nChannels, BeatDelayMaxFrames(pTrack->delay));
+		else if (pTrack->delay->nCapacity > nQuarterFrames * nChannels + nChannels)
+			snprintf(szWhy, sizeof(szWhy), "track %d has %d samples for %d", nTracks[i], pTrack->delay->nCapacity, nQuarterFrames * nChannels);
+	}
+
+	for (int i = 0; i < CHECK_DELAY_RELOADS && szWhy[0] == '\0'; i++)
+	{
+		BeatMachineSetBPM(pBeatMachine, BM_DELAY_MIN_BPM + i * 20);
+
+		if (CheckLoad(szCheck, pBeatMachine, szBeat) == NULL)
+			return;
+
+		int nReloadBytes = CheckEnableDelays(pBeatMachine, nTracks, nCount);
+		if (nReloadBytes != nBytes)
+			snprintf(szWhy, sizeof(szWhy), "the pool grew from %d to %d bytes on load %d", nBytes, nReloadBytes, i + 2);
+	}
+
+	CheckResult(szCheck, szWhy[0] == '\0', szWhy);
+
+	BeatMachineDestroy(pBeatMachine);
+}
+
+
+// --------------------------------------------------------------------------------
+// Every event of every track, in any order: a rewritten step may give its events
+// back in another one.
+// --------------------------------------------------------------------------------
+static uint32_t CheckNoteSum(BeatMachine* pBeatMachine, int* pEventCount)
+{
+	uint32_t nSum = 0;
+	int nEventCount = 0;
+
+	for (int t = 0; t < BM_MAX_TRACK; t++)
+	{
+		BeatMachineTrack* pTrack = pBeatMachine->pTracks[t];
+		if (pTrack == NULL || pTrack->pTrack == NULL)
+			continue;
+
+		uint32_t nStep = 0;
+		uint32_t nLen = 0;
+		MIDINote note = 0;
+		float fVelocity = 0.0f;
+
+		for (int i = 0; pd->sound->track->getNoteAtIndex(pTrack->pTrack, i, &nStep, &nLen, &note, &fVelocity); i++)
+		{
+			uint32_t nEvent = ((uint32_t)(t + 1) << 24) ^ (nStep << 8) ^ ((uint32_t)note << 1) ^ (nLen << 20) ^ ((uint32_t)(fVelocity * 1000.0f) << 12);
+			nSum += nEvent * 2654435761u;
+			nEventCount++;
+		}
+	}
+
+	*pEventCount = nEventCount;
+
+	return nSum;
+}
+
+
+// --------------------------------------------------------------------------------
+// A transpose far enough to pin notes at 0 and 127 and its opposite, and a scale
+// change and back, must give every event back as it was. Track nChordTrack gets
+// two chords on one step that share tones, with lengths and velocities of their
+// own, so a rewrite taking the wrong one's event shows.
+// --------------------------------------------------------------------------------
+static void CheckTranspose(const char* szBeat, int nChordTrack)
+{
+	const char* szCheck = "transpose";
+
+	BeatMachine* pBeatMachine = CheckLoad(szCheck, BeatMachineCreate(pd), szBeat);
+	if (pBeatMachine == NULL)
+		return;
+
+	ScaleManager* pScaleManager = pBeatMachine->pScaleManager;
+	int nScale = pScaleManager->nCurrentScale;
+	int nRoot = pScaleManager->nNoteIndex;
+
+	BeatMachineSetChordTrack(pBeatMachine, nChordTrack, TRUE);
+	BeatMachineAddNote(pBeatMachine, nChordTrack, 8, 4, 60, 0.9f);
+	BeatMachineAddNote(pBeatMachine, nChordTrack, 8, 2, 64, 0.5f);
+
+	int nEventCount = 0;
+	uint32_t nSum = CheckNoteSum(pBeatMachine, &nEventCount);
+
+	const int nMoves[] = { 7, 60, -100 };
+	char szWhy[128] = "";
+
+	for (int i = 0; i < (int)(sizeof(nMoves) / sizeof(nMoves[0])) && szWhy[0] == '\0'; i++)
+	{
+		BeatMachineTranspose(pBeatMachine, nMoves[i]);
+		BeatMachineTranspose(pBeatMachine, -nMoves[i]);
+
+		int nEvents = 0;
+		if (CheckNoteSum(pBeatMachine, &nEvents) != nSum || nEvents != nEventCount)
+			snprintf(szWhy, sizeof(szWhy), "%+d and back gives %d events for %d, or other ones", nMoves[i], nEvents, nEventCount);
+	}
+
+	if (szWhy[0] == '\0')
+	{
+		BeatMachineSetScale(pBeatMachine, SCALE_PHRYGIAN, NOTE_E);
+		BeatMachineSetScale(pBeatMachine, nScale, nRoot);
+
+		int nEvents = 0;
+		if (CheckNoteSum(pBeatMachine, &nEvents) != nSum || nEvents != nEventCount)
+			snprintf(szWhy, sizeof(szWhy), "a scale change and back gives %d events for %d, or other ones", nEvents, nEventCount);
+	}
+
+	CheckResult(szCheck, szWhy[0] == '\0', szWhy);
+
+	BeatMachineDestroy(pBeatMachine);
+}
+
+
+// --------------------------------------------------------------------------------
+// Every chord of every scale, root and pitch, up to the top ones that reach past
+// SCALE_NOTE_MAX: lowest first and in range, the tones of the chord in root
+// position, inversion n with tone n in the bass.
+// --------------------------------------------------------------------------------
+static void CheckChords(void)
+{
+	const char* szCheck = "chords";
+	char szWhy[128] = "";
+
+	ScaleManager scaleManager;
+	ScaleManagerInit(&scaleManager);
+
+	for (int nScale = SCALE_CHROMATIC + 1; nScale < SCALE_COUNT && szWhy[0] == '\0'; nScale++)
+	{
+		for (int nRoot = 0; nRoot < NOTE_COUNT && szWhy[0] == '\0'; nRoot++)
+		{
+			SetupScale(&scaleManager, nScale, nRoot);
+
+			for (int nPitch = 0; nPitch < SCALE_BUFFER_SIZE && szWhy[0] == '\0'; nPitch++)
+			{
+				const uint8_t* pTones = scaleManager.pChordTable[nPitch % SCALE_SEMITONE_COUNT];
+
+				for (int nType = SCALE_CHORD_TRIAD; nType <= SCALE_CHORD_SEVENTH && szWhy[0] == '\0'; nType++)
+				{
+					int nCount = nType == SCALE_CHORD_SEVENTH ? 4 : 3;
+
+					int nClasses = 1 << (nPitch % SCALE_SEMITONE_COUNT);
+					for (int t = 1; t < nCount; t++)
+						nClasses |= 1 << ((nPitch + pTones[t - 1]) % SCALE_SEMITONE_COUNT);
+
+					for (int nInversion = 0; nInversion < nCount && szWhy[0] == '\0'; nInversion++)
+					{
+						int nPitches[SCALE_CHORD_MAX_NOTES];
+						int nGot = ScaleManagerGetChord(&scaleManager, nPitch, nType, nInversion, nPitches);
+
+						int nBass = (nPitch + (nInversion ? pTones[nInversion - 1] : 0)) % SCALE_SEMITONE_COUNT;
+						int nGotClasses = 0;
+						int bOrdered = nGot == nCount;
+
+						for (int i = 0; i < nGot; i++)
+						{
+							nGotClasses |= 1 << (nPitches[i] % SCALE_SEMITONE_COUNT);
+							bOrdered &= nPitches[i] >= 0 && nPitches[i] <= SCALE_NOTE_MAX && (i == 0 || nPitches[i] > nPitches[i - 1]);
+						}
+
+						if (!bOrdered || nGotClasses != nClasses || nPitches[0] % SCALE_SEMITONE_COUNT != nBass)
+						{
+							snprintf(szWhy, sizeof(szWhy), "%s on %d, %s inversion %d gives %d %d %d %d", GetCurrentScaleName(&scaleManager), nPitch,
+								nType == SCALE_CHORD_SEVENTH ? "seventh" : "triad", nInversion, nPitches[0], nPitches[1], nPitches[2], nGot > 3 ? nPitches[3] : -1);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	CheckResult(szCheck, szWhy[0] == '\0', szWhy);
+}
+
+
+// --------------------------------------------------------------------------------
+// Loads the two beats in turn on one machine. Once each has been loaded the arenas
+// hold their blocks, from then on Engine_MemAlloc's live bytes must not move, and
+// after the machine is destroyed they must be back where they were before it.
+// --------------------------------------------------------------------------------
+static void CheckLoadLoop(const char* szFirst, const char* szSecond)
+{
+	char szCheck[64];
+	snprintf(szCheck, sizeof(szCheck), "load loop %s %s", szFirst, szSecond);
+
+	BeatMachineMemStats* pMemStats = BeatMachineGetMemStats();
+
+	int nBaseBytes = pMemStats->nLiveBytes;
+	int nBaseBlocks = pMemStats->nAllocCount - pMemStats->nFreeCount;
+
+	BeatMachine* pBeatMachine = CheckLoad(szCheck, BeatMachineCreate(pd), szFirst);
+	if (pBeatMachine == NULL || CheckLoad(szCheck, pBeatMachine, szSecond) == NULL)
+		return;
+
+	int nWarmBytes = pMemStats->nLiveBytes;
+	int nMaxDrift = 0;
+
+	for (int i = 0; i < CHECK_LOAD_LOOP_COUNT; i++)
+	{
+		if (CheckLoad(szCheck, pBeatMachine, (i & 1) ? szSecond : szFirst) == NULL)
+			return;
+
+		int nDrift = abs(pMemStats->nLiveBytes - nWarmBytes);
+		if (nDrift > nMaxDrift)
+			nMaxDrift = nDrift;
+	}
+
+	BeatMachineDestroy(pBeatMachine);
+
+	int nLeakedBytes = pMemStats->nLiveBytes - nBaseBytes;
+	int nLeakedBlocks = pMemStats->nAllocCount - pMemStats->nFreeCount - nBaseBlocks;
+
+	char szWhy[128];
+	snprintf(szWhy, sizeof(szWhy), "heap drift %d bytes over %d loads, %d bytes in %d blocks left after destroy", nMaxDrift, CHECK_LOAD_LOOP_COUNT, nLeakedBytes, nLeakedBlocks);
+
+	CheckResult(szCheck, nMaxDrift == 0 && nLeakedBytes == 0 && nLeakedBlocks == 0, szWhy);
+}
+
+
+// --------------------------------------------------------------------------------
+// Runs a load without committing it. The load context still holds the beat the
+// way the decoder staged it, building the tracks only reads from there. NULL when
+// the load failed.
+// --------------------------------------------------------------------------------
+static BeatLoadContext* CheckStageBeat(BeatMachine* pBeatMachine, const char* szName, int bUseScanner)
+{
+	pBeatMachine->bUseScanner = bUseScanner;
+
+	if (BeatMachineBeginLoad(pBeatMachine, szName) != 0 || BeatMachineStepLoad(pBeatMachine, BM_LOAD_NO_BUDGET) != BM_LOAD_READY)
+		return NULL;
+
+	return pBeatMachine->pLoad;
+}
+
+
+// --------------------------------------------------------------------------------
+static int CheckCompareNotes(const void* a, const void* b)
+{
+	const BMBNote* pA = a;
+	const BMBNote* pB = b;
+
+	if (pA->nStep != pB->nStep)
+		return pA->nStep - pB->nStep;
+
+	if (pA->nPitch != pB->nPitch)
+		return pA->nPitch - pB->nPitch;
+
+	if (pA->nLen != pB->nLen)
+		return pA->nLen - pB->nLen;
+
+	return (pA->fVelocity > pB->fVelocity) - (pA->fVelocity < pB->fVelocity);
+}
+
+
+// --------------------------------------------------------------------------------
+// the notes of a track in step order, the decoders keep the file's and bmfc sorts
+// --------------------------------------------------------------------------------
+static BMBNote* CheckSortedNotes(const BeatLoadContext* pLoad, const BMBTrack* pInfo)
+{
+	BMBNote* pNotes = malloc(pInfo->nNoteCount * sizeof(BMBNote) + sizeof(BMBNote));
+
+	memcpy(pNotes, &pLoad->pNotes[pInfo->nFirstNote], pInfo->nNoteCount * sizeof(BMBNote));
+	qsort(pNotes, pInfo->nNoteCount, sizeof(BMBNote), CheckCompareNotes);
+
+	return pNotes;
+}
+
+
+// --------------------------------------------------------------------------------
+#define CHECK_FIELD(pA, pB, field)		if ((pA)->field != (pB)->field) { snprintf(szWhy, nWhySize, "%s differs%s", #field, szWhere); return FALSE; }
+#define CHECK_STRING(pA, pB, field)		if (strcmp((pA)->field, (pB)->field) != 0) { snprintf(szWhy, nWhySize, "%s differs%s", #field, szWhere); return FALSE; }
+
+
+// --------------------------------------------------------------------------------
+// Everything a decoder stages that the tracks and notes are built from, the
+// header fields only the compiled file has left out.
+// --------------------------------------------------------------------------------
+static int CheckSameStaged(const BeatLoadContext* pA, const BeatLoadContext* pB, char* szWhy, int nWhySize)
+{
+	char szWhere[32] = "";
+
+	CHECK_FIELD(pA, pB, header.nFileVersion);
+	CHECK_FIELD(pA, pB, header.nBPM);
+	CHECK_FIELD(pA, pB, header.nBeatLength);
+	CHECK_FIELD(pA, pB, header.nLabelCount);
+	CHECK_FIELD(pA, pB, header.bLoopOn);
+	CHECK_FIELD(pA, pB, header.nLoopStart);
+	CHECK_FIELD(pA, pB, header.nLoopEnd);
+	CHECK_FIELD(pA, pB, header.nNoteCount);
+	CHECK_STRING(pA, pB, header.szScale);
+	CHECK_STRING(pA, pB, header.szBaseNote);
+
+	for (int i = 0; i < pA->header.nLabelCount; i++)
+	{
+		CHECK_FIELD(pA, pB, labels[i].nStep);
+		CHECK_STRING(pA, pB, labels[i].szText);
+	}
+
+	for (int t = 0; t < BM_MAX_TRACK; t++)
+	{
+		CHECK_FIELD(pA, pB, bTrackUsed[t]);
+		if (!pA->bTrackUsed[t])
+			continue;
+
+		snprintf(szWhere, sizeof(szWhere), " on track %d", t);
+
+		const BMBTrack* pTrackA = &pA->tracks[t];
+		const BMBTrack* pTrackB = &pB->tracks[t];
+
+		CHECK_FIELD(pTrackA, pTrackB, nId);
+		CHECK_FIELD(pTrackA, pTrackB, nSoundSource);
+		CHECK_FIELD(pTrackA, pTrackB, nColour);
+		CHECK_FIELD(pTrackA, pTrackB, bMuted);
+		CHECK_FIELD(pTrackA, pTrackB, bIsChordTrack);
+		CHECK_FIELD(pTrackA, pTrackB, bHasEnvelope);
+		CHECK_FIELD(pTrackA, pTrackB, bFilterEnabled);
+		CHECK_FIELD(pTrackA, pTrackB, bDelayEnabled);
+		CHECK_FIELD(pTrackA, pTrackB, bBitCrusherEnabled);
+		CHECK_FIELD(pTrackA, pTrackB, nFilterType);
+		CHECK_FIELD(pTrackA, pTrackB, nFilterFreq);
+		CHECK_STRING(pTrackA, pTrackB, szTrackName);
+		CHECK_STRING(pTrackA, pTrackB, szSampleName);
+		CHECK_FIELD(pTrackA, pTrackB, fVolume);
+		CHECK_FIELD(pTrackA, pTrackB, fPanning);
+		CHECK_FIELD(pTrackA, pTrackB, fAttack);
+		CHECK_FIELD(pTrackA, pTrackB, fDecay);
+		CHECK_FIELD(pTrackA, pTrackB, fSustain);
+		CHECK_FIELD(pTrackA, pTrackB, fRelease);
+		CHECK_FIELD(pTrackA, pTrackB, fFilterResn);
+		CHECK_FIELD(pTrackA, pTrackB, fFilterMix);
+		CHECK_FIELD(pTrackA, pTrackB, fDelayFeedback);
+		CHECK_FIELD(pTrackA, pTrackB, fDelayMix);
+		CHECK_FIELD(pTrackA, pTrackB, fBitcrusherAmount);
+		CHECK_FIELD(pTrackA, pTrackB, fBitcrusherMix);
+		CHECK_FIELD(pTrackA, pTrackB, nNoteCount);
+
+		if (memcmp(pTrackA->nHarmonics, pTrackB->nHarmonics, BMB_HARMONIC_COUNT) != 0)
+		{
+			snprintf(szWhy, nWhySize, "nHarmonics differ%s", szWhere);
+			return FALSE;
+		}
+
+		BMBNote* pNotesA = CheckSortedNotes(pA, pTrackA);
+		BMBNote* pNotesB = CheckSortedNotes(pB, pTrackB);
+
+		int nNote = 0;
+		while (nNote < (int)pTrackA->nNoteCount && CheckCompareNotes(&pNotesA[nNote], &pNotesB[nNote]) == 0)
+			nNote++;
+
+		free(pNotesB);
+		free(pNotesA);
+
+		if (nNote < (int)pTrackA->nNoteCount)
+		{
+			snprintf(szWhy, nWhySize, "note %d differs%s", nNote, szWhere);
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+#undef CHECK_STRING
+#undef CHECK_FIELD
+
+
+// --------------------------------------------------------------------------------
+// The .bmf through pd->json is the reference, the in-place scanner and bmfc's
+// .bmb of the same beat have to stage exactly what it does.
+// --------------------------------------------------------------------------------
+static void CheckDecoders(const char* szBeat)
+{
+	char szSource[64];
+	char szCompiled[64];
+	snprintf(szSource, sizeof(szSource), "%s.bmf", szBeat);
+	snprintf(szCompiled, sizeof(szCompiled), "%s.bmb", szBeat);
+
+	const char* szNames[3] = { szSource, szSource, szCompiled };
+	const char* szChecks[3] = { "", "scanner", "bmfc" };
+
+	BeatMachine* pBeatMachines[3];
+	BeatLoadContext* pLoads[3];
+
+	for (int i = 0; i < 3; i++)
+	{
+		pBeatMachines[i] = BeatMachineCreate(pd);
+		pLoads[i] = CheckStageBeat(pBeatMachines[i], szNames[i], i == 1);
+	}
+
+	for (int i = 1; i < 3; i++)
+	{
+		char szCheck[96];
+		snprintf(szCheck, sizeof(szCheck), "decode %s %s", szBeat, szChecks[i]);
+
+		char szWhy[96];
+		snprintf(szWhy, sizeof(szWhy), "can't stage %s", pLoads[0] ? szNames[i] : "the .bmf with pd->json");
+
+		int bSame = pLoads[0] && pLoads[i] && CheckSameStaged(pLoads[0], pLoads[i], szWhy, sizeof(szWhy));
+
+		CheckResult(szCheck, bSame, szWhy);
+	}
+
+	for (int i = 0; i < 3; i++)
+		BeatMachineDestroy(pBeatMachines[i]);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// Steps a load the way a game does from its update callback, the wall time of the
+// longest step, or -1 when the load failed.
+// --------------------------------------------------------------------------------
+static double CheckSlicedLoad(BeatMachine* pBeatMachine, const char* szName, int* pSteps)
+{
+	pBeatMachine->bUseScanner = FALSE;
+
+	if (BeatMachineBeginLoad(pBeatMachine, szName) != 0)
+		return -1.0;
+
+	int nPhase = BM_LOAD_READING;
+	double fMaxStep = 0.0;
+
+	for (*pSteps = 0; nPhase != BM_LOAD_READY; (*pSteps)++)
+	{
+		double fStart = HostWallSeconds();
+		nPhase = BeatMachineStepLoad(pBeatMachine, CHECK_SLICE_BUDGET);
+		double fStep = HostWallSeconds() - fStart;
+
+		if (nPhase == BM_LOAD_FAILED)
+			return -1.0;
+
+		if (fStep > fMaxStep)
+			fMaxStep = fStep;
+	}
+
+	return fMaxStep;
+}
+
+
+// --------------------------------------------------------------------------------
+// No step of a load with a budget may run more than one unit of work past it, the
+// decode included, and the sliced load has to stage what pd->json does in one go.
+// The host is not alone on its cores, so a load only fails when every try overran.
+// --------------------------------------------------------------------------------
+static void CheckLoadSlices(const char* szBeat)
+{
+	char szName[64];
+	snprintf(szName, sizeof(szName), "%s.bmf", szBeat);
+
+	char szCheck[96];
+	snprintf(szCheck, sizeof(szCheck), "load slices %s", szName);
+
+	// the reference load also puts the samples in the cache, a sample file is read in one unit
+	BeatMachine* pReference = BeatMachineCreate(pd);
+	BeatLoadContext* pReferenceLoad = CheckStageBeat(pReference, szName, FALSE);
+
+	BeatMachine* pBeatMachine = BeatMachineCreateWithCache(pd, pReference->pSampleCache);
+
+	int nSteps = 0;
+	double fMaxStep = -1.0;
+
+	for (int i = 0; i < CHECK_SLICE_TRIES && pReferenceLoad; i++)
+	{
+		fMaxStep = CheckSlicedLoad(pBeatMachine, szName, &nSteps);
+		if (fMaxStep < 0.0 || fMaxStep <= 2.0 * CHECK_SLICE_BUDGET / 1000000.0)
+			break;
+	}
+
+	char szWhy[160];
+	snprintf(szWhy, sizeof(szWhy), "the longest of %d steps took %.0f us for a budget of %d us", nSteps, fMaxStep * 1000000.0, CHECK_SLICE_BUDGET);
+
+	int bPassed = FALSE;
+	if (pReferenceLoad == NULL || fMaxStep < 0.0)
+		snprintf(szWhy, sizeof(szWhy), "can't load %s", szName);
+	else if (fMaxStep <= 2.0 * CHECK_SLICE_BUDGET / 1000000.0)
+		bPassed = CheckSameStaged(pReferenceLoad, pBeatMachine->pLoad, szWhy, sizeof(szWhy));
+
+	CheckResult(szCheck, bPassed, szWhy);
+
+	BeatMachineDestroy(pBeatMachine);
+	BeatMachineDestroy(pReference);
+
+}
+
+
+// --------------------------------------------------------------------------------
+// The library entry of a beat has to say what loading the beat does.
+// --------------------------------------------------------------------------------
+static int CheckLibraryEntry(BeatLibrary* pLibrary, const char* szName, char* szWhy, int nWhySize)
+{
+	const BeatLibraryEntry* pEntry = BeatLibraryFind(pLibrary, szName);
+	if (pEntry == NULL)
+	{
+		snprintf(szWhy, nWhySize, "%s is not listed", szName);
+		return FALSE;
+	}
+
+	BeatMachine* pBeatMachine = BeatMachineCreate(pd);
+	int bSame = BeatMachineLoadBeat(pBeatMachine, szName) == 0;
+
+	int nLabelCount = pBeatMachine->nLabelCount < BEAT_LIBRARY_MAX_LABELS ? pBeatMachine->nLabelCount : BEAT_LIBRARY_MAX_LABELS;
+
+	bSame = bSame && pEntry->nBPM == pBeatMachine->nBPM && pEntry->nBeatLength == pBeatMachine->nBeatLength && pEntry->nLabelCount == nLabelCount;
+	for (int i = 0; bSame && i < nLabelCount; i++)
+	{
+		if (pEntry->labels[i].nStep != pBeatMachine->labels[i].nStep || strcmp(pEntry->labels[i].szText, pBeatMachine->labels[i].szText) != 0)
+			bSame = FALSE;
+	}
+
+	if (!bSame)
+		snprintf(szWhy, nWhySize, "the entry of %s is not the beat it loads", szName);
+
+	BeatMachineDestroy(pBeatMachine);
+
+	return bSame;
+}
+
+
+// --------------------------------------------------------------------------------
+// Without an index every beat is decoded and the index written, the next scan has
+// to list all of them from it without opening one, and both have to agree with
+// the beats themselves. The index is removed again afterwards.
+// --------------------------------------------------------------------------------
+static void CheckLibrary(const char* szBeat)
+{
+	const char* szCheck = "library";
+
+	pd->file->unlink("beatlib.idx", 0);
+
+	BeatLibrary* pLibrary = BeatLibraryCreate(pd);
+	int nCount = BeatLibraryScan(pLibrary);
+	int nScanned = BeatLibraryGetStats(pLibrary)->nScanned;
+	BeatLibraryDestroy(pLibrary);
+
+	pLibrary = BeatLibraryCreate(pd);
+	int nIndexCount = BeatLibraryScan(pLibrary);
+	const BeatLibraryStats* pStats = BeatLibraryGetStats(pLibrary);
+
+	char szSource[64];
+	char szCompiled[64];
+	snprintf(szSource, sizeof(szSource), "%s.bmf", szBeat);
+	snprintf(szCompiled, sizeof(szCompiled), "%s.bmb", szBeat);
+
+	char szWhy[160];
+	snprintf(szWhy, sizeof(szWhy), "%d beats, the first scan decoded %d, the second %d and listed %d from the index", nCount, nScanned, pStats->nScanned, pStats->nFromIndex);
+
+	int bPassed = nCount > 0 && nScanned == nCount && nIndexCount == nCount && pStats->nScanned == 0 && pStats->nFromIndex == nCount;
+	bPassed = bPassed && CheckLibraryEntry(pLibrary, szSource, szWhy, sizeof(szWhy)) && CheckLibraryEntry(pLibrary, szCompiled, szWhy, sizeof(szWhy));
+
+	CheckResult(szCheck, bPassed, szWhy);
+
+	BeatLibraryDestroy(pLibrary);
+	pd->file->unlink("beatlib.idx", 0);
+
+}
+
+
+// --------------------------------------------------------------------------------
+static int Usage(void)
+{
+	fprintf(stderr, "usage: bmcheck [-d data dir]\n");
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	const char* szDataPath = "../Source/";
+
+	int nArg = 1;
+	for (; nArg + 1 < argc && argv[nArg][0] == '-'; nArg += 2)
+	{
+		if (strcmp(argv[nArg], "-d") == 0)
+			szDataPath = argv[nArg + 1];
+		else
+			return Usage();
+	}
+
+	if (nArg != argc)
+		return Usage();
+
+	HostSystemInit(szDataPath);
+	HostSoundInit(HOST_DEVICE_RATE, szDataPath);
+
+	memset(&api, 0, sizeof(api));
+	api.system = HostSystemGetAPI();
+	api.file = HostFileGetAPI();
+	api.sound = HostSoundGetAPI();
+	api.json = HostJsonGetAPI();
+
+	CheckInstances("demo.bmf", "stress.bmf");
+	CheckTrackSetters("demo.bmf");
+	CheckDelayPool("demo.bmf");
+	CheckTranspose("demo.bmf", 12);
+	CheckChords();
+
+	CheckLoadLoop("demo.bmf", "stress.bmf");
+	CheckLoadLoop("demo.bmb", "stress.bmb");
+
+	CheckDecoders("demo");
+	CheckDecoders("stress");
+
+	CheckLoadSlices("demo");
+	CheckLoadSlices("stress");
+
+	CheckLibrary("demo");
+
+	if (nFailedChecks > 0)
+	{
+		printf("%d checks failed\n", nFailedChecks);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,115 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// bmchords - writes the chord tables of scale_manager.c.
+//
+// For every scale, root and pitch class the table holds how many semitones the
+// third, fifth and seventh are above the pitch, stepping two scale degrees at a
+// time. A pitch outside the scale takes the chord of the scale degree below it.
+// Run "make chords" after changing scale_intervals.h.
+//
+//	bmchords [out.h]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "scale_manager.h"
+#include "scale_intervals.h"
+
+
+// --------------------------------------------------------------------------------
+// scale_manager.c is linked for the scale names only
+// --------------------------------------------------------------------------------
+void* Engine_MemAlloc(int nSize)
+{
+	return malloc(nSize);
+}
+
+
+// --------------------------------------------------------------------------------
+static void ChordTones(int nScale, int nRoot, int nPitchClass, uint8_t* pTones)
+{
+	const int* pScale = pScales[nScale];
+	int nCount = nScalePitchCount[nScale];
+
+	// semitones above the root and the degree it falls on
+	int nOffset = (nPitchClass - nRoot + SCALE_SEMITONE_COUNT) % SCALE_SEMITONE_COUNT;
+
+	int nDegree = 0;
+	while (nDegree + 1 < nCount && pScale[nDegree + 1] <= nOffset)
+		nDegree++;
+
+	for (int t = 0; t < SCALE_CHORD_TONES; t++)
+	{
+		int nToneDegree = nDegree + (t + 1) * 2;
+		int nTone = pScale[nToneDegree % nCount] + (nToneDegree / nCount) * SCALE_SEMITONE_COUNT;
+
+		pTones[t] = (uint8_t)(nTone - nOffset);
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	FILE* pFile = argc > 1 ? fopen(argv[1], "w") : stdout;
+	if (pFile == NULL)
+	{
+		fprintf(stderr, "bmchords: can't write %s\n", argv[1]);
+		return 1;
+	}
+
+	char** szScaleNames = GetScaleNamesArray();
+	char** szPitchNames = GetPitchNameArray();
+
+	fprintf(pFile, "// Written by tools/bmchords from scale_intervals.h, \"make chords\" in tools.\n\n");
+	fprintf(pFile, "#ifndef SCALE_CHORDS_H\n#define SCALE_CHORDS_H\n\n#pragma once\n\n");
+	fprintf(pFile, "// [scale][root][pitch %% 12]: semitones up to the third, fifth and seventh\n");
+	fprintf(pFile, "static const uint8_t nScaleChordTable[SCALE_COUNT][NOTE_COUNT][NOTE_COUNT][SCALE_CHORD_TONES] =\n{\n");
+
+	for (int s = 0; s < SCALE_COUNT; s++)
+	{
+		fprintf(pFile, "\t// %s\n\t{\n", szScaleNames[s]);
+
+		for (int r = 0; r < NOTE_COUNT; r++)
+		{
+			fprintf(pFile, "\t\t{ ");
+
+			for (int p = 0; p < NOTE_COUNT; p++)
+			{
+				uint8_t tones[SCALE_CHORD_TONES];
+				ChordTones(s, r, p, tones);
+
+				fprintf(pFile, "{ %2d, %2d, %2d }%s", tones[0], tones[1], tones[2], p + 1 < NOTE_COUNT ? ", " : "");
+			}
+
+			fprintf(pFile, " },\t// %s\n", szPitchNames[r]);
+		}
+
+		fprintf(pFile, "\t},\n");
+	}
+
+	fprintf(pFile, "};\n\n#endif\n");
+
+	if (pFile != stdout)
+		fclose(pFile);
+
+	return 0;
+}
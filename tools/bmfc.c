@@ -0,0 +1,626 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// bmfc - PocketBM beat compiler, runs on the PC.
+//
+//	bmfc input.bmf output.bmb		compile a beat file
+//	bmfc -stress output.bmf			write a 16 track, 1280 step stress beat
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "beat_format.h"
+
+
+// --------------------------------------------------------------------------------
+#define MAX_TRACK		16
+#define MAX_LABEL		64
+#define MAX_STEP		1280
+
+// same order as szSoundSrcType in beat_machine.c
+static const char* szSoundSrcType[] =
+{
+	"sampler",
+	"sine",
+	"square",
+	"sawtooth",
+	"triangle",
+	"noise",
+	"phase",
+	"digital",
+	"vosim",
+	"wavetable"
+};
+
+#define SOUND_SRC_COUNT		(int)(sizeof(szSoundSrcType) / sizeof(szSoundSrcType[0]))
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	JSON_NULL,
+	JSON_NUMBER,
+	JSON_STRING,
+	JSON_ARRAY,
+	JSON_TABLE
+} JSON_TYPES;
+
+
+// --------------------------------------------------------------------------------
+typedef struct JsonNode
+{
+	int nType;
+	char* szKey;
+	char* szString;
+	double fNumber;
+
+	struct JsonNode* pChild;
+	struct JsonNode* pNext;
+
+} JsonNode;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	const char* pText;
+	int nPos;
+	int nLine;
+	int bError;
+} JsonParser;
+
+
+// --------------------------------------------------------------------------------
+static void* MemAlloc(size_t nSize)
+{
+	void* p = calloc(1, nSize);
+	if (p == NULL)
+	{
+		fprintf(stderr, "bmfc: out of memory\n");
+		exit(1);
+	}
+	return p;
+}
+
+
+// --------------------------------------------------------------------------------
+static void SkipSpace(JsonParser* pParser)
+{
+	for (;;)
+	{
+		char c = pParser->pText[pParser->nPos];
+		if (c == '\n')
+			pParser->nLine++;
+
+		if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+			pParser->nPos++;
+		else
+			break;
+	}
+}
+
+
+// --------------------------------------------------------------------------------
+static void ParseError(JsonParser* pParser, const char* szError)
+{
+	if (!pParser->bError)
+		fprintf(stderr, "bmfc: line %d: %s\n", pParser->nLine, szError);
+
+	pParser->bError = 1;
+}
+
+
+// --------------------------------------------------------------------------------
+static char* ParseString(JsonParser* pParser)
+{
+	// .bmf strings never use escapes other than \" and \\ so they are kept simple
+	pParser->nPos++;
+
+	int nStart = pParser->nPos;
+	while (pParser->pText[pParser->nPos] && pParser->pText[pParser->nPos] != '"')
+	{
+		if (pParser->pText[pParser->nPos] == '\\' && pParser->pText[pParser->nPos + 1])
+			pParser->nPos++;
+		pParser->nPos++;
+	}
+
+	if (pParser->pText[pParser->nPos] != '"')
+	{
+		ParseError(pParser, "unterminated string");
+		return NULL;
+	}
+
+	int nLen = pParser->nPos - nStart;
+	char* szString = MemAlloc(nLen + 1);
+
+	int nOut = 0;
+	for (int i = 0; i < nLen; i++)
+	{
+		char c = pParser->pText[nStart + i];
+		if (c == '\\')
+			c = pParser->pText[nStart + ++i];
+		szString[nOut++] = c;
+	}
+
+	pParser->nPos++;
+	return szString;
+}
+
+
+// --------------------------------------------------------------------------------
+static JsonNode* ParseValue(JsonParser* pParser)
+{
+	SkipSpace(pParser);
+
+	JsonNode* pNode = MemAlloc(sizeof(JsonNode));
+	char c = pParser->pText[pParser->nPos];
+
+	if (c == '{' || c == '[')
+	{
+		char cEnd = (c == '{') ? '}' : ']';
+		pNode->nType = (c == '{') ? JSON_TABLE : JSON_ARRAY;
+		pParser->nPos++;
+
+		JsonNode** ppLast = &pNode->pChild;
+
+		SkipSpace(pParser);
+		if (pParser->pText[pParser->nPos] == cEnd)
+		{
+			pParser->nPos++;
+			return pNode;
+		}
+
+		while (!pParser->bError)
+		{
+			char* szKey = NULL;
+
+			if (pNode->nType == JSON_TABLE)
+			{
+				SkipSpace(pParser);
+				if (pParser->pText[pParser->nPos] != '"')
+				{
+					ParseError(pParser, "expected a key");
+					break;
+				}
+
+				szKey = ParseString(pParser);
+
+				SkipSpace(pParser);
+				if (pParser->pText[pParser->nPos] != ':')
+				{
+					ParseError(pParser, "expected ':'");
+					break;
+				}
+				pParser->nPos++;
+			}
+
+			JsonNode* pChild = ParseValue(pParser);
+			pChild->szKey = szKey;
+			*ppLast = pChild;
+			ppLast = &pChild->pNext;
+
+			SkipSpace(pParser);
+			c = pParser->pText[pParser->nPos];
+			if (c == ',')
+			{
+				pParser->nPos++;
+			}
+			else if (c == cEnd)
+			{
+				pParser->nPos++;
+				break;
+			}
+			else
+			{
+				ParseError(pParser, "expected ',' or end of list");
+			}
+		}
+	}
+	else if (c == '"')
+	{
+		pNode->nType = JSON_STRING;
+		pNode->szString = ParseString(pParser);
+	}
+	else if (c == '-' || (c >= '0' && c <= '9'))
+	{
+		char* pEnd = NULL;
+		pNode->nType = JSON_NUMBER;
+		pNode->fNumber = strtod(pParser->pText + pParser->nPos, &pEnd);
+		pParser->nPos = (int)(pEnd - pParser->pText);
+	}
+	else if (strncmp(pParser->pText + pParser->nPos, "true", 4) == 0)
+	{
+		pNode->nType = JSON_NUMBER;
+		pNode->fNumber = 1;
+		pParser->nPos += 4;
+	}
+	else if (strncmp(pParser->pText + pParser->nPos, "false", 5) == 0)
+	{
+		pNode->nType = JSON_NUMBER;
+		pParser->nPos += 5;
+	}
+	else if (strncmp(pParser->pText + pParser->nPos, "null", 4) == 0)
+	{
+		pNode->nType = JSON_NULL;
+		pParser->nPos += 4;
+	}
+	else
+	{
+		ParseError(pParser, "unexpected character");
+	}
+
+	return pNode;
+}
+
+
+// --------------------------------------------------------------------------------
+static JsonNode* FindKey(JsonNode* pTable, const char* szKey)
+{
+	if (pTable == NULL || pTable->nType != JSON_TABLE)
+		return NULL;
+
+	for (JsonNode* pChild = pTable->pChild; pChild; pChild = pChild->pNext)
+	{
+		if (pChild->szKey && strcmp(pChild->szKey, szKey) == 0)
+			return pChild;
+	}
+
+	return NULL;
+}
+
+
+// --------------------------------------------------------------------------------
+static double GetNumber(JsonNode* pTable, const char* szKey, double fDefault)
+{
+	JsonNode* pNode = FindKey(pTable, szKey);
+	if (pNode && pNode->nType == JSON_NUMBER)
+		return pNode->fNumber;
+
+	return fDefault;
+}
+
+
+// --------------------------------------------------------------------------------
+static void GetString(JsonNode* pTable, const char* szKey, char* szOut, int nOutSize)
+{
+	JsonNode* pNode = FindKey(pTable, szKey);
+	if (pNode && pNode->nType == JSON_STRING)
+	{
+		strncpy(szOut, pNode->szString, nOutSize - 1);
+		szOut[nOutSize - 1] = '\0';
+	}
+}
+
+
+// --------------------------------------------------------------------------------
+static char* ReadTextFile(const char* szPath)
+{
+	FILE* file = fopen(szPath, "rb");
+	if (file == NULL)
+		return NULL;
+
+	fseek(file, 0, SEEK_END);
+	long nSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	char* pText = MemAlloc(nSize + 1);
+	if (fread(pText, 1, nSize, file) != (size_t)nSize)
+	{
+		fclose(file);
+		free(pText);
+		return NULL;
+	}
+
+	fclose(file);
+	return pText;
+}
+
+
+// --------------------------------------------------------------------------------
+static int CompareNotes(const void* a, const void* b)
+{
+	const BMBNote* pA = a;
+	const BMBNote* pB = b;
+
+	if (pA->nStep != pB->nStep)
+		return (int)pA->nStep - (int)pB->nStep;
+
+	return (int)pA->nPitch - (int)pB->nPitch;
+}
+
+
+// --------------------------------------------------------------------------------
+static void CompileTrack(JsonNode* pTrackNode, BMBTrack* pTrack, BMBNote* pNotes, uint32_t* pNoteCount, int* pBeatLength)
+{
+	memset(pTrack, 0, sizeof(BMBTrack));
+
+	pTrack->nId = (uint8_t)GetNumber(pTrackNode, "id", 0);
+	pTrack->nColour = (uint8_t)GetNumber(pTrackNode, "color", 0);
+	pTrack->bMuted = (uint8_t)GetNumber(pTrackNode, "mute", 0);
+	pTrack->bIsChordTrack = (uint8_t)GetNumber(pTrackNode, "chord", 0);
+	pTrack->fVolume = (float)GetNumber(pTrackNode, "vol", 1.0);
+	pTrack->fPanning = (float)GetNumber(pTrackNode, "pan", 0.0);
+
+	GetString(pTrackNode, "name", pTrack->szTrackName, BMB_NAME_SIZE);
+	GetString(pTrackNode, "sample", pTrack->szSampleName, BMB_SAMPLE_SIZE);
+
+	char szType[32] = "sampler";
+	GetString(pTrackNode, "type", szType, 32);
+	for (int i = 0; i < SOUND_SRC_COUNT; i++)
+	{
+		if (strcmp(szSoundSrcType[i], szType) == 0)
+			pTrack->nSoundSource = (uint8_t)i;
+	}
+
+	// a wavetable track's harmonic levels, from the fundamental up
+	JsonNode* pHarmonics = FindKey(pTrackNode, "harmonics");
+	if (pHarmonics && pHarmonics->nType == JSON_ARRAY)
+	{
+		int nCount = 0;
+		for (JsonNode* pNode = pHarmonics->pChild; pNode && nCount < BMB_HARMONIC_COUNT; pNode = pNode->pNext)
+		{
+			double fLevel = pNode->nType == JSON_NUMBER ? pNode->fNumber : 0.0;
+			fLevel = fLevel < 0.0 ? 0.0 : (fLevel > 1.0 ? 1.0 : fLevel);
+			pTrack->nHarmonics[nCount++] = (uint8_t)(fLevel * 255.0 + 0.5);
+		}
+	}
+
+	JsonNode* pEnv = FindKey(pTrackNode, "env");
+	if (pEnv)
+	{
+		pTrack->bHasEnvelope = 1;
+		pTrack->fAttack = (float)GetNumber(pEnv, "a", 0.0);
+		pTrack->fDecay = (float)GetNumber(pEnv, "d", 0.0);
+		pTrack->fSustain = (float)GetNumber(pEnv, "s", 0.0);
+		pTrack->fRelease = (float)GetNumber(pEnv, "r", 0.0);
+	}
+
+	JsonNode* pFilter = FindKey(pTrackNode, "filter");
+	if (pFilter == NULL)
+		pFilter = FindKey(pTrackNode, "lpf");
+	if (pFilter)
+	{
+		pTrack->bFilterEnabled = 1;
+		pTrack->nFilterType = (uint8_t)GetNumber(pFilter, "type", 0);
+		pTrack->nFilterFreq = (uint16_t)GetNumber(pFilter, "freq", 0);
+		pTrack->fFilterResn = (float)GetNumber(pFilter, "resn", 0.0);
+		pTrack->fFilterMix = (float)GetNumber(pFilter, "mix", 0.0);
+	}
+
+	JsonNode* pDelay = FindKey(pTrackNode, "delay");
+	if (pDelay)
+	{
+		pTrack->bDelayEnabled = 1;
+		pTrack->fDelayFeedback = (float)GetNumber(pDelay, "feedback", 0.0);
+		pTrack->fDelayMix = (float)GetNumber(pDelay, "mix", 0.0);
+	}
+
+	JsonNode* pCrusher = FindKey(pTrackNode, "bitcrush");
+	if (pCrusher)
+	{
+		pTrack->bBitCrusherEnabled = 1;
+		pTrack->fBitcrusherAmount = (float)GetNumber(pCrusher, "amount", 0.0);
+		pTrack->fBitcrusherMix = (float)GetNumber(pCrusher, "mix", 0.0);
+	}
+
+	pTrack->nFirstNote = *pNoteCount;
+
+	JsonNode* pNoteList = FindKey(pTrackNode, "notes");
+	if (pNoteList && pNoteList->nType == JSON_ARRAY)
+	{
+		for (JsonNode* pNode = pNoteList->pChild; pNode; pNode = pNode->pNext)
+		{
+			BMBNote* pNote = &pNotes[*pNoteCount];
+			pNote->nStep = (uint16_t)GetNumber(pNode, "step", 0);
+			pNote->nPitch = (uint8_t)GetNumber(pNode, "pitch", 60);
+			pNote->nLen = (uint8_t)GetNumber(pNode, "len", 1);
+			pNote->fVelocity = (float)GetNumber(pNode, "vel", 1.0);
+
+			int nEnd = pNote->nStep + pNote->nLen;
+			if (nEnd > *pBeatLength)
+				*pBeatLength = nEnd;
+
+			(*pNoteCount)++;
+			pTrack->nNoteCount++;
+		}
+	}
+
+	qsort(pNotes + pTrack->nFirstNote, pTrack->nNoteCount, sizeof(BMBNote), CompareNotes);
+}
+
+
+// --------------------------------------------------------------------------------
+static int CountNotes(JsonNode* pTracks)
+{
+	int nCount = 0;
+
+	for (JsonNode* pTrackNode = pTracks->pChild; pTrackNode; pTrackNode = pTrackNode->pNext)
+	{
+		JsonNode* pNoteList = FindKey(pTrackNode, "notes");
+		if (pNoteList && pNoteList->nType == JSON_ARRAY)
+		{
+			for (JsonNode* pNode = pNoteList->pChild; pNode; pNode = pNode->pNext)
+				nCount++;
+		}
+	}
+
+	return nCount;
+}
+
+
+// --------------------------------------------------------------------------------
+static int CompileBeat(const char* szInput, const char* szOutput)
+{
+	char* pText = ReadTextFile(szInput);
+	if (pText == NULL)
+	{
+		fprintf(stderr, "bmfc: cannot read %s\n", szInput);
+		return 1;
+	}
+
+	JsonParser parser = { pText, 0, 1, 0 };
+	JsonNode* pRoot = ParseValue(&parser);
+	if (parser.bError)
+		return 1;
+
+	JsonNode* pBeat = FindKey(pRoot, "beat");
+	JsonNode* pTracks = FindKey(pBeat, "tracks");
+	if (pBeat == NULL || pTracks == NULL || pTracks->nType != JSON_ARRAY)
+	{
+		fprintf(stderr, "bmfc: %s is not a beat file\n", szInput);
+		return 1;
+	}
+
+	BMBHeader header;
+	memset(&header, 0, sizeof(BMBHeader));
+
+	header.nMagic = BMB_MAGIC;
+	header.nVersion = BMB_VERSION;
+	header.nFileVersion = (uint16_t)GetNumber(pBeat, "ver", 1);
+	header.nBPM = (uint16_t)GetNumber(pBeat, "BPM", 120);
+
+	strcpy(header.szScale, "Major");
+	strcpy(header.szBaseNote, "C");
+	JsonNode* pScale = FindKey(pBeat, "scale");
+	GetString(pScale, "type", header.szScale, BMB_SCALE_SIZE);
+	GetString(pScale, "base", header.szBaseNote, BMB_BASE_NOTE_SIZE);
+
+	JsonNode* pLoop = FindKey(pBeat, "loop");
+	header.bLoopOn = (uint8_t)GetNumber(pLoop, "on", 0);
+	header.nLoopStart = (uint16_t)GetNumber(pLoop, "start", 0);
+	header.nLoopEnd = (uint16_t)GetNumber(pLoop, "end", 0);
+
+	BMBLabel labels[MAX_LABEL];
+	memset(labels, 0, sizeof(labels));
+
+	JsonNode* pLabelList = FindKey(pBeat, "labels");
+	if (pLabelList && pLabelList->nType == JSON_ARRAY)
+	{
+		for (JsonNode* pNode = pLabelList->pChild; pNode && header.nLabelCount < MAX_LABEL; pNode = pNode->pNext)
+		{
+			labels[header.nLabelCount].nStep = (uint16_t)GetNumber(pNode, "step", 0);
+			GetString(pNode, "txt", labels[header.nLabelCount].szText, BMB_NAME_SIZE);
+			header.nLabelCount++;
+		}
+	}
+
+	BMBTrack tracks[MAX_TRACK];
+	BMBNote* pNotes = MemAlloc(sizeof(BMBNote) * (CountNotes(pTracks) + 1));
+	uint32_t nNoteCount = 0;
+	int nBeatLength = 0;
+
+	for (JsonNode* pTrackNode = pTracks->pChild; pTrackNode; pTrackNode = pTrackNode->pNext)
+	{
+		if (header.nTrackCount >= MAX_TRACK)
+		{
+			fprintf(stderr, "bmfc: %s has more than %d tracks\n", szInput, MAX_TRACK);
+			return 1;
+		}
+
+		CompileTrack(pTrackNode, &tracks[header.nTrackCount], pNotes, &nNoteCount, &nBeatLength);
+		header.nTrackCount++;
+	}
+
+	header.nBeatLength = (uint16_t)nBeatLength;
+	header.nNoteCount = nNoteCount;
+	header.nDataSize = header.nTrackCount * sizeof(BMBTrack) + header.nLabelCount * sizeof(BMBLabel) + nNoteCount * sizeof(BMBNote);
+
+	FILE* file = fopen(szOutput, "wb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "bmfc: cannot write %s\n", szOutput);
+		return 1;
+	}
+
+	fwrite(&header, sizeof(BMBHeader), 1, file);
+	fwrite(tracks, sizeof(BMBTrack), header.nTrackCount, file);
+	fwrite(labels, sizeof(BMBLabel), header.nLabelCount, file);
+	fwrite(pNotes, sizeof(BMBNote), nNoteCount, file);
+	fclose(file);
+
+	printf("%s: %d tracks, %d labels, %u notes, %u bytes\n", szOutput, header.nTrackCount, header.nLabelCount, nNoteCount, (unsigned)(sizeof(BMBHeader) + header.nDataSize));
+
+	return 0;
+}
+
+
+// --------------------------------------------------------------------------------
+static int WriteStressBeat(const char* szOutput)
+{
+	// 10 sampler tracks and 6 synth tracks with a note on every step
+	static const char* szSamples[] = { "kick", "snare", "clap", "chihat", "ohihat", "crash", "tom", "cowbell", "piano", "vox-oohs" };
+	static const char* szSynths[] = { "sawtooth", "square", "sine", "vosim", "triangle", "noise" };
+
+	FILE* file = fopen(szOutput, "w");
+	if (file == NULL)
+	{
+		fprintf(stderr, "bmfc: cannot write %s\n", szOutput);
+		return 1;
+	}
+
+	fprintf(file, "{\n\t\"beat\":\n\t{\n\t\t\"ver\": 1,\n\t\t\"BPM\": 120,\n");
+	fprintf(file, "\t\t\"scale\":\n\t\t{\n\t\t\t\"type\": \"Major\", \"base\": \"C\"\n\t\t},\n");
+	fprintf(file, "\t\t\"loop\":\n\t\t{\n\t\t\t\"on\": 0, \"start\": 0, \"end\": %d\n\t\t},\n", MAX_STEP - 1);
+	fprintf(file, "\t\t\"labels\":\n\t\t[\n\t\t],\n\t\t\"tracks\":\n\t\t[\n");
+
+	for (int t = 0; t < MAX_TRACK; t++)
+	{
+		fprintf(file, "\t\t\t{\n\t\t\t\t\"id\": %d,\n\t\t\t\t\"name\": \"TRK%d\",\n\t\t\t\t\"color\": %d,\n", t, t, t % 4);
+
+		if (t < 10)
+			fprintf(file, "\t\t\t\t\"type\": \"sampler\",\n\t\t\t\t\"sample\": \"%s\",\n", szSamples[t]);
+		else
+			fprintf(file, "\t\t\t\t\"type\": \"%s\",\n\t\t\t\t\"env\":\n\t\t\t\t{\n\t\t\t\t\t\"a\": 0.00, \"d\": 0.20, \"s\": 0.30, \"r\": 0.50\n\t\t\t\t},\n", szSynths[t - 10]);
+
+		fprintf(file, "\t\t\t\t\"vol\": 0.50,\n\t\t\t\t\"pan\": 0.00,\n\t\t\t\t\"mute\": 0,\n");
+		if (t == 8)
+			fprintf(file, "\t\t\t\t\"chord\": 1,\n");
+
+		fprintf(file, "\t\t\t\t\"notes\":\n\t\t\t\t[\n");
+		// notes go out of step order, like a beat saved after notes were placed all over the bars
+		for (int i = 0; i < MAX_STEP; i++)
+		{
+			int nStep = (i * 7) % MAX_STEP;
+			int nPitch = 48 + ((nStep * 7 + t * 3) % 24);
+			fprintf(file, "\t\t\t\t\t{ \"step\": %d, \"pitch\": %d, \"len\": 1, \"vel\": %.2f }%s\n", nStep, nPitch, 0.5f + (nStep % 4) * 0.125f, i < MAX_STEP - 1 ? "," : "");
+		}
+		fprintf(file, "\t\t\t\t]\n\t\t\t}%s\n", t < MAX_TRACK - 1 ? "," : "");
+	}
+
+	fprintf(file, "\t\t]\n\t}\n}\n");
+	fclose(file);
+
+	printf("%s: %d tracks, %d notes\n", szOutput, MAX_TRACK, MAX_TRACK * MAX_STEP);
+
+	return 0;
+}
+
+
+// --------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	if (argc == 3 && strcmp(argv[1], "-stress") == 0)
+		return WriteStressBeat(argv[2]);
+
+	if (argc == 3)
+		return CompileBeat(argv[1], argv[2]);
+
+	fprintf(stderr, "usage: bmfc input.bmf output.bmb\n       bmfc -stress output.bmf\n");
+	return 1;
+}
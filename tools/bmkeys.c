@@ -0,0 +1,121 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// bmkeys - writes the key hash table of beat_keys.c.
+//
+// Searches for the lowest seed that puts every key of BEAT_KEY_LIST in a slot of
+// its own and writes the seed with the slots. Run "make keys" after changing the
+// key list in beat_keys.h.
+//
+//	bmkeys [out.h]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "beat_keys.h"
+
+
+// --------------------------------------------------------------------------------
+#define BEAT_KEY_STRING(id, name)	name,
+
+static const char* szKeyNames[BEAT_KEY_COUNT] =
+{
+	"",
+	BEAT_KEY_LIST(BEAT_KEY_STRING)
+};
+
+#undef BEAT_KEY_STRING
+
+
+// --------------------------------------------------------------------------------
+// a list that finds no seed below this needs more BEAT_KEY_HASH_BITS
+// --------------------------------------------------------------------------------
+#define BMKEYS_MAX_SEED		1000000
+
+
+// --------------------------------------------------------------------------------
+static int FillSlots(uint8_t* pSlots, uint32_t nSeed)
+{
+	memset(pSlots, BEAT_KEY_NONE, BEAT_KEY_SLOT_COUNT);
+
+	for (int nKey = BEAT_KEY_NONE + 1; nKey < BEAT_KEY_COUNT; nKey++)
+	{
+		const char* szKey = szKeyNames[nKey];
+		uint32_t nSlot = BeatKeyHash(szKey, strlen(szKey), nSeed);
+
+		if (pSlots[nSlot] != BEAT_KEY_NONE)
+			return 0;
+
+		pSlots[nSlot] = nKey;
+	}
+
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	uint8_t nSlots[BEAT_KEY_SLOT_COUNT];
+
+	uint32_t nSeed = 1;
+	while (!FillSlots(nSlots, nSeed))
+	{
+		if (++nSeed > BMKEYS_MAX_SEED)
+		{
+			fprintf(stderr, "bmkeys: no seed keeps the %d keys apart in %d slots\n", BEAT_KEY_COUNT - 1, BEAT_KEY_SLOT_COUNT);
+			return 1;
+		}
+	}
+
+	FILE* pFile = argc > 1 ? fopen(argv[1], "w") : stdout;
+	if (pFile == NULL)
+	{
+		fprintf(stderr, "bmkeys: can't write %s\n", argv[1]);
+		return 1;
+	}
+
+	fprintf(pFile, "// Written by tools/bmkeys from the key list in beat_keys.h, \"make keys\" in tools.\n\n");
+	fprintf(pFile, "#ifndef BEAT_KEY_SLOTS_H\n#define BEAT_KEY_SLOTS_H\n\n#pragma once\n\n");
+
+	// a key list changed without "make keys" doesn't build
+	fprintf(pFile, "_Static_assert(BEAT_KEY_COUNT == %d, \"the key list changed, run make keys in tools\");\n\n", BEAT_KEY_COUNT);
+
+	fprintf(pFile, "#define BEAT_KEY_SEED\t%uu\n\n", nSeed);
+	fprintf(pFile, "// BeatKeyHash() of every key with BEAT_KEY_SEED: the key in its slot, BEAT_KEY_NONE elsewhere\n");
+	fprintf(pFile, "static const uint8_t nKeySlots[BEAT_KEY_SLOT_COUNT] =\n{\n");
+
+	for (int nRow = 0; nRow < BEAT_KEY_SLOT_COUNT; nRow += 16)
+	{
+		fprintf(pFile, "\t");
+
+		for (int i = nRow; i < nRow + 16; i++)
+			fprintf(pFile, "%2d,%s", nSlots[i], i + 1 < nRow + 16 ? " " : "");
+
+		fprintf(pFile, "\n");
+	}
+
+	fprintf(pFile, "};\n\n#endif\n");
+
+	if (pFile != stdout)
+		fclose(pFile);
+
+	return 0;
+}
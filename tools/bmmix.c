@@ -0,0 +1,203 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// bmmix - times the beat mixer kernels against each other on the PC.
+//
+// Every voice count mixes the same blocks of noise through the reference kernel
+// and the packed one and prints the time per voice frame. The packed kernel
+// rounds per voice pair, so the largest difference to the reference is printed
+// too, it has to stay within one step per pair.
+//
+//	bmmix [seconds of audio per voice count]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "beat_mixer.h"
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	MIX_MAX_VOICES = 16,
+	MIX_SAMPLE_FRAMES = 44100,
+	MIX_DEFAULT_SECONDS = 60
+
+} MIX_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+// beat_mixer.c takes its memory from the engine, the kernels themselves don't
+// --------------------------------------------------------------------------------
+void* Engine_MemAlloc(int nSize)
+{
+	return malloc(nSize);
+}
+
+
+// --------------------------------------------------------------------------------
+void Engine_MemFree(void* pData)
+{
+	free(pData);
+}
+
+
+// --------------------------------------------------------------------------------
+static double Seconds(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+// --------------------------------------------------------------------------------
+typedef void (*MixKernel)(const int16_t** pBlocks, const int16_t* pGains, int nVoices, int32_t* pLeft, int32_t* pRight, int nFrameCount);
+
+
+// --------------------------------------------------------------------------------
+static double TimeKernel(MixKernel kernel, int16_t** pSamples, const int16_t* pGains, int nVoices, int nBlockCount, int64_t* pChecksum)
+{
+	int32_t left[BM_MIXER_BLOCK_FRAMES];
+	int32_t right[BM_MIXER_BLOCK_FRAMES];
+	const int16_t* pBlocks[MIX_MAX_VOICES];
+
+	int64_t nChecksum = 0;
+	double fStart = Seconds();
+
+	for (int b = 0; b < nBlockCount; b++)
+	{
+		// every voice is at another place in its sample, like hits started on different steps
+		for (int v = 0; v < nVoices; v++)
+		{
+			int nFrame = ((b + v * 97) * BM_MIXER_BLOCK_FRAMES) % (MIX_SAMPLE_FRAMES - BM_MIXER_BLOCK_FRAMES);
+			pBlocks[v] = pSamples[v] + nFrame * 2;
+		}
+
+		memset(left, 0, sizeof(left));
+		memset(right, 0, sizeof(right));
+
+		kernel(pBlocks, pGains, nVoices, left, right, BM_MIXER_BLOCK_FRAMES);
+
+		nChecksum += left[b % BM_MIXER_BLOCK_FRAMES] - right[(b * 7) % BM_MIXER_BLOCK_FRAMES];
+	}
+
+	*pChecksum = nChecksum;
+
+	return Seconds() - fStart;
+}
+
+
+// --------------------------------------------------------------------------------
+static int MaxDifference(int16_t** pSamples, const int16_t* pGains, int nVoices)
+{
+	int32_t reference[2][BM_MIXER_BLOCK_FRAMES];
+	int32_t packed[2][BM_MIXER_BLOCK_FRAMES];
+	const int16_t* pBlocks[MIX_MAX_VOICES];
+
+	int nMaxDifference = 0;
+
+	for (int b = 0; b < MIX_SAMPLE_FRAMES / BM_MIXER_BLOCK_FRAMES; b++)
+	{
+		for (int v = 0; v < nVoices; v++)
+			pBlocks[v] = pSamples[v] + b * BM_MIXER_BLOCK_FRAMES * 2;
+
+		memset(reference, 0, sizeof(reference));
+		memset(packed, 0, sizeof(packed));
+
+		BeatMixerMixReference(pBlocks, pGains, nVoices, reference[0], reference[1], BM_MIXER_BLOCK_FRAMES);
+		BeatMixerMixPacked(pBlocks, pGains, nVoices, packed[0], packed[1], BM_MIXER_BLOCK_FRAMES);
+
+		for (int c = 0; c < 2; c++)
+		{
+			for (int i = 0; i < BM_MIXER_BLOCK_FRAMES; i++)
+			{
+				int nDifference = abs(reference[c][i] - packed[c][i]);
+				if (nDifference > nMaxDifference)
+					nMaxDifference = nDifference;
+			}
+		}
+	}
+
+	return nMaxDifference;
+}
+
+
+// --------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	int nSeconds = argc > 1 ? atoi(argv[1]) : MIX_DEFAULT_SECONDS;
+	if (nSeconds <= 0)
+	{
+		fprintf(stderr, "usage: bmmix [seconds]\n");
+		return 1;
+	}
+
+	// decaying noise bursts stand in for drum hits, gains spread over the stereo field
+	int16_t* pSamples[MIX_MAX_VOICES];
+	int16_t gains[MIX_MAX_VOICES * 2];
+
+	srand(1);
+
+	for (int v = 0; v < MIX_MAX_VOICES; v++)
+	{
+		pSamples[v] = malloc(MIX_SAMPLE_FRAMES * 2 * sizeof(int16_t));
+
+		for (int i = 0; i < MIX_SAMPLE_FRAMES * 2; i++)
+		{
+			int nEnvelope = 32767 - (i / 2) * 32767 / MIX_SAMPLE_FRAMES;
+			pSamples[v][i] = (int16_t)(((rand() % 65536) - 32768) * nEnvelope / 32768);
+		}
+
+		gains[v * 2] = (int16_t)(32767 - v * 1500);
+		gains[v * 2 + 1] = (int16_t)(9000 + v * 1500);
+	}
+
+	int nBlockCount = nSeconds * BM_MIXER_RATE / BM_MIXER_BLOCK_FRAMES;
+	int nVoiceCounts[] = { 1, 2, 4, 7, 8, 16 };
+
+	printf("voices  reference ns/frame  packed ns/frame  speed up  max difference\n");
+
+	for (int n = 0; n < (int)(sizeof(nVoiceCounts) / sizeof(nVoiceCounts[0])); n++)
+	{
+		int nVoices = nVoiceCounts[n];
+		int64_t nReferenceSum = 0;
+		int64_t nPackedSum = 0;
+
+		double fReference = TimeKernel(BeatMixerMixReference, pSamples, gains, nVoices, nBlockCount, &nReferenceSum);
+		double fPacked = TimeKernel(BeatMixerMixPacked, pSamples, gains, nVoices, nBlockCount, &nPackedSum);
+
+		double fVoiceFrames = (double)nBlockCount * BM_MIXER_BLOCK_FRAMES * nVoices;
+		int nMaxDifference = MaxDifference(pSamples, gains, nVoices);
+
+		printf("%6d  %18.3f  %15.3f  %7.2fx  %d (limit %d)%s\n", nVoices, fReference * 1e9 / fVoiceFrames, fPacked * 1e9 / fVoiceFrames,
+			fPacked > 0.0 ? fReference / fPacked : 0.0, nMaxDifference, nVoices / 2, nMaxDifference <= nVoices / 2 ? "" : "  FAILED");
+
+		// keeps the compiler from dropping the loops
+		if (nReferenceSum == 0x7FFFFFFFFFFFFFFF || nPackedSum == 0x7FFFFFFFFFFFFFFF)
+			printf("\n");
+	}
+
+	for (int v = 0; v < MIX_MAX_VOICES; v++)
+		free(pSamples[v]);
+
+	return 0;
+}
@@ -0,0 +1,579 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// bmrender - bounces a beat to a WAV file on the PC.
+//
+// The player code is compiled as it is and runs on a host PlaydateAPI: plain
+// stdio for the file system and the software mixer in host_sound.c for the
+// sound. Nothing waits on a clock, so a beat renders as fast as the mixer goes.
+//
+//	bmrender [-r rate] [-l loops] [-t seconds] [-m mixer] [-v voices] [-s steal] [-k label@seconds] [-e 0|1] [-q sample@steps] [-z track mask] [-p KB] [-i track mask] [-x track mask] [-y steps] [-d data dir] beat out.wav
+//
+// -m 1 plays the sampler tracks through the beat mixer with its reference kernel,
+// -m 2 with the packed one. Without it every track has its own synth and channel.
+// -v sets the size of the mixer's voice pool and -s 1 steals the quietest voice
+// instead of the oldest when it is full, the occupancy printed at the end shows
+// how many voices a beat really needs.
+//
+// -k drop@12.5 seeks to the label "drop" 12.5 seconds in. While a seek is pending
+// the player is updated once per 1/30 s, as often as the device runs its frames,
+// and the latency from the call to the label being heard is printed.
+//
+// -e 1 subscribes to the beat's events and hands them out once per 1/30 s frame.
+// The counts are printed with how far the step times are off the step grid and
+// how long after its step a frame got to see an event.
+//
+// -q cowbell@4 measures BeatMachineTriggerQuantized(): the sample of the beat is
+// triggered from 1/30 s frames at uneven times, quantized to 4 steps, and every
+// start the mixer makes is compared with the start of its step in the sequence.
+// Printed next to it is how far off the grid the same calls would have been had
+// they played on the frame.
+//
+// -z 0x0c freezes tracks 2 and 3 as the beat loads. What each frozen track costs
+// in sample memory is printed against the voice time and the effects it saves,
+// and the render time next to a render without -z shows what that buys.
+//
+// -p 2048 prerenders the loop region into a buffer of at most 2048 KB once the
+// beat plays, 2 ms of it per 1/30 s frame, and plays that instead of the tracks
+// while the playhead is in the region. How long the render took, in frames and
+// in time, is printed with how often the buffer had to be put back on the beat.
+//
+// -i 0x0c gives tracks 2 and 3 a filter, a bit crusher and a delay of their own,
+// -x 0x0c sends them to the shared delay and filter buses instead. The render
+// times of the two show what a track of inserts costs against a send. -y 3 makes
+// the echoes of both a dotted eighth instead of a quarter, the lines the insert
+// delays got from the machine's pool are printed at the end.
+//
+// The beat is named the way BeatMachineLoadBeat() takes it, "demo.bmf" for the
+// source and "demo.bmb" for the compiled file, both under <data dir>/beats.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "pd_api.h"
+#include "beat_machine.h"
+#include "host_sound.h"
+#include "host_system.h"
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	RENDER_BLOCK_FRAMES = 4096,
+	RENDER_FRAME_RATE = 30,
+	RENDER_DEFAULT_SECONDS = 600
+
+} RENDER_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+static const char* szDataPath = "../Source/";
+
+
+// --------------------------------------------------------------------------------
+static void WriteLE(FILE* file, uint32_t nValue, int nBytes)
+{
+	for (int i = 0; i < nBytes; i++)
+		fputc((nValue >> (i * 8)) & 0xFF, file);
+}
+
+
+// --------------------------------------------------------------------------------
+static int WriteWav(const char* szPath, const int16_t* pFrames, int nFrameCount, int nSampleRate)
+{
+	FILE* file = fopen(szPath, "wb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "bmrender: can't write %s\n", szPath);
+		return 0;
+	}
+
+	uint32_t nDataSize = nFrameCount * 2 * sizeof(int16_t);
+
+	fwrite("RIFF", 1, 4, file);
+	WriteLE(file, 36 + nDataSize, 4);
+	fwrite("WAVEfmt ", 1, 8, file);
+	WriteLE(file, 16, 4);
+	WriteLE(file, 1, 2);					// PCM
+	WriteLE(file, 2, 2);					// stereo
+	WriteLE(file, nSampleRate, 4);
+	WriteLE(file, nSampleRate * 4, 4);
+	WriteLE(file, 4, 2);
+	WriteLE(file, 16, 2);
+	fwrite("data", 1, 4, file);
+	WriteLE(file, nDataSize, 4);
+
+	for (int i = 0; i < nFrameCount * 2; i++)
+		WriteLE(file, (uint16_t)pFrames[i], 2);
+
+	int bResult = ferror(file) == 0;
+	fclose(file);
+
+	return bResult;
+}
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int nCounts[5];				// per event type, step to loop
+
+	int nLastStep;
+	uint32_t nLastTime;
+	double fFramesPerStep;
+	double fMaxGridError;		// frames
+
+	uint32_t nNow;
+	uint32_t nMaxDelay;			// frames from a step to the frame it was handed out on
+
+} RenderEventStats;
+
+
+// --------------------------------------------------------------------------------
+static void RenderOnEvent(const BeatEvent* pEvent, void* pUserdata)
+{
+	RenderEventStats* pStats = pUserdata;
+
+	for (int i = 0; i < 5; i++)
+	{
+		if (pEvent->nType == (1 << i))
+			pStats->nCounts[i]++;
+	}
+
+	if (pEvent->nType != BM_EVENT_STEP)
+		return;
+
+	if (pStats->nNow - pEvent->nTime > pStats->nMaxDelay)
+		pStats->nMaxDelay = pStats->nNow - pEvent->nTime;
+
+	// only steps that follow each other, a seek or a wrap can be any distance apart
+	if (pEvent->nStep == pStats->nLastStep + 1)
+	{
+		double fError = fabs((double)(pEvent->nTime - pStats->nLastTime) - pStats->fFramesPerStep);
+		if (fError > pStats->fMaxGridError)
+			pStats->fMaxGridError = fError;
+	}
+
+	pStats->nLastStep = pEvent->nStep;
+	pStats->nLastTime = pEvent->nTime;
+}
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	uint32_t nStepTimes[BM_MAX_STEP_COUNT];		// when each step last started
+
+	int bWaiting;					// a trigger whose start hasn't been measured yet
+	int nTargetStep;
+	uint32_t nCallTime;
+	uint32_t nLastStart;
+
+	int nMeasured;
+	double fErrorSum;
+	double fMaxError;				// frames between the sample start and the step start
+	double fFrameErrorSum;			// the same calls played on their frame
+
+} RenderTriggerStats;
+
+
+// --------------------------------------------------------------------------------
+static void RenderOnTriggerStep(const BeatEvent* pEvent, void* pUserdata)
+{
+	RenderTriggerStats* pStats = pUserdata;
+
+	if (pEvent->nStep >= 0 && pEvent->nStep < BM_MAX_STEP_COUNT)
+		pStats->nStepTimes[pEvent->nStep] = pEvent->nTime;
+}
+
+
+// --------------------------------------------------------------------------------
+static int Usage(void)
+{
+	fprintf(stderr, "usage: bmrender [-r rate] [-l loops] [-t seconds] [-m 0|1|2] [-v voices] [-s 0|1] [-k label@seconds] [-e 0|1] [-q sample@steps] [-z track mask] [-p KB] [-i track mask] [-x track mask] [-y steps] [-d data dir] beat out.wav\n");
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	int nSampleRate = HOST_DEVICE_RATE;
+	int nLoops = 1;
+	int nMaxSeconds = RENDER_DEFAULT_SECONDS;
+	int nMixer = 0;
+	int nMixerVoices = BM_MIXER_DEFAULT_VOICES;
+	int nStealMode = BM_MIXER_STEAL_OLDEST;
+
+	char szSeekLabel[BMB_NAME_SIZE] = { 0 };
+	double fSeekSeconds = -1.0;
+	int bEvents = 0;
+
+	char szTriggerSample[BMB_SAMPLE_SIZE] = { 0 };
+	int nTriggerQuantum = 0;
+
+	int nFreezeMask = 0;
+	int nPrerenderKB = 0;
+	int nInsertMask = 0;
+	int nSendMask = 0;
+	int nDelaySteps = BM_DELAY_QUARTER;
+
+	int nArg = 1;
+	for (; nArg + 1 < argc && argv[nArg][0] == '-'; nArg += 2)
+	{
+		if (strcmp(argv[nArg], "-r") == 0)
+			nSampleRate = atoi(argv[nArg + 1]);
+		else if (strcmp(argv[nArg], "-l") == 0)
+			nLoops = atoi(argv[nArg + 1]);
+		else if (strcmp(argv[nArg], "-t") == 0)
+			nMaxSeconds = atoi(argv[nArg + 1]);
+		else if (strcmp(argv[nArg], "-m") == 0)
+			nMixer = atoi(argv[nArg + 1]);
+		else if (strcmp(argv[nArg], "-v") == 0)
+			nMixerVoices = atoi(argv[nArg + 1]);
+		else if (strcmp(argv[nArg], "-s") == 0)
+			nStealMode = atoi(argv[nArg + 1]);
+		else if (strcmp(argv[nArg], "-d") == 0)
+			szDataPath = argv[nArg + 1];
+		else if (strcmp(argv[nArg], "-k") == 0)
+		{
+			const char* szAt = strchr(argv[nArg + 1], '@');
+			if (szAt == NULL || szAt - argv[nArg + 1] >= BMB_NAME_SIZE)
+				return Usage();
+
+			memcpy(szSeekLabel, argv[nArg + 1], szAt - argv[nArg + 1]);
+			fSeekSeconds = atof(szAt + 1);
+		}
+		else if (strcmp(argv[nArg], "-e") == 0)
+			bEvents = atoi(argv[nArg + 1]);
+		else if (strcmp(argv[nArg], "-q") == 0)
+		{
+			const char* szAt = strchr(argv[nArg + 1], '@');
+			if (szAt == NULL || szAt - argv[nArg + 1] >= BMB_SAMPLE_SIZE)
+				return Usage();
+
+			memcpy(szTriggerSample, argv[nArg + 1], szAt - argv[nArg + 1]);
+			nTriggerQuantum = atoi(szAt + 1);
+			if (nTriggerQuantum < 1)
+				return Usage();
+		}
+		else if (strcmp(argv[nArg], "-p") == 0)
+			nPrerenderKB = atoi(argv[nArg + 1]);
+		else if (strcmp(argv[nArg], "-z") == 0)
+			nFreezeMask = (int)strtol(argv[nArg + 1], NULL, 0);
+		else if (strcmp(argv[nArg], "-i") == 0)
+			nInsertMask = (int)strtol(argv[nArg + 1], NULL, 0);
+		else if (strcmp(argv[nArg], "-x") == 0)
+			nSendMask = (int)strtol(argv[nArg + 1], NULL, 0);
+		else if (strcmp(argv[nArg], "-y") == 0)
+			nDelaySteps = atoi(argv[nArg + 1]);
+		else
+			return Usage();
+	}
+
+	if (argc - nArg != 2 || nSampleRate < 8000 || nLoops < 0 || nMaxSeconds <= 0 || nMixer < 0 || nMixer > 2
+		|| nMixerVoices < 1 || nMixerVoices > BM_MIXER_MAX_VOICES || nStealMode < 0 || nStealMode > 1
+		|| nDelaySteps < 1 || nDelaySteps > BM_DELAY_MAX_STEPS)
+		return Usage();
+
+	const char* szBeat = argv[nArg];
+	const char* szOutput = argv[nArg + 1];
+
+	HostSystemInit(szDataPath);
+	HostSoundInit(nSampleRate, szDataPath);
+
+	// there is no pd->json here, .bmf files go through the in-place scanner
+	PlaydateAPI api;
+	memset(&api, 0, sizeof(api));
+	api.system = HostSystemGetAPI();
+	api.file = HostFileGetAPI();
+	api.sound = HostSoundGetAPI();
+
+	BeatMachine* pBeatMachine = BeatMachineCreate(&api);
+	pBeatMachine->bUseScanner = 1;
+	pBeatMachine->bUseMixer = nMixer > 0;
+	pBeatMachine->nMixerVoices = nMixerVoices;
+	pBeatMachine->nFreezeMask = nFreezeMask;
+
+	if (BeatMachineLoadBeat(pBeatMachine, szBeat) != 0)
+	{
+		fprintf(stderr, "bmrender: can't load %s\n", szBeat);
+		BeatMachineDestroy(pBeatMachine);
+		return 1;
+	}
+
+	double fLoadSeconds = HostWallSeconds();
+
+	if (pBeatMachine->pMixer)
+	{
+		BeatMixerSetKernel(pBeatMachine->pMixer, nMixer == 1 ? BM_MIXER_KERNEL_REFERENCE : BM_MIXER_KERNEL_PACKED);
+		BeatMixerSetStealMode(pBeatMachine->pMixer, nStealMode);
+	}
+
+	RenderEventStats eventStats;
+	memset(&eventStats, 0, sizeof(eventStats));
+	eventStats.nLastStep = -2;
+	eventStats.fFramesPerStep = HOST_DEVICE_RATE * 60.0 / (pBeatMachine->nBPM * BM_STEPS_PER_BEAT);
+
+	if (bEvents)
+		BeatMachineSubscribe(pBeatMachine, BM_EVENT_ALL, RenderOnEvent, &eventStats);
+
+	// the step starts come from the event bus, the sample starts from the host mixer
+	RenderTriggerStats* pTriggerStats = calloc(1, sizeof(RenderTriggerStats));
+	uint32_t nNextTrigger = HOST_DEVICE_RATE / 2;
+	uint32_t nTriggerRandom = 12345;
+
+	if (nTriggerQuantum > 0)
+		BeatMachineSubscribe(pBeatMachine, BM_EVENT_STEP, RenderOnTriggerStep, pTriggerStats);
+
+	// the same echo and low pass on the inserts as on the buses
+	if (nSendMask)
+	{
+		BeatMachineSetDelayBus(pBeatMachine, nDelaySteps, 0.4f, 0.5f);
+		BeatMachineSetFilterBus(pBeatMachine, kFilterTypeLowPass, 800, 0.3f, 0.5f);
+	}
+
+	for (int i = 0; i < BM_MAX_TRACK; i++)
+	{
+		if (nInsertMask & (1 << i))
+		{
+			BeatMachineEnableFilter(pBeatMachine, i, kFilterTypeLowPass, 800, 0.3f, 0.5f);
+			BeatMachineEnableBitCrusher(pBeatMachine, i, 0.5f, 0.3f);
+			BeatMachineEnableDelay(pBeatMachine, i, 0.4f, 0.3f);
+			BeatMachineSetDelayTime(pBeatMachine, i, nDelaySteps);
+		}
+
+		if (nSendMask & (1 << i))
+		{
+			BeatMachineSetSend(pBeatMachine, i, BM_BUS_DELAY, 0.2f);
+			BeatMachineSetSend(pBeatMachine, i, BM_BUS_FILTER, 0.3f);
+		}
+	}
+
+	BeatMachinePlayTheBeat(pBeatMachine, nLoops);
+
+	int nPrerenderFrames = 0;
+	int nPrerenderStart = -1;
+	if (nPrerenderKB > 0 && BeatMachineBeginPrerender(pBeatMachine, nPrerenderKB * 1024) != BM_PRERENDER_OK)
+		fprintf(stderr, "bmrender: can't prerender, error %d\n", pBeatMachine->prerender.nError);
+
+	int nMaxFrames = nMaxSeconds * nSampleRate;
+	int nFrameCount = 0;
+	int nFrameCapacity = 0;
+	int16_t* pFrames = NULL;
+
+	int nSeekFrame = fSeekSeconds >= 0.0 ? (int)(fSeekSeconds * nSampleRate) : -1;
+	int bSeekCalled = 0;
+
+	// loops of 0 play forever, the -t cap ends those
+	while (HostSoundIsActive() && nFrameCount < nMaxFrames)
+	{
+		if (nFrameCount + RENDER_BLOCK_FRAMES > nFrameCapacity)
+		{
+			nFrameCapacity = nFrameCapacity ? nFrameCapacity * 2 : nSampleRate * 8;
+			pFrames = realloc(pFrames, nFrameCapacity * 2 * sizeof(int16_t));
+			if (pFrames == NULL)
+			{
+				fprintf(stderr, "bmrender: out of memory\n");
+				return 1;
+			}
+		}
+
+		int nBlockFrames = RENDER_BLOCK_FRAMES;
+
+		if (nSeekFrame >= 0 && (!bSeekCalled || pBeatMachine->seek.bPending))
+		{
+			nBlockFrames = nSampleRate / RENDER_FRAME_RATE;
+
+			if (!bSeekCalled && nFrameCount >= nSeekFrame)
+			{
+				bSeekCalled = 1;
+				if (BeatMachineSeekToLabel(pBeatMachine, szSeekLabel) != 0)
+					fprintf(stderr, "bmrender: can't seek to %s\n", szSeekLabel);
+			}
+
+			BeatMachineUpdateSeek(pBeatMachine);
+		}
+
+		if (bEvents || nTriggerQuantum > 0)
+		{
+			nBlockFrames = nSampleRate / RENDER_FRAME_RATE;
+
+			eventStats.nNow = api.sound->getCurrentTime();
+			BeatMachineDispatchEvents(pBeatMachine);
+		}
+
+		if (nTriggerQuantum > 0)
+		{
+			RenderTriggerStats* pTrigger = pTriggerStats;
+			const HostSoundStats* pHostStats = HostSoundGetStats();
+			uint32_t nNow = api.sound->getCurrentTime();
+
+			// measured once the sample has started and the step it is on has come by
+			uint32_t nStepTime = pTrigger->nStepTimes[pTrigger->nTargetStep];
+			if (pTrigger->bWaiting && pHostStats->nLastScheduledStart != pTrigger->nLastStart && (int32_t)(nStepTime - pTrigger->nCallTime) >= 0)
+			{
+				double fError = fabs((double)(int32_t)(pHostStats->nLastScheduledStart - nStepTime));
+				pTrigger->fErrorSum += fError;
+				if (fError > pTrigger->fMaxError)
+					pTrigger->fMaxError = fError;
+
+				double fGrid = eventStats.fFramesPerStep * nTriggerQuantum;
+				double fEarly = fmod((double)(nStepTime - pTrigger->nCallTime), fGrid);
+				pTrigger->fFrameErrorSum += fEarly < fGrid - fEarly ? fEarly : fGrid - fEarly;
+
+				pTrigger->nMeasured++;
+				pTrigger->bWaiting = 0;
+
+				// 0.3 to 1.2 s on, so the calls land all over the grid
+				nTriggerRandom = nTriggerRandom * 1103515245 + 12345;
+				nNextTrigger = nNow + HOST_DEVICE_RATE * 3 / 10 + (nTriggerRandom >> 8) % (HOST_DEVICE_RATE * 9 / 10);
+			}
+
+			if (!pTrigger->bWaiting && (int32_t)(nNow - nNextTrigger) >= 0 && pBeatMachine->pSequence && api.sound->sequence->isPlaying(pBeatMachine->pSequence))
+			{
+				if (BeatMachineTriggerQuantized(pBeatMachine, szTriggerSample, nTriggerQuantum, 1.0f) != 0)
+				{
+					fprintf(stderr, "bmrender: the beat has no sample %s\n", szTriggerSample);
+					nTriggerQuantum = 0;
+				}
+				else
+				{
+					pTrigger->bWaiting = 1;
+					pTrigger->nTargetStep = pBeatMachine->triggers.nLastStep;
+					pTrigger->nCallTime = pBeatMachine->triggers.nLastCallTime;
+					pTrigger->nLastStart = pHostStats->nLastScheduledStart;
+				}
+			}
+		}
+
+		if (nPrerenderKB > 0)
+		{
+			nBlockFrames = nSampleRate / RENDER_FRAME_RATE;
+
+			int nState = BeatMachineStepPrerender(pBeatMachine, 2000);
+			if (nState == BM_PRERENDER_RENDERING)
+				nPrerenderFrames++;
+			else if (nState == BM_PRERENDER_PLAYING && nPrerenderStart < 0)
+				nPrerenderStart = nFrameCount;
+		}
+
+		HostSoundRender(pFrames + nFrameCount * 2, nBlockFrames);
+		nFrameCount += nBlockFrames;
+	}
+
+	double fRenderSeconds = HostWallSeconds() - fLoadSeconds;
+
+	if (pBeatMachine->pMixer)
+	{
+		const BeatMixerStats* pMixerStats = BeatMixerGetStats(pBeatMachine->pMixer);
+		printf("mixer: %s kernel, %llu voice frames (%llu pitched or padded), peak %d voices\n", nMixer == 1 ? "reference" : "packed",
+			(unsigned long long)pMixerStats->nVoiceFrames, (unsigned long long)pMixerStats->nResampledFrames, pMixerStats->nPeakVoices);
+
+		printf("voice pool: %d voices, %u notes, %u stolen, %u over a track limit\n", nMixerVoices, pMixerStats->nNotes,
+			pMixerStats->nStolenVoices, pMixerStats->nLimitedVoices);
+
+		// share of the mixed blocks that had at least n voices playing
+		uint32_t nAtLeast = 0;
+		printf("occupancy:");
+		for (int n = nMixerVoices; n > 0; n--)
+		{
+			nAtLeast += pMixerStats->nOccupancy[n];
+			if (pMixerStats->nOccupancy[n] || n == 1)
+				printf(" >=%d %.1f%%", n, pMixerStats->nBlocks ? 100.0 * nAtLeast / pMixerStats->nBlocks : 0.0);
+		}
+		printf("\n");
+	}
+
+	if (pBeatMachine->pDelayPool)
+	{
+		const BeatDelayPool* pPool = pBeatMachine->pDelayPool;
+		int nUsed = 0;
+		for (int i = 0; i < pPool->nLineCount; i++)
+			nUsed += pPool->lines[i].bInUse;
+
+		printf("delay pool: %d of %d lines, %d KB, %d tracks left dry\n", nUsed, pPool->nLineCount, pPool->nBytes / 1024, pPool->nDenied);
+	}
+
+	if (pBeatMachine->seek.nSeekCount > 0)
+	{
+		const BeatSeek* pSeek = &pBeatMachine->seek;
+		printf("seek: %s at step %d, on step %d, %.1f ms after the call, %d steps late\n", szSeekLabel, pSeek->nTargetStep, pSeek->nBarStep,
+			pSeek->nLastLatency * 1000.0 / HOST_DEVICE_RATE, pSeek->nLastLateSteps);
+	}
+
+	if (pTriggerStats->nMeasured > 0)
+	{
+		printf("triggers: %d on a %d step grid, %.2f frames off on average, %.2f at most, %.1f ms off on average when played on the frame\n",
+			pTriggerStats->nMeasured, nTriggerQuantum, pTriggerStats->fErrorSum / pTriggerStats->nMeasured, pTriggerStats->fMaxError,
+			pTriggerStats->fFrameErrorSum / pTriggerStats->nMeasured * 1000.0 / HOST_DEVICE_RATE);
+	}
+
+	free(pTriggerStats);
+
+	if (nPrerenderKB > 0)
+	{
+		const BeatPrerender* pRender = &pBeatMachine->prerender;
+		if (nPrerenderStart >= 0)
+		{
+			printf("prerender: steps %d - %d, %d notes into %.1f KB in %.1f ms over %d frames, played from %.2f s, %d resyncs, %u clipped samples\n",
+				pRender->nFirstStep, pRender->nFirstStep + pRender->nStepCount - 1, pRender->nNotesMixed, pRender->nBytes / 1024.0,
+				pRender->fRenderTime * 1000.0, nPrerenderFrames + 1, (double)nPrerenderStart / nSampleRate, pRender->nResyncs, pRender->nClippedSamples);
+		}
+		else
+		{
+			printf("prerender: never played, error %d\n", pRender->nError);
+		}
+	}
+
+	for (int i = 0; i < BM_MAX_TRACK; i++)
+	{
+		BeatFreezeCost cost;
+		if ((nFreezeMask & (1 << i)) && pBeatMachine->pTracks[i] && pBeatMachine->pTracks[i]->pFrozen
+			&& BeatMachineGetFreezeCost(pBeatMachine, i, &cost) == BM_FREEZE_OK)
+		{
+			printf("freeze: track %d, %d notes on %d keys, %.1f KB of samples for %.1f voice seconds a pass and %d effects, rendered in %.1f ms\n",
+				i, cost.nNoteCount, cost.nKeyCount, cost.nSampleBytes / 1024.0, cost.fVoiceSeconds, cost.nLiveEffects, cost.fRenderTime * 1000.0);
+		}
+	}
+
+	if (bEvents)
+	{
+		printf("events: %d steps, %d beats, %d bars, %d labels, %d loops, %u dropped, steps within %.1f frames of the grid, seen up to %.1f ms after the step\n",
+			eventStats.nCounts[0], eventStats.nCounts[1], eventStats.nCounts[2], eventStats.nCounts[3], eventStats.nCounts[4], pBeatMachine->events.nDropped,
+			eventStats.fMaxGridError, eventStats.nMaxDelay * 1000.0 / HOST_DEVICE_RATE);
+	}
+
+	BeatMachineDestroy(pBeatMachine);
+
+	int bWritten = WriteWav(szOutput, pFrames, nFrameCount, nSampleRate);
+	free(pFrames);
+
+	if (!bWritten)
+		return 1;
+
+	const HostSoundStats* pStats = HostSoundGetStats();
+	double fAudioSeconds = (double)nFrameCount / nSampleRate;
+
+	printf("%s: %.2f s of audio at %d Hz in %.3f s (%.1fx real time), load %.1f ms\n", szOutput, fAudioSeconds, nSampleRate, fRenderSeconds, fRenderSeconds > 0.0 ? fAudioSeconds / fRenderSeconds : 0.0, fLoadSeconds * 1000.0);
+	printf("notes %d, peak voices %d, stolen voices %d, %.1f voices on average, %llu clipped samples\n", pStats->nNoteCount, pStats->nPeakVoices, pStats->nStolenVoices, nFrameCount ? (double)pStats->nVoiceFrames / nFrameCount : 0.0, (unsigned long long)pStats->nClippedSamples);
+
+	return 0;
+}
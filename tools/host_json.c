@@ -0,0 +1,354 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_json.h"
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	json_decoder* pDecoder;
+
+	const char* pText;
+	int nPos;
+	int nLine;
+	int bError;
+
+} HostJsonParser;
+
+
+// --------------------------------------------------------------------------------
+static void HostJsonSkipSpace(HostJsonParser* pParser)
+{
+	for (;;)
+	{
+		char c = pParser->pText[pParser->nPos];
+		if (c == '\n')
+			pParser->nLine++;
+
+		if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+			pParser->nPos++;
+		else
+			break;
+	}
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostJsonError(HostJsonParser* pParser, const char* szError)
+{
+	if (!pParser->bError && pParser->pDecoder->decodeError)
+		pParser->pDecoder->decodeError(pParser->pDecoder, szError, pParser->nLine);
+
+	pParser->bError = 1;
+}
+
+
+// --------------------------------------------------------------------------------
+// The string without its quotes and escapes, freed by the caller. \uXXXX is kept
+// as it is, .bmf files don't use it.
+// --------------------------------------------------------------------------------
+static char* HostJsonParseString(HostJsonParser* pParser)
+{
+	pParser->nPos++;
+
+	int nStart = pParser->nPos;
+	while (pParser->pText[pParser->nPos] && pParser->pText[pParser->nPos] != '"')
+	{
+		if (pParser->pText[pParser->nPos] == '\\' && pParser->pText[pParser->nPos + 1])
+			pParser->nPos++;
+		pParser->nPos++;
+	}
+
+	if (pParser->pText[pParser->nPos] != '"')
+	{
+		HostJsonError(pParser, "unterminated string");
+		return NULL;
+	}
+
+	int nLen = pParser->nPos - nStart;
+	char* szString = malloc(nLen + 1);
+
+	int nOut = 0;
+	for (int i = 0; i < nLen; i++)
+	{
+		char c = pParser->pText[nStart + i];
+		if (c == '\\')
+		{
+			c = pParser->pText[nStart + ++i];
+			c = c == 'n' ? '\n' : (c == 't' ? '\t' : (c == 'r' ? '\r' : c));
+		}
+		szString[nOut++] = c;
+	}
+	szString[nOut] = '\0';
+
+	pParser->nPos++;
+	return szString;
+}
+
+
+// --------------------------------------------------------------------------------
+// strings, numbers, true, false and null, the string is freed by the caller
+// --------------------------------------------------------------------------------
+static json_value HostJsonParseScalar(HostJsonParser* pParser)
+{
+	json_value value;
+	memset(&value, 0, sizeof(value));
+	value.type = kJSONNull;
+
+	const char* pText = pParser->pText + pParser->nPos;
+
+	if (*pText == '"')
+	{
+		value.data.stringval = HostJsonParseString(pParser);
+		value.type = value.data.stringval ? kJSONString : kJSONNull;
+	}
+	else if (*pText == '-' || (*pText >= '0' && *pText <= '9'))
+	{
+		char* pEnd = NULL;
+		double fNumber = strtod(pText, &pEnd);
+
+		// whole numbers without a fraction or exponent are integers, as on the device
+		int bInteger = 1;
+		for (const char* p = pText; p < pEnd; p++)
+		{
+			if (*p == '.' || *p == 'e' || *p == 'E')
+				bInteger = 0;
+		}
+
+		value.type = bInteger ? kJSONInteger : kJSONFloat;
+		if (bInteger)
+			value.data.intval = (int)strtol(pText, NULL, 10);
+		else
+			value.data.floatval = (float)fNumber;
+
+		pParser->nPos += (int)(pEnd - pText);
+	}
+	else if (strncmp(pText, "true", 4) == 0)
+	{
+		value.type = kJSONTrue;
+		pParser->nPos += 4;
+	}
+	else if (strncmp(pText, "false", 5) == 0)
+	{
+		value.type = kJSONFalse;
+		pParser->nPos += 5;
+	}
+	else if (strncmp(pText, "null", 4) == 0)
+	{
+		pParser->nPos += 4;
+	}
+	else
+	{
+		HostJsonError(pParser, "unexpected character");
+	}
+
+	return value;
+}
+
+
+// --------------------------------------------------------------------------------
+// A table or array: willDecodeSublist, a should/did pair for every value and
+// didDecodeSublist, whose result is the value of the list. Array positions count
+// from 1 like on the device.
+// --------------------------------------------------------------------------------
+static json_value HostJsonParseList(HostJsonParser* pParser, const char* szName)
+{
+	json_decoder* pDecoder = pParser->pDecoder;
+
+	char cEnd = pParser->pText[pParser->nPos] == '{' ? '}' : ']';
+	json_value_type nType = cEnd == '}' ? kJSONTable : kJSONArray;
+	pParser->nPos++;
+
+	if (pDecoder->willDecodeSublist)
+		pDecoder->willDecodeSublist(pDecoder, szName, nType);
+
+	HostJsonSkipSpace(pParser);
+	int bEmpty = pParser->pText[pParser->nPos] == cEnd;
+	if (bEmpty)
+		pParser->nPos++;
+
+	for (int nPos = 1; !bEmpty && !pParser->bError; nPos++)
+	{
+		char* szKey = NULL;
+		char szIndex[16];
+
+		if (nType == kJSONTable)
+		{
+			HostJsonSkipSpace(pParser);
+			if (pParser->pText[pParser->nPos] != '"')
+			{
+				HostJsonError(pParser, "expected a key");
+				break;
+			}
+
+			szKey = HostJsonParseString(pParser);
+			if (szKey == NULL)
+				break;
+
+			HostJsonSkipSpace(pParser);
+			if (pParser->pText[pParser->nPos] != ':')
+			{
+				HostJsonError(pParser, "expected ':'");
+				free(szKey);
+				break;
+			}
+			pParser->nPos++;
+		}
+		else
+		{
+			snprintf(szIndex, sizeof(szIndex), "[%d]", nPos);
+		}
+
+		// a value the callbacks don't want is still parsed, its callbacks go nowhere
+		int bWanted = 1;
+		if (nType == kJSONTable && pDecoder->shouldDecodeTableValueForKey)
+			bWanted = pDecoder->shouldDecodeTableValueForKey(pDecoder, szKey);
+		else if (nType == kJSONArray && pDecoder->shouldDecodeArrayValueAtIndex)
+			bWanted = pDecoder->shouldDecodeArrayValueAtIndex(pDecoder, nPos);
+
+		json_decoder skip;
+		memset(&skip, 0, sizeof(skip));
+		if (!bWanted)
+			pParser->pDecoder = &skip;
+
+		HostJsonSkipSpace(pParser);
+		char cValue = pParser->pText[pParser->nPos];
+
+		json_value value = (cValue == '{' || cValue == '[') ? HostJsonParseList(pParser, szKey ? szKey : szIndex) : HostJsonParseScalar(pParser);
+
+		pParser->pDecoder = pDecoder;
+
+		if (bWanted && !pParser->bError)
+		{
+			if (nType == kJSONTable && pDecoder->didDecodeTableValue)
+				pDecoder->didDecodeTableValue(pDecoder, szKey, value);
+			else if (nType == kJSONArray && pDecoder->didDecodeArrayValue)
+				pDecoder->didDecodeArrayValue(pDecoder, nPos, value);
+		}
+
+		if (value.type == kJSONString)
+			free(value.data.stringval);
+		free(szKey);
+
+		HostJsonSkipSpace(pParser);
+		char c = pParser->pText[pParser->nPos];
+		if (c == ',')
+		{
+			pParser->nPos++;
+		}
+		else if (c == cEnd)
+		{
+			pParser->nPos++;
+			break;
+		}
+		else
+		{
+			HostJsonError(pParser, "expected ',' or end of list");
+		}
+	}
+
+	json_value value;
+	memset(&value, 0, sizeof(value));
+	value.type = nType;
+
+	if (!pParser->bError && pDecoder->didDecodeSublist)
+		value.data.tableval = pDecoder->didDecodeSublist(pDecoder, szName, nType);
+
+	return value;
+}
+
+
+// --------------------------------------------------------------------------------
+static int HostJsonDecodeString(json_decoder* pDecoder, const char* szJson, json_value* pOutValue)
+{
+	HostJsonParser parser;
+	memset(&parser, 0, sizeof(parser));
+	parser.pDecoder = pDecoder;
+	parser.pText = szJson;
+	parser.nLine = 1;
+
+	HostJsonSkipSpace(&parser);
+	char c = szJson[parser.nPos];
+
+	json_value value = (c == '{' || c == '[') ? HostJsonParseList(&parser, "_root") : HostJsonParseScalar(&parser);
+
+	if (value.type == kJSONString)
+		free(value.data.stringval);
+
+	if (pOutValue)
+	{
+		*pOutValue = value;
+		if (value.type == kJSONString)
+			pOutValue->type = kJSONNull;
+	}
+
+	return parser.bError ? 0 : 1;
+}
+
+
+// --------------------------------------------------------------------------------
+// the reader is drained into one string first, .bmf files are small enough
+// --------------------------------------------------------------------------------
+static int HostJsonDecode(json_decoder* pDecoder, json_reader reader, json_value* pOutValue)
+{
+	int nSize = 0;
+	int nCapacity = 4096;
+	char* szJson = malloc(nCapacity);
+
+	for (;;)
+	{
+		if (nCapacity - nSize < 1024)
+		{
+			nCapacity *= 2;
+			szJson = realloc(szJson, nCapacity);
+		}
+
+		int nRead = reader.read(reader.userdata, (uint8_t*)szJson + nSize, nCapacity - nSize - 1);
+		if (nRead <= 0)
+			break;
+
+		nSize += nRead;
+	}
+
+	szJson[nSize] = '\0';
+
+	int nResult = HostJsonDecodeString(pDecoder, szJson, pOutValue);
+	free(szJson);
+
+	return nResult;
+}
+
+
+// --------------------------------------------------------------------------------
+static const struct playdate_json jsonApi =
+{
+	.decode = HostJsonDecode,
+	.decodeString = HostJsonDecodeString,
+};
+
+
+// --------------------------------------------------------------------------------
+const struct playdate_json* HostJsonGetAPI(void)
+{
+	return &jsonApi;
+}
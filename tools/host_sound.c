@@ -0,0 +1,2285 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// The models are simple on purpose: naive oscillators, a linear ADSR, linearly
+// interpolated samples and textbook biquads. They are close enough to listen to a
+// beat and to compare what beats cost, not to match the device sample for sample.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "host_sound.h"
+
+
+// --------------------------------------------------------------------------------
+#define HOST_TWO_PI		6.28318531f
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	HOST_SOURCE_SYNTH,
+	HOST_SOURCE_INSTRUMENT,
+	HOST_SOURCE_CALLBACK,
+	HOST_SOURCE_PLAYER,
+
+	HOST_EFFECT_FILTER,
+	HOST_EFFECT_DELAY,
+	HOST_EFFECT_CRUSHER,
+	HOST_EFFECT_CUSTOM,
+
+	HOST_ENV_IDLE,
+	HOST_ENV_ATTACK,
+	HOST_ENV_DECAY,
+	HOST_ENV_SUSTAIN,
+	HOST_ENV_RELEASE,
+
+	HOST_MAX_OBJECTS = 256,
+	HOST_GENERATOR_ONE = 1 << 24,	// generators render Q8.24
+	HOST_MAX_CHUNK = 256,
+	HOST_CRUSHER_MAX_HOLD = 32
+
+} HOST_INTERNAL_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+// The pd->sound types are opaque, every object here starts with its kind so a
+// SoundSource* handed to a channel can be told apart.
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int nKind;
+
+} HostSource;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int16_t* pFrames;			// converted to 16 bit stereo
+	int nFrameCount;
+	int nSampleRate;
+
+	uint8_t* pData;				// the data as it is in the file, for getData()
+	int nByteLength;
+	SoundFormat format;
+
+} HostSample;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	HostSource source;
+
+	SoundWaveform nWaveform;
+	HostSample* pSample;
+
+	// set by setGenerator(), the synth's own oscillator and sample are off
+	synthRenderFunc pfnRender;
+	synthNoteOnFunc pfnNoteOn;
+	synthReleaseFunc pfnRelease;
+	synthDeallocFunc pfnDealloc;
+	synthCopyUserdata pfnCopyUserdata;
+	void* pUserdata;
+	int bStereo;					// a mono generator only gets the left buffer
+
+	float fAttack;
+	float fDecay;
+	float fSustain;
+	float fRelease;
+
+	int nStage;
+	float fLevel;
+	float fAttackRate;
+	float fDecayRate;
+	float fReleaseRate;
+	float fVelocity;
+
+	double fPhase;				// 0 - 1 for oscillators, the frame for samples
+	double fPhaseStep;
+	uint32_t nNoise;
+
+	int nOffFrames;				// frames until the note is released, -1 when held
+	uint64_t nStartFrame;		// the oldest voice is the one stolen
+
+	// a note played with a start time waits in the pending list until its frame
+	int bPending;
+	uint64_t nPendingFrame;
+	float fPendingNote;
+	float fPendingVelocity;
+	int nPendingLength;
+
+} HostSynth;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	HostSource source;
+
+	HostSynth* pVoices[HOST_MAX_VOICES];
+	float fRangeStart[HOST_MAX_VOICES];
+	float fRangeEnd[HOST_MAX_VOICES];
+	float fTranspose[HOST_MAX_VOICES];
+	int nVoiceCount;
+
+} HostInstrument;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int nKind;
+	float fMix;
+
+	// two pole filter
+	TwoPoleFilterType nFilterType;
+	float fFrequency;
+	float fResonance;
+	float fGain;
+	float b0, b1, b2, a1, a2;
+	float x1[2], x2[2], y1[2], y2[2];
+
+	// delay line
+	float* pBuffer;
+	int nCapacity;
+	int nLength;
+	int nPosition;
+	float fFeedback;
+
+	// bit crusher
+	float fAmount;
+	float fUndersampling;
+	int nHold;
+	float fHeld[2];
+
+	// made with newEffect()
+	effectProc* pfnProc;
+	void* pUserdata;
+
+} HostEffect;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	float fVolume;
+	float fPan;
+
+	HostSource* pSources[HOST_MAX_CHANNEL_SOURCES];
+	int nSourceCount;
+
+	HostEffect* pEffects[HOST_MAX_CHANNEL_EFFECTS];
+	int nEffectCount;
+
+} HostChannel;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	HostSource source;
+
+	AudioSourceFunction* pfnCallback;
+	void* pContext;
+	int bStereo;
+
+} HostCallbackSource;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	HostSource source;
+
+	HostSample* pSample;
+	double fPosition;			// in frames of the sample
+	float fRate;
+	int nRepeat;				// 0 loops until stopped
+	int bPlaying;
+
+	float fLeft;
+	float fRight;
+
+} HostSamplePlayer;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	uint32_t nStep;
+	uint32_t nLen;
+	float fNote;
+	float fVelocity;
+
+} HostNote;
+
+
+// --------------------------------------------------------------------------------
+typedef struct HostSequence HostSequence;
+
+typedef struct
+{
+	HostSequence* pSequence;
+	HostInstrument* pInstrument;
+	int bMuted;
+
+	HostNote* pNotes;			// in step order
+	int nNoteCount;
+	int nNoteCapacity;
+	int nCursor;				// first note at or after the next step
+
+} HostTrack;
+
+
+// --------------------------------------------------------------------------------
+struct HostSequence
+{
+	HostTrack* pTracks[HOST_MAX_SEQUENCE_TRACKS];
+	int nTrackCount;
+
+	float fStepsPerSecond;
+
+	int nLoopStart;
+	int nLoopEnd;
+	int nLoops;					// 0 loops forever
+	int nLoopsPlayed;
+
+	int bPlaying;
+	int nStep;					// next step to start
+	int nCurrentStep;			// step that is playing
+	double fFramesToStep;
+
+};
+
+
+// --------------------------------------------------------------------------------
+static int nRate = HOST_DEVICE_RATE;
+static const char* szRootPath = "";
+static uint64_t nFrame = 0;
+
+static HostChannel* pChannels[HOST_MAX_OBJECTS];
+static int nChannelCount = 0;
+static HostChannel* pDefaultChannel = NULL;
+
+static HostSequence* pSequences[HOST_MAX_OBJECTS];
+static int nSequenceCount = 0;
+
+static HostSynth* pPendingSynths[HOST_MAX_OBJECTS];
+static int nPendingCount = 0;
+
+static HostSoundStats stats;
+
+
+// --------------------------------------------------------------------------------
+static void* HostAlloc(size_t nSize)
+{
+	void* pData = calloc(1, nSize);
+	if (pData == NULL)
+	{
+		fprintf(stderr, "host sound: out of memory\n");
+		exit(1);
+	}
+
+	return pData;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostRegister(void** pList, int* pCount, void* pObject)
+{
+	if (*pCount < HOST_MAX_OBJECTS)
+		pList[(*pCount)++] = pObject;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostUnregister(void** pList, int* pCount, void* pObject)
+{
+	for (int i = 0; i < *pCount; i++)
+	{
+		if (pList[i] == pObject)
+		{
+			pList[i] = pList[--(*pCount)];
+			return;
+		}
+	}
+}
+
+
+// --------------------------------------------------------------------------------
+// samples
+// --------------------------------------------------------------------------------
+static uint32_t HostReadLE(const uint8_t* p, int nBytes)
+{
+	uint32_t nValue = 0;
+	for (int i = nBytes - 1; i >= 0; i--)
+		nValue = (nValue << 8) | p[i];
+
+	return nValue;
+}
+
+
+// --------------------------------------------------------------------------------
+static HostSample* HostSampleCreate(const uint8_t* pData, int nDataSize, int nChannels, int nBits, int nSampleRate)
+{
+	HostSample* pSample = HostAlloc(sizeof(HostSample));
+
+	int nFrameBytes = nChannels * nBits / 8;
+	pSample->nFrameCount = nDataSize / nFrameBytes;
+	pSample->nSampleRate = nSampleRate;
+	pSample->pFrames = HostAlloc(pSample->nFrameCount * 2 * sizeof(int16_t) + 1);
+
+	for (int i = 0; i < pSample->nFrameCount; i++)
+	{
+		for (int c = 0; c < 2; c++)
+		{
+			const uint8_t* p = pData + i * nFrameBytes + (c < nChannels ? c : 0) * (nBits / 8);
+			pSample->pFrames[i * 2 + c] = nBits == 16 ? (int16_t)HostReadLE(p, 2) : (int16_t)((p[0] - 128) << 8);
+		}
+	}
+
+	pSample->nByteLength = nDataSize;
+	pSample->pData = HostAlloc(nDataSize + 1);
+	memcpy(pSample->pData, pData, nDataSize);
+
+	if (nBits == 16)
+		pSample->format = nChannels == 2 ? kSound16bitStereo : kSound16bitMono;
+	else
+		pSample->format = nChannels == 2 ? kSound8bitStereo : kSound8bitMono;
+
+	return pSample;
+}
+
+
+// --------------------------------------------------------------------------------
+static AudioSample* HostSampleLoad(const char* szPath)
+{
+	char szFullPath[1024];
+	snprintf(szFullPath, sizeof(szFullPath), "%s%s.wav", szRootPath, szPath);
+
+	FILE* file = fopen(szFullPath, "rb");
+	if (file == NULL)
+		return NULL;
+
+	fseek(file, 0, SEEK_END);
+	long nFileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	uint8_t* pFile = HostAlloc(nFileSize);
+	int bRead = fread(pFile, 1, nFileSize, file) == (size_t)nFileSize;
+	fclose(file);
+
+	if (!bRead || nFileSize < 12 || memcmp(pFile, "RIFF", 4) != 0 || memcmp(pFile + 8, "WAVE", 4) != 0)
+	{
+		free(pFile);
+		return NULL;
+	}
+
+	int nChannels = 0;
+	int nBits = 0;
+	int nSampleRate = 0;
+	const uint8_t* pData = NULL;
+	int nDataSize = 0;
+
+	for (long nPos = 12; nPos + 8 <= nFileSize;)
+	{
+		uint32_t nChunkSize = HostReadLE(pFile + nPos + 4, 4);
+		const uint8_t* pChunk = pFile + nPos + 8;
+
+		if (nPos + 8 + (long)nChunkSize > nFileSize)
+			nChunkSize = (uint32_t)(nFileSize - nPos - 8);
+
+		if (memcmp(pFile + nPos, "fmt ", 4) == 0 && nChunkSize >= 16 && HostReadLE(pChunk, 2) == 1)
+		{
+			nChannels = HostReadLE(pChunk + 2, 2);
+			nSampleRate = HostReadLE(pChunk + 4, 4);
+			nBits = HostReadLE(pChunk + 14, 2);
+		}
+		else if (memcmp(pFile + nPos, "data", 4) == 0)
+		{
+			pData = pChunk;
+			nDataSize = nChunkSize;
+		}
+
+		nPos += 8 + nChunkSize + (nChunkSize & 1);
+	}
+
+	// only what pdc would accept as PCM
+	if (pData == NULL || (nChannels != 1 && nChannels != 2) || (nBits != 8 && nBits != 16) || nSampleRate <= 0)
+	{
+		free(pFile);
+		return NULL;
+	}
+
+	HostSample* pSample = HostSampleCreate(pData, nDataSize, nChannels, nBits, nSampleRate);
+
+	free(pFile);
+
+	return (AudioSample*)pSample;
+}
+
+
+// --------------------------------------------------------------------------------
+// The sample keeps its own copy, the caller's data can go right away.
+// --------------------------------------------------------------------------------
+static AudioSample* HostSampleNewFromData(uint8_t* data, SoundFormat format, uint32_t sampleRate, int byteCount, int shouldFreeData)
+{
+	if (data == NULL || byteCount <= 0 || sampleRate == 0)
+		return NULL;
+
+	int nChannels = (format == kSound8bitStereo || format == kSound16bitStereo) ? 2 : 1;
+	int nBits = (format == kSound16bitMono || format == kSound16bitStereo) ? 16 : 8;
+
+	HostSample* pSample = HostSampleCreate(data, byteCount, nChannels, nBits, (int)sampleRate);
+
+	if (shouldFreeData)
+		free(data);
+
+	return (AudioSample*)pSample;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSampleFree(AudioSample* sample)
+{
+	HostSample* pSample = (HostSample*)sample;
+	if (pSample == NULL)
+		return;
+
+	free(pSample->pFrames);
+	free(pSample->pData);
+	free(pSample);
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSampleGetData(AudioSample* sample, uint8_t** data, SoundFormat* format, uint32_t* sampleRate, uint32_t* bytelength)
+{
+	HostSample* pSample = (HostSample*)sample;
+
+	if (data)			*data = pSample->pData;
+	if (format)			*format = pSample->format;
+	if (sampleRate)		*sampleRate = pSample->nSampleRate;
+	if (bytelength)		*bytelength = pSample->nByteLength;
+}
+
+
+// --------------------------------------------------------------------------------
+static float HostSampleGetLength(AudioSample* sample)
+{
+	HostSample* pSample = (HostSample*)sample;
+
+	return (float)pSample->nFrameCount / pSample->nSampleRate;
+}
+
+
+// --------------------------------------------------------------------------------
+// synths
+// --------------------------------------------------------------------------------
+static PDSynth* HostSynthNew(void)
+{
+	HostSynth* pSynth = HostAlloc(sizeof(HostSynth));
+
+	// the device default is an organ style envelope that holds until the note ends
+	pSynth->source.nKind = HOST_SOURCE_SYNTH;
+	pSynth->nWaveform = kWaveformSquare;
+	pSynth->fSustain = 1.0f;
+	pSynth->nStage = HOST_ENV_IDLE;
+	pSynth->nNoise = 0x12345678;
+
+	return (PDSynth*)pSynth;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSynthClearGenerator(HostSynth* pSynth)
+{
+	if (pSynth->pfnDealloc)
+		pSynth->pfnDealloc(pSynth->pUserdata);
+
+	pSynth->pfnRender = NULL;
+	pSynth->pfnNoteOn = NULL;
+	pSynth->pfnRelease = NULL;
+	pSynth->pfnDealloc = NULL;
+	pSynth->pfnCopyUserdata = NULL;
+	pSynth->pUserdata = NULL;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSynthFree(PDSynth* synth)
+{
+	HostUnregister((void**)pPendingSynths, &nPendingCount, synth);
+	HostSynthClearGenerator((HostSynth*)synth);
+	free(synth);
+}
+
+
+// --------------------------------------------------------------------------------
+static PDSynth* HostSynthCopy(PDSynth* synth)
+{
+	HostSynth* pCopy = HostAlloc(sizeof(HostSynth));
+	memcpy(pCopy, synth, sizeof(HostSynth));
+	pCopy->bPending = 0;
+
+	pCopy->nStage = HOST_ENV_IDLE;
+	pCopy->fLevel = 0.0f;
+
+	if (pCopy->pfnCopyUserdata)
+		pCopy->pUserdata = pCopy->pfnCopyUserdata(pCopy->pUserdata);
+
+	return (PDSynth*)pCopy;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSynthSetWaveform(PDSynth* synth, SoundWaveform wave)
+{
+	HostSynth* pSynth = (HostSynth*)synth;
+
+	HostSynthClearGenerator(pSynth);
+	pSynth->nWaveform = wave;
+	pSynth->pSample = NULL;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSynthSetSample(PDSynth* synth, AudioSample* sample, uint32_t sustainStart, uint32_t sustainEnd)
+{
+	HostSynthClearGenerator((HostSynth*)synth);
+	((HostSynth*)synth)->pSample = (HostSample*)sample;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSynthSetGenerator(PDSynth* synth, int stereo, synthRenderFunc render, synthNoteOnFunc noteOn, synthReleaseFunc release, synthSetParameterFunc setparam, synthDeallocFunc dealloc, synthCopyUserdata copyUserdata, void* userdata)
+{
+	HostSynth* pSynth = (HostSynth*)synth;
+
+	HostSynthClearGenerator(pSynth);
+
+	pSynth->pSample = NULL;
+	pSynth->pfnRender = render;
+	pSynth->pfnNoteOn = noteOn;
+	pSynth->pfnRelease = release;
+	pSynth->pfnDealloc = dealloc;
+	pSynth->pfnCopyUserdata = copyUserdata;
+	pSynth->pUserdata = userdata;
+	pSynth->bStereo = stereo;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSynthSetAttackTime(PDSynth* synth, float attack)		{ ((HostSynth*)synth)->fAttack = attack; }
+static void HostSynthSetDecayTime(PDSynth* synth, float decay)			{ ((HostSynth*)synth)->fDecay = decay; }
+static void HostSynthSetSustainLevel(PDSynth* synth, float sustain)		{ ((HostSynth*)synth)->fSustain = sustain; }
+static void HostSynthSetReleaseTime(PDSynth* synth, float release)		{ ((HostSynth*)synth)->fRelease = release; }
+
+
+// --------------------------------------------------------------------------------
+static int HostSynthIsPlaying(PDSynth* synth)
+{
+	return ((HostSynth*)synth)->nStage != HOST_ENV_IDLE;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSynthNoteOn(HostSynth* pSynth, float fNote, float fVelocity, int nLengthFrames)
+{
+	if (pSynth->pfnNoteOn)
+	{
+		pSynth->fPhaseStep = 440.0 * pow(2.0, (fNote - 69.0f) / 12.0) / nRate;
+		pSynth->pfnNoteOn(pSynth->pUserdata, fNote, fVelocity, nLengthFrames >= 0 ? (float)nLengthFrames / nRate : -1.0f);
+	}
+	else if (pSynth->pSample)
+	{
+		// a sample is pitched from middle C and resampled to the output rate
+		pSynth->fPhase = 0.0;
+		pSynth->fPhaseStep = (double)pSynth->pSample->nSampleRate / nRate * pow(2.0, (fNote - HOST_MIDDLE_C) / 12.0);
+	}
+	else
+	{
+		double fFrequency = 440.0 * pow(2.0, (fNote - 69.0f) / 12.0);
+		pSynth->fPhase = 0.0;
+		pSynth->fPhaseStep = fFrequency / nRate;
+	}
+
+	pSynth->fVelocity = fVelocity;
+	pSynth->nOffFrames = nLengthFrames;
+	pSynth->nStartFrame = nFrame;
+
+	pSynth->fAttackRate = pSynth->fAttack > 0.0f ? 1.0f / (pSynth->fAttack * nRate) : 1.0f;
+	pSynth->fDecayRate = pSynth->fDecay > 0.0f ? (1.0f - pSynth->fSustain) / (pSynth->fDecay * nRate) : 1.0f;
+
+	pSynth->fLevel = 0.0f;
+	pSynth->nStage = HOST_ENV_ATTACK;
+
+	stats.nNoteCount++;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSynthNoteOff(HostSynth* pSynth)
+{
+	if (pSynth->nStage == HOST_ENV_IDLE || pSynth->nStage == HOST_ENV_RELEASE)
+		return;
+
+	if (pSynth->pfnRelease)
+		pSynth->pfnRelease(pSynth->pUserdata, 0);
+
+	if (pSynth->fRelease <= 0.0f || pSynth->fLevel <= 0.0f)
+	{
+		pSynth->nStage = HOST_ENV_IDLE;
+		pSynth->fLevel = 0.0f;
+		return;
+	}
+
+	pSynth->fReleaseRate = pSynth->fLevel / (pSynth->fRelease * nRate);
+	pSynth->nStage = HOST_ENV_RELEASE;
+}
+
+
+// --------------------------------------------------------------------------------
+// when is in the 44.1 kHz frames of pd->sound->getCurrentTime(), a time that has
+// passed plays straight away. len is in seconds, below 0 the note is held.
+// --------------------------------------------------------------------------------
+static void HostSynthPlayMIDINote(PDSynth* synth, MIDINote note, float vel, float len, uint32_t when)
+{
+	HostSynth* pSynth = (HostSynth*)synth;
+
+	int nLengthFrames = len >= 0.0f ? (int)(len * nRate) : -1;
+	uint64_t nWhenFrame = (uint64_t)when * nRate / HOST_DEVICE_RATE;
+
+	if (when == 0 || nWhenFrame <= nFrame)
+	{
+		HostUnregister((void**)pPendingSynths, &nPendingCount, pSynth);
+		pSynth->bPending = 0;
+
+		HostSynthNoteOn(pSynth, note, vel, nLengthFrames);
+		return;
+	}
+
+	if (!pSynth->bPending)
+		HostRegister((void**)pPendingSynths, &nPendingCount, pSynth);
+
+	pSynth->bPending = 1;
+	pSynth->nPendingFrame = nWhenFrame;
+	pSynth->fPendingNote = note;
+	pSynth->fPendingVelocity = vel;
+	pSynth->nPendingLength = nLengthFrames;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSynthPlayNote(PDSynth* synth, float freq, float vel, float len, uint32_t when)
+{
+	HostSynthPlayMIDINote(synth, 69.0f + 12.0f * log2f(freq / 440.0f), vel, len, when);
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSynthPlayNoteOff(PDSynth* synth, uint32_t when)
+{
+	HostSynth* pSynth = (HostSynth*)synth;
+
+	HostUnregister((void**)pPendingSynths, &nPendingCount, pSynth);
+	pSynth->bPending = 0;
+
+	HostSynthNoteOff(pSynth);
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSynthStop(PDSynth* synth)
+{
+	HostSynth* pSynth = (HostSynth*)synth;
+
+	HostUnregister((void**)pPendingSynths, &nPendingCount, pSynth);
+	pSynth->bPending = 0;
+
+	pSynth->nStage = HOST_ENV_IDLE;
+	pSynth->fLevel = 0.0f;
+}
+
+
+// --------------------------------------------------------------------------------
+// Starts the pending notes that are due and returns the frames to the next one.
+// --------------------------------------------------------------------------------
+static int HostStartPendingNotes(int nChunk)
+{
+	for (int i = 0; i < nPendingCount; i++)
+	{
+		HostSynth* pSynth = pPendingSynths[i];
+
+		if (pSynth->nPendingFrame <= nFrame)
+		{
+			pPendingSynths[i--] = pPendingSynths[--nPendingCount];
+			pSynth->bPending = 0;
+
+			HostSynthNoteOn(pSynth, pSynth->fPendingNote, pSynth->fPendingVelocity, pSynth->nPendingLength);
+			stats.nLastScheduledStart = (uint32_t)(nFrame * HOST_DEVICE_RATE / nRate);
+		}
+		else if (pSynth->nPendingFrame - nFrame < (uint64_t)nChunk)
+		{
+			nChunk = (int)(pSynth->nPendingFrame - nFrame);
+		}
+	}
+
+	return nChunk;
+}
+
+
+// --------------------------------------------------------------------------------
+static float HostSynthEnvelope(HostSynth* pSynth)
+{
+	switch (pSynth->nStage)
+	{
+	case HOST_ENV_ATTACK:
+		pSynth->fLevel += pSynth->fAttackRate;
+		if (pSynth->fLevel >= 1.0f)
+		{
+			pSynth->fLevel = 1.0f;
+			pSynth->nStage = HOST_ENV_DECAY;
+		}
+		break;
+
+	case HOST_ENV_DECAY:
+		pSynth->fLevel -= pSynth->fDecayRate;
+		if (pSynth->fLevel <= pSynth->fSustain)
+		{
+			pSynth->fLevel = pSynth->fSustain;
+			pSynth->nStage = HOST_ENV_SUSTAIN;
+		}
+		break;
+
+	case HOST_ENV_RELEASE:
+		pSynth->fLevel -= pSynth->fReleaseRate;
+		if (pSynth->fLevel <= 0.0f)
+		{
+			pSynth->fLevel = 0.0f;
+			pSynth->nStage = HOST_ENV_IDLE;
+		}
+		break;
+	}
+
+	return pSynth->fLevel;
+}
+
+
+// --------------------------------------------------------------------------------
+static float HostSynthOscillator(HostSynth* pSynth)
+{
+	float p = (float)pSynth->fPhase;
+	float fValue;
+
+	switch (pSynth->nWaveform)
+	{
+	case kWaveformSquare:	fValue = p < 0.5f ? 1.0f : -1.0f;					break;
+	case kWaveformTriangle:	fValue = p < 0.5f ? 4.0f * p - 1.0f : 3.0f - 4.0f * p;	break;
+	case kWaveformSawtooth:	fValue = 2.0f * p - 1.0f;							break;
+
+	case kWaveformNoise:
+		pSynth->nNoise ^= pSynth->nNoise << 13;
+		pSynth->nNoise ^= pSynth->nNoise >> 17;
+		pSynth->nNoise ^= pSynth->nNoise << 5;
+		fValue = (int32_t)pSynth->nNoise / 2147483648.0f;
+		break;
+
+	// rough stand-ins for the pocket operator voices
+	case kWaveformPOPhase:
+		fValue = sinf(HOST_TWO_PI * (p + 0.25f * sinf(HOST_TWO_PI * p)));
+		break;
+
+	case kWaveformPODigital:
+		fValue = roundf(sinf(HOST_TWO_PI * p) * 4.0f) / 4.0f;
+		break;
+
+	case kWaveformPOVosim:
+	{
+		float fPulse = sinf(HOST_TWO_PI * p);
+		fValue = p < 0.5f ? fPulse * fPulse * 2.0f - 1.0f : -1.0f + (1.0f - p);
+		break;
+	}
+
+	default:
+		fValue = sinf(HOST_TWO_PI * p);
+		break;
+	}
+
+	pSynth->fPhase += pSynth->fPhaseStep;
+	if (pSynth->fPhase >= 1.0)
+		pSynth->fPhase -= 1.0;
+
+	return fValue;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSynthRender(HostSynth* pSynth, float* pMix, int nFrameCount)
+{
+	if (pSynth->nStage == HOST_ENV_IDLE)
+		return;
+
+	stats.nVoiceFrames += nFrameCount;
+
+	int32_t generated[HOST_MAX_CHUNK * 2];
+	int bGenerated = 0;
+
+	if (pSynth->pfnRender)
+	{
+		memset(generated, 0, sizeof(generated));
+		bGenerated = pSynth->pfnRender(pSynth->pUserdata, generated, pSynth->bStereo ? generated + HOST_MAX_CHUNK : NULL, nFrameCount, (uint32_t)(pSynth->fPhaseStep * 4294967296.0), 0);
+
+		if (bGenerated && !pSynth->bStereo)
+			memcpy(generated + HOST_MAX_CHUNK, generated, nFrameCount * sizeof(int32_t));
+	}
+
+	for (int i = 0; i < nFrameCount && pSynth->nStage != HOST_ENV_IDLE; i++)
+	{
+		if (pSynth->nOffFrames >= 0 && pSynth->nOffFrames-- == 0)
+			HostSynthNoteOff(pSynth);
+
+		float fGain = HostSynthEnvelope(pSynth) * pSynth->fVelocity;
+
+		if (pSynth->pfnRender)
+		{
+			// a generator that returns 0 had nothing to add, it still holds the voice
+			if (bGenerated)
+			{
+				pMix[i * 2] += fGain * generated[i] / (float)HOST_GENERATOR_ONE;
+				pMix[i * 2 + 1] += fGain * generated[HOST_MAX_CHUNK + i] / (float)HOST_GENERATOR_ONE;
+			}
+		}
+		else if (pSynth->pSample)
+		{
+			HostSample* pSample = pSynth->pSample;
+
+			int nIndex = (int)pSynth->fPhase;
+			if (nIndex + 1 >= pSample->nFrameCount)
+			{
+				pSynth->nStage = HOST_ENV_IDLE;
+				break;
+			}
+
+			float fFraction = (float)(pSynth->fPhase - nIndex);
+			const int16_t* pFrame = &pSample->pFrames[nIndex * 2];
+
+			pMix[i * 2] += fGain * (pFrame[0] + (pFrame[2] - pFrame[0]) * fFraction) / 32768.0f;
+			pMix[i * 2 + 1] += fGain * (pFrame[1] + (pFrame[3] - pFrame[1]) * fFraction) / 32768.0f;
+
+			pSynth->fPhase += pSynth->fPhaseStep;
+		}
+		else
+		{
+			float fValue = fGain * HostSynthOscillator(pSynth);
+
+			pMix[i * 2] += fValue;
+			pMix[i * 2 + 1] += fValue;
+		}
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+// instruments
+// --------------------------------------------------------------------------------
+static PDSynthInstrument* HostInstrumentNew(void)
+{
+	HostInstrument* pInstrument = HostAlloc(sizeof(HostInstrument));
+	pInstrument->source.nKind = HOST_SOURCE_INSTRUMENT;
+
+	return (PDSynthInstrument*)pInstrument;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostInstrumentFree(PDSynthInstrument* inst)
+{
+	// the voices belong to the caller, same as on the device
+	free(inst);
+}
+
+
+// --------------------------------------------------------------------------------
+static int HostInstrumentAddVoice(PDSynthInstrument* inst, PDSynth* synth, MIDINote rangeStart, MIDINote rangeEnd, float transpose)
+{
+	HostInstrument* pInstrument = (HostInstrument*)inst;
+
+	if (pInstrument->nVoiceCount == HOST_MAX_VOICES)
+		return 0;
+
+	int nVoice = pInstrument->nVoiceCount++;
+	pInstrument->pVoices[nVoice] = (HostSynth*)synth;
+	pInstrument->fRangeStart[nVoice] = rangeStart;
+	pInstrument->fRangeEnd[nVoice] = rangeEnd;
+	pInstrument->fTranspose[nVoice] = transpose;
+
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+static int HostInstrumentActiveVoiceCount(PDSynthInstrument* inst)
+{
+	HostInstrument* pInstrument = (HostInstrument*)inst;
+
+	int nCount = 0;
+	for (int i = 0; i < pInstrument->nVoiceCount; i++)
+	{
+		if (pInstrument->pVoices[i]->nStage != HOST_ENV_IDLE)
+			nCount++;
+	}
+
+	return nCount;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostInstrumentNoteOn(HostInstrument* pInstrument, float fNote, float fVelocity, int nLengthFrames)
+{
+	// a free voice if there is one, otherwise the one that started first
+	int nChosen = -1;
+
+	for (int i = 0; i < pInstrument->nVoiceCount; i++)
+	{
+		if (fNote < pInstrument->fRangeStart[i] || fNote > pInstrument->fRangeEnd[i])
+			continue;
+
+		HostSynth* pVoice = pInstrument->pVoices[i];
+
+		if (pVoice->nStage == HOST_ENV_IDLE)
+		{
+			nChosen = i;
+			break;
+		}
+
+		if (nChosen == -1 || pVoice->nStartFrame < pInstrument->pVoices[nChosen]->nStartFrame)
+			nChosen = i;
+	}
+
+	if (nChosen == -1)
+		return;
+
+	// retriggering a voice that is already letting go is not counted
+	int nStage = pInstrument->pVoices[nChosen]->nStage;
+	if (nStage != HOST_ENV_IDLE && nStage != HOST_ENV_RELEASE)
+		stats.nStolenVoices++;
+
+	HostSynthNoteOn(pInstrument->pVoices[nChosen], fNote + pInstrument->fTranspose[nChosen], fVelocity, nLengthFrames);
+}
+
+
+// --------------------------------------------------------------------------------
+// effects
+// --------------------------------------------------------------------------------
+static HostEffect* HostEffectNew(int nKind)
+{
+	HostEffect* pEffect = HostAlloc(sizeof(HostEffect));
+	pEffect->nKind = nKind;
+	pEffect->fMix = 1.0f;
+
+	return pEffect;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostEffectFree(HostEffect* pEffect)
+{
+	if (pEffect == NULL)
+		return;
+
+	free(pEffect->pBuffer);
+	free(pEffect);
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostEffectSetMix(SoundEffect* effect, float level)
+{
+	((HostEffect*)effect)->fMix = level;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostFilterUpdate(HostEffect* pEffect)
+{
+	// RBJ cookbook biquads, resonance 0 - 1 maps to a Q of 0.7 - 10
+	float fFrequency = pEffect->fFrequency;
+	if (fFrequency < 10.0f)
+		fFrequency = 10.0f;
+	if (fFrequency > nRate * 0.45f)
+		fFrequency = nRate * 0.45f;
+
+	float fQ = 0.707f + pEffect->fResonance * 9.3f;
+	float w = HOST_TWO_PI * fFrequency / nRate;
+	float fAlpha = sinf(w) / (2.0f * fQ);
+	float fCos = cosf(w);
+	float A = powf(10.0f, pEffect->fGain / 40.0f);
+
+	float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a0 = 1.0f, a1 = 0.0f, a2 = 0.0f;
+
+	switch (pEffect->nFilterType)
+	{
+	case kFilterTypeLowPass:
+		b0 = (1.0f - fCos) / 2.0f;	b1 = 1.0f - fCos;	b2 = b0;
+		a0 = 1.0f + fAlpha;	a1 = -2.0f * fCos;	a2 = 1.0f - fAlpha;
+		break;
+
+	case kFilterTypeHighPass:
+		b0 = (1.0f + fCos) / 2.0f;	b1 = -(1.0f + fCos);	b2 = b0;
+		a0 = 1.0f + fAlpha;	a1 = -2.0f * fCos;	a2 = 1.0f - fAlpha;
+		break;
+
+	case kFilterTypeBandPass:
+		b0 = fAlpha;	b1 = 0.0f;	b2 = -fAlpha;
+		a0 = 1.0f + fAlpha;	a1 = -2.0f * fCos;	a2 = 1.0f - fAlpha;
+		break;
+
+	case kFilterTypeNotch:
+		b0 = 1.0f;	b1 = -2.0f * fCos;	b2 = 1.0f;
+		a0 = 1.0f + fAlpha;	a1 = -2.0f * fCos;	a2 = 1.0f - fAlpha;
+		break;
+
+	case kFilterTypePEQ:
+		b0 = 1.0f + fAlpha * A;	b1 = -2.0f * fCos;	b2 = 1.0f - fAlpha * A;
+		a0 = 1.0f + fAlpha / A;	a1 = -2.0f * fCos;	a2 = 1.0f - fAlpha / A;
+		break;
+
+	case kFilterTypeLowShelf:
+	{
+		float fRoot = 2.0f * sqrtf(A) * fAlpha;
+		b0 = A * ((A + 1) - (A - 1) * fCos + fRoot);	b1 = 2 * A * ((A - 1) - (A + 1) * fCos);	b2 = A * ((A + 1) - (A - 1) * fCos - fRoot);
+		a0 = (A + 1) + (A - 1) * fCos + fRoot;			a1 = -2 * ((A - 1) + (A + 1) * fCos);		a2 = (A + 1) + (A - 1) * fCos - fRoot;
+		break;
+	}
+
+	case kFilterTypeHighShelf:
+	{
+		float fRoot = 2.0f * sqrtf(A) * fAlpha;
+		b0 = A * ((A + 1) + (A - 1) * fCos + fRoot);	b1 = -2 * A * ((A - 1) + (A + 1) * fCos);	b2 = A * ((A + 1) + (A - 1) * fCos - fRoot);
+		a0 = (A + 1) - (A - 1) * fCos + fRoot;			a1 = 2 * ((A - 1) - (A + 1) * fCos);		a2 = (A + 1) - (A - 1) * fCos - fRoot;
+		break;
+	}
+	}
+
+	pEffect->b0 = b0 / a0;
+	pEffect->b1 = b1 / a0;
+	pEffect->b2 = b2 / a0;
+	pEffect->a1 = a1 / a0;
+	pEffect->a2 = a2 / a0;
+}
+
+
+// --------------------------------------------------------------------------------
+static TwoPoleFilter* HostFilterNew(void)
+{
+	HostEffect* pEffect = HostEffectNew(HOST_EFFECT_FILTER);
+	pEffect->nFilterType = kFilterTypeLowPass;
+	pEffect->fFrequency = 1000.0f;
+	HostFilterUpdate(pEffect);
+
+	return (TwoPoleFilter*)pEffect;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostFilterFree(TwoPoleFilter* filter)							{ HostEffectFree((HostEffect*)filter); }
+static void HostFilterSetType(TwoPoleFilter* filter, TwoPoleFilterType type)	{ ((HostEffect*)filter)->nFilterType = type;		HostFilterUpdate((HostEffect*)filter); }
+static void HostFilterSetFrequency(TwoPoleFilter* filter, float frequency)	{ ((HostEffect*)filter)->fFrequency = frequency;	HostFilterUpdate((HostEffect*)filter); }
+static void HostFilterSetResonance(TwoPoleFilter* filter, float resonance)	{ ((HostEffect*)filter)->fResonance = resonance;	HostFilterUpdate((HostEffect*)filter); }
+static void HostFilterSetGain(TwoPoleFilter* filter, float gain)				{ ((HostEffect*)filter)->fGain = gain;				HostFilterUpdate((HostEffect*)filter); }
+
+
+// --------------------------------------------------------------------------------
+static DelayLine* HostDelayNew(int length, int stereo)
+{
+	HostEffect* pEffect = HostEffectNew(HOST_EFFECT_DELAY);
+
+	// lengths are device frames, the line is stretched to the output rate
+	pEffect->nLength = (int)((int64_t)length * nRate / HOST_DEVICE_RATE);
+	if (pEffect->nLength < 1)
+		pEffect->nLength = 1;
+
+	pEffect->nCapacity = pEffect->nLength;
+	pEffect->pBuffer = HostAlloc(pEffect->nLength * 2 * sizeof(float));
+
+	return (DelayLine*)pEffect;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostDelayFree(DelayLine* d)							{ HostEffectFree((HostEffect*)d); }
+static void HostDelaySetFeedback(DelayLine* d, float fb)		{ ((HostEffect*)d)->fFeedback = fb; }
+
+
+// --------------------------------------------------------------------------------
+static void HostDelaySetLength(DelayLine* d, int frames)
+{
+	HostEffect* pEffect = (HostEffect*)d;
+
+	int nLength = (int)((int64_t)frames * nRate / HOST_DEVICE_RATE);
+	if (nLength >= 1 && nLength <= pEffect->nCapacity)
+	{
+		pEffect->nLength = nLength;
+		pEffect->nPosition %= nLength;
+	}
+}
+
+
+// --------------------------------------------------------------------------------
+static BitCrusher* HostCrusherNew(void)
+{
+	return (BitCrusher*)HostEffectNew(HOST_EFFECT_CRUSHER);
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostCrusherFree(BitCrusher* filter)								{ HostEffectFree((HostEffect*)filter); }
+static void HostCrusherSetAmount(BitCrusher* filter, float amount)			{ ((HostEffect*)filter)->fAmount = amount; }
+static void HostCrusherSetUndersampling(BitCrusher* filter, float value)	{ ((HostEffect*)filter)->fUndersampling = value; }
+
+
+// --------------------------------------------------------------------------------
+static SoundEffect* HostCustomEffectNew(effectProc* proc, void* userdata)
+{
+	HostEffect* pEffect = HostEffectNew(HOST_EFFECT_CUSTOM);
+	pEffect->pfnProc = proc;
+	pEffect->pUserdata = userdata;
+
+	return (SoundEffect*)pEffect;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostCustomEffectFree(SoundEffect* effect)							{ HostEffectFree((HostEffect*)effect); }
+static void HostEffectSetUserdata(SoundEffect* effect, void* userdata)			{ ((HostEffect*)effect)->pUserdata = userdata; }
+static void* HostEffectGetUserdata(SoundEffect* effect)						{ return ((HostEffect*)effect)->pUserdata; }
+
+
+// --------------------------------------------------------------------------------
+// A custom effect gets the chunk in Q8.24 the way the device hands it over and
+// returns whether it wrote anything back.
+// --------------------------------------------------------------------------------
+static void HostCustomEffectProcess(HostEffect* pEffect, float* pMix, int nFrameCount)
+{
+	int32_t left[HOST_MAX_CHUNK];
+	int32_t right[HOST_MAX_CHUNK];
+	int bActive = 0;
+
+	for (int i = 0; i < nFrameCount; i++)
+	{
+		left[i] = (int32_t)(pMix[i * 2] * HOST_GENERATOR_ONE);
+		right[i] = (int32_t)(pMix[i * 2 + 1] * HOST_GENERATOR_ONE);
+		bActive |= left[i] | right[i];
+	}
+
+	if (!pEffect->pfnProc((SoundEffect*)pEffect, left, right, nFrameCount, bActive != 0))
+		return;
+
+	for (int i = 0; i < nFrameCount; i++)
+	{
+		pMix[i * 2] = left[i] / (float)HOST_GENERATOR_ONE;
+		pMix[i * 2 + 1] = right[i] / (float)HOST_GENERATOR_ONE;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostEffectProcess(HostEffect* pEffect, float* pMix, int nFrameCount)
+{
+	if (pEffect->nKind == HOST_EFFECT_CUSTOM)
+	{
+		HostCustomEffectProcess(pEffect, pMix, nFrameCount);
+		return;
+	}
+
+	float fWet = pEffect->fMix;
+	float fDry = 1.0f - fWet;
+
+	for (int i = 0; i < nFrameCount; i++)
+	{
+		for (int c = 0; c < 2; c++)
+		{
+			float x = pMix[i * 2 + c];
+			float y = x;
+
+			switch (pEffect->nKind)
+			{
+			case HOST_EFFECT_FILTER:
+				y = pEffect->b0 * x + pEffect->b1 * pEffect->x1[c] + pEffect->b2 * pEffect->x2[c] - pEffect->a1 * pEffect->y1[c] - pEffect->a2 * pEffect->y2[c];
+				pEffect->x2[c] = pEffect->x1[c];
+				pEffect->x1[c] = x;
+				pEffect->y2[c] = pEffect->y1[c];
+				pEffect->y1[c] = y;
+				break;
+
+			case HOST_EFFECT_DELAY:
+			{
+				float* pTap = &pEffect->pBuffer[pEffect->nPosition * 2 + c];
+				y = *pTap;
+				*pTap = x + y * pEffect->fFeedback;
+				break;
+			}
+
+			case HOST_EFFECT_CRUSHER:
+			{
+				// amount takes the 16 bits down to 1, undersampling holds a value for up to 32 frames
+				if (pEffect->nHold == 0)
+				{
+					float fSteps = powf(2.0f, 16.0f * (1.0f - pEffect->fAmount));
+					pEffect->fHeld[c] = floorf(x * fSteps) / fSteps;
+				}
+				y = pEffect->fHeld[c];
+				break;
+			}
+			}
+
+			pMix[i * 2 + c] = x * fDry + y * fWet;
+		}
+
+		if (pEffect->nKind == HOST_EFFECT_DELAY && ++pEffect->nPosition == pEffect->nLength)
+			pEffect->nPosition = 0;
+
+		if (pEffect->nKind == HOST_EFFECT_CRUSHER && ++pEffect->nHold > (int)(pEffect->fUndersampling * HOST_CRUSHER_MAX_HOLD))
+			pEffect->nHold = 0;
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+// channels
+// --------------------------------------------------------------------------------
+static SoundChannel* HostChannelNew(void)
+{
+	HostChannel* pChannel = HostAlloc(sizeof(HostChannel));
+	pChannel->fVolume = 1.0f;
+
+	HostRegister((void**)pChannels, &nChannelCount, pChannel);
+
+	return (SoundChannel*)pChannel;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostChannelFree(SoundChannel* channel)
+{
+	HostUnregister((void**)pChannels, &nChannelCount, channel);
+	free(channel);
+}
+
+
+// --------------------------------------------------------------------------------
+static int HostChannelAddSource(SoundChannel* channel, SoundSource* source)
+{
+	HostChannel* pChannel = (HostChannel*)channel;
+
+	if (pChannel->nSourceCount == HOST_MAX_CHANNEL_SOURCES)
+		return 0;
+
+	pChannel->pSources[pChannel->nSourceCount++] = (HostSource*)source;
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+static SoundSource* HostChannelAddCallbackSource(SoundChannel* channel, AudioSourceFunction* callback, void* context, int stereo)
+{
+	// the caller frees it with pd->system->realloc(), the same as on the device
+	HostCallbackSource* pSource = HostAlloc(sizeof(HostCallbackSource));
+	pSource->source.nKind = HOST_SOURCE_CALLBACK;
+	pSource->pfnCallback = callback;
+	pSource->pContext = context;
+	pSource->bStereo = stereo;
+
+	if (!HostChannelAddSource(channel, (SoundSource*)pSource))
+	{
+		free(pSource);
+		return NULL;
+	}
+
+	return (SoundSource*)pSource;
+}
+
+
+// --------------------------------------------------------------------------------
+static int HostChannelRemoveSource(SoundChannel* channel, SoundSource* source)
+{
+	HostChannel* pChannel = (HostChannel*)channel;
+
+	int nCount = pChannel->nSourceCount;
+	HostUnregister((void**)pChannel->pSources, &pChannel->nSourceCount, source);
+
+	return pChannel->nSourceCount != nCount;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostChannelAddEffect(SoundChannel* channel, SoundEffect* effect)
+{
+	HostChannel* pChannel = (HostChannel*)channel;
+
+	if (pChannel->nEffectCount < HOST_MAX_CHANNEL_EFFECTS)
+		pChannel->pEffects[pChannel->nEffectCount++] = (HostEffect*)effect;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostChannelRemoveEffect(SoundChannel* channel, SoundEffect* effect)
+{
+	HostChannel* pChannel = (HostChannel*)channel;
+
+	// effects run in the order they were added, so the rest move up
+	for (int i = 0; i < pChannel->nEffectCount; i++)
+	{
+		if (pChannel->pEffects[i] == (HostEffect*)effect)
+		{
+			memmove(&pChannel->pEffects[i], &pChannel->pEffects[i + 1], (pChannel->nEffectCount - i - 1) * sizeof(HostEffect*));
+			pChannel->nEffectCount--;
+			return;
+		}
+	}
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostChannelSetVolume(SoundChannel* channel, float volume)	{ ((HostChannel*)channel)->fVolume = volume; }
+static float HostChannelGetVolume(SoundChannel* channel)				{ return ((HostChannel*)channel)->fVolume; }
+static void HostChannelSetPan(SoundChannel* channel, float pan)			{ ((HostChannel*)channel)->fPan = pan; }
+
+
+// --------------------------------------------------------------------------------
+// sample players, they play on the default channel as on the device
+// --------------------------------------------------------------------------------
+static SoundChannel* HostGetDefaultChannel(void)
+{
+	if (pDefaultChannel == NULL)
+		pDefaultChannel = (HostChannel*)HostChannelNew();
+
+	return (SoundChannel*)pDefaultChannel;
+}
+
+
+// --------------------------------------------------------------------------------
+static SamplePlayer* HostSamplePlayerNew(void)
+{
+	HostSamplePlayer* pPlayer = HostAlloc(sizeof(HostSamplePlayer));
+	pPlayer->source.nKind = HOST_SOURCE_PLAYER;
+	pPlayer->fRate = 1.0f;
+	pPlayer->fLeft = 1.0f;
+	pPlayer->fRight = 1.0f;
+
+	return (SamplePlayer*)pPlayer;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSamplePlayerStop(SamplePlayer* player)
+{
+	HostSamplePlayer* pPlayer = (HostSamplePlayer*)player;
+
+	if (pPlayer->bPlaying)
+		HostChannelRemoveSource(HostGetDefaultChannel(), (SoundSource*)pPlayer);
+
+	pPlayer->bPlaying = 0;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSamplePlayerFree(SamplePlayer* player)
+{
+	HostSamplePlayerStop(player);
+	free(player);
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSamplePlayerSetSample(SamplePlayer* player, AudioSample* sample)
+{
+	HostSamplePlayer* pPlayer = (HostSamplePlayer*)player;
+
+	pPlayer->pSample = (HostSample*)sample;
+	pPlayer->fPosition = 0.0;
+}
+
+
+// --------------------------------------------------------------------------------
+static int HostSamplePlayerPlay(SamplePlayer* player, int repeat, float rate)
+{
+	HostSamplePlayer* pPlayer = (HostSamplePlayer*)player;
+
+	if (pPlayer->pSample == NULL)
+		return 0;
+
+	if (!pPlayer->bPlaying && !HostChannelAddSource(HostGetDefaultChannel(), (SoundSource*)pPlayer))
+		return 0;
+
+	pPlayer->nRepeat = repeat;
+	pPlayer->fRate = rate;
+	pPlayer->fPosition = 0.0;
+	pPlayer->bPlaying = 1;
+
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+static int HostSamplePlayerIsPlaying(SamplePlayer* player)
+{
+	return ((HostSamplePlayer*)player)->bPlaying;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSamplePlayerSetVolume(SamplePlayer* player, float left, float right)
+{
+	HostSamplePlayer* pPlayer = (HostSamplePlayer*)player;
+
+	pPlayer->fLeft = left;
+	pPlayer->fRight = right;
+}
+
+
+// --------------------------------------------------------------------------------
+static float HostSamplePlayerGetLength(SamplePlayer* player)
+{
+	HostSamplePlayer* pPlayer = (HostSamplePlayer*)player;
+
+	return pPlayer->pSample ? (float)pPlayer->pSample->nFrameCount / pPlayer->pSample->nSampleRate : 0.0f;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSamplePlayerSetOffset(SamplePlayer* player, float offset)
+{
+	HostSamplePlayer* pPlayer = (HostSamplePlayer*)player;
+
+	if (pPlayer->pSample)
+		pPlayer->fPosition = (double)offset * pPlayer->pSample->nSampleRate;
+}
+
+
+// --------------------------------------------------------------------------------
+static float HostSamplePlayerGetOffset(SamplePlayer* player)
+{
+	HostSamplePlayer* pPlayer = (HostSamplePlayer*)player;
+
+	return pPlayer->pSample ? (float)(pPlayer->fPosition / pPlayer->pSample->nSampleRate) : 0.0f;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSamplePlayerRender(HostSamplePlayer* pPlayer, float* pMix, int nFrameCount)
+{
+	HostSample* pSample = pPlayer->pSample;
+	double fStep = (double)pSample->nSampleRate / nRate * pPlayer->fRate;
+
+	for (int i = 0; i < nFrameCount && pPlayer->bPlaying; i++)
+	{
+		int nIndex = (int)pPlayer->fPosition;
+		float fFraction = (float)(pPlayer->fPosition - nIndex);
+
+		// the frame after the last one is the first one again when it loops
+		const int16_t* pFrame = &pSample->pFrames[nIndex * 2];
+		const int16_t* pNext = nIndex + 1 < pSample->nFrameCount ? pFrame + 2 : (pPlayer->nRepeat != 1 ? pSample->pFrames : pFrame);
+
+		pMix[i * 2] += pPlayer->fLeft * (pFrame[0] + (pNext[0] - pFrame[0]) * fFraction) / 32768.0f;
+		pMix[i * 2 + 1] += pPlayer->fRight * (pFrame[1] + (pNext[1] - pFrame[1]) * fFraction) / 32768.0f;
+
+		pPlayer->fPosition += fStep;
+		if (pPlayer->fPosition >= pSample->nFrameCount)
+		{
+			pPlayer->fPosition -= pSample->nFrameCount;
+
+			if (pPlayer->nRepeat > 0 && --pPlayer->nRepeat == 0)
+				pPlayer->bPlaying = 0;
+		}
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static int HostChannelRender(HostChannel* pChannel, float* pOut, int nFrameCount)
+{
+	float mix[HOST_MAX_CHUNK * 2];
+	memset(mix, 0, nFrameCount * 2 * sizeof(float));
+
+	int nVoices = 0;
+
+	for (int s = 0; s < pChannel->nSourceCount; s++)
+	{
+		HostSource* pSource = pChannel->pSources[s];
+
+		if (pSource->nKind == HOST_SOURCE_SYNTH)
+		{
+			nVoices += ((HostSynth*)pSource)->nStage != HOST_ENV_IDLE;
+			HostSynthRender((HostSynth*)pSource, mix, nFrameCount);
+		}
+		else if (pSource->nKind == HOST_SOURCE_INSTRUMENT)
+		{
+			HostInstrument* pInstrument = (HostInstrument*)pSource;
+
+			for (int v = 0; v < pInstrument->nVoiceCount; v++)
+			{
+				nVoices += pInstrument->pVoices[v]->nStage != HOST_ENV_IDLE;
+				HostSynthRender(pInstrument->pVoices[v], mix, nFrameCount);
+			}
+		}
+		else if (pSource->nKind == HOST_SOURCE_PLAYER)
+		{
+			HostSamplePlayer* pPlayer = (HostSamplePlayer*)pSource;
+
+			nVoices += pPlayer->bPlaying;
+			if (pPlayer->bPlaying)
+				HostSamplePlayerRender(pPlayer, mix, nFrameCount);
+		}
+		else if (pSource->nKind == HOST_SOURCE_CALLBACK)
+		{
+			HostCallbackSource* pCallback = (HostCallbackSource*)pSource;
+			int16_t left[HOST_MAX_CHUNK];
+			int16_t right[HOST_MAX_CHUNK];
+
+			if (pCallback->pfnCallback(pCallback->pContext, left, pCallback->bStereo ? right : NULL, nFrameCount))
+			{
+				for (int i = 0; i < nFrameCount; i++)
+				{
+					mix[i * 2] += left[i] / 32768.0f;
+					mix[i * 2 + 1] += (pCallback->bStereo ? right[i] : left[i]) / 32768.0f;
+				}
+			}
+		}
+	}
+
+	for (int e = 0; e < pChannel->nEffectCount; e++)
+		HostEffectProcess(pChannel->pEffects[e], mix, nFrameCount);
+
+	// pan -1 is hard left, the other side is turned down rather than boosted
+	float fLeft = pChannel->fVolume * (pChannel->fPan > 0.0f ? 1.0f - pChannel->fPan : 1.0f);
+	float fRight = pChannel->fVolume * (pChannel->fPan < 0.0f ? 1.0f + pChannel->fPan : 1.0f);
+
+	for (int i = 0; i < nFrameCount; i++)
+	{
+		pOut[i * 2] += mix[i * 2] * fLeft;
+		pOut[i * 2 + 1] += mix[i * 2 + 1] * fRight;
+	}
+
+	return nVoices;
+}
+
+
+// --------------------------------------------------------------------------------
+// sequences and tracks
+// --------------------------------------------------------------------------------
+static SequenceTrack* HostTrackNew(void)
+{
+	return (SequenceTrack*)HostAlloc(sizeof(HostTrack));
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostTrackFree(SequenceTrack* track)
+{
+	HostTrack* pTrack = (HostTrack*)track;
+	HostSequence* pSequence = pTrack->pSequence;
+
+	if (pSequence)
+	{
+		for (int i = 0; i < pSequence->nTrackCount; i++)
+		{
+			if (pSequence->pTracks[i] == pTrack)
+				pSequence->pTracks[i] = NULL;
+		}
+	}
+
+	free(pTrack->pNotes);
+	free(pTrack);
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostTrackSetInstrument(SequenceTrack* track, PDSynthInstrument* inst)	{ ((HostTrack*)track)->pInstrument = (HostInstrument*)inst; }
+static PDSynthInstrument* HostTrackGetInstrument(SequenceTrack* track)				{ return (PDSynthInstrument*)((HostTrack*)track)->pInstrument; }
+static void HostTrackSetMuted(SequenceTrack* track, int mute)						{ ((HostTrack*)track)->bMuted = mute; }
+
+
+// --------------------------------------------------------------------------------
+static void HostTrackAddNoteEvent(SequenceTrack* track, uint32_t step, uint32_t len, MIDINote note, float velocity)
+{
+	HostTrack* pTrack = (HostTrack*)track;
+
+	if (pTrack->nNoteCount == pTrack->nNoteCapacity)
+	{
+		pTrack->nNoteCapacity = pTrack->nNoteCapacity ? pTrack->nNoteCapacity * 2 : 64;
+		pTrack->pNotes = realloc(pTrack->pNotes, pTrack->nNoteCapacity * sizeof(HostNote));
+		if (pTrack->pNotes == NULL)
+		{
+			fprintf(stderr, "host sound: out of memory\n");
+			exit(1);
+		}
+	}
+
+	// kept in step order, appending is the common case
+	int nIndex = pTrack->nNoteCount;
+	while (nIndex > 0 && pTrack->pNotes[nIndex - 1].nStep > step)
+		nIndex--;
+
+	memmove(&pTrack->pNotes[nIndex + 1], &pTrack->pNotes[nIndex], (pTrack->nNoteCount - nIndex) * sizeof(HostNote));
+	pTrack->nNoteCount++;
+
+	// a note slipped in before the cursor of a playing sequence must not be played again
+	if (nIndex < pTrack->nCursor)
+		pTrack->nCursor++;
+
+	HostNote* pNote = &pTrack->pNotes[nIndex];
+	pNote->nStep = step;
+	pNote->nLen = len;
+	pNote->fNote = note;
+	pNote->fVelocity = velocity;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostTrackRemoveNoteEvent(SequenceTrack* track, uint32_t step, MIDINote note)
+{
+	HostTrack* pTrack = (HostTrack*)track;
+
+	for (int i = 0; i < pTrack->nNoteCount; i++)
+	{
+		if (pTrack->pNotes[i].nStep == step && pTrack->pNotes[i].fNote == note)
+		{
+			memmove(&pTrack->pNotes[i], &pTrack->pNotes[i + 1], (pTrack->nNoteCount - i - 1) * sizeof(HostNote));
+			pTrack->nNoteCount--;
+
+			if (i < pTrack->nCursor)
+				pTrack->nCursor--;
+
+			return;
+		}
+	}
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostTrackClearNotes(SequenceTrack* track)
+{
+	((HostTrack*)track)->nNoteCount = 0;
+	((HostTrack*)track)->nCursor = 0;
+}
+
+
+// --------------------------------------------------------------------------------
+static int HostTrackGetIndexForStep(SequenceTrack* track, uint32_t step)
+{
+	HostTrack* pTrack = (HostTrack*)track;
+
+	int nIndex = 0;
+	while (nIndex < pTrack->nNoteCount && pTrack->pNotes[nIndex].nStep < step)
+		nIndex++;
+
+	return nIndex;
+}
+
+
+// --------------------------------------------------------------------------------
+static int HostTrackGetNoteAtIndex(SequenceTrack* track, int index, uint32_t* outStep, uint32_t* outLen, MIDINote* outNote, float* outVelocity)
+{
+	HostTrack* pTrack = (HostTrack*)track;
+
+	if (index < 0 || index >= pTrack->nNoteCount)
+		return 0;
+
+	const HostNote* pNote = &pTrack->pNotes[index];
+
+	if (outStep)
+		*outStep = pNote->nStep;
+	if (outLen)
+		*outLen = pNote->nLen;
+	if (outNote)
+		*outNote = pNote->fNote;
+	if (outVelocity)
+		*outVelocity = pNote->fVelocity;
+
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+static uint32_t HostTrackGetLength(SequenceTrack* track)
+{
+	HostTrack* pTrack = (HostTrack*)track;
+
+	uint32_t nLength = 0;
+	for (int i = 0; i < pTrack->nNoteCount; i++)
+	{
+		if (pTrack->pNotes[i].nStep + pTrack->pNotes[i].nLen > nLength)
+			nLength = pTrack->pNotes[i].nStep + pTrack->pNotes[i].nLen;
+	}
+
+	return nLength;
+}
+
+
+// --------------------------------------------------------------------------------
+static SoundSequence* HostSequenceNew(void)
+{
+	HostSequence* pSequence = HostAlloc(sizeof(HostSequence));
+	pSequence->fStepsPerSecond = 8.0f;
+	pSequence->nLoops = 1;
+
+	HostRegister((void**)pSequences, &nSequenceCount, pSequence);
+
+	return (SoundSequence*)pSequence;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSequenceFree(SoundSequence* seq)
+{
+	HostSequence* pSequence = (HostSequence*)seq;
+
+	for (int i = 0; i < pSequence->nTrackCount; i++)
+	{
+		if (pSequence->pTracks[i])
+			pSequence->pTracks[i]->pSequence = NULL;
+	}
+
+	HostUnregister((void**)pSequences, &nSequenceCount, pSequence);
+	free(pSequence);
+}
+
+
+// --------------------------------------------------------------------------------
+static SequenceTrack* HostSequenceAddTrack(SoundSequence* seq)
+{
+	HostSequence* pSequence = (HostSequence*)seq;
+
+	if (pSequence->nTrackCount == HOST_MAX_SEQUENCE_TRACKS)
+		return NULL;
+
+	HostTrack* pTrack = (HostTrack*)HostTrackNew();
+	pTrack->pSequence = pSequence;
+	pSequence->pTracks[pSequence->nTrackCount++] = pTrack;
+
+	return (SequenceTrack*)pTrack;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSequenceSetLoops(SoundSequence* seq, int loopstart, int loopend, int loops)
+{
+	HostSequence* pSequence = (HostSequence*)seq;
+
+	pSequence->nLoopStart = loopstart;
+	pSequence->nLoopEnd = loopend;
+	pSequence->nLoops = loops;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSequenceSetTempo(SoundSequence* seq, float stepsPerSecond)	{ ((HostSequence*)seq)->fStepsPerSecond = stepsPerSecond; }
+static float HostSequenceGetTempo(SoundSequence* seq)						{ return ((HostSequence*)seq)->fStepsPerSecond; }
+static int HostSequenceGetTrackCount(SoundSequence* seq)					{ return ((HostSequence*)seq)->nTrackCount; }
+static int HostSequenceIsPlaying(SoundSequence* seq)						{ return ((HostSequence*)seq)->bPlaying; }
+
+
+// --------------------------------------------------------------------------------
+static void HostSequenceSeek(HostSequence* pSequence, int nStep)
+{
+	pSequence->nStep = nStep;
+	pSequence->nCurrentStep = nStep;
+
+	for (int t = 0; t < pSequence->nTrackCount; t++)
+	{
+		HostTrack* pTrack = pSequence->pTracks[t];
+		if (pTrack == NULL)
+			continue;
+
+		int nLow = 0;
+		int nHigh = pTrack->nNoteCount;
+		while (nLow < nHigh)
+		{
+			int nMid = (nLow + nHigh) / 2;
+			if ((int)pTrack->pNotes[nMid].nStep < nStep)
+				nLow = nMid + 1;
+			else
+				nHigh = nMid;
+		}
+
+		pTrack->nCursor = nLow;
+	}
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSequencePlay(SoundSequence* seq, SequenceFinishedCallback finishCallback, void* userdata)
+{
+	HostSequence* pSequence = (HostSequence*)seq;
+
+	HostSequenceSeek(pSequence, pSequence->nStep);
+	pSequence->nLoopsPlayed = 0;
+	pSequence->fFramesToStep = 0.0;
+	pSequence->bPlaying = 1;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSequenceAllNotesOff(SoundSequence* seq)
+{
+	HostSequence* pSequence = (HostSequence*)seq;
+
+	for (int t = 0; t < pSequence->nTrackCount; t++)
+	{
+		HostTrack* pTrack = pSequence->pTracks[t];
+		if (pTrack == NULL || pTrack->pInstrument == NULL)
+			continue;
+
+		for (int v = 0; v < pTrack->pInstrument->nVoiceCount; v++)
+			HostSynthNoteOff(pTrack->pInstrument->pVoices[v]);
+	}
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSequenceStop(SoundSequence* seq)
+{
+	HostSequence* pSequence = (HostSequence*)seq;
+
+	pSequence->bPlaying = 0;
+	HostSequenceAllNotesOff(seq);
+}
+
+
+// --------------------------------------------------------------------------------
+static uint32_t HostSequenceGetLength(SoundSequence* seq)
+{
+	HostSequence* pSequence = (HostSequence*)seq;
+
+	uint32_t nLength = 0;
+	for (int t = 0; t < pSequence->nTrackCount; t++)
+	{
+		if (pSequence->pTracks[t])
+		{
+			uint32_t nTrackLength = HostTrackGetLength((SequenceTrack*)pSequence->pTracks[t]);
+			if (nTrackLength > nLength)
+				nLength = nTrackLength;
+		}
+	}
+
+	return nLength;
+}
+
+
+// --------------------------------------------------------------------------------
+// Starts the next step, with bPlayNotes clear its notes are passed over.
+// --------------------------------------------------------------------------------
+static void HostSequenceStartStep(HostSequence* pSequence, int bPlayNotes)
+{
+	int nStep = pSequence->nStep;
+	double fFramesPerStep = nRate / pSequence->fStepsPerSecond;
+
+	for (int t = 0; t < pSequence->nTrackCount; t++)
+	{
+		HostTrack* pTrack = pSequence->pTracks[t];
+		if (pTrack == NULL)
+			continue;
+
+		while (pTrack->nCursor < pTrack->nNoteCount && (int)pTrack->pNotes[pTrack->nCursor].nStep <= nStep)
+		{
+			const HostNote* pNote = &pTrack->pNotes[pTrack->nCursor++];
+
+			if (bPlayNotes && !pTrack->bMuted && pTrack->pInstrument && (int)pNote->nStep == nStep)
+				HostInstrumentNoteOn(pTrack->pInstrument, pNote->fNote, pNote->fVelocity, (int)(pNote->nLen * fFramesPerStep));
+		}
+	}
+
+	pSequence->nCurrentStep = nStep;
+	pSequence->nStep++;
+	pSequence->fFramesToStep += fFramesPerStep;
+
+	int nEnd = pSequence->nLoopEnd > 0 ? pSequence->nLoopEnd : (int)HostSequenceGetLength((SoundSequence*)pSequence);
+
+	if (pSequence->nStep >= nEnd)
+	{
+		pSequence->nLoopsPlayed++;
+
+		// the last loop lets its notes ring out, the sequence just stops starting new ones
+		if (pSequence->nLoops > 0 && pSequence->nLoopsPlayed >= pSequence->nLoops)
+			pSequence->bPlaying = 0;
+		else
+		{
+			// the last step of the loop plays on until the first one starts again
+			HostSequenceSeek(pSequence, pSequence->nLoopStart);
+			pSequence->nCurrentStep = nStep;
+		}
+	}
+
+}
+
+
+// --------------------------------------------------------------------------------
+static int HostSequenceGetCurrentStep(SoundSequence* seq, int* timeOffset)
+{
+	HostSequence* pSequence = (HostSequence*)seq;
+
+	// frames since the step started, in the 44.1 kHz frames of the device
+	if (timeOffset)
+	{
+		double fFramesPerStep = nRate / pSequence->fStepsPerSecond;
+		double fOffset = fFramesPerStep - pSequence->fFramesToStep;
+
+		*timeOffset = fOffset > 0.0 && pSequence->bPlaying ? (int)(fOffset * HOST_DEVICE_RATE / nRate) : 0;
+	}
+
+	return pSequence->nCurrentStep;
+}
+
+
+// --------------------------------------------------------------------------------
+static void HostSequenceSetCurrentStep(SoundSequence* seq, int step, int timeOffset, int playNotes)
+{
+	HostSequence* pSequence = (HostSequence*)seq;
+
+	HostSequenceSeek(pSequence, step);
+	pSequence->fFramesToStep = 0.0;
+
+	if (timeOffset <= 0)
+		return;
+
+	// timeOffset into the step, it is under way already and only plays its notes if asked to
+	HostSequenceStartStep(pSequence, playNotes);
+
+	pSequence->fFramesToStep -= (double)timeOffset * nRate / HOST_DEVICE_RATE;
+	if (pSequence->fFramesToStep < 0.0)
+		pSequence->fFramesToStep = 0.0;
+}
+
+
+// --------------------------------------------------------------------------------
+// sound
+// --------------------------------------------------------------------------------
+static uint32_t HostGetCurrentTime(void)
+{
+	// the player reads this as 44.1 kHz frames whatever rate is rendered
+	return (uint32_t)(nFrame * HOST_DEVICE_RATE / nRate);
+}
+
+
+// --------------------------------------------------------------------------------
+// Channels are in the mix from newChannel() on, these take them out and back in.
+// --------------------------------------------------------------------------------
+static int HostAddChannel(SoundChannel* channel)
+{
+	for (int i = 0; i < nChannelCount; i++)
+	{
+		if (pChannels[i] == (HostChannel*)channel)
+			return 0;
+	}
+
+	HostRegister((void**)pChannels, &nChannelCount, channel);
+	return 1;
+}
+
+
+// --------------------------------------------------------------------------------
+static int HostRemoveChannel(SoundChannel* channel)
+{
+	int nCount = nChannelCount;
+	HostUnregister((void**)pChannels, &nChannelCount, channel);
+
+	return nChannelCount != nCount;
+}
+
+
+// --------------------------------------------------------------------------------
+static const struct playdate_sound_channel channelApi =
+{
+	.newChannel = HostChannelNew,
+	.freeChannel = HostChannelFree,
+	.addSource = HostChannelAddSource,
+	.removeSource = HostChannelRemoveSource,
+	.addCallbackSource = HostChannelAddCallbackSource,
+	.addEffect = HostChannelAddEffect,
+	.removeEffect = HostChannelRemoveEffect,
+	.setVolume = HostChannelSetVolume,
+	.getVolume = HostChannelGetVolume,
+	.setPan = HostChannelSetPan,
+};
+
+static const struct playdate_sound_sample sampleApi =
+{
+	.load = HostSampleLoad,
+	.newSampleFromData = HostSampleNewFromData,
+	.getData = HostSampleGetData,
+	.freeSample = HostSampleFree,
+	.getLength = HostSampleGetLength,
+};
+
+static const struct playdate_sound_sampleplayer samplePlayerApi =
+{
+	.newPlayer = HostSamplePlayerNew,
+	.freePlayer = HostSamplePlayerFree,
+	.setSample = HostSamplePlayerSetSample,
+	.play = HostSamplePlayerPlay,
+	.isPlaying = HostSamplePlayerIsPlaying,
+	.stop = HostSamplePlayerStop,
+	.setVolume = HostSamplePlayerSetVolume,
+	.getLength = HostSamplePlayerGetLength,
+	.setOffset = HostSamplePlayerSetOffset,
+	.getOffset = HostSamplePlayerGetOffset,
+};
+
+static const struct playdate_sound_synth synthApi =
+{
+	.newSynth = HostSynthNew,
+	.freeSynth = HostSynthFree,
+	.setWaveform = HostSynthSetWaveform,
+	.setSample = HostSynthSetSample,
+	.setGenerator = HostSynthSetGenerator,
+	.setAttackTime = HostSynthSetAttackTime,
+	.setDecayTime = HostSynthSetDecayTime,
+	.setSustainLevel = HostSynthSetSustainLevel,
+	.setReleaseTime = HostSynthSetReleaseTime,
+	.playNote = HostSynthPlayNote,
+	.playMIDINote = HostSynthPlayMIDINote,
+	.noteOff = HostSynthPlayNoteOff,
+	.stop = HostSynthStop,
+	.isPlaying = HostSynthIsPlaying,
+	.copy = HostSynthCopy,
+};
+
+static const struct playdate_sound_instrument instrumentApi =
+{
+	.newInstrument = HostInstrumentNew,
+	.freeInstrument = HostInstrumentFree,
+	.addVoice = HostInstrumentAddVoice,
+	.activeVoiceCount = HostInstrumentActiveVoiceCount,
+};
+
+static const struct playdate_sound_track trackApi =
+{
+	.newTrack = HostTrackNew,
+	.freeTrack = HostTrackFree,
+	.setInstrument = HostTrackSetInstrument,
+	.getInstrument = HostTrackGetInstrument,
+	.addNoteEvent = HostTrackAddNoteEvent,
+	.removeNoteEvent = HostTrackRemoveNoteEvent,
+	.clearNotes = HostTrackClearNotes,
+	.setMuted = HostTrackSetMuted,
+	.getLength = HostTrackGetLength,
+	.getIndexForStep = HostTrackGetIndexForStep,
+	.getNoteAtIndex = HostTrackGetNoteAtIndex,
+};
+
+static const struct playdate_sound_sequence sequenceApi =
+{
+	.newSequence = HostSequenceNew,
+	.freeSequence = HostSequenceFree,
+	.setLoops = HostSequenceSetLoops,
+	.setTempo = HostSequenceSetTempo,
+	.getTempo = HostSequenceGetTempo,
+	.getTrackCount = HostSequenceGetTrackCount,
+	.addTrack = HostSequenceAddTrack,
+	.allNotesOff = HostSequenceAllNotesOff,
+	.isPlaying = HostSequenceIsPlaying,
+	.getLength = HostSequenceGetLength,
+	.play = HostSequencePlay,
+	.stop = HostSequenceStop,
+	.getCurrentStep = HostSequenceGetCurrentStep,
+	.setCurrentStep = HostSequenceSetCurrentStep,
+};
+
+static const struct playdate_sound_effect_twopolefilter filterApi =
+{
+	.newFilter = HostFilterNew,
+	.freeFilter = HostFilterFree,
+	.setType = HostFilterSetType,
+	.setFrequency = HostFilterSetFrequency,
+	.setGain = HostFilterSetGain,
+	.setResonance = HostFilterSetResonance,
+};
+
+static const struct playdate_sound_effect_bitcrusher crusherApi =
+{
+	.newBitCrusher = HostCrusherNew,
+	.freeBitCrusher = HostCrusherFree,
+	.setAmount = HostCrusherSetAmount,
+	.setUndersampling = HostCrusherSetUndersampling,
+};
+
+static const struct playdate_sound_effect_delayline delayApi =
+{
+	.newDelayLine = HostDelayNew,
+	.freeDelayLine = HostDelayFree,
+	.setLength = HostDelaySetLength,
+	.setFeedback = HostDelaySetFeedback,
+};
+
+static const struct playdate_sound_effect effectApi =
+{
+	.newEffect = HostCustomEffectNew,
+	.freeEffect = HostCustomEffectFree,
+	.setMix = HostEffectSetMix,
+	.twopolefilter = &filterApi,
+	.bitcrusher = &crusherApi,
+	.delayline = &delayApi,
+	.setUserdata = HostEffectSetUserdata,
+	.getUserdata = HostEffectGetUserdata,
+};
+
+static const struct playdate_sound soundApi =
+{
+	.channel = &channelApi,
+	.sample = &sampleApi,
+	.sampleplayer = &samplePlayerApi,
+	.synth = &synthApi,
+	.sequence = &sequenceApi,
+	.effect = &effectApi,
+	.instrument = &instrumentApi,
+	.track = &trackApi,
+	.getCurrentTime = HostGetCurrentTime,
+	.getDefaultChannel = HostGetDefaultChannel,
+	.addChannel = HostAddChannel,
+	.removeChannel = HostRemoveChannel,
+};
+
+
+// --------------------------------------------------------------------------------
+void HostSoundInit(int nSampleRate, const char* szRoot)
+{
+	nRate = nSampleRate;
+	szRootPath = szRoot;
+	nFrame = 0;
+
+	memset(&stats, 0, sizeof(HostSoundStats));
+}
+
+
+// --------------------------------------------------------------------------------
+const struct playdate_sound* HostSoundGetAPI(void)
+{
+	return &soundApi;
+}
+
+
+// --------------------------------------------------------------------------------
+const HostSoundStats* HostSoundGetStats(void)
+{
+	return &stats;
+}
+
+
+// --------------------------------------------------------------------------------
+int HostSoundIsActive(void)
+{
+	if (nPendingCount > 0)
+		return 1;
+
+	for (int i = 0; i < nSequenceCount; i++)
+	{
+		if (pSequences[i]->bPlaying)
+			return 1;
+	}
+
+	for (int i = 0; i < nChannelCount; i++)
+	{
+		HostChannel* pChannel = pChannels[i];
+
+		for (int s = 0; s < pChannel->nSourceCount; s++)
+		{
+			HostSource* pSource = pChannel->pSources[s];
+
+			if (pSource->nKind == HOST_SOURCE_SYNTH && ((HostSynth*)pSource)->nStage != HOST_ENV_IDLE)
+				return 1;
+
+			if (pSource->nKind == HOST_SOURCE_INSTRUMENT && HostInstrumentActiveVoiceCount((PDSynthInstrument*)pSource) > 0)
+				return 1;
+
+			if (pSource->nKind == HOST_SOURCE_PLAYER && ((HostSamplePlayer*)pSource)->bPlaying)
+				return 1;
+		}
+	}
+
+	return 0;
+}
+
+
+// --------------------------------------------------------------------------------
+// Renders interleaved 16 bit stereo. The frames are cut at every step of every
+// playing sequence, so notes start on the frame their step starts.
+// --------------------------------------------------------------------------------
+void HostSoundRender(int16_t* pFrames, int nFrameCount)
+{
+	float out[HOST_MAX_CHUNK * 2];
+
+	while (nFrameCount > 0)
+	{
+		int nChunk = nFrameCount < HOST_MAX_CHUNK ? nFrameCount : HOST_MAX_CHUNK;
+
+		for (int i = 0; i < nSequenceCount; i++)
+		{
+			HostSequence* pSequence = pSequences[i];
+
+			while (pSequence->bPlaying && pSequence->fFramesToStep < 1.0)
+				HostSequenceStartStep(pSequence, 1);
+
+			if (pSequence->bPlaying && pSequence->fFramesToStep < nChunk)
+				nChunk = (int)pSequence->fFramesToStep;
+		}
+
+		// notes played with a start time are cut in the same way
+		nChunk = HostStartPendingNotes(nChunk);
+
+		memset(out, 0, nChunk * 2 * sizeof(float));
+
+		int nVoices = 0;
+		for (int i = 0; i < nChannelCount; i++)
+			nVoices += HostChannelRender(pChannels[i], out, nChunk);
+
+		if (nVoices > stats.nPeakVoices)
+			stats.nPeakVoices = nVoices;
+
+		for (int i = 0; i < nSequenceCount; i++)
+		{
+			if (pSequences[i]->bPlaying)
+				pSequences[i]->fFramesToStep -= nChunk;
+		}
+
+		for (int i = 0; i < nChunk * 2; i++)
+		{
+			float fValue = out[i] * 32767.0f;
+			if (fValue > 32767.0f || fValue < -32768.0f)
+			{
+				fValue = fValue > 0.0f ? 32767.0f : -32768.0f;
+				stats.nClippedSamples++;
+			}
+
+			*pFrames++ = (int16_t)fValue;
+		}
+
+		nFrame += nChunk;
+		nFrameCount -= nChunk;
+	}
+
+}
@@ -0,0 +1,71 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// host_sound - a software version of the parts of pd->sound the player uses, so
+// beat_machine.c can load and play a beat on the PC. Everything is rendered by
+// HostSoundRender(), there is no audio device and no thread.
+
+#ifndef HOSTSOUND_H
+#define HOSTSOUND_H
+
+#pragma once
+
+#include <stdint.h>
+
+#include "pd_api.h"
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	HOST_MAX_VOICES = 128,			// per instrument, a frozen track uses one per key
+	HOST_MAX_CHANNEL_SOURCES = 8,
+	HOST_MAX_CHANNEL_EFFECTS = 8,
+	HOST_MAX_SEQUENCE_TRACKS = 64,
+
+	HOST_DEVICE_RATE = 44100,		// delay lengths are given in frames at this rate
+	HOST_MIDDLE_C = 60				// a sample plays at its own pitch on this note
+
+} HOST_SOUND_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+typedef struct
+{
+	int nNoteCount;					// note events started
+	int nStolenVoices;
+	int nPeakVoices;				// most voices sounding at once
+	uint64_t nVoiceFrames;			// frames rendered by all voices, the main cost of a beat
+	uint64_t nClippedSamples;		// the mix is saturated like on the device
+	uint32_t nLastScheduledStart;	// device time the last note played with a start time began on
+
+} HostSoundStats;
+
+
+// --------------------------------------------------------------------------------
+void HostSoundInit(int nSampleRate, const char* szRoot);
+
+const struct playdate_sound* HostSoundGetAPI(void);
+
+void HostSoundRender(int16_t* pFrames, int nFrameCount);
+int HostSoundIsActive(void);
+
+const HostSoundStats* HostSoundGetStats(void);
+
+
+#endif
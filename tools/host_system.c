@@ -0,0 +1,245 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include "host_system.h"
+
+
+// --------------------------------------------------------------------------------
+static const char* szRootPath = "../Source/";
+static struct timespec startTime;
+
+
+// --------------------------------------------------------------------------------
+static const char* FullPath(const char* szPath)
+{
+	static char szFullPath[HOST_PATH_SIZE];
+	snprintf(szFullPath, sizeof(szFullPath), "%s%s", szRootPath, szPath);
+
+	return szFullPath;
+}
+
+
+// --------------------------------------------------------------------------------
+double HostWallSeconds(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec - startTime.tv_sec) + (now.tv_nsec - startTime.tv_nsec) / 1e9;
+}
+
+
+// --------------------------------------------------------------------------------
+// system
+// --------------------------------------------------------------------------------
+static void* SysRealloc(void* ptr, size_t size)
+{
+	if (size == 0)
+	{
+		free(ptr);
+		return NULL;
+	}
+
+	return realloc(ptr, size);
+}
+
+
+// --------------------------------------------------------------------------------
+static void SysLog(const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+
+	fputc('\n', stderr);
+}
+
+
+// --------------------------------------------------------------------------------
+static float SysGetElapsedTime(void)
+{
+	return (float)HostWallSeconds();
+}
+
+
+// --------------------------------------------------------------------------------
+static void SysResetElapsedTime(void)
+{
+	clock_gettime(CLOCK_MONOTONIC, &startTime);
+}
+
+
+// --------------------------------------------------------------------------------
+static unsigned int SysGetCurrentTimeMilliseconds(void)
+{
+	return (unsigned int)(HostWallSeconds() * 1000.0);
+}
+
+
+// --------------------------------------------------------------------------------
+// files
+// --------------------------------------------------------------------------------
+static const char* FileGetErr(void)
+{
+	return "host file error";
+}
+
+
+// --------------------------------------------------------------------------------
+static int FileStatPath(const char* path, FileStat* pStat)
+{
+	struct stat fileStat;
+	if (stat(FullPath(path), &fileStat) != 0)
+		return -1;
+
+	struct tm* pTime = gmtime(&fileStat.st_mtime);
+
+	memset(pStat, 0, sizeof(FileStat));
+	pStat->isdir = S_ISDIR(fileStat.st_mode);
+	pStat->size = (unsigned int)fileStat.st_size;
+	pStat->m_year = pTime->tm_year + 1900;
+	pStat->m_month = pTime->tm_mon + 1;
+	pStat->m_day = pTime->tm_mday;
+	pStat->m_hour = pTime->tm_hour;
+	pStat->m_minute = pTime->tm_min;
+	pStat->m_second = pTime->tm_sec;
+
+	return 0;
+}
+
+
+// --------------------------------------------------------------------------------
+// names come in the order of readdir(), folders with a trailing '/' as on the device
+// --------------------------------------------------------------------------------
+static int FileListFiles(const char* path, void (*callback)(const char* path, void* userdata), void* userdata, int showhidden)
+{
+	char szDir[HOST_PATH_SIZE];
+	snprintf(szDir, sizeof(szDir), "%s", FullPath(path));
+
+	DIR* pDir = opendir(szDir);
+	if (pDir == NULL)
+		return -1;
+
+	struct dirent* pEntry;
+	while ((pEntry = readdir(pDir)) != NULL)
+	{
+		if (strcmp(pEntry->d_name, ".") == 0 || strcmp(pEntry->d_name, "..") == 0)
+			continue;
+
+		if (!showhidden && pEntry->d_name[0] == '.')
+			continue;
+
+		char szPath[HOST_PATH_SIZE + sizeof(pEntry->d_name)];
+		snprintf(szPath, sizeof(szPath), "%s/%s", szDir, pEntry->d_name);
+
+		struct stat fileStat;
+		int bDir = stat(szPath, &fileStat) == 0 && S_ISDIR(fileStat.st_mode);
+
+		char szName[HOST_PATH_SIZE];
+		snprintf(szName, sizeof(szName), "%s%s", pEntry->d_name, bDir ? "/" : "");
+
+		callback(szName, userdata);
+	}
+
+	closedir(pDir);
+	return 0;
+}
+
+
+// --------------------------------------------------------------------------------
+static int FileUnlink(const char* name, int recursive)
+{
+	return unlink(FullPath(name)) == 0 ? 0 : -1;
+}
+
+
+// --------------------------------------------------------------------------------
+static SDFile* FileOpen(const char* name, FileOptions mode)
+{
+	return (SDFile*)fopen(FullPath(name), (mode & kFileWrite) ? "wb" : (mode & kFileAppend) ? "ab" : "rb");
+}
+
+
+// --------------------------------------------------------------------------------
+static int FileClose(SDFile* file)											{ return fclose((FILE*)file); }
+static int FileRead(SDFile* file, void* buf, unsigned int len)				{ return (int)fread(buf, 1, len, (FILE*)file); }
+static int FileWrite(SDFile* file, const void* buf, unsigned int len)		{ return (int)fwrite(buf, 1, len, (FILE*)file); }
+static int FileTell(SDFile* file)											{ return (int)ftell((FILE*)file); }
+static int FileSeek(SDFile* file, int pos, int whence)						{ return fseek((FILE*)file, pos, whence); }
+
+
+// --------------------------------------------------------------------------------
+static const struct playdate_sys sysApi =
+{
+	.realloc = SysRealloc,
+	.logToConsole = SysLog,
+	.error = SysLog,
+	.getCurrentTimeMilliseconds = SysGetCurrentTimeMilliseconds,
+	.getElapsedTime = SysGetElapsedTime,
+	.resetElapsedTime = SysResetElapsedTime,
+};
+
+static const struct playdate_file fileApi =
+{
+	.geterr = FileGetErr,
+	.listfiles = FileListFiles,
+	.stat = FileStatPath,
+	.unlink = FileUnlink,
+	.open = FileOpen,
+	.close = FileClose,
+	.read = FileRead,
+	.write = FileWrite,
+	.tell = FileTell,
+	.seek = FileSeek,
+};
+
+
+// --------------------------------------------------------------------------------
+// szRoot is where the device would have the game's data, "beats/demo.bmf" is read
+// from szRoot + "beats/demo.bmf". The elapsed time starts from here.
+// --------------------------------------------------------------------------------
+void HostSystemInit(const char* szRoot)
+{
+	szRootPath = szRoot;
+	SysResetElapsedTime();
+
+}
+
+
+// --------------------------------------------------------------------------------
+const struct playdate_sys* HostSystemGetAPI(void)
+{
+	return &sysApi;
+}
+
+
+// --------------------------------------------------------------------------------
+const struct playdate_file* HostFileGetAPI(void)
+{
+	return &fileApi;
+}
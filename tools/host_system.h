@@ -0,0 +1,47 @@
+/*
+BSD Zero Clause License
+=======================
+
+Copyright (C) Khors Media
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// host_system - pd->system and pd->file for the host tools, the file system is
+// plain stdio under a data directory and the elapsed time is the wall clock.
+
+#ifndef HOSTSYSTEM_H
+#define HOSTSYSTEM_H
+
+#pragma once
+
+#include "pd_api.h"
+
+
+// --------------------------------------------------------------------------------
+typedef enum
+{
+	HOST_PATH_SIZE = 1024
+
+} HOST_SYSTEM_CONSTS;
+
+
+// --------------------------------------------------------------------------------
+void HostSystemInit(const char* szRoot);
+
+const struct playdate_sys* HostSystemGetAPI(void);
+const struct playdate_file* HostFileGetAPI(void);
+
+double HostWallSeconds(void);
+
+
+#endif